@@ -57,6 +57,7 @@
 # include <openssl/dh.h>
 #endif
 #include <openssl/x509.h>
+#include <openssl/pem.h>
 #include <openssl/dsa.h>
 #include "./testdsa.h"
 #include <openssl/modes.h>
@@ -79,6 +80,8 @@
 #define MAX_ECDH_SIZE   256
 #define MISALIGN        64
 #define MAX_FFDH_SIZE 1024
+/* The largest generate request of the built-in DRBGs */
+#define MAX_RAND_BUFFER (1 << 16)
 
 #ifndef RSA_DEFAULT_PRIME_NUM
 # define RSA_DEFAULT_PRIME_NUM 2
@@ -210,7 +213,8 @@ typedef enum OPTION_choice {
     OPT_ERR = -1, OPT_EOF = 0, OPT_HELP,
     OPT_ELAPSED, OPT_EVP, OPT_HMAC, OPT_DECRYPT, OPT_ENGINE, OPT_MULTI,
     OPT_MR, OPT_MB, OPT_MISALIGN, OPT_ASYNCJOBS, OPT_R_ENUM, OPT_PROV_ENUM,
-    OPT_PRIMES, OPT_SECONDS, OPT_BYTES, OPT_AEAD, OPT_CMAC
+    OPT_PRIMES, OPT_SECONDS, OPT_BYTES, OPT_AEAD, OPT_CMAC, OPT_RAND_BUFFER,
+    OPT_LOAD
 } OPTION_CHOICE;
 
 const OPTIONS speed_options[] = {
@@ -241,6 +245,8 @@ const OPTIONS speed_options[] = {
      "Time decryption instead of encryption (only EVP)"},
     {"aead", OPT_AEAD, '-',
      "Benchmark EVP-named AEAD cipher in TLS-like sequence"},
+    {"load", OPT_LOAD, '-',
+     "Also time loading of the RSA keys from DER and PEM"},
 
     OPT_SECTION("Timing"),
     {"elapsed", OPT_ELAPSED, '-',
@@ -251,6 +257,8 @@ const OPTIONS speed_options[] = {
      "Run [non-PKI] benchmarks on custom-sized buffer"},
     {"misalign", OPT_MISALIGN, 'p',
      "Use specified offset to mis-align buffers"},
+    {"rand_buffer", OPT_RAND_BUFFER, 'p',
+     "Serve small rand requests from a buffer of the given size"},
 
     OPT_R_OPTIONS,
     OPT_PROV_OPTIONS,
@@ -345,7 +353,8 @@ static const OPT_PAIR rsa_choices[RSA_NUM] = {
     {"rsa15360", R_RSA_15360}
 };
 
-static double rsa_results[RSA_NUM][2];  /* 2 ops: sign then verify */
+/* 4 ops: sign, verify, load from DER and load from PEM */
+static double rsa_results[RSA_NUM][4];
 
 #ifndef OPENSSL_NO_DH
 enum ff_params_t {
@@ -439,7 +448,9 @@ static const OPT_PAIR eddsa_choices[EdDSA_NUM] = {
     {"ed448", R_EC_Ed448}
 
 };
-static double eddsa_results[EdDSA_NUM][2];    /* 2 ops: sign then verify */
+/* 3 ops: sign, verify, then verify in batches of EdDSA_BATCH */
+static double eddsa_results[EdDSA_NUM][3];
+#define EdDSA_BATCH 64
 
 #ifndef OPENSSL_NO_SM2
 enum { R_EC_CURVESM2, SM2_NUM };
@@ -851,6 +862,8 @@ static int EVP_Update_loop_aead(void *args)
             EVP_EncryptUpdate(ctx, NULL, &outl, aad, sizeof(aad));
             EVP_EncryptUpdate(ctx, buf, &outl, buf, lengths[testnum]);
             EVP_EncryptFinal_ex(ctx, buf + outl, &outl);
+            EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG,
+                                sizeof(faketag), faketag);
         }
     }
     return count;
@@ -900,6 +913,54 @@ static int RSA_verify_loop(void *args)
     return count;
 }
 
+/* The encodings of the RSA key that is currently being loaded */
+static unsigned char *load_der = NULL;
+static long load_der_len = 0;
+static char *load_pem = NULL;
+static long load_pem_len = 0;
+
+static int RSA_load_der_loop(void *args)
+{
+    const unsigned char *p;
+    EVP_PKEY *pkey;
+    int count;
+
+    for (count = 0; COND(rsa_c[testnum][0]); count++) {
+        p = load_der;
+        pkey = d2i_PrivateKey(EVP_PKEY_RSA, NULL, &p, load_der_len);
+        if (pkey == NULL) {
+            BIO_printf(bio_err, "RSA key load failure\n");
+            ERR_print_errors(bio_err);
+            count = -1;
+            break;
+        }
+        EVP_PKEY_free(pkey);
+    }
+    return count;
+}
+
+static int RSA_load_pem_loop(void *args)
+{
+    BIO *in;
+    EVP_PKEY *pkey = NULL;
+    int count;
+
+    for (count = 0; COND(rsa_c[testnum][0]); count++) {
+        if ((in = BIO_new_mem_buf(load_pem, (int)load_pem_len)) != NULL)
+            pkey = PEM_read_bio_PrivateKey(in, NULL, NULL, NULL);
+        BIO_free(in);
+        if (pkey == NULL) {
+            BIO_printf(bio_err, "RSA key load failure\n");
+            ERR_print_errors(bio_err);
+            count = -1;
+            break;
+        }
+        EVP_PKEY_free(pkey);
+        pkey = NULL;
+    }
+    return count;
+}
+
 #ifndef OPENSSL_NO_DH
 static long ffdh_c[FFDH_NUM][1];
 
@@ -1064,6 +1125,34 @@ static int EdDSA_verify_loop(void *args)
     return count;
 }
 
+static int EdDSA_verify_batch_loop(void *args)
+{
+    loopargs_t *tempargs = *(loopargs_t **) args;
+    EVP_MD_CTX **edctx = tempargs->eddsa_ctx2;
+    const unsigned char *sigs[EdDSA_BATCH], *tbs[EdDSA_BATCH];
+    size_t siglens[EdDSA_BATCH], tbslens[EdDSA_BATCH];
+    int vresults[EdDSA_BATCH];
+    int i, ret, count;
+
+    for (i = 0; i < EdDSA_BATCH; i++) {
+        sigs[i] = tempargs->buf2;
+        siglens[i] = tempargs->sigsize;
+        tbs[i] = tempargs->buf;
+        tbslens[i] = 20;
+    }
+    for (count = 0; COND(eddsa_c[testnum][1]); count += EdDSA_BATCH) {
+        ret = EVP_DigestVerifyBatch(edctx[testnum], EdDSA_BATCH, sigs, siglens,
+                                    tbs, tbslens, vresults);
+        if (ret != 1) {
+            BIO_printf(bio_err, "EdDSA batch verify failure\n");
+            ERR_print_errors(bio_err);
+            count = -1;
+            break;
+        }
+    }
+    return count;
+}
+
 #ifndef OPENSSL_NO_SM2
 static long sm2_c[SM2_NUM][2];
 static int SM2_sign_loop(void *args)
@@ -1378,7 +1467,8 @@ int speed_main(int argc, char **argv)
     OPTION_CHOICE o;
     int async_init = 0, multiblock = 0, pr_header = 0;
     uint8_t doit[ALGOR_NUM] = { 0 };
-    int ret = 1, misalign = 0, lengths_single = 0, aead = 0;
+    int ret = 1, misalign = 0, lengths_single = 0, aead = 0, load = 0;
+    unsigned long rand_buffer = 0;
     long count = 0;
     unsigned int size_num = SIZE_NUM;
     unsigned int i, k, loopargs_len = 0, async_jobs = 0;
@@ -1637,6 +1727,18 @@ int speed_main(int argc, char **argv)
         case OPT_AEAD:
             aead = 1;
             break;
+        case OPT_LOAD:
+            load = 1;
+            break;
+        case OPT_RAND_BUFFER:
+            if (!opt_ulong(opt_arg(), &rand_buffer))
+                goto end;
+            if (rand_buffer > MAX_RAND_BUFFER) {
+                BIO_printf(bio_err, "%s: Maximum rand buffer size is %d\n",
+                           prog, MAX_RAND_BUFFER);
+                goto opterr;
+            }
+            break;
         }
     }
 
@@ -2194,6 +2296,19 @@ int speed_main(int argc, char **argv)
     }
 
     if (doit[D_RAND]) {
+        if (rand_buffer > 0) {
+            OSSL_PARAM params[2];
+            size_t bufsize = rand_buffer;
+
+            params[0] = OSSL_PARAM_construct_size_t(OSSL_DRBG_PARAM_BUFFER_SIZE,
+                                                    &bufsize);
+            params[1] = OSSL_PARAM_construct_end();
+            if (!EVP_RAND_set_ctx_params(RAND_get0_public(NULL), params)) {
+                BIO_printf(bio_err, "Failed to set rand buffer size\n");
+                ERR_print_errors(bio_err);
+                goto end;
+            }
+        }
         for (testnum = 0; testnum < size_num; testnum++) {
             print_message(names[D_RAND], c[D_RAND][testnum], lengths[testnum],
                           seconds.sym);
@@ -2433,6 +2548,49 @@ int speed_main(int argc, char **argv)
             rsa_results[testnum][1] = (double)count / d;
         }
 
+        if (load && rsa_key != NULL) {
+            BIO *mem = BIO_new(BIO_s_mem());
+
+            st = mem != NULL
+                && (load_der_len = i2d_PrivateKey(rsa_key, &load_der)) > 0
+                && PEM_write_bio_PrivateKey(mem, rsa_key, NULL, NULL, 0,
+                                            NULL, NULL)
+                && (load_pem_len = BIO_get_mem_data(mem, &load_pem)) > 0;
+            if (!st) {
+                BIO_printf(bio_err,
+                           "RSA key encoding failure.  No RSA key loading will be done.\n");
+                ERR_print_errors(bio_err);
+            } else {
+                pkey_print_message("DER load", "rsa",
+                                   rsa_c[testnum][0], rsa_keys[testnum].bits,
+                                   seconds.rsa);
+                Time_F(START);
+                count = run_benchmark(async_jobs, RSA_load_der_loop, loopargs);
+                d = Time_F(STOP);
+                BIO_printf(bio_err,
+                           mr ? "+R14:%ld:%d:%.2f\n"
+                           : "%ld %u bits RSA DER loads in %.2fs\n",
+                           count, rsa_keys[testnum].bits, d);
+                rsa_results[testnum][2] = (double)count / d;
+
+                pkey_print_message("PEM load", "rsa",
+                                   rsa_c[testnum][0], rsa_keys[testnum].bits,
+                                   seconds.rsa);
+                Time_F(START);
+                count = run_benchmark(async_jobs, RSA_load_pem_loop, loopargs);
+                d = Time_F(STOP);
+                BIO_printf(bio_err,
+                           mr ? "+R15:%ld:%d:%.2f\n"
+                           : "%ld %u bits RSA PEM loads in %.2fs\n",
+                           count, rsa_keys[testnum].bits, d);
+                rsa_results[testnum][3] = (double)count / d;
+            }
+            OPENSSL_free(load_der);
+            load_der = NULL;
+            load_pem = NULL;
+            BIO_free(mem);
+        }
+
         if (op_count <= 1) {
             /* if longer than 10s, don't do any more */
             stop_it(rsa_doit, testnum);
@@ -2790,6 +2948,21 @@ int speed_main(int argc, char **argv)
                            count, ed_curves[testnum].bits,
                            ed_curves[testnum].name, d);
                 eddsa_results[testnum][1] = (double)count / d;
+
+                /* Perform EdDSA batch verification test */
+                pkey_print_message("batch verify", ed_curves[testnum].name,
+                                   eddsa_c[testnum][1],
+                                   ed_curves[testnum].bits, seconds.eddsa);
+                Time_F(START);
+                count = run_benchmark(async_jobs, EdDSA_verify_batch_loop,
+                                      loopargs);
+                d = Time_F(STOP);
+                BIO_printf(bio_err,
+                           mr ? "+R13:%ld:%u:%s:%.2f\n"
+                           : "%ld %u bits %s batch verify in %.2fs\n",
+                           count, ed_curves[testnum].bits,
+                           ed_curves[testnum].name, d);
+                eddsa_results[testnum][2] = (double)count / d;
             }
 
             if (op_count <= 1) {
@@ -3172,6 +3345,23 @@ int speed_main(int argc, char **argv)
                    rsa_results[k][0], rsa_results[k][1]);
     }
     testnum = 1;
+    for (k = 0; k < RSA_NUM; k++) {
+        if (!rsa_doit[k] || rsa_results[k][2] == 0)
+            continue;
+        if (testnum && !mr) {
+            printf("%18sDER     PEM        DER/s    PEM/s  (key loading)\n",
+                   " ");
+            testnum = 0;
+        }
+        if (mr)
+            printf("+F10:%u:%u:%f:%f\n",
+                   k, rsa_keys[k].bits, rsa_results[k][2], rsa_results[k][3]);
+        else
+            printf("rsa %4u bits %8.6fs %8.6fs %8.1f %8.1f\n",
+                   rsa_keys[k].bits, 1.0 / rsa_results[k][2], 1.0 / rsa_results[k][3],
+                   rsa_results[k][2], rsa_results[k][3]);
+    }
+    testnum = 1;
     for (k = 0; k < DSA_NUM; k++) {
         if (!dsa_doit[k])
             continue;
@@ -3246,6 +3436,26 @@ int speed_main(int argc, char **argv)
                    eddsa_results[k][0], eddsa_results[k][1]);
     }
 
+    testnum = 1;
+    for (k = 0; k < OSSL_NELEM(eddsa_doit); k++) {
+        if (!eddsa_doit[k] || eddsa_results[k][2] == 0)
+            continue;
+        if (testnum && !mr) {
+            printf("%30sverify  verify/s  (in batches of %d)\n", " ",
+                   EdDSA_BATCH);
+            testnum = 0;
+        }
+
+        if (mr)
+            printf("+F9:%u:%u:%s:%f\n",
+                   k, ed_curves[k].bits, ed_curves[k].name,
+                   eddsa_results[k][2]);
+        else
+            printf("%4u bits EdDSA (%s) %8.4fs %8.1f\n",
+                   ed_curves[k].bits, ed_curves[k].name,
+                   1.0 / eddsa_results[k][2], eddsa_results[k][2]);
+    }
+
 #ifndef OPENSSL_NO_SM2
     testnum = 1;
     for (k = 0; k < OSSL_NELEM(sm2_doit); k++) {
@@ -3498,6 +3708,19 @@ static int do_multi(int multi, int size_num)
 
                 d = atof(sstrsep(&p, sep));
                 rsa_results[k][1] += d;
+            } else if (strncmp(buf, "+F10:", 5) == 0) {
+                int k;
+                double d;
+
+                p = buf + 5;
+                k = atoi(sstrsep(&p, sep));
+                sstrsep(&p, sep);
+
+                d = atof(sstrsep(&p, sep));
+                rsa_results[k][2] += d;
+
+                d = atof(sstrsep(&p, sep));
+                rsa_results[k][3] += d;
             } else if (strncmp(buf, "+F3:", 4) == 0) {
                 int k;
                 double d;
@@ -3548,6 +3771,17 @@ static int do_multi(int multi, int size_num)
 
                 d = atof(sstrsep(&p, sep));
                 eddsa_results[k][1] += d;
+            } else if (strncmp(buf, "+F9:", 4) == 0) {
+                int k;
+                double d;
+
+                p = buf + 4;
+                k = atoi(sstrsep(&p, sep));
+                sstrsep(&p, sep);
+                sstrsep(&p, sep);
+
+                d = atof(sstrsep(&p, sep));
+                eddsa_results[k][2] += d;
 # ifndef OPENSSL_NO_SM2
             } else if (strncmp(buf, "+F7:", 4) == 0) {
                 int k;
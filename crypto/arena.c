@@ -0,0 +1,166 @@
+/*
+ * Copyright 2021 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include <openssl/crypto.h>
+#include "internal/arena.h"
+
+/*
+ * Allocations are carved off the end of the current chunk.  Each chunk
+ * knows the arena position it starts at, so that a position returned by
+ * ossl_arena_mark() identifies both a chunk and an offset into it.
+ * Chunks that are given up by ossl_arena_release() are kept for reuse,
+ * unless they were made bigger than usual for an oversized allocation.
+ */
+
+#define ARENA_ALIGN             16
+#define ARENA_ROUND(n)          (((n) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+#define ARENA_MIN_CHUNK_SIZE    256
+
+typedef struct arena_chunk_st {
+    struct arena_chunk_st *prev;
+    size_t size;                /* Usable bytes after the header */
+    size_t base;                /* Arena position of the first usable byte */
+} ARENA_CHUNK;
+
+#define ARENA_CHUNK_HDR         ARENA_ROUND(sizeof(ARENA_CHUNK))
+#define ARENA_CHUNK_DATA(c)     ((unsigned char *)(c) + ARENA_CHUNK_HDR)
+
+struct ossl_arena_st {
+    ARENA_CHUNK *chunk;         /* The chunk being allocated from */
+    ARENA_CHUNK *spare;         /* Released chunks of the usual size */
+    size_t chunk_size;
+    size_t used;                /* Bytes used in |chunk| */
+
+    size_t allocs;              /* Number of allocations served */
+    size_t heap_allocs;         /* Number of chunks taken from the heap */
+    size_t high_water;          /* Largest position reached */
+};
+
+OSSL_ARENA *ossl_arena_new(size_t chunk_size)
+{
+    OSSL_ARENA *arena = OPENSSL_zalloc(sizeof(*arena));
+
+    if (arena == NULL)
+        return NULL;
+    if (chunk_size < ARENA_MIN_CHUNK_SIZE)
+        chunk_size = ARENA_MIN_CHUNK_SIZE;
+    arena->chunk_size = ARENA_ROUND(chunk_size);
+    return arena;
+}
+
+static void arena_free_chunks(ARENA_CHUNK *chunk)
+{
+    ARENA_CHUNK *prev;
+
+    for (; chunk != NULL; chunk = prev) {
+        prev = chunk->prev;
+        OPENSSL_free(chunk);
+    }
+}
+
+void ossl_arena_free(OSSL_ARENA *arena)
+{
+    if (arena == NULL)
+        return;
+    arena_free_chunks(arena->chunk);
+    arena_free_chunks(arena->spare);
+    OPENSSL_free(arena);
+}
+
+/* Start a new chunk of at least |num| bytes at the current position */
+static int arena_grow(OSSL_ARENA *arena, size_t num)
+{
+    ARENA_CHUNK *chunk;
+    size_t base = ossl_arena_mark(arena);
+
+    if (num <= arena->chunk_size && arena->spare != NULL) {
+        chunk = arena->spare;
+        arena->spare = chunk->prev;
+    } else {
+        size_t size = num > arena->chunk_size ? num : arena->chunk_size;
+
+        if (size > SIZE_MAX - ARENA_CHUNK_HDR
+                || (chunk = OPENSSL_malloc(ARENA_CHUNK_HDR + size)) == NULL)
+            return 0;
+        chunk->size = size;
+        arena->heap_allocs++;
+    }
+    chunk->base = base;
+    chunk->prev = arena->chunk;
+    arena->chunk = chunk;
+    arena->used = 0;
+    return 1;
+}
+
+void *ossl_arena_alloc(OSSL_ARENA *arena, size_t num)
+{
+    void *ret;
+
+    if (num == 0 || num > SIZE_MAX - ARENA_ALIGN)
+        return NULL;
+    num = ARENA_ROUND(num);
+
+    if ((arena->chunk == NULL || arena->chunk->size - arena->used < num)
+            && !arena_grow(arena, num))
+        return NULL;
+
+    ret = ARENA_CHUNK_DATA(arena->chunk) + arena->used;
+    arena->used += num;
+    arena->allocs++;
+    if (arena->chunk->base + arena->used > arena->high_water)
+        arena->high_water = arena->chunk->base + arena->used;
+    return ret;
+}
+
+void *ossl_arena_zalloc(OSSL_ARENA *arena, size_t num)
+{
+    void *ret = ossl_arena_alloc(arena, num);
+
+    if (ret != NULL)
+        memset(ret, 0, num);
+    return ret;
+}
+
+size_t ossl_arena_mark(const OSSL_ARENA *arena)
+{
+    return arena->chunk == NULL ? 0 : arena->chunk->base + arena->used;
+}
+
+void ossl_arena_release(OSSL_ARENA *arena, size_t mark)
+{
+    ARENA_CHUNK *chunk;
+
+    while ((chunk = arena->chunk) != NULL && chunk->base >= mark) {
+        arena->chunk = chunk->prev;
+        if (chunk->size == arena->chunk_size) {
+            chunk->prev = arena->spare;
+            arena->spare = chunk;
+        } else {
+            OPENSSL_free(chunk);
+        }
+    }
+    arena->used = chunk == NULL ? 0 : mark - chunk->base;
+}
+
+void ossl_arena_reset(OSSL_ARENA *arena)
+{
+    ossl_arena_release(arena, 0);
+}
+
+void ossl_arena_get_stats(const OSSL_ARENA *arena, size_t *allocs,
+                          size_t *heap_allocs, size_t *high_water)
+{
+    if (allocs != NULL)
+        *allocs = arena->allocs;
+    if (heap_allocs != NULL)
+        *heap_allocs = arena->heap_allocs;
+    if (high_water != NULL)
+        *high_water = arena->high_water;
+}
@@ -77,12 +77,14 @@ int ossl_i2c_ASN1_BIT_STRING(ASN1_BIT_STRING *a, unsigned char **pp)
 }
 
 ASN1_BIT_STRING *ossl_c2i_ASN1_BIT_STRING(ASN1_BIT_STRING **a,
-                                          const unsigned char **pp, long len)
+                                          const unsigned char **pp, long len,
+                                          int borrow)
 {
     ASN1_BIT_STRING *ret = NULL;
     const unsigned char *p;
     unsigned char *s;
     int i;
+    int borrowed = 0;
 
     if (len < 1) {
         i = ASN1_R_STRING_TOO_SHORT;
@@ -114,20 +116,26 @@ ASN1_BIT_STRING *ossl_c2i_ASN1_BIT_STRING(ASN1_BIT_STRING **a,
     ret->flags |= (ASN1_STRING_FLAG_BITS_LEFT | i); /* set */
 
     if (len-- > 1) {            /* using one because of the bits left byte */
-        s = OPENSSL_malloc((int)len);
-        if (s == NULL) {
-            i = ERR_R_MALLOC_FAILURE;
-            goto err;
+        if (borrow && (p[len - 1] & ~(0xff << i)) == 0) {
+            /* The unused bits are clear already, so the input can be used */
+            s = (unsigned char *)p;
+            borrowed = 1;
+        } else {
+            s = OPENSSL_malloc((int)len);
+            if (s == NULL) {
+                i = ERR_R_MALLOC_FAILURE;
+                goto err;
+            }
+            memcpy(s, p, (int)len);
+            s[len - 1] &= (0xff << i);
         }
-        memcpy(s, p, (int)len);
-        s[len - 1] &= (0xff << i);
         p += len;
     } else
         s = NULL;
 
-    ret->length = (int)len;
-    OPENSSL_free(ret->data);
-    ret->data = s;
+    ASN1_STRING_set0(ret, s, (int)len);
+    if (borrowed)
+        ret->flags |= ASN1_STRING_FLAG_BORROWED;
     ret->type = V_ASN1_BIT_STRING;
     if (a != NULL)
         (*a) = ret;
@@ -159,6 +167,11 @@ int ASN1_BIT_STRING_set_bit(ASN1_BIT_STRING *a, int n, int value)
 
     a->flags &= ~(ASN1_STRING_FLAG_BITS_LEFT | 0x07); /* clear, set on write */
 
+    /* Borrowed data must not be written to, so take a copy first */
+    if ((a->flags & ASN1_STRING_FLAG_BORROWED) != 0
+        && !ASN1_STRING_set(a, a->data, a->length))
+        return 0;
+
     if ((a->length < (w + 1)) || (a->data == NULL)) {
         if (!value)
             return 1;         /* Don't need to set */
@@ -253,9 +253,10 @@ int ASN1_STRING_copy(ASN1_STRING *dst, const ASN1_STRING *str)
     dst->type = str->type;
     if (!ASN1_STRING_set(dst, str->data, str->length))
         return 0;
-    /* Copy flags but preserve embed value */
+    /* Copy flags but preserve embed value, the copy owns its data */
     dst->flags &= ASN1_STRING_FLAG_EMBED;
-    dst->flags |= str->flags & ~ASN1_STRING_FLAG_EMBED;
+    dst->flags |= str->flags
+        & ~(ASN1_STRING_FLAG_EMBED | ASN1_STRING_FLAG_BORROWED);
     return 1;
 }
 
@@ -297,6 +298,11 @@ int ASN1_STRING_set(ASN1_STRING *str, const void *_data, int len_in)
         ERR_raise(ERR_LIB_ASN1, ASN1_R_TOO_LARGE);
         return 0;
     }
+    /* Never write to or reallocate data that isn't ours */
+    if ((str->flags & ASN1_STRING_FLAG_BORROWED) != 0) {
+        str->data = NULL;
+        str->flags &= ~ASN1_STRING_FLAG_BORROWED;
+    }
     if ((size_t)str->length <= len || str->data == NULL) {
         c = str->data;
         str->data = OPENSSL_realloc(c, len + 1);
@@ -317,7 +323,9 @@ int ASN1_STRING_set(ASN1_STRING *str, const void *_data, int len_in)
 
 void ASN1_STRING_set0(ASN1_STRING *str, void *data, int len)
 {
-    OPENSSL_free(str->data);
+    if ((str->flags & ASN1_STRING_FLAG_BORROWED) == 0)
+        OPENSSL_free(str->data);
+    str->flags &= ~ASN1_STRING_FLAG_BORROWED;
     str->data = data;
     str->length = len;
 }
@@ -344,7 +352,7 @@ void ossl_asn1_string_embed_free(ASN1_STRING *a, int embed)
 {
     if (a == NULL)
         return;
-    if (!(a->flags & ASN1_STRING_FLAG_NDEF))
+    if (!(a->flags & (ASN1_STRING_FLAG_NDEF | ASN1_STRING_FLAG_BORROWED)))
         OPENSSL_free(a->data);
     if (embed == 0)
         OPENSSL_free(a);
@@ -361,7 +369,8 @@ void ASN1_STRING_clear_free(ASN1_STRING *a)
 {
     if (a == NULL)
         return;
-    if (a->data && !(a->flags & ASN1_STRING_FLAG_NDEF))
+    if (a->data
+        && !(a->flags & (ASN1_STRING_FLAG_NDEF | ASN1_STRING_FLAG_BORROWED)))
         OPENSSL_cleanse(a->data, a->length);
     ASN1_STRING_free(a);
 }
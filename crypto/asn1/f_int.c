@@ -134,6 +134,7 @@ int a2i_ASN1_INTEGER(BIO *bp, ASN1_INTEGER *bs, char *buf, int size)
     }
     bs->length = num;
     bs->data = s;
+    bs->flags &= ~ASN1_STRING_FLAG_BORROWED;
     return 1;
  err:
     ERR_raise(ERR_LIB_ASN1, ASN1_R_SHORT_LINE);
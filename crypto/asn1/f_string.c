@@ -126,6 +126,7 @@ int a2i_ASN1_STRING(BIO *bp, ASN1_STRING *bs, char *buf, int size)
     }
     bs->length = num;
     bs->data = s;
+    bs->flags &= ~ASN1_STRING_FLAG_BORROWED;
     return 1;
 
  err:
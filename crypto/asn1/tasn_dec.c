@@ -57,7 +57,8 @@ static int asn1_d2i_ex_primitive(ASN1_VALUE **pval,
                                  int tag, int aclass, char opt,
                                  ASN1_TLC *ctx);
 static int asn1_ex_c2i(ASN1_VALUE **pval, const unsigned char *cont, int len,
-                       int utype, char *free_cont, const ASN1_ITEM *it);
+                       int utype, char *free_cont, int borrow,
+                       const ASN1_ITEM *it);
 
 /* Table to convert tags to bit values, used for MSTRING type */
 static const unsigned long tag2bit[32] = {
@@ -88,9 +89,17 @@ unsigned long ASN1_tag2bit(int tag)
     return tag2bit[tag];
 }
 
+/*
+ * Bits of ASN1_TLC.valid.  Callers of ASN1_item_ex_d2i() only ever set it
+ * to zero, so the borrowed decoding mode lives there rather than in a field
+ * of its own that they wouldn't know to initialise.
+ */
+#define ASN1_TLC_VALID          0x01
+#define ASN1_TLC_BORROW         0x02
+
 /* Macro to initialize and invalidate the cache */
 
-#define asn1_tlc_clear(c)       if (c) (c)->valid = 0
+#define asn1_tlc_clear(c)       if (c) (c)->valid &= ~ASN1_TLC_VALID
 /* Version to avoid compiler warning about 'c' always non-NULL */
 #define asn1_tlc_clear_nc(c)    (c)->valid = 0
 
@@ -101,9 +110,9 @@ unsigned long ASN1_tag2bit(int tag)
  * this will simply be a special case.
  */
 
-ASN1_VALUE *ASN1_item_d2i(ASN1_VALUE **pval,
-                          const unsigned char **in, long len,
-                          const ASN1_ITEM *it)
+static ASN1_VALUE *asn1_item_d2i(ASN1_VALUE **pval,
+                                 const unsigned char **in, long len,
+                                 const ASN1_ITEM *it, int borrow)
 {
     ASN1_TLC c;
     ASN1_VALUE *ptmpval = NULL;
@@ -111,11 +120,31 @@ ASN1_VALUE *ASN1_item_d2i(ASN1_VALUE **pval,
     if (pval == NULL)
         pval = &ptmpval;
     asn1_tlc_clear_nc(&c);
+    if (borrow)
+        c.valid |= ASN1_TLC_BORROW;
     if (ASN1_item_ex_d2i(pval, in, len, it, -1, 0, 0, &c) > 0)
         return *pval;
     return NULL;
 }
 
+ASN1_VALUE *ASN1_item_d2i(ASN1_VALUE **pval,
+                          const unsigned char **in, long len,
+                          const ASN1_ITEM *it)
+{
+    return asn1_item_d2i(pval, in, len, it, 0);
+}
+
+/*
+ * Like ASN1_item_d2i(), but strings get to point into the input instead of
+ * getting a copy of it, so the input must outlive the result.
+ */
+ASN1_VALUE *ASN1_item_d2i_borrowed(ASN1_VALUE **pval,
+                                   const unsigned char **in, long len,
+                                   const ASN1_ITEM *it)
+{
+    return asn1_item_d2i(pval, in, len, it, 1);
+}
+
 int ASN1_item_ex_d2i(ASN1_VALUE **pval, const unsigned char **in, long len,
                      const ASN1_ITEM *it,
                      int tag, int aclass, char opt, ASN1_TLC *ctx)
@@ -771,7 +800,8 @@ static int asn1_d2i_ex_primitive(ASN1_VALUE **pval,
 
     /* We now have content length and type: translate into a structure */
     /* asn1_ex_c2i may reuse allocated buffer, and so sets free_cont to 0 */
-    if (!asn1_ex_c2i(pval, cont, len, utype, &free_cont, it))
+    if (!asn1_ex_c2i(pval, cont, len, utype, &free_cont,
+                     ctx != NULL && (ctx->valid & ASN1_TLC_BORROW) != 0, it))
         goto err;
 
     *in = p;
@@ -785,7 +815,8 @@ static int asn1_d2i_ex_primitive(ASN1_VALUE **pval,
 /* Translate ASN1 content octets into a structure */
 
 static int asn1_ex_c2i(ASN1_VALUE **pval, const unsigned char *cont, int len,
-                       int utype, char *free_cont, const ASN1_ITEM *it)
+                       int utype, char *free_cont, int borrow,
+                       const ASN1_ITEM *it)
 {
     ASN1_VALUE **opval = NULL;
     ASN1_STRING *stmp;
@@ -838,7 +869,8 @@ static int asn1_ex_c2i(ASN1_VALUE **pval, const unsigned char *cont, int len,
         break;
 
     case V_ASN1_BIT_STRING:
-        if (!ossl_c2i_ASN1_BIT_STRING((ASN1_BIT_STRING **)pval, &cont, len))
+        if (!ossl_c2i_ASN1_BIT_STRING((ASN1_BIT_STRING **)pval, &cont, len,
+                                      borrow && !*free_cont))
             goto err;
         break;
 
@@ -891,10 +923,11 @@ static int asn1_ex_c2i(ASN1_VALUE **pval, const unsigned char *cont, int len,
         }
         /* If we've already allocated a buffer use it */
         if (*free_cont) {
-            OPENSSL_free(stmp->data);
-            stmp->data = (unsigned char *)cont; /* UGLY CAST! RL */
-            stmp->length = len;
+            ASN1_STRING_set0(stmp, (unsigned char *)cont, len);
             *free_cont = 0;
+        } else if (borrow) {
+            ASN1_STRING_set0(stmp, (unsigned char *)cont, len);
+            stmp->flags |= ASN1_STRING_FLAG_BORROWED;
         } else {
             if (!ASN1_STRING_set(stmp, cont, len)) {
                 ERR_raise(ERR_LIB_ASN1, ERR_R_MALLOC_FAILURE);
@@ -1100,7 +1133,7 @@ static int asn1_check_tlen(long *olen, int *otag, unsigned char *oclass,
     p = *in;
     q = p;
 
-    if (ctx && ctx->valid) {
+    if (ctx && (ctx->valid & ASN1_TLC_VALID) != 0) {
         i = ctx->ret;
         plen = ctx->plen;
         pclass = ctx->pclass;
@@ -1114,7 +1147,7 @@ static int asn1_check_tlen(long *olen, int *otag, unsigned char *oclass,
             ctx->pclass = pclass;
             ctx->ptag = ptag;
             ctx->hdrlen = p - q;
-            ctx->valid = 1;
+            ctx->valid |= ASN1_TLC_VALID;
             /*
              * If definite length, and no error, length + header can't exceed
              * total amount of data available.
@@ -0,0 +1,568 @@
+#! /usr/bin/env perl
+# Copyright 2021 The OpenSSL Project Authors. All Rights Reserved.
+#
+# Licensed under the Apache License 2.0 (the "License").  You may not use
+# this file except in compliance with the License.  You can obtain a copy
+# in the file LICENSE in the source distribution or at
+# https://www.openssl.org/source/license.html
+#
+# Almost Montgomery Multiplication (AMM) of two independent pairs of
+# 1024-bit operands, using AVX512_IFMA. Single operand versions for 2048-,
+# 3072- and 4096-bit moduli follow further down.
+#
+# Operands are held in radix 2^52, 20 digits each, one digit per 64-bit
+# lane spread over three zmm registers. For every digit b[i] the products
+# a*b[i] and m*y, with y chosen to clear the lowest digit, are accumulated
+# with vpmadd52luq/vpmadd52huq. The high halves are accumulated against
+# copies of a and m shifted up by one digit, so that all four products of
+# an iteration land in the accumulator before it is shifted down by one
+# digit. The carry out of the lowest digit is tracked in a general purpose
+# register and only folded into the result by the final normalization.
+#
+# The two operand pairs are processed in interleaved fashion to hide the
+# latency of the scalar reduction step. Result is not fully reduced: for
+# inputs in [0, 2m) it is in [0, 2m), which is sufficient for modular
+# exponentiation with R = 2^1040 > 4m.
+#
+# Only zmm0-zmm5 and zmm16-zmm31 are used, which are all volatile in the
+# Win64 ABI, and no stack frame is needed.
+#
+# rsa2048 sign/s	scalar(*)	this
+# 2.0GHz Xeon(**)	907		1770/+95%
+#
+# (*)	x86_64-mont5 with MULX/AD*X;
+# (**)	AVX512_IFMA capable server part;
+
+# $output is the last argument if it looks like a file (it has an extension)
+# $flavour is the first argument if it doesn't look like a file
+$output = $#ARGV >= 0 && $ARGV[$#ARGV] =~ m|\.\w+$| ? pop : undef;
+$flavour = $#ARGV >= 0 && $ARGV[0] !~ m|\.| ? shift : undef;
+
+$win64=0; $win64=1 if ($flavour =~ /[nm]asm|mingw64/ || $output =~ /\.asm$/);
+
+$0 =~ m/(.*[\/\\])[^\/\\]+$/; $dir=$1;
+( $xlate="${dir}x86_64-xlate.pl" and -f $xlate ) or
+( $xlate="${dir}../../perlasm/x86_64-xlate.pl" and -f $xlate) or
+die "can't locate x86_64-xlate.pl";
+
+if (`$ENV{CC} -Wa,-v -c -o /dev/null -x assembler /dev/null 2>&1`
+		=~ /GNU assembler version ([2-9]\.[0-9]+)/) {
+	$avx512ifma = ($1>=2.26);
+}
+
+if (!$avx512ifma && $win64 && ($flavour =~ /nasm/ || $ENV{ASM} =~ /nasm/) &&
+	   `nasm -v 2>&1` =~ /NASM version ([2-9]\.[0-9]+)(?:\.([0-9]+))?/) {
+	$avx512ifma = ($1==2.11 && $2>=8) + ($1>=2.12);
+}
+
+if (!$avx512ifma && `$ENV{CC} -v 2>&1` =~ /((?:clang|LLVM) version|.*based on LLVM) ([0-9]+)\.([0-9]+)/) {
+	$avx512ifma = ($2>=7);
+}
+
+open OUT,"| \"$^X\" \"$xlate\" $flavour \"$output\""
+    or die "can't call $xlate: $!";
+*STDOUT=*OUT;
+
+if ($avx512ifma) {{{
+# void ossl_rsaz_amm52x20_x2_ifma256(BN_ULONG res[2][20],
+#                                    const BN_ULONG a[2][20],
+#                                    const BN_ULONG b[2][20],
+#                                    const BN_ULONG m[4][24],
+#                                    const BN_ULONG k0[2]);
+#
+# m[] holds, for each lane, the modulus and the modulus shifted up by one
+# digit, both zero padded to 24 digits: m0, m0 << 52, m1, m1 << 52.
+# |res| may alias |a| and |b|.
+my ($res,$a,$b,$m,$k0) = $win64 ? ("%rcx","%rdx","%r8","%r9","%r10")
+				: ("%rdi","%rsi","%rdx","%rcx","%r8");
+my ($acc0,$acc1,$mask) = ("%r11","%rax",$a);	# $a is dead by then
+my ($t,$t1) = $win64 ? ("%rdi","%rsi") : ("%r9","%r10");
+
+# per lane registers
+my @A  = (["%zmm16","%zmm17","%zmm18"], ["%zmm0","%zmm1","%zmm2"]);
+my @As = (["%zmm19","%zmm20","%zmm21"], ["%zmm3","%zmm4","%zmm5"]);
+my @L  = (["%zmm22","%zmm23","%zmm24"], ["%zmm27","%zmm28","%zmm29"]);
+my @B  = ("%zmm25","%zmm30");
+my @Y  = ("%zmm26","%zmm31");
+my @Lx = ("%xmm22","%xmm27");
+my @acc = ($acc0,$acc1);
+my @tmp = ($t,$t1);
+
+$code.=<<___;
+.text
+
+.globl	ossl_rsaz_avx512ifma_eligible
+.type	ossl_rsaz_avx512ifma_eligible,\@abi-omnipotent
+.align	32
+ossl_rsaz_avx512ifma_eligible:
+	mov	OPENSSL_ia32cap_P+8(%rip),%ecx
+	xor	%eax,%eax
+	and	\$`1<<16|1<<21`,%ecx	# check for AVX512F+AVX512IFMA
+	cmp	\$`1<<16|1<<21`,%ecx
+	sete	%al
+	ret
+.size	ossl_rsaz_avx512ifma_eligible,.-ossl_rsaz_avx512ifma_eligible
+
+.globl	ossl_rsaz_amm52x20_x2_ifma256
+.type	ossl_rsaz_amm52x20_x2_ifma256,\@abi-omnipotent
+.align	32
+ossl_rsaz_amm52x20_x2_ifma256:
+.cfi_startproc
+___
+$code.=<<___	if ($win64);
+	mov	40(%rsp),$k0		# 5th argument
+	mov	%rdi,8(%rsp)		# use home area to preserve
+	mov	%rsi,16(%rsp)		# non-volatile registers
+___
+$code.=<<___;
+	mov	\$0x0f,%eax
+	kmovw	%eax,%k1		# lanes 16..19 of a 20-digit operand
+	mov	\$0x7f,%eax
+	kmovw	%eax,%k2		# accumulator shift
+	mov	\$0xfe,%eax
+	kmovw	%eax,%k3		# first digit of shifted operand
+
+___
+for my $l (0..1) {
+my ($o0,$o1,$o2) = map(160*$l+64*$_, (0..2));
+$code.=<<___;
+	vmovdqu64	$o0($a),$A[$l][0]
+	vmovdqu64	$o1($a),$A[$l][1]
+	vmovdqu64	$o2($a),$A[$l][2]\{%k1\}\{z\}
+	valignq		\$7,$A[$l][0],$A[$l][0],$As[$l][0]\{%k3\}\{z\}
+	valignq		\$7,$A[$l][0],$A[$l][1],$As[$l][1]
+	valignq		\$7,$A[$l][1],$A[$l][2],$As[$l][2]
+	vpxorq		$L[$l][0],$L[$l][0],$L[$l][0]
+	vpxorq		$L[$l][1],$L[$l][1],$L[$l][1]
+	vpxorq		$L[$l][2],$L[$l][2],$L[$l][2]
+___
+}
+$code.=<<___;
+	xor	$acc0,$acc0
+	xor	$acc1,$acc1
+	mov	\$0xfffffffffffff,$mask
+___
+
+for my $i (0..19) {
+# accumulate a*b[i]
+for my $l (0..1) {
+my $off = 160*$l + 8*$i;
+$code.=<<___;
+	vpbroadcastq	$off($b),$B[$l]
+___
+}
+for my $j (0..2) {
+for my $l (0..1) {
+$code.=<<___;
+	vpmadd52luq	$A[$l][$j],$B[$l],$L[$l][$j]
+___
+}
+}
+for my $j (0..2) {
+for my $l (0..1) {
+$code.=<<___;
+	vpmadd52huq	$As[$l][$j],$B[$l],$L[$l][$j]
+___
+}
+}
+# y = (acc[0] * k0) mod 2^52, carry = (acc[0] + m[0] * y) >> 52
+for my $l (0..1) {
+$code.=<<___;
+	vmovq		$Lx[$l],$tmp[$l]
+___
+}
+for my $l (0..1) {
+$code.=<<___;
+	add		$tmp[$l],$acc[$l]
+___
+}
+for my $l (0..1) {
+my $off = 8*$l;
+$code.=<<___;
+	mov		$acc[$l],$tmp[$l]
+	imul		$off($k0),$tmp[$l]
+	and		$mask,$tmp[$l]
+	vpbroadcastq	$tmp[$l],$Y[$l]
+___
+}
+for my $l (0..1) {
+my $off = 384*$l;
+$code.=<<___;
+	imul		$off($m),$tmp[$l]
+	and		$mask,$tmp[$l]
+	add		$tmp[$l],$acc[$l]
+	shr		\$52,$acc[$l]
+___
+}
+# accumulate m*y
+for my $j (0..2) {
+for my $l (0..1) {
+my $off = 384*$l + 64*$j;
+$code.=<<___;
+	vpmadd52luq	$off($m),$Y[$l],$L[$l][$j]
+___
+}
+}
+for my $j (0..2) {
+for my $l (0..1) {
+my $off = 384*$l + 192 + 64*$j;
+$code.=<<___;
+	vpmadd52huq	$off($m),$Y[$l],$L[$l][$j]
+___
+}
+}
+# shift accumulator down by one digit
+for my $l (0..1) {
+$code.=<<___;
+	valignq		\$1,$L[$l][0],$L[$l][1],$L[$l][0]
+	valignq		\$1,$L[$l][1],$L[$l][2],$L[$l][1]
+	valignq		\$1,$L[$l][2],$L[$l][2],$L[$l][2]\{%k2\}\{z\}
+___
+}
+}
+
+# store and normalize to 52-bit digits
+for my $l (0..1) {
+my ($o0,$o1,$o2) = map(160*$l+64*$_, (0..2));
+$code.=<<___;
+	vmovdqu64	$L[$l][0],$o0($res)
+	vmovdqu64	$L[$l][1],$o1($res)
+	vmovdqu64	$L[$l][2],$o2($res)\{%k1\}
+___
+}
+for my $j (0..19) {
+for my $l (0..1) {
+my $off = 160*$l + 8*$j;
+$code.=<<___;
+	mov		$off($res),$tmp[$l]
+	add		$acc[$l],$tmp[$l]
+	mov		$tmp[$l],$acc[$l]
+	and		$mask,$tmp[$l]
+	shr		\$52,$acc[$l]
+	mov		$tmp[$l],$off($res)
+___
+}
+}
+$code.=<<___	if ($win64);
+	mov	8(%rsp),%rdi
+	mov	16(%rsp),%rsi
+___
+$code.=<<___;
+	vzeroupper
+	ret
+.cfi_endproc
+.size	ossl_rsaz_amm52x20_x2_ifma256,.-ossl_rsaz_amm52x20_x2_ifma256
+___
+
+# void ossl_extract_multiplier_2x20_win5(BN_ULONG out[2][20],
+#                                        const BN_ULONG table[32][2][20],
+#                                        int idx0, int idx1);
+#
+# Constant time table lookup: every entry is read and blended in under a
+# mask computed from the secret indices.
+{
+my ($out,$tbl,$idx0,$idx1) = $win64 ? ("%rcx","%rdx","%r8","%r9")
+				    : ("%rdi","%rsi","%rdx","%rcx");
+my @R = (["%zmm16","%zmm17","%zmm18"], ["%zmm19","%zmm20","%zmm21"]);
+my @T = ("%zmm22","%zmm23","%zmm24");
+my ($I0,$I1,$C,$ONE) = ("%zmm25","%zmm26","%zmm27","%zmm28");
+my ($idx0d,$idx1d) = map { my $r = $_; $r =~ s/^%r([a-d])x$/%e$1x/ or $r .= "d"; $r }
+			 ($idx0,$idx1);
+
+$code.=<<___;
+.globl	ossl_extract_multiplier_2x20_win5
+.type	ossl_extract_multiplier_2x20_win5,\@abi-omnipotent
+.align	32
+ossl_extract_multiplier_2x20_win5:
+.cfi_startproc
+	mov	\$0x0f,%eax
+	kmovw	%eax,%k1
+	mov	$idx0d,$idx0d		# zero-extend the int arguments
+	mov	$idx1d,$idx1d
+	mov	\$1,%eax
+	vpbroadcastq	%rax,$ONE
+	vpbroadcastq	$idx0,$I0
+	vpbroadcastq	$idx1,$I1
+	vpxorq		$C,$C,$C
+___
+for my $l (0..1) {
+for my $j (0..2) {
+$code.=<<___;
+	vpxorq		$R[$l][$j],$R[$l][$j],$R[$l][$j]
+___
+}
+}
+$code.=<<___;
+	lea	`32*320`($tbl),%rax
+.Loop_extract:
+	vpcmpeqq	$C,$I0,%k2
+	vpcmpeqq	$C,$I1,%k3
+___
+for my $l (0..1) {
+my $k = $l ? "%k3" : "%k2";
+my ($o0,$o1,$o2) = map(160*$l+64*$_, (0..2));
+$code.=<<___;
+	vmovdqu64	$o0($tbl),$T[0]
+	vmovdqu64	$o1($tbl),$T[1]
+	vmovdqu64	$o2($tbl),$T[2]\{%k1\}\{z\}
+	vpblendmq	$T[0],$R[$l][0],$R[$l][0]\{$k\}
+	vpblendmq	$T[1],$R[$l][1],$R[$l][1]\{$k\}
+	vpblendmq	$T[2],$R[$l][2],$R[$l][2]\{$k\}
+___
+}
+$code.=<<___;
+	vpaddq		$ONE,$C,$C
+	lea	320($tbl),$tbl
+	cmp	%rax,$tbl
+	jne	.Loop_extract
+
+___
+for my $l (0..1) {
+my ($o0,$o1,$o2) = map(160*$l+64*$_, (0..2));
+$code.=<<___;
+	vmovdqu64	$R[$l][0],$o0($out)
+	vmovdqu64	$R[$l][1],$o1($out)
+	vmovdqu64	$R[$l][2],$o2($out)\{%k1\}
+___
+}
+$code.=<<___;
+	vzeroupper
+	ret
+.cfi_endproc
+.size	ossl_extract_multiplier_2x20_win5,.-ossl_extract_multiplier_2x20_win5
+___
+}
+
+# void ossl_rsaz_amm52x${n}_x1_ifma256(BN_ULONG res[$npad],
+#                                     const BN_ULONG a[$npad],
+#                                     const BN_ULONG b[$npad],
+#                                     const BN_ULONG m[$npad],
+#                                     BN_ULONG k0);
+#
+# Single operand AMM for 2048-, 3072- and 4096-bit moduli, i.e. $n = 40, 60
+# and 80 digits, with all operands zero padded to a whole number of zmm
+# registers. Instead of keeping copies of a and m shifted up by one digit,
+# the high halves of the products are accumulated after the accumulator has
+# been shifted down, which leaves enough registers to hold all of a. The
+# loop over the digits of b is not unrolled, to keep the code size sane.
+#
+# ossl_extract_multiplier_1x${n}_win5 is the matching constant time lookup
+# of entry |idx| in a table of 32 padded operands.
+sub amm52_x1 {
+my $n = shift;
+my $nregs = ($n + 7) >> 3;
+my $npad = 8 * $nregs;
+my ($res,$a,$b,$m,$k0) = $win64 ? ("%rcx","%rdx","%r8","%r9","%r10")
+				: ("%rdi","%rsi","%rdx","%rcx","%r8");
+my ($acc,$t,$cnt) = $win64 ? ("%r11","%rdi","%rsi") : ("%r9","%r10","%r11");
+my $mask = "%rax";
+# zmm0-zmm5 and zmm16-zmm31 only, as in the two-lane code
+my @pool = (map("%zmm$_", (16..31)), map("%zmm$_", (0..5)));
+my @A = splice(@pool, 0, $nregs);
+my @L = splice(@pool, 0, $nregs);
+my ($B, $Y) = splice(@pool, 0, 2);
+(my $Lx = $L[0]) =~ s/zmm/xmm/;
+
+$code.=<<___;
+.globl	ossl_rsaz_amm52x${n}_x1_ifma256
+.type	ossl_rsaz_amm52x${n}_x1_ifma256,\@abi-omnipotent
+.align	32
+ossl_rsaz_amm52x${n}_x1_ifma256:
+.cfi_startproc
+___
+$code.=<<___	if ($win64);
+	mov	40(%rsp),$k0		# 5th argument
+	mov	%rdi,8(%rsp)		# use home area to preserve
+	mov	%rsi,16(%rsp)		# non-volatile registers
+___
+$code.=<<___;
+	mov	\$0x7f,%eax
+	kmovw	%eax,%k2		# accumulator shift
+___
+for my $j (0..$nregs-1) {
+$code.=<<___;
+	vmovdqu64	`64*$j`($a),$A[$j]
+	vpxorq		$L[$j],$L[$j],$L[$j]
+___
+}
+$code.=<<___;
+	xor	$acc,$acc
+	mov	\$0xfffffffffffff,$mask
+	mov	\$$n,$cnt
+
+.align	32
+.Loop_amm52x${n}:
+	vpbroadcastq	($b),$B
+___
+# accumulate low halves of a*b[i]
+for my $j (0..$nregs-1) {
+$code.=<<___;
+	vpmadd52luq	$A[$j],$B,$L[$j]
+___
+}
+# y = (acc[0] * k0) mod 2^52, carry = (acc[0] + m[0] * y) >> 52
+$code.=<<___;
+	vmovq		$Lx,$t
+	add		$t,$acc
+	mov		$acc,$t
+	imul		$k0,$t
+	and		$mask,$t
+	vpbroadcastq	$t,$Y
+	imul		($m),$t
+	and		$mask,$t
+	add		$t,$acc
+	shr		\$52,$acc
+___
+for my $j (0..$nregs-1) {
+$code.=<<___;
+	vpmadd52luq	`64*$j`($m),$Y,$L[$j]
+___
+}
+# shift accumulator down by one digit
+for my $j (0..$nregs-2) {
+$code.=<<___;
+	valignq		\$1,$L[$j],$L[$j+1],$L[$j]
+___
+}
+$code.=<<___;
+	valignq		\$1,$L[-1],$L[-1],$L[-1]\{%k2\}\{z\}
+___
+# and accumulate the high halves in place
+for my $j (0..$nregs-1) {
+$code.=<<___;
+	vpmadd52huq	$A[$j],$B,$L[$j]
+	vpmadd52huq	`64*$j`($m),$Y,$L[$j]
+___
+}
+$code.=<<___;
+	lea		8($b),$b
+	dec		$cnt
+	jnz		.Loop_amm52x${n}
+
+___
+# store and normalize to 52-bit digits
+for my $j (0..$nregs-1) {
+$code.=<<___;
+	vmovdqu64	$L[$j],`64*$j`($res)
+___
+}
+$code.=<<___;
+	mov	\$$n,$cnt
+.Lnorm_amm52x${n}:
+	mov	($res),$t
+	add	$acc,$t
+	mov	$t,$acc
+	and	$mask,$t
+	shr	\$52,$acc
+	mov	$t,($res)
+	lea	8($res),$res
+	dec	$cnt
+	jnz	.Lnorm_amm52x${n}
+___
+$code.=<<___	if ($win64);
+	mov	8(%rsp),%rdi
+	mov	16(%rsp),%rsi
+___
+$code.=<<___;
+	vzeroupper
+	ret
+.cfi_endproc
+.size	ossl_rsaz_amm52x${n}_x1_ifma256,.-ossl_rsaz_amm52x${n}_x1_ifma256
+___
+
+# void ossl_extract_multiplier_1x${n}_win5(BN_ULONG out[$npad],
+#                                         const BN_ULONG table[32][$npad],
+#                                         int idx);
+{
+my ($out,$tbl,$idx) = $win64 ? ("%rcx","%rdx","%r8") : ("%rdi","%rsi","%rdx");
+my $idxd = $win64 ? "%r8d" : "%edx";
+my @pool = (map("%zmm$_", (16..31)), map("%zmm$_", (0..5)));
+my @R = splice(@pool, 0, $nregs);
+my ($I,$C,$ONE) = splice(@pool, 0, 3);
+
+$code.=<<___;
+.globl	ossl_extract_multiplier_1x${n}_win5
+.type	ossl_extract_multiplier_1x${n}_win5,\@abi-omnipotent
+.align	32
+ossl_extract_multiplier_1x${n}_win5:
+.cfi_startproc
+	mov	$idxd,$idxd		# zero-extend the int argument
+	mov	\$1,%eax
+	vpbroadcastq	%rax,$ONE
+	vpbroadcastq	$idx,$I
+	vpxorq		$C,$C,$C
+___
+for my $j (0..$nregs-1) {
+$code.=<<___;
+	vpxorq		$R[$j],$R[$j],$R[$j]
+___
+}
+$code.=<<___;
+	lea	`32*8*$npad`($tbl),%rax
+.Loop_extract_1x${n}:
+	vpcmpeqq	$C,$I,%k1
+___
+for my $j (0..$nregs-1) {
+$code.=<<___;
+	vpblendmq	`64*$j`($tbl),$R[$j],$R[$j]\{%k1\}
+___
+}
+$code.=<<___;
+	vpaddq		$ONE,$C,$C
+	lea	`8*$npad`($tbl),$tbl
+	cmp	%rax,$tbl
+	jne	.Loop_extract_1x${n}
+
+___
+for my $j (0..$nregs-1) {
+$code.=<<___;
+	vmovdqu64	$R[$j],`64*$j`($out)
+___
+}
+$code.=<<___;
+	vzeroupper
+	ret
+.cfi_endproc
+.size	ossl_extract_multiplier_1x${n}_win5,.-ossl_extract_multiplier_1x${n}_win5
+___
+}
+}
+
+amm52_x1($_) for (40, 60, 80);
+}}} else {{{
+$code.=<<___;	# assembler is too old
+.text
+
+.globl	ossl_rsaz_avx512ifma_eligible
+.type	ossl_rsaz_avx512ifma_eligible,\@abi-omnipotent
+ossl_rsaz_avx512ifma_eligible:
+	xor	%eax,%eax
+	ret
+.size	ossl_rsaz_avx512ifma_eligible,.-ossl_rsaz_avx512ifma_eligible
+
+.globl	ossl_rsaz_amm52x20_x2_ifma256
+.globl	ossl_extract_multiplier_2x20_win5
+.globl	ossl_rsaz_amm52x40_x1_ifma256
+.globl	ossl_extract_multiplier_1x40_win5
+.globl	ossl_rsaz_amm52x60_x1_ifma256
+.globl	ossl_extract_multiplier_1x60_win5
+.globl	ossl_rsaz_amm52x80_x1_ifma256
+.globl	ossl_extract_multiplier_1x80_win5
+.type	ossl_rsaz_amm52x20_x2_ifma256,\@abi-omnipotent
+ossl_rsaz_amm52x20_x2_ifma256:
+ossl_extract_multiplier_2x20_win5:
+ossl_rsaz_amm52x40_x1_ifma256:
+ossl_extract_multiplier_1x40_win5:
+ossl_rsaz_amm52x60_x1_ifma256:
+ossl_extract_multiplier_1x60_win5:
+ossl_rsaz_amm52x80_x1_ifma256:
+ossl_extract_multiplier_1x80_win5:
+	.byte	0x0f,0x0b	# ud2
+	ret
+.size	ossl_rsaz_amm52x20_x2_ifma256,.-ossl_rsaz_amm52x20_x2_ifma256
+___
+}}}
+
+$code =~ s/\`([^\`]*)\`/eval $1/gem;
+print $code;
+close STDOUT or die "error closing STDOUT: $!";
@@ -0,0 +1,268 @@
+/*
+ * Copyright 2021 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Fixed-base exponentiation with the comb method of Lim and Lee,
+ * "More Flexible Exponentiation with Precomputation", CRYPTO '94.
+ *
+ * An exponent of up to |bits| bits is split into BN_COMB_WIDTH rows of
+ * |spacing| bits each.  Entry i of the table holds the product of
+ * g^(2^(j * spacing)) for each bit j set in i, so that one pass over the
+ * columns computes g^e with |spacing| squarings and |spacing|
+ * multiplications, instead of |bits| squarings for a windowed ladder.
+ */
+
+#include "internal/cryptlib.h"
+#include "internal/constant_time.h"
+#include "bn_local.h"
+#include "rsaz_exp.h"
+
+/* This matches the window of the AVX512_IFMA table lookup */
+#define BN_COMB_WIDTH   5
+#define BN_COMB_ENTRIES (1 << BN_COMB_WIDTH)
+
+struct bn_comb_st {
+    BN_MONT_CTX *mont;
+    BIGNUM *g;
+    int bits;                   /* Maximum exponent length */
+    int spacing;                /* Exponent bits per row */
+    int top;                    /* Words per table entry */
+    int rsaz;                   /* Set if the table is for the RSAZ code */
+    /*
+     * BN_COMB_ENTRIES entries in Montgomery form, interleaved so that word
+     * i of entry j is at table[i * BN_COMB_ENTRIES + j], or the table of
+     * the RSAZ code.  Either way it is aligned to a cache line.
+     */
+    BN_ULONG *table;
+    void *storage;
+};
+
+/* Store |a| zero padded into the table entry |idx| */
+static void comb_store(BN_COMB *comb, int idx, const BIGNUM *a)
+{
+    BN_ULONG *table = comb->table + idx;
+    int i;
+
+    for (i = 0; i < comb->top; i++, table += BN_COMB_ENTRIES)
+        *table = i < a->top ? a->d[i] : 0;
+}
+
+/*
+ * Load the table entry |idx| into |r|, touching every entry so that the
+ * memory access pattern does not depend on |idx|.
+ */
+static void comb_select(BIGNUM *r, const BN_COMB *comb, int idx)
+{
+    const BN_ULONG *table = comb->table;
+    BN_ULONG mask[BN_COMB_ENTRIES], acc;
+    int i, j;
+
+    for (j = 0; j < BN_COMB_ENTRIES; j++)
+        mask[j] = (BN_ULONG)0 - (BN_ULONG)(constant_time_eq_int(j, idx) & 1);
+    for (i = 0; i < comb->top; i++, table += BN_COMB_ENTRIES) {
+        for (acc = 0, j = 0; j < BN_COMB_ENTRIES; j++)
+            acc |= table[j] & mask[j];
+        r->d[i] = acc;
+    }
+    r->top = comb->top;
+    r->neg = 0;
+}
+
+static int comb_alloc(BN_COMB *comb, size_t words)
+{
+    comb->storage = OPENSSL_zalloc(words * sizeof(BN_ULONG) + 64);
+    if (comb->storage == NULL) {
+        ERR_raise(ERR_LIB_BN, ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+    comb->table = (BN_ULONG *)((unsigned char *)comb->storage
+                               + (64 - ((size_t)comb->storage & 63)));
+    return 1;
+}
+
+BN_COMB *ossl_bn_comb_new(const BIGNUM *g, const BIGNUM *m, int bits,
+                          BN_CTX *ctx)
+{
+    BN_COMB *comb;
+    BIGNUM *pw, *t;
+    int i, j, hb;
+#ifdef RSAZ_ENABLED
+    size_t len;
+#endif
+
+    if (bits <= 0 || BN_is_negative(g) || BN_ucmp(g, m) >= 0) {
+        ERR_raise(ERR_LIB_BN, ERR_R_PASSED_INVALID_ARGUMENT);
+        return NULL;
+    }
+    if ((comb = OPENSSL_zalloc(sizeof(*comb))) == NULL) {
+        ERR_raise(ERR_LIB_BN, ERR_R_MALLOC_FAILURE);
+        return NULL;
+    }
+
+    BN_CTX_start(ctx);
+    pw = BN_CTX_get(ctx);
+    t = BN_CTX_get(ctx);
+    if (t == NULL
+            || (comb->mont = BN_MONT_CTX_new()) == NULL
+            || !BN_MONT_CTX_set(comb->mont, m, ctx)
+            || (comb->g = BN_dup(g)) == NULL)
+        goto err;
+
+    comb->bits = bits;
+    comb->spacing = (bits + BN_COMB_WIDTH - 1) / BN_COMB_WIDTH;
+    comb->top = comb->mont->N.top;
+
+#ifdef RSAZ_ENABLED
+    if (ossl_rsaz_avx512ifma_eligible()
+            && BN_num_bits(m) == comb->top * BN_BITS2
+            && (len = ossl_rsaz_comb_avx512_x1_table_len(BN_num_bits(m))) > 0) {
+        if (!comb_alloc(comb, len)
+                || !ossl_rsaz_comb_avx512_x1_init(comb->table, g->d, g->top,
+                                                  m->d, comb->mont->RR.d,
+                                                  comb->mont->n0[0],
+                                                  BN_num_bits(m),
+                                                  comb->spacing))
+            goto err;
+        comb->rsaz = 1;
+        BN_CTX_end(ctx);
+        return comb;
+    }
+#endif
+
+    if (!comb_alloc(comb, (size_t)BN_COMB_ENTRIES * comb->top)
+            || bn_wexpand(pw, comb->top) == NULL
+            || bn_wexpand(t, comb->top) == NULL)
+        goto err;
+
+    /* Entry 0 is one, and entry 2^j is g^(2^(j * spacing)) */
+    if (!BN_to_montgomery(t, BN_value_one(), comb->mont, ctx)
+            || !bn_to_mont_fixed_top(pw, g, comb->mont, ctx))
+        goto err;
+    comb_store(comb, 0, t);
+    for (j = 0; j < BN_COMB_WIDTH; j++) {
+        if (j > 0)
+            for (i = 0; i < comb->spacing; i++)
+                if (!bn_mul_mont_fixed_top(pw, pw, pw, comb->mont, ctx))
+                    goto err;
+        comb_store(comb, 1 << j, pw);
+    }
+
+    /* The remaining entries are products of those */
+    for (i = 3; i < BN_COMB_ENTRIES; i++) {
+        hb = BN_num_bits_word((BN_ULONG)i) - 1;
+        if (i == 1 << hb)
+            continue;
+        comb_select(pw, comb, 1 << hb);
+        comb_select(t, comb, i ^ (1 << hb));
+        if (!bn_mul_mont_fixed_top(t, t, pw, comb->mont, ctx))
+            goto err;
+        comb_store(comb, i, t);
+    }
+
+    BN_CTX_end(ctx);
+    return comb;
+ err:
+    BN_CTX_end(ctx);
+    ossl_bn_comb_free(comb);
+    return NULL;
+}
+
+void ossl_bn_comb_free(BN_COMB *comb)
+{
+    if (comb == NULL)
+        return;
+    BN_MONT_CTX_free(comb->mont);
+    BN_free(comb->g);
+    OPENSSL_free(comb->storage);
+    OPENSSL_free(comb);
+}
+
+int ossl_bn_comb_matches(const BN_COMB *comb, const BIGNUM *g,
+                         const BIGNUM *m, int bits)
+{
+    return bits <= comb->bits
+           && BN_cmp(g, comb->g) == 0
+           && BN_cmp(m, &comb->mont->N) == 0;
+}
+
+/*
+ * Compute r = g^p mod m, in time that depends only on the parameters of
+ * |comb| and not on |p|, which must be non-negative and at most comb->bits
+ * bits long.
+ */
+int ossl_bn_comb_mod_exp(BIGNUM *r, const BN_COMB *comb, const BIGNUM *p,
+                         BN_CTX *ctx)
+{
+    BIGNUM *acc, *t, *e;
+    BN_ULONG word;
+    int i, j, k, bit, idx, ret = 0;
+    int words = (comb->spacing * BN_COMB_WIDTH + BN_BITS2 - 1) / BN_BITS2;
+
+    if (BN_is_negative(p) || BN_num_bits(p) > comb->bits) {
+        ERR_raise(ERR_LIB_BN, BN_R_BIGNUM_TOO_LONG);
+        return 0;
+    }
+
+    BN_CTX_start(ctx);
+    acc = BN_CTX_get(ctx);
+    t = BN_CTX_get(ctx);
+    e = BN_CTX_get(ctx);
+    if (e == NULL
+            || bn_wexpand(acc, comb->top) == NULL
+            || bn_wexpand(t, comb->top) == NULL
+            || bn_wexpand(e, words) == NULL)
+        goto err;
+
+    /* Zero pad the exponent so that every column can be read from it */
+    for (i = 0; i < words; i++)
+        e->d[i] = i < p->top ? p->d[i] : 0;
+
+#ifdef RSAZ_ENABLED
+    if (comb->rsaz) {
+        if (bn_wexpand(r, comb->top) == NULL
+                || !ossl_rsaz_comb_avx512_x1(r->d, comb->table, e->d, words,
+                                             comb->mont->N.d,
+                                             comb->mont->n0[0],
+                                             comb->top * BN_BITS2,
+                                             comb->spacing))
+            goto err;
+        r->top = comb->top;
+        r->neg = 0;
+        bn_correct_top(r);
+        ret = 1;
+        goto err;
+    }
+#endif
+
+    for (k = comb->spacing - 1; k >= 0; k--) {
+        idx = 0;
+        for (j = 0; j < BN_COMB_WIDTH; j++) {
+            bit = k + j * comb->spacing;
+            word = e->d[bit / BN_BITS2] >> (bit % BN_BITS2);
+            idx |= (int)(word & 1) << j;
+        }
+        if (k == comb->spacing - 1) {
+            comb_select(acc, comb, idx);
+            continue;
+        }
+        comb_select(t, comb, idx);
+        if (!bn_mul_mont_fixed_top(acc, acc, acc, comb->mont, ctx)
+                || !bn_mul_mont_fixed_top(acc, acc, t, comb->mont, ctx))
+            goto err;
+    }
+
+    ret = BN_from_montgomery(r, acc, comb->mont, ctx);
+ err:
+    if (e != NULL) {
+        BN_clear(acc);
+        BN_clear(e);
+    }
+    BN_CTX_end(ctx);
+    return ret;
+}
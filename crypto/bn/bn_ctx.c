@@ -9,6 +9,9 @@
 
 #include <openssl/trace.h>
 #include "internal/cryptlib.h"
+#include "internal/tsan_assist.h"
+#include "crypto/cryptlib.h"
+#include "crypto/bn.h"
 #include "bn_local.h"
 
 /*-
@@ -51,6 +54,7 @@ static void BN_POOL_init(BN_POOL *);
 static void BN_POOL_finish(BN_POOL *);
 static BIGNUM *BN_POOL_get(BN_POOL *, int);
 static void BN_POOL_release(BN_POOL *, unsigned int);
+static void BN_POOL_cleanse(BN_POOL *);
 
 /************/
 /* BN_STACK */
@@ -256,6 +260,171 @@ OSSL_LIB_CTX *ossl_bn_get_libctx(BN_CTX *ctx)
     return ctx->libctx;
 }
 
+/****************/
+/* BN_CTX cache */
+/****************/
+
+/*
+ * Each thread keeps one idle BN_CTX of each flavour per library context, so
+ * that the public key operations don't have to build a new pool (and grow
+ * all of its bignums) every time they run.
+ */
+typedef struct bn_ctx_thread_cache_st {
+    BN_CTX *idle[2];            /* Indexed by "secure" */
+} BN_CTX_THREAD_CACHE;
+
+typedef struct bn_ctx_cache_st {
+    CRYPTO_THREAD_LOCAL local;
+    TSAN_QUALIFIER int acquired;
+    TSAN_QUALIFIER int allocated;
+} BN_CTX_CACHE;
+
+static void *bn_ctx_cache_new(OSSL_LIB_CTX *libctx)
+{
+    BN_CTX_CACHE *cache = OPENSSL_zalloc(sizeof(*cache));
+
+    if (cache == NULL)
+        return NULL;
+
+#ifndef FIPS_MODULE
+    /* Make sure the base libcrypto thread handling has been initialised */
+    OPENSSL_init_crypto(OPENSSL_INIT_BASE_ONLY, NULL);
+#endif
+
+    if (!CRYPTO_THREAD_init_local(&cache->local, NULL)) {
+        OPENSSL_free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+static void bn_ctx_cache_free(void *vcache)
+{
+    BN_CTX_CACHE *cache = vcache;
+
+    if (cache == NULL)
+        return;
+    CRYPTO_THREAD_cleanup_local(&cache->local);
+    OPENSSL_free(cache);
+}
+
+static const OSSL_LIB_CTX_METHOD bn_ctx_cache_method = {
+    bn_ctx_cache_new,
+    bn_ctx_cache_free,
+};
+
+static BN_CTX_CACHE *bn_ctx_get_cache(OSSL_LIB_CTX *libctx)
+{
+    return ossl_lib_ctx_get_data(libctx, OSSL_LIB_CTX_BN_CTX_CACHE_INDEX,
+                                 &bn_ctx_cache_method);
+}
+
+static void bn_ctx_cache_delete_thread_state(void *arg)
+{
+    BN_CTX_CACHE *cache = bn_ctx_get_cache(arg);
+    BN_CTX_THREAD_CACHE *tcache;
+
+    if (cache == NULL)
+        return;
+
+    tcache = CRYPTO_THREAD_get_local(&cache->local);
+    CRYPTO_THREAD_set_local(&cache->local, NULL);
+    if (tcache != NULL) {
+        BN_CTX_free(tcache->idle[0]);
+        BN_CTX_free(tcache->idle[1]);
+        OPENSSL_free(tcache);
+    }
+}
+
+static BN_CTX_THREAD_CACHE *bn_ctx_get_thread_cache(OSSL_LIB_CTX *libctx,
+                                                    BN_CTX_CACHE *cache)
+{
+    BN_CTX_THREAD_CACHE *tcache = CRYPTO_THREAD_get_local(&cache->local);
+
+    if (tcache != NULL)
+        return tcache;
+
+    libctx = ossl_lib_ctx_get_concrete(libctx);
+    if ((tcache = OPENSSL_zalloc(sizeof(*tcache))) == NULL)
+        return NULL;
+    if (!ossl_init_thread_start(NULL, libctx,
+                                bn_ctx_cache_delete_thread_state)
+            || !CRYPTO_THREAD_set_local(&cache->local, tcache)) {
+        OPENSSL_free(tcache);
+        return NULL;
+    }
+    return tcache;
+}
+
+/*
+ * Get a BN_CTX for one operation, taking this thread's idle one if there is
+ * one.  It must be handed back with ossl_bn_ctx_release() rather than freed.
+ */
+BN_CTX *ossl_bn_ctx_acquire(OSSL_LIB_CTX *libctx, int secure)
+{
+    BN_CTX_CACHE *cache = bn_ctx_get_cache(libctx);
+    BN_CTX_THREAD_CACHE *tcache;
+    BN_CTX *ret;
+
+    secure = secure != 0;
+    if (cache != NULL) {
+        tsan_counter(&cache->acquired);
+        tcache = CRYPTO_THREAD_get_local(&cache->local);
+        if (tcache != NULL && tcache->idle[secure] != NULL) {
+            ret = tcache->idle[secure];
+            tcache->idle[secure] = NULL;
+            return ret;
+        }
+        tsan_counter(&cache->allocated);
+    }
+    return secure ? BN_CTX_secure_new_ex(libctx) : BN_CTX_new_ex(libctx);
+}
+
+/*
+ * Hand back a BN_CTX obtained from ossl_bn_ctx_acquire().  The values left
+ * in its bignums are wiped, but the memory is kept for the next operation on
+ * this thread, unless the thread already has an idle BN_CTX of its own.
+ */
+void ossl_bn_ctx_release(BN_CTX *ctx)
+{
+    BN_CTX_CACHE *cache;
+    BN_CTX_THREAD_CACHE *tcache;
+    int secure;
+
+    if (ctx == NULL)
+        return;
+
+    /* Only a context with all of its frames closed is fit for reuse */
+    if (ctx->used != 0 || ctx->stack.depth != 0 || ctx->err_stack != 0
+            || (cache = bn_ctx_get_cache(ctx->libctx)) == NULL
+            || (tcache = bn_ctx_get_thread_cache(ctx->libctx, cache)) == NULL) {
+        BN_CTX_free(ctx);
+        return;
+    }
+
+    secure = (ctx->flags & BN_FLG_SECURE) != 0;
+    if (tcache->idle[secure] != NULL) {
+        BN_CTX_free(ctx);
+        return;
+    }
+    BN_POOL_cleanse(&ctx->pool);
+    ctx->too_many = 0;
+    tcache->idle[secure] = ctx;
+}
+
+/*
+ * Report how many BN_CTXs have been acquired, and how many of those had to
+ * be allocated because no idle one was available.
+ */
+void ossl_bn_ctx_cache_get_stats(OSSL_LIB_CTX *libctx, int *acquired,
+                                 int *allocated)
+{
+    BN_CTX_CACHE *cache = bn_ctx_get_cache(libctx);
+
+    *acquired = cache == NULL ? 0 : tsan_load(&cache->acquired);
+    *allocated = cache == NULL ? 0 : tsan_load(&cache->allocated);
+}
+
 /************/
 /* BN_STACK */
 /************/
@@ -367,6 +536,22 @@ static BIGNUM *BN_POOL_get(BN_POOL *p, int flag)
     return p->current->vals + ((p->used++) % BN_CTX_POOL_SIZE);
 }
 
+/* Wipe the values of all bignums in the pool, keeping their memory */
+static void BN_POOL_cleanse(BN_POOL *p)
+{
+    BN_POOL_ITEM *item;
+    BIGNUM *bn;
+    unsigned int loop;
+
+    for (item = p->head; item != NULL; item = item->next)
+        for (loop = 0, bn = item->vals; loop++ < BN_CTX_POOL_SIZE; bn++)
+            if (bn->d != NULL) {
+                OPENSSL_cleanse(bn->d, bn->dmax * sizeof(bn->d[0]));
+                bn->top = 0;
+                bn->neg = 0;
+            }
+}
+
 static void BN_POOL_release(BN_POOL *p, unsigned int num)
 {
     unsigned int offset = (p->used - 1) % BN_CTX_POOL_SIZE;
@@ -681,6 +681,19 @@ int BN_mod_exp_mont_consttime(BIGNUM *rr, const BIGNUM *a, const BIGNUM *p,
         bn_correct_top(rr);
         ret = 1;
         goto err;
+    } else if ((BN_num_bits(m) == 2048 || BN_num_bits(m) == 3072
+                || BN_num_bits(m) == 4096)
+               && ossl_rsaz_avx512ifma_eligible()) {
+        /* FFDHE groups and the CRT halves of RSA-4096 and up */
+        if (NULL == bn_wexpand(rr, top))
+            goto err;
+        ret = ossl_rsaz_mod_exp_avx512_x1(rr->d, a->d, a->top, p->d, p->top,
+                                          m->d, mont->RR.d, mont->n0[0],
+                                          BN_num_bits(m));
+        rr->top = top;
+        rr->neg = 0;
+        bn_correct_top(rr);
+        goto err;
     }
 #endif
 
@@ -1390,3 +1403,81 @@ int BN_mod_exp_simple(BIGNUM *r, const BIGNUM *a, const BIGNUM *p,
     bn_check_top(r);
     return ret;
 }
+
+/*
+ * Computes rr1 = a1^p1 mod m1 and rr2 = a2^p2 mod m2 in constant time.
+ * The two exponentiations are done together when a dedicated two-lane
+ * implementation is available for the operand sizes, e.g. for the CRT
+ * halves of an RSA-2048 private key operation, and one after the other
+ * otherwise.
+ */
+int ossl_bn_mod_exp_mont_consttime_x2(BIGNUM *rr1, const BIGNUM *a1,
+                                      const BIGNUM *p1, const BIGNUM *m1,
+                                      BN_MONT_CTX *in_mont1,
+                                      BIGNUM *rr2, const BIGNUM *a2,
+                                      const BIGNUM *p2, const BIGNUM *m2,
+                                      BN_MONT_CTX *in_mont2, BN_CTX *ctx)
+{
+    int ret = 0;
+#ifdef RSAZ_ENABLED
+    BN_MONT_CTX *mont1 = NULL, *mont2 = NULL;
+
+    if (ossl_rsaz_avx512ifma_eligible()
+        && a1->top == 16 && p1->top == 16 && BN_num_bits(m1) == 1024
+        && a2->top == 16 && p2->top == 16 && BN_num_bits(m2) == 1024
+        && !a1->neg && !a2->neg
+        && BN_ucmp(a1, m1) < 0 && BN_ucmp(a2, m2) < 0) {
+
+        if (bn_wexpand(rr1, 16) == NULL || bn_wexpand(rr2, 16) == NULL)
+            goto err;
+
+        if (in_mont1 != NULL) {
+            mont1 = in_mont1;
+        } else {
+            if ((mont1 = BN_MONT_CTX_new()) == NULL)
+                goto err;
+            if (!BN_MONT_CTX_set(mont1, m1, ctx))
+                goto err;
+        }
+        if (in_mont2 != NULL) {
+            mont2 = in_mont2;
+        } else {
+            if ((mont2 = BN_MONT_CTX_new()) == NULL)
+                goto err;
+            if (!BN_MONT_CTX_set(mont2, m2, ctx))
+                goto err;
+        }
+
+        ret = ossl_rsaz_mod_exp_avx512_x2(rr1->d, a1->d, p1->d, m1->d,
+                                          mont1->RR.d, mont1->n0[0],
+                                          rr2->d, a2->d, p2->d, m2->d,
+                                          mont2->RR.d, mont2->n0[0]);
+
+        rr1->top = 16;
+        rr1->neg = 0;
+        bn_correct_top(rr1);
+        bn_check_top(rr1);
+
+        rr2->top = 16;
+        rr2->neg = 0;
+        bn_correct_top(rr2);
+        bn_check_top(rr2);
+
+        goto err;
+    }
+#endif
+
+    /* No dual exponentiation available, compute one after the other */
+    ret = BN_mod_exp_mont_consttime(rr1, a1, p1, m1, ctx, in_mont1);
+    ret &= BN_mod_exp_mont_consttime(rr2, a2, p2, m2, ctx, in_mont2);
+
+#ifdef RSAZ_ENABLED
+ err:
+    if (in_mont2 == NULL)
+        BN_MONT_CTX_free(mont2);
+    if (in_mont1 == NULL)
+        BN_MONT_CTX_free(mont1);
+#endif
+
+    return ret;
+}
@@ -669,4 +669,22 @@ static ossl_inline BIGNUM *bn_expand(BIGNUM *a, int bits)
 int bn_check_prime_int(const BIGNUM *w, int checks, BN_CTX *ctx,
                       int do_trial_division, BN_GENCB *cb);
 
+/*
+ * Trial division sieve for the candidates w, w + step, w + 2 * step, ...
+ * It keeps the residues of the current candidate modulo the small primes,
+ * so moving on to the next candidate only costs a word addition per prime
+ * instead of a multi-precision division.
+ */
+typedef struct bn_sieve_st {
+    int num;                    /* Number of small primes used */
+    BN_ULONG *mods;             /* Current candidate mod each small prime */
+    BN_ULONG *steps;            /* Step mod each small prime */
+} BN_SIEVE;
+
+int bn_sieve_init(BN_SIEVE *sieve, int bits);
+int bn_sieve_start(BN_SIEVE *sieve, const BIGNUM *w, const BIGNUM *step);
+int bn_sieve_has_small_factor(const BN_SIEVE *sieve);
+void bn_sieve_next(BN_SIEVE *sieve);
+void bn_sieve_cleanup(BN_SIEVE *sieve);
+
 #endif
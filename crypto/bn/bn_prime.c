@@ -257,6 +257,68 @@ int BN_check_prime(const BIGNUM *p, BN_CTX *ctx, BN_GENCB *cb)
     return bn_check_prime_int(p, 0, ctx, 1, cb);
 }
 
+/*
+ * Set up |sieve| for candidates of |bits| bits, using the same number of
+ * small primes as the trial division in bn_is_prime_int().
+ */
+int bn_sieve_init(BN_SIEVE *sieve, int bits)
+{
+    sieve->num = calc_trial_divisions(bits);
+    sieve->mods = OPENSSL_zalloc(2 * sieve->num * sizeof(*sieve->mods));
+    if (sieve->mods == NULL) {
+        ERR_raise(ERR_LIB_BN, ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+    sieve->steps = sieve->mods + sieve->num;
+    return 1;
+}
+
+/*
+ * Start sieving the candidates |w| + i * |step|.
+ * All candidates must be larger than the small primes used.
+ */
+int bn_sieve_start(BN_SIEVE *sieve, const BIGNUM *w, const BIGNUM *step)
+{
+    int i;
+
+    for (i = 0; i < sieve->num; i++) {
+        sieve->mods[i] = BN_mod_word(w, primes[i]);
+        sieve->steps[i] = BN_mod_word(step, primes[i]);
+        if (sieve->mods[i] == (BN_ULONG)-1 || sieve->steps[i] == (BN_ULONG)-1)
+            return 0;
+    }
+    return 1;
+}
+
+/* Returns 1 if the current candidate is divisible by a small prime */
+int bn_sieve_has_small_factor(const BN_SIEVE *sieve)
+{
+    int i;
+
+    for (i = 0; i < sieve->num; i++)
+        if (sieve->mods[i] == 0)
+            return 1;
+    return 0;
+}
+
+/* Move on to the next candidate */
+void bn_sieve_next(BN_SIEVE *sieve)
+{
+    int i;
+
+    for (i = 0; i < sieve->num; i++) {
+        sieve->mods[i] += sieve->steps[i];
+        if (sieve->mods[i] >= primes[i])
+            sieve->mods[i] -= primes[i];
+    }
+}
+
+void bn_sieve_cleanup(BN_SIEVE *sieve)
+{
+    OPENSSL_clear_free(sieve->mods, 2 * sieve->num * sizeof(*sieve->mods));
+    sieve->mods = sieve->steps = NULL;
+}
+
 /*
  * Tests that |w| is probably prime
  * See FIPS 186-4 C.3.1 Miller Rabin Probabilistic Primality Test.
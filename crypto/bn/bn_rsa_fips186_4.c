@@ -243,10 +243,14 @@ int ossl_bn_rsa_fips186_4_derive_prime(BIGNUM *Y, BIGNUM *X, const BIGNUM *Xin,
                                        BN_GENCB *cb)
 {
     int ret = 0;
-    int i, imax;
+    int i, imax, rv;
     int bits = nlen >> 1;
     BIGNUM *tmp, *R, *r1r2x2, *y1, *r1x2;
     BIGNUM *base, *range;
+    BN_SIEVE sieve;
+
+    if (!bn_sieve_init(&sieve, bits))
+        return 0;
 
     BN_CTX_start(ctx);
 
@@ -312,6 +316,13 @@ int ossl_bn_rsa_fips186_4_derive_prime(BIGNUM *Y, BIGNUM *X, const BIGNUM *Xin,
         /* (Step 4) Y = X + ((R - X) mod 2r1r2) */
         if (!BN_mod_sub(Y, R, X, r1r2x2, ctx) || !BN_add(Y, Y, X))
             goto err;
+        /*
+         * Candidates with a small factor are skipped using a sieve that
+         * follows Y through the steps below, rather than by trial division
+         * of every candidate.
+         */
+        if (!bn_sieve_start(&sieve, Y, r1r2x2))
+            goto err;
         /* (Step 5) */
         i = 0;
         for (;;) {
@@ -325,15 +336,24 @@ int ossl_bn_rsa_fips186_4_derive_prime(BIGNUM *Y, BIGNUM *X, const BIGNUM *Xin,
             BN_GENCB_call(cb, 0, 2);
 
             /* (Step 7) If GCD(Y-1) == 1 & Y is probably prime then return Y */
-            if (BN_copy(y1, Y) == NULL
-                    || !BN_sub_word(y1, 1)
-                    || !BN_gcd(tmp, y1, e, ctx))
-                goto err;
-            if (BN_is_one(tmp) && BN_check_prime(Y, ctx, cb))
-                goto end;
+            if (!bn_sieve_has_small_factor(&sieve)) {
+                if (BN_copy(y1, Y) == NULL
+                        || !BN_sub_word(y1, 1)
+                        || !BN_gcd(tmp, y1, e, ctx))
+                    goto err;
+                if (BN_is_one(tmp)) {
+                    /* The sieve has already done the trial division */
+                    rv = bn_check_prime_int(Y, 0, ctx, 0, cb);
+                    if (rv < 0)
+                        goto err;
+                    if (rv > 0)
+                        goto end;
+                }
+            }
             /* (Step 8-10) */
             if (++i >= imax || !BN_add(Y, Y, r1r2x2))
                 goto err;
+            bn_sieve_next(&sieve);
         }
     }
 end:
@@ -342,5 +362,6 @@ end:
 err:
     BN_clear(y1);
     BN_CTX_end(ctx);
+    bn_sieve_cleanup(&sieve);
     return ret;
 }
@@ -35,6 +35,29 @@ void RSAZ_512_mod_exp(BN_ULONG result[8],
                       const BN_ULONG m_norm[8], BN_ULONG k0,
                       const BN_ULONG RR[8]);
 
+int ossl_rsaz_avx512ifma_eligible(void);
+
+int ossl_rsaz_mod_exp_avx512_x2(BN_ULONG *res1, const BN_ULONG *base1,
+                                const BN_ULONG *exp1, const BN_ULONG *m1,
+                                const BN_ULONG *RR1, BN_ULONG k0_1,
+                                BN_ULONG *res2, const BN_ULONG *base2,
+                                const BN_ULONG *exp2, const BN_ULONG *m2,
+                                const BN_ULONG *RR2, BN_ULONG k0_2);
+int ossl_rsaz_mod_exp_avx512_x1(BN_ULONG *res, const BN_ULONG *base,
+                                int base_len, const BN_ULONG *exp,
+                                int exp_len, const BN_ULONG *m,
+                                const BN_ULONG *RR, BN_ULONG k0,
+                                int factor_bits);
+size_t ossl_rsaz_comb_avx512_x1_table_len(int factor_bits);
+int ossl_rsaz_comb_avx512_x1_init(BN_ULONG *table, const BN_ULONG *g,
+                                  int g_len, const BN_ULONG *m,
+                                  const BN_ULONG *RR, BN_ULONG k0,
+                                  int factor_bits, int spacing);
+int ossl_rsaz_comb_avx512_x1(BN_ULONG *res, const BN_ULONG *table,
+                             const BN_ULONG *exp, int exp_len,
+                             const BN_ULONG *m, BN_ULONG k0,
+                             int factor_bits, int spacing);
+
 # endif
 
 #endif
@@ -0,0 +1,471 @@
+/*
+ * Copyright 2021 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <openssl/opensslconf.h>
+#include <openssl/crypto.h>
+#include "internal/constant_time.h"
+#include "bn_local.h"
+#include "rsaz_exp.h"
+
+#ifndef RSAZ_ENABLED
+NON_EMPTY_TRANSLATION_UNIT
+#else
+
+/*
+ * See crypto/bn/asm/rsaz-avx512.pl for further details.
+ */
+void ossl_rsaz_amm52x20_x2_ifma256(BN_ULONG *res, const BN_ULONG *a,
+                                   const BN_ULONG *b, const BN_ULONG *m,
+                                   const BN_ULONG k0[2]);
+void ossl_extract_multiplier_2x20_win5(BN_ULONG *out, const BN_ULONG *table,
+                                       int idx0, int idx1);
+void ossl_rsaz_amm52x40_x1_ifma256(BN_ULONG *res, const BN_ULONG *a,
+                                   const BN_ULONG *b, const BN_ULONG *m,
+                                   BN_ULONG k0);
+void ossl_extract_multiplier_1x40_win5(BN_ULONG *out, const BN_ULONG *table,
+                                       int idx);
+void ossl_rsaz_amm52x60_x1_ifma256(BN_ULONG *res, const BN_ULONG *a,
+                                   const BN_ULONG *b, const BN_ULONG *m,
+                                   BN_ULONG k0);
+void ossl_extract_multiplier_1x60_win5(BN_ULONG *out, const BN_ULONG *table,
+                                       int idx);
+void ossl_rsaz_amm52x80_x1_ifma256(BN_ULONG *res, const BN_ULONG *a,
+                                   const BN_ULONG *b, const BN_ULONG *m,
+                                   BN_ULONG k0);
+void ossl_extract_multiplier_1x80_win5(BN_ULONG *out, const BN_ULONG *table,
+                                       int idx);
+
+#if defined(__GNUC__)
+# define ALIGN64        __attribute__((aligned(64)))
+#elif defined(_MSC_VER)
+# define ALIGN64        __declspec(align(64))
+#else
+/* not fatal, might hurt performance a little */
+# define ALIGN64
+#endif
+
+#define DIGIT_SIZE      52
+#define DIGIT_MASK      ((BN_ULONG)0xFFFFFFFFFFFFF)
+#define MAX_WORDS       64      /* 4096-bit factor in 64-bit words */
+#define MAX_DIGITS      80      /* 4096-bit factor in 52-bit digits */
+#define FACTOR_WORDS    16      /* 1024-bit factor in 64-bit words */
+#define NUM_DIGITS      20      /* 1024-bit factor in 52-bit digits */
+#define NUM_DIGITS_PAD  24      /* padded to a whole number of zmm registers */
+
+#define EXP_WIN_SIZE    5
+#define EXP_WIN_MASK    ((1 << EXP_WIN_SIZE) - 1)
+#define TABLE_SIZE      (1 << EXP_WIN_SIZE)
+
+/* Two lanes of 20 digits each, laid out one after the other */
+#define X2              (2 * NUM_DIGITS)
+
+ALIGN64 static const BN_ULONG one[X2] = {
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+/* 2^64, used to turn 2^2048 mod m into 2^2080 mod m */
+ALIGN64 static const BN_ULONG two64[X2] = {
+    0, 1 << 12, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 1 << 12, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+/*
+ * Convert a number of |in_len| 64-bit words to |out_len| 52-bit digits,
+ * zero padded as needed.
+ */
+static void to_words52(BN_ULONG *out, int out_len,
+                       const BN_ULONG *in, int in_len)
+{
+    int i, bit, word, shift;
+
+    for (i = 0; i < out_len; i++) {
+        bit = i * DIGIT_SIZE;
+        word = bit / BN_BITS2;
+        shift = bit % BN_BITS2;
+        out[i] = word < in_len ? in[word] >> shift : 0;
+        if (shift > BN_BITS2 - DIGIT_SIZE && word + 1 < in_len)
+            out[i] |= in[word + 1] << (BN_BITS2 - shift);
+        out[i] &= DIGIT_MASK;
+    }
+}
+
+/*
+ * Convert |in_len| 52-bit digits back to |out_len| 64-bit words, with bits
+ * above |out_len| words dropped.
+ */
+static void from_words52(BN_ULONG *out, int out_len,
+                         const BN_ULONG *in, int in_len)
+{
+    int i, bit, word, shift;
+
+    memset(out, 0, out_len * sizeof(*out));
+    for (i = 0; i < in_len; i++) {
+        bit = i * DIGIT_SIZE;
+        word = bit / BN_BITS2;
+        shift = bit % BN_BITS2;
+        if (word >= out_len)
+            break;
+        out[word] |= in[i] << shift;
+        if (shift > BN_BITS2 - DIGIT_SIZE && word + 1 < out_len)
+            out[word + 1] |= in[i] >> (BN_BITS2 - shift);
+    }
+}
+
+/* Get the window of an exponent of |len| words that starts at |bit| */
+static int get_window(const BN_ULONG *exp, int len, int bit)
+{
+    int word = bit / BN_BITS2, shift = bit % BN_BITS2;
+    BN_ULONG w = exp[word] >> shift;
+
+    if (shift > BN_BITS2 - EXP_WIN_SIZE && word + 1 < len)
+        w |= exp[word + 1] << (BN_BITS2 - shift);
+    return (int)(w & EXP_WIN_MASK);
+}
+
+/* Reduce |r| of |len| + 1 words from [0, 2m) to [0, m) in constant time */
+static void reduce_once(BN_ULONG *res, const BN_ULONG *r, const BN_ULONG *m,
+                        int len)
+{
+    BN_ULONG t[MAX_WORDS + 1], mm[MAX_WORDS + 1], mask;
+    int i;
+
+    memcpy(mm, m, len * sizeof(*m));
+    mm[len] = 0;
+    mask = (BN_ULONG)0 - bn_sub_words(t, r, mm, len + 1);
+    for (i = 0; i < len; i++)
+        res[i] = constant_time_select_64(mask, r[i], t[i]);
+    OPENSSL_cleanse(t, sizeof(t));
+}
+
+/*
+ * Dual 1024-bit modular exponentiation res_l = base_l^exp_l mod m_l, using
+ * Almost Montgomery Multiplication in radix 2^52 on both lanes at once.
+ * |base| must be less than |m|, |RR| is 2^2048 mod m and |k0| is
+ * -m^-1 mod 2^64, as found in the BN_MONT_CTX. All operands are 16 words
+ * long and the whole computation is constant time.
+ *
+ * Returns 1 on success.
+ */
+int ossl_rsaz_mod_exp_avx512_x2(BN_ULONG *res1, const BN_ULONG *base1,
+                                const BN_ULONG *exp1, const BN_ULONG *m1,
+                                const BN_ULONG *RR1, BN_ULONG k0_1,
+                                BN_ULONG *res2, const BN_ULONG *base2,
+                                const BN_ULONG *exp2, const BN_ULONG *m2,
+                                const BN_ULONG *RR2, BN_ULONG k0_2)
+{
+    ALIGN64 BN_ULONG m[4 * NUM_DIGITS_PAD];
+    ALIGN64 BN_ULONG rr[X2];
+    ALIGN64 BN_ULONG acc[X2];
+    ALIGN64 BN_ULONG mult[X2];
+    ALIGN64 BN_ULONG table[TABLE_SIZE * X2];
+    BN_ULONG k0[2], out[FACTOR_WORDS + 1];
+    const BN_ULONG *mods[2] = { m1, m2 };
+    BN_ULONG *res[2] = { res1, res2 };
+    int i, l, bit;
+
+    /* Modulus and modulus shifted up by one digit, for each lane */
+    memset(m, 0, sizeof(m));
+    for (l = 0; l < 2; l++) {
+        to_words52(m + 2 * l * NUM_DIGITS_PAD, NUM_DIGITS,
+                   mods[l], FACTOR_WORDS);
+        memcpy(m + (2 * l + 1) * NUM_DIGITS_PAD + 1,
+               m + 2 * l * NUM_DIGITS_PAD, NUM_DIGITS * sizeof(*m));
+    }
+    k0[0] = k0_1 & DIGIT_MASK;
+    k0[1] = k0_2 & DIGIT_MASK;
+
+    /* rr = 2^(2 * 1040) mod m, from 2^(2 * 1024) mod m */
+    to_words52(rr, NUM_DIGITS, RR1, FACTOR_WORDS);
+    to_words52(rr + NUM_DIGITS, NUM_DIGITS, RR2, FACTOR_WORDS);
+    ossl_rsaz_amm52x20_x2_ifma256(rr, rr, rr, m, k0);
+    ossl_rsaz_amm52x20_x2_ifma256(rr, rr, two64, m, k0);
+
+    /* table[i] = base^i in Montgomery form */
+    to_words52(mult, NUM_DIGITS, base1, FACTOR_WORDS);
+    to_words52(mult + NUM_DIGITS, NUM_DIGITS, base2, FACTOR_WORDS);
+    ossl_rsaz_amm52x20_x2_ifma256(table, one, rr, m, k0);
+    ossl_rsaz_amm52x20_x2_ifma256(table + X2, mult, rr, m, k0);
+    for (i = 2; i < TABLE_SIZE; i++)
+        ossl_rsaz_amm52x20_x2_ifma256(table + i * X2, table + (i - 1) * X2,
+                                      table + X2, m, k0);
+
+    /* Fixed window exponentiation, starting with the top 1024 % 5 bits */
+    bit = (FACTOR_WORDS * BN_BITS2 / EXP_WIN_SIZE) * EXP_WIN_SIZE;
+    ossl_extract_multiplier_2x20_win5(acc, table,
+                                      get_window(exp1, FACTOR_WORDS, bit),
+                                      get_window(exp2, FACTOR_WORDS, bit));
+
+    while (bit > 0) {
+        bit -= EXP_WIN_SIZE;
+        for (i = 0; i < EXP_WIN_SIZE; i++)
+            ossl_rsaz_amm52x20_x2_ifma256(acc, acc, acc, m, k0);
+        ossl_extract_multiplier_2x20_win5(mult, table,
+                                          get_window(exp1, FACTOR_WORDS, bit),
+                                          get_window(exp2, FACTOR_WORDS, bit));
+        ossl_rsaz_amm52x20_x2_ifma256(acc, acc, mult, m, k0);
+    }
+
+    /* Convert out of Montgomery form and fully reduce */
+    ossl_rsaz_amm52x20_x2_ifma256(acc, acc, one, m, k0);
+    for (l = 0; l < 2; l++) {
+        from_words52(out, FACTOR_WORDS + 1, acc + l * NUM_DIGITS,
+                     NUM_DIGITS);
+        reduce_once(res[l], out, mods[l], FACTOR_WORDS);
+    }
+
+    OPENSSL_cleanse(table, sizeof(table));
+    OPENSSL_cleanse(acc, sizeof(acc));
+    OPENSSL_cleanse(mult, sizeof(mult));
+    OPENSSL_cleanse(rr, sizeof(rr));
+    OPENSSL_cleanse(out, sizeof(out));
+    return 1;
+}
+
+typedef void (*AMM52_X1_FN)(BN_ULONG *res, const BN_ULONG *a,
+                            const BN_ULONG *b, const BN_ULONG *m, BN_ULONG k0);
+typedef void (*EXTRACT_X1_FN)(BN_ULONG *out, const BN_ULONG *table, int idx);
+
+/*
+ * Look up the single lane kernels for a |factor_bits| modulus.  Returns the
+ * number of 52-bit digits, padded to whole zmm registers, or 0 if there are
+ * no kernels of that size.
+ */
+static int get_x1_kernels(int factor_bits, AMM52_X1_FN *amm,
+                          EXTRACT_X1_FN *extract, int *digits)
+{
+    switch (factor_bits) {
+    case 2048:
+        *digits = 40;
+        *amm = ossl_rsaz_amm52x40_x1_ifma256;
+        *extract = ossl_extract_multiplier_1x40_win5;
+        break;
+    case 3072:
+        *digits = 60;
+        *amm = ossl_rsaz_amm52x60_x1_ifma256;
+        *extract = ossl_extract_multiplier_1x60_win5;
+        break;
+    case 4096:
+        *digits = 80;
+        *amm = ossl_rsaz_amm52x80_x1_ifma256;
+        *extract = ossl_extract_multiplier_1x80_win5;
+        break;
+    default:
+        return 0;
+    }
+    /* The kernels work on whole zmm registers */
+    return (*digits + 7) & ~7;
+}
+
+/*
+ * Set |rr| to 2^(2 * 52 * digits) mod m, from RR = 2^(2 * factor_bits) mod m:
+ * squaring RR leaves 2^(4 * factor_bits - 52 * digits), which is put right
+ * by a multiplication with 2^(4 * (52 * digits - factor_bits)).  |twok| is
+ * scratch space of |pad| digits, which must be zero on entry.
+ */
+static void get_rr52(BN_ULONG *rr, BN_ULONG *twok, const BN_ULONG *RR,
+                     const BN_ULONG *mm, BN_ULONG k0, AMM52_X1_FN amm,
+                     int factor_bits, int digits, int pad)
+{
+    int bit = 4 * (DIGIT_SIZE * digits - factor_bits);
+
+    twok[bit / DIGIT_SIZE] = (BN_ULONG)1 << (bit % DIGIT_SIZE);
+    to_words52(rr, pad, RR, factor_bits / BN_BITS2);
+    amm(rr, rr, rr, mm, k0);
+    amm(rr, rr, twok, mm, k0);
+}
+
+/*
+ * Single 2048-, 3072- or 4096-bit modular exponentiation res = base^exp mod m
+ * with the AMM kernel for that size, which is given by |factor_bits|.  |m|,
+ * |RR| and |res| are |factor_bits| / 64 words long, |base| (which must be
+ * less than |m|) has |base_len| words and |exp| has |exp_len| words, all of
+ * which are used so as not to leak the position of the top set bit.  |RR|
+ * and |k0| are as above.
+ *
+ * Returns 1 on success, 0 if |factor_bits| isn't supported or on allocation
+ * failure.
+ */
+int ossl_rsaz_mod_exp_avx512_x1(BN_ULONG *res, const BN_ULONG *base,
+                                int base_len, const BN_ULONG *exp,
+                                int exp_len, const BN_ULONG *m,
+                                const BN_ULONG *RR, BN_ULONG k0,
+                                int factor_bits)
+{
+    AMM52_X1_FN amm;
+    EXTRACT_X1_FN extract;
+    int words = factor_bits / BN_BITS2, digits, pad, i, bit;
+    unsigned char *storage;
+    size_t storage_len;
+    BN_ULONG *mm, *rr, *acc, *mult, *one_x1, *twok, *table;
+    BN_ULONG out[MAX_WORDS + 1];
+
+    if ((pad = get_x1_kernels(factor_bits, &amm, &extract, &digits)) == 0)
+        return 0;
+
+    /* Six operands and the table, on a cache line boundary */
+    storage_len = (6 + TABLE_SIZE) * pad * sizeof(BN_ULONG) + 64;
+    if ((storage = OPENSSL_zalloc(storage_len)) == NULL)
+        return 0;
+    mm = (BN_ULONG *)(storage + (64 - ((size_t)storage & 63)));
+    rr = mm + pad;
+    acc = rr + pad;
+    mult = acc + pad;
+    one_x1 = mult + pad;
+    twok = one_x1 + pad;
+    table = twok + pad;
+
+    to_words52(mm, pad, m, words);
+    k0 &= DIGIT_MASK;
+    one_x1[0] = 1;
+    get_rr52(rr, twok, RR, mm, k0, amm, factor_bits, digits, pad);
+
+    /* table[i] = base^i in Montgomery form */
+    to_words52(mult, pad, base, base_len);
+    amm(table, one_x1, rr, mm, k0);
+    amm(table + pad, mult, rr, mm, k0);
+    for (i = 2; i < TABLE_SIZE; i++)
+        amm(table + i * pad, table + (i - 1) * pad, table + pad, mm, k0);
+
+    /* Fixed window exponentiation, from the window holding the top bit */
+    bit = ((exp_len * BN_BITS2 - 1) / EXP_WIN_SIZE) * EXP_WIN_SIZE;
+    extract(acc, table, get_window(exp, exp_len, bit));
+
+    while (bit > 0) {
+        bit -= EXP_WIN_SIZE;
+        for (i = 0; i < EXP_WIN_SIZE; i++)
+            amm(acc, acc, acc, mm, k0);
+        extract(mult, table, get_window(exp, exp_len, bit));
+        amm(acc, acc, mult, mm, k0);
+    }
+
+    /* Convert out of Montgomery form and fully reduce */
+    amm(acc, acc, one_x1, mm, k0);
+    from_words52(out, words + 1, acc, digits);
+    reduce_once(res, out, m, words);
+
+    OPENSSL_cleanse(out, sizeof(out));
+    OPENSSL_clear_free(storage, storage_len);
+    return 1;
+}
+
+/*
+ * Fixed-base comb exponentiation with the single lane kernels, see
+ * crypto/bn/bn_comb.c.  The table holds TABLE_SIZE entries of the padded
+ * digit length, so the comb has EXP_WIN_SIZE rows of |spacing| bits.
+ *
+ * Returns the length in words of the table for a |factor_bits| modulus, or
+ * 0 if it isn't supported.
+ */
+size_t ossl_rsaz_comb_avx512_x1_table_len(int factor_bits)
+{
+    AMM52_X1_FN amm;
+    EXTRACT_X1_FN extract;
+    int digits;
+
+    return (size_t)TABLE_SIZE * get_x1_kernels(factor_bits, &amm, &extract,
+                                               &digits);
+}
+
+/*
+ * Fill |table|, which must be 64 byte aligned, for the base |g| of |g_len|
+ * words.  The other arguments are as for ossl_rsaz_mod_exp_avx512_x1().
+ *
+ * Returns 1 on success.
+ */
+int ossl_rsaz_comb_avx512_x1_init(BN_ULONG *table, const BN_ULONG *g,
+                                  int g_len, const BN_ULONG *m,
+                                  const BN_ULONG *RR, BN_ULONG k0,
+                                  int factor_bits, int spacing)
+{
+    AMM52_X1_FN amm;
+    EXTRACT_X1_FN extract;
+    int words = factor_bits / BN_BITS2, digits, pad, i, j, hb;
+    ALIGN64 BN_ULONG mm[MAX_DIGITS], rr[MAX_DIGITS], pw[MAX_DIGITS];
+    ALIGN64 BN_ULONG one_x1[MAX_DIGITS] = { 1 };
+    ALIGN64 BN_ULONG twok[MAX_DIGITS] = { 0 };
+
+    if ((pad = get_x1_kernels(factor_bits, &amm, &extract, &digits)) == 0)
+        return 0;
+
+    to_words52(mm, pad, m, words);
+    k0 &= DIGIT_MASK;
+    get_rr52(rr, twok, RR, mm, k0, amm, factor_bits, digits, pad);
+
+    /* Entry 0 is one, and entry 2^j is g^(2^(j * spacing)) */
+    amm(table, one_x1, rr, mm, k0);
+    to_words52(pw, pad, g, g_len);
+    amm(pw, pw, rr, mm, k0);
+    for (j = 0; j < EXP_WIN_SIZE; j++) {
+        if (j > 0)
+            for (i = 0; i < spacing; i++)
+                amm(pw, pw, pw, mm, k0);
+        memcpy(table + (1 << j) * pad, pw, pad * sizeof(*pw));
+    }
+
+    /* The remaining entries are products of those */
+    for (i = 3; i < TABLE_SIZE; i++) {
+        hb = BN_num_bits_word((BN_ULONG)i) - 1;
+        if (i != 1 << hb)
+            amm(table + i * pad, table + (i ^ (1 << hb)) * pad,
+                table + (1 << hb) * pad, mm, k0);
+    }
+    return 1;
+}
+
+/*
+ * Compute res = g^exp mod m with a table from ossl_rsaz_comb_avx512_x1_init().
+ * |exp| has |exp_len| words, which must cover EXP_WIN_SIZE * |spacing| bits.
+ *
+ * Returns 1 on success.
+ */
+int ossl_rsaz_comb_avx512_x1(BN_ULONG *res, const BN_ULONG *table,
+                             const BN_ULONG *exp, int exp_len,
+                             const BN_ULONG *m, BN_ULONG k0,
+                             int factor_bits, int spacing)
+{
+    AMM52_X1_FN amm;
+    EXTRACT_X1_FN extract;
+    int words = factor_bits / BN_BITS2, digits, pad, j, k, bit, idx;
+    ALIGN64 BN_ULONG mm[MAX_DIGITS], acc[MAX_DIGITS], mult[MAX_DIGITS];
+    ALIGN64 BN_ULONG one_x1[MAX_DIGITS] = { 1 };
+    BN_ULONG out[MAX_WORDS + 1];
+
+    if ((pad = get_x1_kernels(factor_bits, &amm, &extract, &digits)) == 0
+            || exp_len * BN_BITS2 < EXP_WIN_SIZE * spacing)
+        return 0;
+
+    to_words52(mm, pad, m, words);
+    k0 &= DIGIT_MASK;
+
+    for (k = spacing - 1; k >= 0; k--) {
+        for (idx = 0, j = 0; j < EXP_WIN_SIZE; j++) {
+            bit = k + j * spacing;
+            idx |= (int)((exp[bit / BN_BITS2] >> (bit % BN_BITS2)) & 1) << j;
+        }
+        if (k == spacing - 1) {
+            extract(acc, table, idx);
+            continue;
+        }
+        extract(mult, table, idx);
+        amm(acc, acc, acc, mm, k0);
+        amm(acc, acc, mult, mm, k0);
+    }
+
+    /* Convert out of Montgomery form and fully reduce */
+    amm(acc, acc, one_x1, mm, k0);
+    from_words52(out, words + 1, acc, digits);
+    reduce_once(res, out, m, words);
+
+    OPENSSL_cleanse(acc, sizeof(acc));
+    OPENSSL_cleanse(out, sizeof(out));
+    return 1;
+}
+
+#endif
@@ -19,6 +19,7 @@
 #include "crypto/bn.h"
 #include "crypto/dh.h"
 #include "crypto/security_bits.h"
+#include "internal/ffc.h"
 
 #ifdef FIPS_MODULE
 # define MIN_STRENGTH 112
@@ -53,7 +54,7 @@ static int compute_key(unsigned char *key, const BIGNUM *pub_key, DH *dh)
         return 0;
     }
 
-    ctx = BN_CTX_new_ex(dh->libctx);
+    ctx = ossl_bn_ctx_acquire(dh->libctx, 0);
     if (ctx == NULL)
         goto err;
     BN_CTX_start(ctx);
@@ -90,7 +91,7 @@ static int compute_key(unsigned char *key, const BIGNUM *pub_key, DH *dh)
     ret = BN_bn2binpad(tmp, key, BN_num_bytes(dh->params.p));
  err:
     BN_CTX_end(ctx);
-    BN_CTX_free(ctx);
+    ossl_bn_ctx_release(ctx);
     return ret;
 }
 
@@ -210,6 +211,134 @@ int DH_generate_key(DH *dh)
 #endif
 }
 
+/*
+ * Fixed-base tables for the named groups, built the first time a key is
+ * generated in a group and kept for the life of the library context.  The
+ * cost of a table grows with the exponent length it is built for, so there
+ * is one per group and private key length.
+ */
+#define DH_FIXED_BASE_MAX   16
+
+typedef struct dh_fixed_base_cache_st {
+    CRYPTO_RWLOCK *lock;
+    struct {
+        int nid;
+        int bits;
+        BN_COMB *comb;
+    } entry[DH_FIXED_BASE_MAX];
+} DH_FIXED_BASE_CACHE;
+
+static void *dh_fixed_base_cache_new(OSSL_LIB_CTX *libctx)
+{
+    DH_FIXED_BASE_CACHE *cache = OPENSSL_zalloc(sizeof(*cache));
+
+    if (cache == NULL)
+        return NULL;
+    if ((cache->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+        OPENSSL_free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+static void dh_fixed_base_cache_free(void *vcache)
+{
+    DH_FIXED_BASE_CACHE *cache = vcache;
+    int i;
+
+    if (cache == NULL)
+        return;
+    for (i = 0; i < DH_FIXED_BASE_MAX; i++)
+        ossl_bn_comb_free(cache->entry[i].comb);
+    CRYPTO_THREAD_lock_free(cache->lock);
+    OPENSSL_free(cache);
+}
+
+static const OSSL_LIB_CTX_METHOD dh_fixed_base_cache_method = {
+    dh_fixed_base_cache_new,
+    dh_fixed_base_cache_free,
+};
+
+/* Sets |*full| if there is no table and no room to add one */
+static BN_COMB *dh_fixed_base_lookup(DH_FIXED_BASE_CACHE *cache, int nid,
+                                     int bits, int *full)
+{
+    BN_COMB *comb = NULL;
+    int i;
+
+    *full = 1;
+    if (!CRYPTO_THREAD_read_lock(cache->lock))
+        return NULL;
+    for (i = 0; i < DH_FIXED_BASE_MAX && cache->entry[i].comb != NULL; i++) {
+        if (cache->entry[i].nid == nid && cache->entry[i].bits == bits) {
+            comb = cache->entry[i].comb;
+            break;
+        }
+    }
+    *full = i == DH_FIXED_BASE_MAX;
+    CRYPTO_THREAD_unlock(cache->lock);
+    return comb;
+}
+
+/*
+ * Returns the table for the named group and private key length of |dh|, or
+ * NULL if there is none and one cannot be built.  The parameters are checked
+ * against the group itself before a table is built from them, since the nid
+ * is only cached.
+ */
+static BN_COMB *dh_get_fixed_base(const DH *dh, BN_CTX *ctx)
+{
+    DH_FIXED_BASE_CACHE *cache;
+    const DH_NAMED_GROUP *group;
+    BN_COMB *comb, *ret = NULL;
+    /* A generated private key may be as large as 2^length */
+    int bits = dh->length != 0 ? dh->length + 1 : BN_num_bits(dh->params.p);
+    int nid = DH_get_nid(dh), full, i;
+
+    if (nid == NID_undef)
+        return NULL;
+    cache = ossl_lib_ctx_get_data(dh->libctx, OSSL_LIB_CTX_DH_FIXED_BASE_INDEX,
+                                  &dh_fixed_base_cache_method);
+    if (cache == NULL)
+        return NULL;
+    if ((comb = dh_fixed_base_lookup(cache, nid, bits, &full)) != NULL
+            || full)
+        return comb;
+
+    group = ossl_ffc_numbers_to_dh_named_group(dh->params.p, dh->params.q,
+                                               dh->params.g);
+    if (ossl_ffc_named_group_get_uid(group) != nid)
+        return NULL;
+    /* Without a table the caller falls back, so any error is not reported */
+    ERR_set_mark();
+    comb = ossl_bn_comb_new(dh->params.g, dh->params.p, bits, ctx);
+    ERR_pop_to_mark();
+    if (comb == NULL)
+        return NULL;
+
+    /* Another thread may have got there first */
+    if (!CRYPTO_THREAD_write_lock(cache->lock)) {
+        ossl_bn_comb_free(comb);
+        return NULL;
+    }
+    for (i = 0; i < DH_FIXED_BASE_MAX; i++) {
+        if (cache->entry[i].comb == NULL) {
+            cache->entry[i].nid = nid;
+            cache->entry[i].bits = bits;
+            cache->entry[i].comb = ret = comb;
+            comb = NULL;
+            break;
+        }
+        if (cache->entry[i].nid == nid && cache->entry[i].bits == bits) {
+            ret = cache->entry[i].comb;
+            break;
+        }
+    }
+    CRYPTO_THREAD_unlock(cache->lock);
+    ossl_bn_comb_free(comb);
+    return ret;
+}
+
 int ossl_dh_generate_public_key(BN_CTX *ctx, const DH *dh,
                                 const BIGNUM *priv_key, BIGNUM *pub_key)
 {
@@ -237,6 +366,19 @@ int ossl_dh_generate_public_key(BN_CTX *ctx, const DH *dh,
     BN_with_flags(prk, priv_key, BN_FLG_CONSTTIME);
 
     /* pub_key = g^priv_key mod p */
+#ifndef FIPS_MODULE
+    if (dh->meth->bn_mod_exp == dh_bn_mod_exp)
+#endif
+    {
+        BN_COMB *comb = dh_get_fixed_base(dh, ctx);
+
+        if (comb != NULL
+                && ossl_bn_comb_matches(comb, dh->params.g, dh->params.p,
+                                        BN_num_bits(prk))) {
+            ret = ossl_bn_comb_mod_exp(pub_key, comb, prk, ctx);
+            goto err;
+        }
+    }
     if (!dh->meth->bn_mod_exp(dh, pub_key, dh->params.g, prk, dh->params.p,
                               ctx, mont))
         goto err;
@@ -266,7 +408,7 @@ static int generate_key(DH *dh)
         return 0;
     }
 
-    ctx = BN_CTX_new_ex(dh->libctx);
+    ctx = ossl_bn_ctx_acquire(dh->libctx, 0);
     if (ctx == NULL)
         goto err;
 
@@ -359,7 +501,7 @@ static int generate_key(DH *dh)
         BN_free(pub_key);
     if (priv_key != dh->priv_key)
         BN_free(priv_key);
-    BN_CTX_free(ctx);
+    ossl_bn_ctx_release(ctx);
     return ok;
 }
 
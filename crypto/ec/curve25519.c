@@ -18,6 +18,7 @@
 #include "ec_local.h"
 #include <openssl/evp.h>
 #include <openssl/sha.h>
+#include <openssl/rand.h>
 
 #if defined(X25519_ASM) && (defined(__x86_64) || defined(__x86_64__) || \
                             defined(_M_AMD64) || defined(_M_X64))
@@ -203,13 +204,12 @@ static void fe64_invert(fe64 out, const fe64 z)
 }
 
 /*
- * Duplicate of original x25519_scalar_mult_generic, but using
- * fe64_* subroutines.
+ * Duplicate of original x25519_ladder_generic, but using fe64_* subroutines.
  */
-static void x25519_scalar_mulx(uint8_t out[32], const uint8_t scalar[32],
+static void x25519_ladder_mulx(fe64 x2, fe64 z2, const uint8_t scalar[32],
                                const uint8_t point[32])
 {
-    fe64 x1, x2, z2, x3, z3, tmp0, tmp1;
+    fe64 x1, x3, z3, tmp0, tmp1;
     uint8_t e[32];
     unsigned swap = 0;
     int pos;
@@ -251,11 +251,18 @@ static void x25519_scalar_mulx(uint8_t out[32], const uint8_t scalar[32],
         fe64_mul(z2, tmp1, tmp0);
     }
 
+    OPENSSL_cleanse(e, sizeof(e));
+}
+
+static void x25519_scalar_mulx(uint8_t out[32], const uint8_t scalar[32],
+                               const uint8_t point[32])
+{
+    fe64 x2, z2;
+
+    x25519_ladder_mulx(x2, z2, scalar, point);
     fe64_invert(z2, z2);
     fe64_mul(x2, x2, z2);
     fe64_tobytes(out, x2);
-
-    OPENSSL_cleanse(e, sizeof(e));
 }
 #endif
 
@@ -688,24 +695,16 @@ static void fe51_invert(fe51 out, const fe51 z)
 }
 
 /*
- * Duplicate of original x25519_scalar_mult_generic, but using
- * fe51_* subroutines.
+ * Duplicate of original x25519_ladder_generic, but using fe51_* subroutines.
  */
-static void x25519_scalar_mult(uint8_t out[32], const uint8_t scalar[32],
-                               const uint8_t point[32])
+static void x25519_ladder51(fe51 x2, fe51 z2, const uint8_t scalar[32],
+                            const uint8_t point[32])
 {
-    fe51 x1, x2, z2, x3, z3, tmp0, tmp1;
+    fe51 x1, x3, z3, tmp0, tmp1;
     uint8_t e[32];
     unsigned swap = 0;
     int pos;
 
-# ifdef BASE_2_64_IMPLEMENTED
-    if (x25519_fe64_eligible()) {
-        x25519_scalar_mulx(out, scalar, point);
-        return;
-    }
-# endif
-
     memcpy(e, scalar, 32);
     e[0]  &= 0xf8;
     e[31] &= 0x7f;
@@ -743,11 +742,52 @@ static void x25519_scalar_mult(uint8_t out[32], const uint8_t scalar[32],
         fe51_mul(z2, tmp1, tmp0);
     }
 
+    OPENSSL_cleanse(e, sizeof(e));
+}
+
+static void x25519_scalar_mult(uint8_t out[32], const uint8_t scalar[32],
+                               const uint8_t point[32])
+{
+    fe51 x2, z2;
+
+# ifdef BASE_2_64_IMPLEMENTED
+    if (x25519_fe64_eligible()) {
+        x25519_scalar_mulx(out, scalar, point);
+        return;
+    }
+# endif
+
+    x25519_ladder51(x2, z2, scalar, point);
     fe51_invert(z2, z2);
     fe51_mul(x2, x2, z2);
     fe51_tobytes(out, x2);
+}
 
-    OPENSSL_cleanse(e, sizeof(e));
+/*
+ * Same as x25519_scalar_mult(), but stops short of the final inversion and
+ * returns the projective coordinates of the result instead.
+ */
+static void x25519_scalar_mult_proj(uint8_t x[32], uint8_t z[32],
+                                    const uint8_t scalar[32],
+                                    const uint8_t point[32])
+{
+# ifdef BASE_2_64_IMPLEMENTED
+    if (x25519_fe64_eligible()) {
+        fe64 x2, z2;
+
+        x25519_ladder_mulx(x2, z2, scalar, point);
+        fe64_tobytes(x, x2);
+        fe64_tobytes(z, z2);
+        return;
+    }
+# endif
+    {
+        fe51 x2, z2;
+
+        x25519_ladder51(x2, z2, scalar, point);
+        fe51_tobytes(x, x2);
+        fe51_tobytes(z, z2);
+    }
 }
 #endif
 
@@ -1906,6 +1946,25 @@ static int ge_frombytes_vartime(ge_p3 *h, const uint8_t *s)
     return 0;
 }
 
+/*
+ * Like ge_frombytes_vartime(), but only accepts the encoding that
+ * ge_tobytes() produces for the point, so y must be less than p and the sign
+ * bit must be clear if x is 0.
+ */
+static int ge_frombytes_canonical_vartime(ge_p3 *h, const uint8_t *s)
+{
+    uint8_t y[32];
+
+    if (ge_frombytes_vartime(h, s) != 0)
+        return -1;
+    fe_tobytes(y, h->Y);
+    if (memcmp(y, s, 31) != 0 || y[31] != (s[31] & 0x7f))
+        return -1;
+    if (!fe_isnonzero(h->X) && (s[31] >> 7) != 0)
+        return -1;
+    return 0;
+}
+
 static void ge_p2_0(ge_p2 *h)
 {
     fe_0(h->X);
@@ -4372,10 +4431,9 @@ static void fe_mul121666(fe h, fe f)
     h[9] = (int32_t)h9;
 }
 
-static void x25519_scalar_mult_generic(uint8_t out[32],
-                                       const uint8_t scalar[32],
-                                       const uint8_t point[32]) {
-    fe x1, x2, z2, x3, z3, tmp0, tmp1;
+static void x25519_ladder_generic(fe x2, fe z2, const uint8_t scalar[32],
+                                  const uint8_t point[32]) {
+    fe x1, x3, z3, tmp0, tmp1;
     uint8_t e[32];
     unsigned swap = 0;
     int pos;
@@ -4416,16 +4474,31 @@ static void x25519_scalar_mult_generic(uint8_t out[32],
         fe_mul(z2, tmp1, tmp0);
     }
 
-    fe_invert(z2, z2);
-    fe_mul(x2, x2, z2);
-    fe_tobytes(out, x2);
-
     OPENSSL_cleanse(e, sizeof(e));
 }
 
 static void x25519_scalar_mult(uint8_t out[32], const uint8_t scalar[32],
                                const uint8_t point[32]) {
-    x25519_scalar_mult_generic(out, scalar, point);
+    fe x2, z2;
+
+    x25519_ladder_generic(x2, z2, scalar, point);
+    fe_invert(z2, z2);
+    fe_mul(x2, x2, z2);
+    fe_tobytes(out, x2);
+}
+
+/*
+ * Same as x25519_scalar_mult(), but stops short of the final inversion and
+ * returns the projective coordinates of the result instead.
+ */
+static void x25519_scalar_mult_proj(uint8_t x[32], uint8_t z[32],
+                                    const uint8_t scalar[32],
+                                    const uint8_t point[32]) {
+    fe x2, z2;
+
+    x25519_ladder_generic(x2, z2, scalar, point);
+    fe_tobytes(x, x2);
+    fe_tobytes(z, z2);
 }
 #endif
 
@@ -4538,6 +4611,24 @@ static const ge_precomp Bi[8] = {
  * and b = b[0]+256*b[1]+...+256^31 b[31].
  * B is the Ed25519 base point (x,4/5) with x positive.
  */
+/* Ai = A,3A,5A,7A,9A,11A,13A,15A */
+static void ge_p3_odd_multiples(ge_cached Ai[8], const ge_p3 *A)
+{
+    ge_p1p1 t;
+    ge_p3 u;
+    ge_p3 A2;
+    int i;
+
+    ge_p3_to_cached(&Ai[0], A);
+    ge_p3_dbl(&t, A);
+    ge_p1p1_to_p3(&A2, &t);
+    for (i = 1; i < 8; i++) {
+        ge_add(&t, &A2, &Ai[i - 1]);
+        ge_p1p1_to_p3(&u, &t);
+        ge_p3_to_cached(&Ai[i], &u);
+    }
+}
+
 static void ge_double_scalarmult_vartime(ge_p2 *r, const uint8_t *a,
                                          const ge_p3 *A, const uint8_t *b)
 {
@@ -4546,36 +4637,12 @@ static void ge_double_scalarmult_vartime(ge_p2 *r, const uint8_t *a,
     ge_cached Ai[8]; /* A,3A,5A,7A,9A,11A,13A,15A */
     ge_p1p1 t;
     ge_p3 u;
-    ge_p3 A2;
     int i;
 
     slide(aslide, a);
     slide(bslide, b);
 
-    ge_p3_to_cached(&Ai[0], A);
-    ge_p3_dbl(&t, A);
-    ge_p1p1_to_p3(&A2, &t);
-    ge_add(&t, &A2, &Ai[0]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[1], &u);
-    ge_add(&t, &A2, &Ai[1]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[2], &u);
-    ge_add(&t, &A2, &Ai[2]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[3], &u);
-    ge_add(&t, &A2, &Ai[3]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[4], &u);
-    ge_add(&t, &A2, &Ai[4]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[5], &u);
-    ge_add(&t, &A2, &Ai[5]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[6], &u);
-    ge_add(&t, &A2, &Ai[6]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[7], &u);
+    ge_p3_odd_multiples(Ai, A);
 
     ge_p2_0(r);
 
@@ -4608,6 +4675,59 @@ static void ge_double_scalarmult_vartime(ge_p2 *r, const uint8_t *a,
     }
 }
 
+/*
+ * r = b * B + a_0 * A_0 + ... + a_{num-1} * A_{num-1}, where the caller has
+ * recoded each a_j with slide() into |aslide[j]| and stored the odd multiples
+ * of A_j in |Ai[j]|.  The doublings are shared between all the points.
+ */
+static void ge_multi_scalarmult_vartime(ge_p2 *r, const uint8_t *b,
+                                        size_t num, signed char (*aslide)[256],
+                                        ge_cached (*Ai)[8])
+{
+    signed char bslide[256];
+    ge_p1p1 t;
+    ge_p3 u;
+    size_t j;
+    int i;
+
+    slide(bslide, b);
+
+    ge_p2_0(r);
+
+    for (i = 255; i >= 0; --i) {
+        if (bslide[i])
+            break;
+        for (j = 0; j < num && !aslide[j][i]; j++)
+            continue;
+        if (j < num)
+            break;
+    }
+
+    for (; i >= 0; --i) {
+        ge_p2_dbl(&t, r);
+
+        for (j = 0; j < num; j++) {
+            if (aslide[j][i] > 0) {
+                ge_p1p1_to_p3(&u, &t);
+                ge_add(&t, &u, &Ai[j][aslide[j][i] / 2]);
+            } else if (aslide[j][i] < 0) {
+                ge_p1p1_to_p3(&u, &t);
+                ge_sub(&t, &u, &Ai[j][(-aslide[j][i]) / 2]);
+            }
+        }
+
+        if (bslide[i] > 0) {
+            ge_p1p1_to_p3(&u, &t);
+            ge_madd(&t, &u, &Bi[bslide[i] / 2]);
+        } else if (bslide[i] < 0) {
+            ge_p1p1_to_p3(&u, &t);
+            ge_msub(&t, &u, &Bi[(-bslide[i]) / 2]);
+        }
+
+        ge_p1p1_to_p2(r, &t);
+    }
+}
+
 /*
  * The set of scalars is \Z/l
  * where l = 2^252 + 27742317777372353535851937790883648493.
@@ -5494,38 +5614,22 @@ err:
 
 static const char allzeroes[15];
 
-int
-ossl_ed25519_verify(const uint8_t *message, size_t message_len,
-                    const uint8_t signature[64], const uint8_t public_key[32],
-                    OSSL_LIB_CTX *libctx, const char *propq)
+/*
+ * Check 0 <= s < L where L = 2^252 + 27742317777372353535851937790883648493
+ *
+ * If not the signature is publicly invalid. Since it's public we can do the
+ * check in variable time.
+ */
+static int ed25519_s_is_canonical(const uint8_t *s)
 {
     int i;
-    ge_p3 A;
-    const uint8_t *r, *s;
-    EVP_MD *sha512;
-    EVP_MD_CTX *hash_ctx = NULL;
-    unsigned int sz;
-    int res = 0;
-    ge_p2 R;
-    uint8_t rcheck[32];
-    uint8_t h[SHA512_DIGEST_LENGTH];
     /* 27742317777372353535851937790883648493 in little endian format */
-    const uint8_t l_low[16] = {
+    static const uint8_t l_low[16] = {
         0xED, 0xD3, 0xF5, 0x5C, 0x1A, 0x63, 0x12, 0x58, 0xD6, 0x9C, 0xF7, 0xA2,
         0xDE, 0xF9, 0xDE, 0x14
     };
 
-    r = signature;
-    s = signature + 32;
-
-    /*
-     * Check 0 <= s < L where L = 2^252 + 27742317777372353535851937790883648493
-     *
-     * If not the signature is publicly invalid. Since it's public we can do the
-     * check in variable time.
-     *
-     * First check the most significant byte
-     */
+    /* First check the most significant byte */
     if (s[31] > 0x10)
         return 0;
     if (s[31] == 0x10) {
@@ -5544,6 +5648,29 @@ ossl_ed25519_verify(const uint8_t *message, size_t message_len,
         if (i < 0)
             return 0;
     }
+    return 1;
+}
+
+int
+ossl_ed25519_verify(const uint8_t *message, size_t message_len,
+                    const uint8_t signature[64], const uint8_t public_key[32],
+                    OSSL_LIB_CTX *libctx, const char *propq)
+{
+    ge_p3 A;
+    const uint8_t *r, *s;
+    EVP_MD *sha512;
+    EVP_MD_CTX *hash_ctx = NULL;
+    unsigned int sz;
+    int res = 0;
+    ge_p2 R;
+    uint8_t rcheck[32];
+    uint8_t h[SHA512_DIGEST_LENGTH];
+
+    r = signature;
+    s = signature + 32;
+
+    if (!ed25519_s_is_canonical(s))
+        return 0;
 
     if (ge_frombytes_vartime(&A, public_key) != 0) {
         return 0;
@@ -5579,6 +5706,174 @@ err:
     return res;
 }
 
+/*
+ * Multiplies |P| by the cofactor 8 and returns 1 if the result is the
+ * identity.
+ */
+static int ge_p2_is_small_order(ge_p2 *P)
+{
+    ge_p1p1 t;
+    int k;
+
+    for (k = 0; k < 3; k++) {
+        ge_p2_dbl(&t, P);
+        ge_p1p1_to_p2(P, &t);
+    }
+    fe_sub(P->Y, P->Y, P->Z);
+    return !fe_isnonzero(P->X) && !fe_isnonzero(P->Y);
+}
+
+/*
+ * Signatures are verified in chunks of this many, which bounds the memory
+ * used for the odd multiples of the R values to about 100 KiB.
+ */
+#define ED25519_BATCH_SIZE 64
+
+/*
+ * Verifies |num| signatures under the same public key, writing 1 (valid) or
+ * 0 (invalid) to each element of |results|.
+ *
+ * Each chunk is checked with a single multi-scalar multiplication, using the
+ * randomised batch equation
+ *
+ *   [8](sum(z_i * s_i) B - sum(z_i * k_i) A - sum(z_i R_i)) = 0
+ *
+ * with random 128-bit z_i.  If a chunk fails the check, its signatures are
+ * checked one by one with the same equation and z_i = 1 to find the bad ones,
+ * so a signature gets the same result whatever else is in its chunk.
+ *
+ * A batch equation cannot reject a small order component in R without
+ * checking every R for one, which costs about as much as verifying the
+ * signature on its own.  So, as RFC 8032 allows, this function uses the
+ * cofactored equation throughout.  Unlike ossl_ed25519_verify(), it accepts
+ * signatures whose R differs from [s]B - [k]A by a small order point.  No
+ * signer following RFC 8032 produces such signatures.
+ *
+ * Returns 1 if all signatures are valid, 0 if any are not, or -1 on error.
+ */
+int
+ossl_ed25519_verify_batch(int *results, size_t num,
+                          const uint8_t *const messages[],
+                          const size_t message_lens[],
+                          const uint8_t *const signatures[],
+                          const uint8_t public_key[32],
+                          OSSL_LIB_CTX *libctx, const char *propq)
+{
+    signed char (*slides)[256] = NULL;
+    ge_cached (*tables)[8] = NULL;
+    size_t idx[ED25519_BATCH_SIZE];
+    uint8_t hs[ED25519_BATCH_SIZE][32];
+    size_t start, end, i, n;
+    ge_p3 A, R;
+    ge_p2 P;
+    EVP_MD *sha512 = NULL;
+    EVP_MD_CTX *hash_ctx = NULL;
+    uint8_t h[SHA512_DIGEST_LENGTH];
+    uint8_t z[32], a[32], b[32];
+    unsigned int sz;
+    int res = -1, all = 1;
+
+    for (i = 0; i < num; i++)
+        results[i] = 0;
+    if (num == 0)
+        return 1;
+    if (ge_frombytes_vartime(&A, public_key) != 0)
+        return 0;
+
+    fe_neg(A.X, A.X);
+    fe_neg(A.T, A.T);
+
+    /* Entry 0 is for the public key, the R values follow */
+    slides = OPENSSL_malloc((ED25519_BATCH_SIZE + 1) * sizeof(*slides));
+    tables = OPENSSL_malloc((ED25519_BATCH_SIZE + 1) * sizeof(*tables));
+    sha512 = EVP_MD_fetch(libctx, SN_sha512, propq);
+    hash_ctx = EVP_MD_CTX_new();
+    if (slides == NULL || tables == NULL || sha512 == NULL || hash_ctx == NULL)
+        goto err;
+
+    ge_p3_odd_multiples(tables[0], &A);
+    memset(z, 0, sizeof(z));
+
+    for (start = 0; start < num; start = end) {
+        end = num - start > ED25519_BATCH_SIZE ? start + ED25519_BATCH_SIZE
+                                               : num;
+        memset(a, 0, sizeof(a));
+        memset(b, 0, sizeof(b));
+        n = 0;
+
+        for (i = start; i < end; i++) {
+            const uint8_t *r = signatures[i], *s = signatures[i] + 32;
+
+            /*
+             * Signatures that fail these checks are invalid whatever the
+             * rest of the batch looks like, so they are left out of it.
+             */
+            if (!ed25519_s_is_canonical(s)
+                || ge_frombytes_canonical_vartime(&R, r) != 0) {
+                all = 0;
+                continue;
+            }
+
+            if (!EVP_DigestInit_ex(hash_ctx, sha512, NULL)
+                || !EVP_DigestUpdate(hash_ctx, r, 32)
+                || !EVP_DigestUpdate(hash_ctx, public_key, 32)
+                || !EVP_DigestUpdate(hash_ctx, messages[i], message_lens[i])
+                || !EVP_DigestFinal_ex(hash_ctx, h, &sz))
+                goto err;
+            x25519_sc_reduce(h);
+
+            if (RAND_bytes_ex(libctx, z, 16) <= 0)
+                goto err;
+            sc_muladd(a, z, h, a);
+            sc_muladd(b, z, s, b);
+
+            fe_neg(R.X, R.X);
+            fe_neg(R.T, R.T);
+            slide(slides[n + 1], z);
+            ge_p3_odd_multiples(tables[n + 1], &R);
+            memcpy(hs[n], h, sizeof(hs[n]));
+            idx[n++] = i;
+        }
+        if (n == 0)
+            continue;
+
+        slide(slides[0], a);
+        ge_multi_scalarmult_vartime(&P, b, n + 1, slides, tables);
+        if (ge_p2_is_small_order(&P)) {
+            for (i = 0; i < n; i++)
+                results[idx[i]] = 1;
+            continue;
+        }
+
+        /*
+         * Check each signature on its own with z = 1, moving its R table
+         * into slot 1.  Tables are only moved down, so none is overwritten
+         * before it is used.
+         */
+        memset(z, 0, sizeof(z));
+        z[0] = 1;
+        slide(slides[1], z);
+        for (i = 0; i < n; i++) {
+            if (i > 0)
+                memcpy(tables[1], tables[i + 1], sizeof(tables[1]));
+            slide(slides[0], hs[i]);
+            ge_multi_scalarmult_vartime(&P, signatures[idx[i]] + 32, 2,
+                                        slides, tables);
+            results[idx[i]] = ge_p2_is_small_order(&P);
+            if (!results[idx[i]])
+                all = 0;
+        }
+    }
+    res = all;
+
+err:
+    OPENSSL_free(slides);
+    OPENSSL_free(tables);
+    EVP_MD_free(sha512);
+    EVP_MD_CTX_free(hash_ctx);
+    return res;
+}
+
 int
 ossl_ed25519_public_from_private(OSSL_LIB_CTX *ctx, uint8_t out_public_key[32],
                                  const uint8_t private_key[32],
@@ -5620,6 +5915,82 @@ ossl_x25519(uint8_t out_shared_key[32], const uint8_t private_key[32],
     return CRYPTO_memcmp(kZeros, out_shared_key, 32) != 0;
 }
 
+#define X25519_BATCH_SIZE 32
+
+/*
+ * Computes |num| X25519 shared secrets for one private key.  The ladders
+ * are run as usual, but their final inversions are shared across a chunk
+ * using Montgomery's trick: one inversion plus three multiplications per
+ * item instead of one inversion per item.  A peer point of small order
+ * gives z = 0, which is swapped for 1 so it cannot spoil the rest of the
+ * chunk, and the result forced to zero as ossl_x25519() would have.
+ *
+ * |results[i]| is set to 1 if |out_shared_keys[i]| holds a valid secret and
+ * to 0 otherwise.  Returns 1 if all results are valid and 0 otherwise.
+ */
+int
+ossl_x25519_batch(int *results, size_t num, uint8_t *const out_shared_keys[],
+                  const uint8_t private_key[32],
+                  const uint8_t *const peer_public_values[])
+{
+    static const uint8_t kZeros[32] = {0};
+    fe z[X25519_BATCH_SIZE], acc[X25519_BATCH_SIZE], one, inv, t;
+    uint8_t zbytes[32];
+    unsigned int is_zero[X25519_BATCH_SIZE];
+    size_t i, n, done;
+    int ret = 1;
+
+    fe_1(one);
+    for (done = 0; done < num; done += n) {
+        n = num - done;
+        if (n > X25519_BATCH_SIZE)
+            n = X25519_BATCH_SIZE;
+
+        for (i = 0; i < n; i++) {
+            x25519_scalar_mult_proj(out_shared_keys[done + i], zbytes,
+                                    private_key, peer_public_values[done + i]);
+            fe_frombytes(z[i], zbytes);
+            is_zero[i] = (unsigned int)!fe_isnonzero(z[i]);
+            fe_cmov(z[i], one, is_zero[i]);
+            if (i == 0)
+                fe_copy(acc[0], z[0]);
+            else
+                fe_mul(acc[i], acc[i - 1], z[i]);
+        }
+
+        fe_invert(inv, acc[n - 1]);
+        for (i = n; i-- > 0;) {
+            uint8_t *out = out_shared_keys[done + i];
+            fe x;
+
+            /* inv is now (z[0] * ... * z[i])^-1 */
+            if (i > 0) {
+                fe_mul(t, inv, acc[i - 1]);
+                fe_mul(inv, inv, z[i]);
+            } else {
+                fe_copy(t, inv);
+            }
+            fe_frombytes(x, out);
+            fe_mul(x, x, t);
+            fe_tobytes(out, x);
+
+            /* Small order points produce zero, just as in ossl_x25519() */
+            if (is_zero[i])
+                memset(out, 0, 32);
+            results[done + i] = CRYPTO_memcmp(kZeros, out, 32) != 0;
+            if (!results[done + i])
+                ret = 0;
+        }
+    }
+
+    OPENSSL_cleanse(zbytes, sizeof(zbytes));
+    OPENSSL_cleanse(z, sizeof(z));
+    OPENSSL_cleanse(acc, sizeof(acc));
+    OPENSSL_cleanse(inv, sizeof(inv));
+    OPENSSL_cleanse(t, sizeof(t));
+    return ret;
+}
+
 void
 ossl_x25519_public_from_private(uint8_t out_public_value[32],
                                 const uint8_t private_key[32])
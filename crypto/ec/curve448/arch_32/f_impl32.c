@@ -12,6 +12,8 @@
 
 #include "field.h"
 
+#if ARCH_WORD_BITS == 32
+
 void gf_mul(gf_s * RESTRICT cs, const gf as, const gf bs)
 {
     const uint32_t *a = as->limb, *b = bs->limb;
@@ -93,3 +95,7 @@ void gf_sqr(gf_s * RESTRICT cs, const gf as)
 {
     gf_mul(cs, as, as);         /* Performs better with a dedicated square */
 }
+
+#else
+NON_EMPTY_TRANSLATION_UNIT
+#endif
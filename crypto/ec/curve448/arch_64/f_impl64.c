@@ -0,0 +1,169 @@
+/*
+ * Copyright 2017-2021 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2014 Cryptography Research, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ *
+ * Originally written by Mike Hamburg
+ */
+
+#include "field.h"
+
+#if ARCH_WORD_BITS == 64
+
+/*
+ * Limbs are 56 bits, eight of them in two halves of four.  With phi = 2^224
+ * the prime is phi^2 - phi - 1, so a product of a = a0 + a1 * phi and
+ * b = b0 + b1 * phi reduces to
+ *
+ *   (a0 * b0 + a1 * b1) + ((a0 + a1) * (b0 + b1) - a0 * b0) * phi
+ *
+ * which takes three half-size products instead of four.
+ */
+void gf_mul(gf_s * RESTRICT cs, const gf as, const gf bs)
+{
+    const uint64_t *a = as->limb, *b = bs->limb;
+    uint64_t *c = cs->limb;
+    __uint128_t accum0 = 0, accum1 = 0, accum2;
+    uint64_t mask = (1ULL << 56) - 1;
+    uint64_t aa[4], bb[4];
+    int i, j;
+
+    for (i = 0; i < 4; i++) {
+        aa[i] = a[i] + a[i + 4];
+        bb[i] = b[i] + b[i + 4];
+    }
+
+    for (j = 0; j < 4; j++) {
+        accum2 = 0;
+        for (i = 0; i < j + 1; i++) {
+            accum2 += widemul(a[j - i], b[i]);
+            accum1 += widemul(aa[j - i], bb[i]);
+            accum0 += widemul(a[4 + j - i], b[4 + i]);
+        }
+        accum1 -= accum2;
+        accum0 += accum2;
+        accum2 = 0;
+        for (i = j + 1; i < 4; i++) {
+            accum0 -= widemul(a[4 + j - i], b[i]);
+            accum2 += widemul(aa[4 + j - i], bb[i]);
+            accum1 += widemul(a[8 + j - i], b[4 + i]);
+        }
+        accum1 += accum2;
+        accum0 += accum2;
+        c[j] = ((uint64_t)(accum0)) & mask;
+        c[j + 4] = ((uint64_t)(accum1)) & mask;
+        accum0 >>= 56;
+        accum1 >>= 56;
+    }
+
+    accum0 += accum1;
+    accum0 += c[4];
+    accum1 += c[0];
+    c[4] = ((uint64_t)(accum0)) & mask;
+    c[0] = ((uint64_t)(accum1)) & mask;
+
+    accum0 >>= 56;
+    accum1 >>= 56;
+    c[5] += ((uint64_t)(accum0));
+    c[1] += ((uint64_t)(accum1));
+}
+
+void gf_mulw_unsigned(gf_s * RESTRICT cs, const gf as, uint32_t b)
+{
+    const uint64_t *a = as->limb;
+    uint64_t *c = cs->limb;
+    __uint128_t accum0 = 0, accum4 = 0;
+    uint64_t mask = (1ULL << 56) - 1;
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        accum0 += widemul(b, a[i]);
+        accum4 += widemul(b, a[i + 4]);
+        c[i] = accum0 & mask;
+        accum0 >>= 56;
+        c[i + 4] = accum4 & mask;
+        accum4 >>= 56;
+    }
+
+    accum0 += accum4 + c[4];
+    c[4] = ((uint64_t)accum0) & mask;
+    c[5] += (uint64_t)(accum0 >> 56);
+
+    accum4 += c[0];
+    c[0] = ((uint64_t)accum4) & mask;
+    c[1] += (uint64_t)(accum4 >> 56);
+}
+
+/*
+ * The same reduction as gf_mul(), but with each half-size square taking ten
+ * products instead of sixteen.
+ */
+void gf_sqr(gf_s * RESTRICT cs, const gf as)
+{
+    const uint64_t *a = as->limb;
+    uint64_t *c = cs->limb;
+    __uint128_t lo[7], hi[7], accum0, accum1;
+    uint64_t mask = (1ULL << 56) - 1;
+    uint64_t aa[4], d[8], dd[4];
+    int i, j;
+
+    for (i = 0; i < 4; i++) {
+        aa[i] = a[i] + a[i + 4];
+        dd[i] = aa[i] << 1;
+    }
+    for (i = 0; i < 8; i++)
+        d[i] = a[i] << 1;
+
+    /* lo = a0^2 + a1^2, hi = (a0 + a1)^2 - a0^2, column by column */
+    for (j = 0; j < 7; j++) {
+        __uint128_t s0 = 0, s1 = 0, s2 = 0;
+
+        for (i = j < 4 ? 0 : j - 3; 2 * i < j; i++) {
+            s0 += widemul(d[i], a[j - i]);
+            s1 += widemul(d[i + 4], a[j - i + 4]);
+            s2 += widemul(dd[i], aa[j - i]);
+        }
+        if ((j & 1) == 0) {
+            s0 += widemul(a[j / 2], a[j / 2]);
+            s1 += widemul(a[j / 2 + 4], a[j / 2 + 4]);
+            s2 += widemul(aa[j / 2], aa[j / 2]);
+        }
+        lo[j] = s0 + s1;
+        hi[j] = s2 - s0;
+    }
+
+    /* Fold the columns at phi and above: phi^2 = phi + 1 */
+    accum0 = 0;
+    accum1 = 0;
+    for (j = 0; j < 4; j++) {
+        accum0 += lo[j];
+        accum1 += hi[j];
+        if (j < 3) {
+            accum0 += hi[j + 4];
+            accum1 += lo[j + 4] + hi[j + 4];
+        }
+        c[j] = ((uint64_t)accum0) & mask;
+        c[j + 4] = ((uint64_t)accum1) & mask;
+        accum0 >>= 56;
+        accum1 >>= 56;
+    }
+
+    accum0 += accum1;
+    accum0 += c[4];
+    accum1 += c[0];
+    c[4] = ((uint64_t)(accum0)) & mask;
+    c[0] = ((uint64_t)(accum1)) & mask;
+
+    accum0 >>= 56;
+    accum1 >>= 56;
+    c[5] += ((uint64_t)(accum0));
+    c[1] += ((uint64_t)(accum1));
+}
+
+#else
+NON_EMPTY_TRANSLATION_UNIT
+#endif
@@ -93,6 +93,7 @@ void EC_KEY_free(EC_KEY *r)
 #endif
     CRYPTO_THREAD_lock_free(r->lock);
     EC_GROUP_free(r->group);
+    EC_GROUP_free(r->verify_precomp);
     EC_POINT_free(r->pub_key);
     BN_clear_free(r->priv_key);
     OPENSSL_free(r->propq);
@@ -159,6 +160,7 @@ EC_KEY *EC_KEY_copy(EC_KEY *dest, const EC_KEY *src)
     dest->conv_form = src->conv_form;
     dest->version = src->version;
     dest->flags = src->flags;
+    dest->verify_precomp_threshold = src->verify_precomp_threshold;
 #ifndef FIPS_MODULE
     if (!CRYPTO_dup_ex_data(CRYPTO_EX_INDEX_EC_KEY,
                             &dest->ex_data, &src->ex_data))
@@ -677,6 +679,123 @@ void ossl_ec_key_set0_libctx(EC_KEY *key, OSSL_LIB_CTX *libctx)
     /* Do we need to propagate this to the group? */
 }
 
+int ossl_ec_key_set_verify_precomp_threshold(EC_KEY *key, int threshold)
+{
+    if (threshold < 0) {
+        ERR_raise(ERR_LIB_EC, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+    key->verify_precomp_threshold = threshold;
+    return 1;
+}
+
+/*
+ * Returns a copy of the key's group that has the public key as generator,
+ * with the multiples of it precomputed, or NULL if the group method has no
+ * precomputation to offer.  The generic wNAF code is left out: it already
+ * interleaves both scalars, and would do single scalar multiplications with
+ * the ladder regardless of any table.
+ */
+static EC_GROUP *ec_key_verify_precomp_new(const EC_KEY *key, BN_CTX *ctx)
+{
+    const EC_METHOD *meth = key->group->meth;
+    EC_GROUP *group;
+
+    if (meth->mul == NULL || meth->precompute_mult == NULL)
+        return NULL;
+
+    group = EC_GROUP_dup(key->group);
+    if (group == NULL
+        || !EC_GROUP_set_generator(group, key->pub_key,
+                                   key->group->order, key->group->cofactor))
+        goto err;
+    if (!meth->precompute_mult(group, ctx))
+        goto err;
+    return group;
+
+ err:
+    EC_GROUP_free(group);
+    return NULL;
+}
+
+/*
+ * (Re)builds the public key table if it is missing or stale.  Failure is not
+ * an error, the caller simply falls back to the variable base multiplication.
+ */
+static void ec_key_verify_precomp_update(EC_KEY *key, BN_CTX *ctx)
+{
+    if (!CRYPTO_THREAD_write_lock(key->lock))
+        return;
+    if (key->verify_precomp_dirty_cnt != key->dirty_cnt + 1) {
+        EC_GROUP_free(key->verify_precomp);
+        ERR_set_mark();
+        key->verify_precomp = ec_key_verify_precomp_new(key, ctx);
+        ERR_pop_to_mark();
+        key->verify_precomp_dirty_cnt = key->dirty_cnt + 1;
+    }
+    CRYPTO_THREAD_unlock(key->lock);
+}
+
+/*
+ * Computes r = g_scalar * G + p_scalar * pub_key using the public key table.
+ * Returns -1 if there is no up to date table, with |*built| set if building
+ * one has already been attempted for the current key material.
+ */
+static int ec_key_verify_precomp_mul(EC_KEY *key, EC_POINT *r,
+                                     const BIGNUM *g_scalar,
+                                     const BIGNUM *p_scalar, BN_CTX *ctx,
+                                     int *built)
+{
+    const EC_GROUP *group = key->group;
+    EC_POINT *tmp = NULL;
+    int ret = -1;
+
+    *built = 0;
+    if (!CRYPTO_THREAD_read_lock(key->lock))
+        return -1;
+    if (key->verify_precomp_dirty_cnt == key->dirty_cnt + 1) {
+        *built = 1;
+        if (key->verify_precomp != NULL)
+            ret = (tmp = EC_POINT_new(group)) != NULL
+                  && EC_POINT_mul(key->verify_precomp, tmp, p_scalar,
+                                  NULL, NULL, ctx)
+                  && EC_POINT_mul(group, r, g_scalar, NULL, NULL, ctx)
+                  && EC_POINT_add(group, r, r, tmp, ctx);
+    }
+    CRYPTO_THREAD_unlock(key->lock);
+    EC_POINT_free(tmp);
+    return ret;
+}
+
+/*
+ * Computes r = g_scalar * G + p_scalar * pub_key, as needed for signature
+ * verification.  Keys that have a verification precompute threshold build
+ * a table for the public key once they have been used that many times, so
+ * that both halves become fixed base multiplications.
+ */
+int ossl_ec_key_verify_mul(EC_KEY *key, EC_POINT *r, const BIGNUM *g_scalar,
+                           const BIGNUM *p_scalar, BN_CTX *ctx)
+{
+    int ret, built, count;
+
+    if (key->verify_precomp_threshold <= 0)
+        return EC_POINT_mul(key->group, r, g_scalar, key->pub_key, p_scalar,
+                            ctx);
+
+    ret = ec_key_verify_precomp_mul(key, r, g_scalar, p_scalar, ctx, &built);
+    if (ret < 0 && !built
+        && CRYPTO_atomic_add(&key->verify_count, 1, &count, key->lock)
+        && count >= key->verify_precomp_threshold) {
+        ec_key_verify_precomp_update(key, ctx);
+        ret = ec_key_verify_precomp_mul(key, r, g_scalar, p_scalar, ctx,
+                                        &built);
+    }
+    if (ret < 0)
+        ret = EC_POINT_mul(key->group, r, g_scalar, key->pub_key, p_scalar,
+                           ctx);
+    return ret;
+}
+
 const EC_GROUP *EC_KEY_get0_group(const EC_KEY *key)
 {
     return key->group;
@@ -18,6 +18,7 @@
 #include <limits.h>
 
 #include "internal/cryptlib.h"
+#include "crypto/bn.h"
 
 #include <openssl/err.h>
 #include <openssl/bn.h>
@@ -58,7 +59,7 @@ int ossl_ecdh_simple_compute_key(unsigned char **pout, size_t *poutlen,
     size_t buflen, len;
     unsigned char *buf = NULL;
 
-    if ((ctx = BN_CTX_new_ex(ecdh->libctx)) == NULL)
+    if ((ctx = ossl_bn_ctx_acquire(ecdh->libctx, 0)) == NULL)
         goto err;
     BN_CTX_start(ctx);
     x = BN_CTX_get(ctx);
@@ -140,7 +141,7 @@ int ossl_ecdh_simple_compute_key(unsigned char **pout, size_t *poutlen,
     BN_clear(x);
     EC_POINT_clear_free(tmp);
     BN_CTX_end(ctx);
-    BN_CTX_free(ctx);
+    ossl_bn_ctx_release(ctx);
     OPENSSL_free(buf);
     return ret;
 }
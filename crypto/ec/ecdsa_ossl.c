@@ -99,7 +99,7 @@ static int ecdsa_sign_setup(EC_KEY *eckey, BN_CTX *ctx_in,
     }
 
     if ((ctx = ctx_in) == NULL) {
-        if ((ctx = BN_CTX_new_ex(eckey->libctx)) == NULL) {
+        if ((ctx = ossl_bn_ctx_acquire(eckey->libctx, 0)) == NULL) {
             ERR_raise(ERR_LIB_EC, ERR_R_MALLOC_FAILURE);
             return 0;
         }
@@ -178,7 +178,7 @@ static int ecdsa_sign_setup(EC_KEY *eckey, BN_CTX *ctx_in,
         BN_clear_free(r);
     }
     if (ctx != ctx_in)
-        BN_CTX_free(ctx);
+        ossl_bn_ctx_release(ctx);
     EC_POINT_free(tmp_point);
     BN_clear_free(X);
     return ret;
@@ -232,7 +232,7 @@ ECDSA_SIG *ossl_ecdsa_simple_sign_sig(const unsigned char *dgst, int dgst_len,
     }
     s = ret->s;
 
-    if ((ctx = BN_CTX_new_ex(eckey->libctx)) == NULL
+    if ((ctx = ossl_bn_ctx_acquire(eckey->libctx, 0)) == NULL
         || (m = BN_new()) == NULL) {
         ERR_raise(ERR_LIB_EC, ERR_R_MALLOC_FAILURE);
         goto err;
@@ -316,7 +316,7 @@ ECDSA_SIG *ossl_ecdsa_simple_sign_sig(const unsigned char *dgst, int dgst_len,
         ECDSA_SIG_free(ret);
         ret = NULL;
     }
-    BN_CTX_free(ctx);
+    ossl_bn_ctx_release(ctx);
     BN_clear_free(m);
     BN_clear_free(kinv);
     return ret;
@@ -376,7 +376,7 @@ int ossl_ecdsa_simple_verify_sig(const unsigned char *dgst, int dgst_len,
         return -1;
     }
 
-    ctx = BN_CTX_new_ex(eckey->libctx);
+    ctx = ossl_bn_ctx_acquire(eckey->libctx, 0);
     if (ctx == NULL) {
         ERR_raise(ERR_LIB_EC, ERR_R_MALLOC_FAILURE);
         return -1;
@@ -440,7 +440,7 @@ int ossl_ecdsa_simple_verify_sig(const unsigned char *dgst, int dgst_len,
         ERR_raise(ERR_LIB_EC, ERR_R_MALLOC_FAILURE);
         goto err;
     }
-    if (!EC_POINT_mul(group, point, u1, pub_key, u2, ctx)) {
+    if (!ossl_ec_key_verify_mul(eckey, point, u1, u2, ctx)) {
         ERR_raise(ERR_LIB_EC, ERR_R_EC_LIB);
         goto err;
     }
@@ -458,7 +458,7 @@ int ossl_ecdsa_simple_verify_sig(const unsigned char *dgst, int dgst_len,
     ret = (BN_ucmp(u1, sig->r) == 0);
  err:
     BN_CTX_end(ctx);
-    BN_CTX_free(ctx);
+    ossl_bn_ctx_release(ctx);
     EC_POINT_free(point);
     return ret;
 }
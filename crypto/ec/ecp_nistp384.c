@@ -0,0 +1,1628 @@
+/*
+ * Copyright 2021 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * ECDSA low level APIs are deprecated for public use, but still ok for
+ * internal use.
+ */
+#include "internal/deprecated.h"
+
+/*
+ * A 64-bit implementation of the NIST P-384 elliptic curve point
+ * multiplication.
+ *
+ * The group arithmetic, the precomputation tables and the OpenSSL
+ * integration follow ecp_nistp521.c and ecp_nistp256.c.  The field arithmetic
+ * is different: P-384 has no convenient unsaturated representation, so field
+ * elements are kept fully reduced in Montgomery form in six saturated 64-bit
+ * limbs.
+ */
+
+#include <openssl/e_os2.h>
+
+#include <string.h>
+#include <openssl/err.h>
+#include "ec_local.h"
+
+#if defined(__SIZEOF_INT128__) && __SIZEOF_INT128__==16
+  /* even with gcc, the typedef won't work for 32-bit platforms */
+typedef __uint128_t uint128_t;  /* nonstandard; implemented by gcc on 64-bit
+                                 * platforms */
+typedef __int128_t int128_t;
+#else
+# error "Your compiler doesn't appear to support 128-bit integer types"
+#endif
+
+typedef uint8_t u8;
+typedef uint64_t u64;
+
+/*
+ * The underlying field. P384 operates over GF(2^384-2^128-2^96+2^32-1). We
+ * can serialize an element of this field into 48 bytes. We call this an
+ * felem_bytearray.
+ */
+
+typedef u8 felem_bytearray[48];
+
+/*
+ * These are the parameters of P384, taken from FIPS 186-3, section D.1.2.4.
+ * These values are big-endian.
+ */
+static const felem_bytearray nistp384_curve_params[5] = {
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, /* p */
+     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+     0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, /* a = -3 */
+     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+     0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xfc},
+    {0xb3, 0x31, 0x2f, 0xa7, 0xe2, 0x3e, 0xe7, 0xe4, /* b */
+     0x98, 0x8e, 0x05, 0x6b, 0xe3, 0xf8, 0x2d, 0x19,
+     0x18, 0x1d, 0x9c, 0x6e, 0xfe, 0x81, 0x41, 0x12,
+     0x03, 0x14, 0x08, 0x8f, 0x50, 0x13, 0x87, 0x5a,
+     0xc6, 0x56, 0x39, 0x8d, 0x8a, 0x2e, 0xd1, 0x9d,
+     0x2a, 0x85, 0xc8, 0xed, 0xd3, 0xec, 0x2a, 0xef},
+    {0xaa, 0x87, 0xca, 0x22, 0xbe, 0x8b, 0x05, 0x37, /* x */
+     0x8e, 0xb1, 0xc7, 0x1e, 0xf3, 0x20, 0xad, 0x74,
+     0x6e, 0x1d, 0x3b, 0x62, 0x8b, 0xa7, 0x9b, 0x98,
+     0x59, 0xf7, 0x41, 0xe0, 0x82, 0x54, 0x2a, 0x38,
+     0x55, 0x02, 0xf2, 0x5d, 0xbf, 0x55, 0x29, 0x6c,
+     0x3a, 0x54, 0x5e, 0x38, 0x72, 0x76, 0x0a, 0xb7},
+    {0x36, 0x17, 0xde, 0x4a, 0x96, 0x26, 0x2c, 0x6f, /* y */
+     0x5d, 0x9e, 0x98, 0xbf, 0x92, 0x92, 0xdc, 0x29,
+     0xf8, 0xf4, 0x1d, 0xbd, 0x28, 0x9a, 0x14, 0x7c,
+     0xe9, 0xda, 0x31, 0x13, 0xb5, 0xf0, 0xb8, 0xc0,
+     0x0a, 0x60, 0xb1, 0xce, 0x1d, 0x7e, 0x81, 0x9d,
+     0x7a, 0x43, 0x1d, 0x7c, 0x90, 0xea, 0x0e, 0x5f}
+};
+
+/*-
+ * The representation of field elements.
+ * ------------------------------------
+ *
+ * We represent field elements with six 64-bit values, least significant
+ * first.  An element x is stored in Montgomery form as x*2^384 mod p, and is
+ * always fully reduced, i.e. less than p.  This makes every field element
+ * representation unique, so that no contraction step is needed before
+ * comparing or serializing, at the cost of a conditional subtraction after
+ * every addition and multiplication.
+ */
+
+#define NLIMBS 6
+
+typedef uint64_t limb;
+typedef limb felem[NLIMBS];
+
+/* p, least significant limb first */
+static const felem kPrime = {
+    0x00000000ffffffff, 0xffffffff00000000, 0xfffffffffffffffe,
+    0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff
+};
+
+/* -p^-1 mod 2^64 */
+static const limb kPrimeN0 = 0x0000000100000001;
+
+/* 2^384 mod p, i.e. one in Montgomery form */
+static const felem kOne = {
+    0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000
+};
+
+/* 2^768 mod p, used to convert into Montgomery form */
+static const felem kRR = {
+    0xfffffffe00000001, 0x0000000200000000, 0xfffffffe00000000,
+    0x0000000200000000, 0x0000000000000001, 0x0000000000000000
+};
+
+/* bin48_to_felem takes a little-endian byte array and converts it into limbs */
+static void bin48_to_felem(felem out, const u8 in[48])
+{
+    int i, j;
+
+    for (i = 0; i < NLIMBS; i++) {
+        out[i] = 0;
+        for (j = 7; j >= 0; j--)
+            out[i] = (out[i] << 8) | in[8 * i + j];
+    }
+}
+
+/* felem_to_bin48 serializes limbs into a little-endian, 48 byte array */
+static void felem_to_bin48(u8 out[48], const felem in)
+{
+    int i, j;
+
+    for (i = 0; i < NLIMBS; i++)
+        for (j = 0; j < 8; j++)
+            out[8 * i + j] = (u8)(in[i] >> (8 * j));
+}
+
+/*-
+ * Field operations
+ * ----------------
+ */
+
+static void felem_one(felem out)
+{
+    memcpy(out, kOne, sizeof(felem));
+}
+
+static void felem_assign(felem out, const felem in)
+{
+    out[0] = in[0];
+    out[1] = in[1];
+    out[2] = in[2];
+    out[3] = in[3];
+    out[4] = in[4];
+    out[5] = in[5];
+}
+
+/*
+ * felem_reduce_once sets out = in - p if (top, in) >= p and out = in
+ * otherwise, for (top, in) < 2p, in constant time.
+ */
+static void felem_reduce_once(felem out, const felem in, limb top)
+{
+    felem tmp;
+    limb borrow = 0, mask;
+    uint128_t diff;
+    unsigned i;
+
+    for (i = 0; i < NLIMBS; i++) {
+        diff = (uint128_t)in[i] - kPrime[i] - borrow;
+        tmp[i] = (limb)diff;
+        borrow = (limb)(diff >> 64) & 1;
+    }
+    /* the subtraction underflowed iff |top| is zero and there was a borrow */
+    mask = 0 - (borrow & ~top & 1);
+    for (i = 0; i < NLIMBS; i++)
+        out[i] = (in[i] & mask) | (tmp[i] & ~mask);
+}
+
+/* felem_add sets out = in1 + in2 */
+static void felem_add(felem out, const felem in1, const felem in2)
+{
+    felem tmp;
+    limb carry = 0;
+    uint128_t sum;
+    unsigned i;
+
+    for (i = 0; i < NLIMBS; i++) {
+        sum = (uint128_t)in1[i] + in2[i] + carry;
+        tmp[i] = (limb)sum;
+        carry = (limb)(sum >> 64);
+    }
+    felem_reduce_once(out, tmp, carry);
+}
+
+/* felem_sub sets out = in1 - in2 */
+static void felem_sub(felem out, const felem in1, const felem in2)
+{
+    limb borrow = 0, carry = 0, mask;
+    uint128_t diff, sum;
+    unsigned i;
+
+    for (i = 0; i < NLIMBS; i++) {
+        diff = (uint128_t)in1[i] - in2[i] - borrow;
+        out[i] = (limb)diff;
+        borrow = (limb)(diff >> 64) & 1;
+    }
+    /* add p back if the subtraction underflowed */
+    mask = 0 - borrow;
+    for (i = 0; i < NLIMBS; i++) {
+        sum = (uint128_t)out[i] + (kPrime[i] & mask) + carry;
+        out[i] = (limb)sum;
+        carry = (limb)(sum >> 64);
+    }
+}
+
+/* felem_neg sets out = -in */
+static void felem_neg(felem out, const felem in)
+{
+    static const felem zero = { 0 };
+
+    felem_sub(out, zero, in);
+}
+
+/*-
+ * felem_reduce sets out = in * 2^-384 mod p, for a 768-bit |in| less than
+ * p * 2^384, by word-by-word Montgomery reduction.
+ *
+ * Each step adds m * p to clear the lowest remaining limb.  Since
+ *   p = 2^384 - (2^128 + 2^96 - 2^32 + 1)
+ * this is m * 2^384 less a 193-bit multiple of m, which costs two
+ * multiplications rather than six.  Limbs are accumulated in signed 128-bit
+ * values so that borrows can be propagated lazily.
+ *
+ * On exit:
+ *   out < p
+ */
+static void felem_reduce(felem out, const limb in[2 * NLIMBS])
+{
+    int128_t acc[2 * NLIMBS];
+    uint128_t prod;
+    felem tmp;
+    limb m;
+    unsigned i;
+
+    for (i = 0; i < 2 * NLIMBS; i++)
+        acc[i] = in[i];
+
+    for (i = 0; i < NLIMBS; i++) {
+        m = (limb)acc[i] * kPrimeN0;
+        /* subtract m * (2^128 + 2^96 - 2^32 + 1) */
+        prod = (uint128_t)m * 0xffffffff00000001;
+        acc[i] -= (limb)prod;
+        acc[i + 1] -= (limb)(prod >> 64);
+        acc[i + 1] -= (int128_t)((uint128_t)m * 0xffffffff);
+        acc[i + 2] -= m;
+        /* add m * 2^384 */
+        acc[i + NLIMBS] += m;
+        /* the low 64 bits of acc[i] are now zero */
+        acc[i + 1] += acc[i] >> 64;
+    }
+
+    for (i = NLIMBS; i < 2 * NLIMBS - 1; i++) {
+        tmp[i - NLIMBS] = (limb)acc[i];
+        acc[i + 1] += acc[i] >> 64;
+    }
+    tmp[NLIMBS - 1] = (limb)acc[2 * NLIMBS - 1];
+    /* the result is less than 2p */
+    felem_reduce_once(out, tmp, (limb)(acc[2 * NLIMBS - 1] >> 64));
+}
+
+/*-
+ * felem_mul sets out = in1 * in2 * 2^-384 mod p
+ * On entry:
+ *   in1 < p, in2 < p (or in1 < 2^384, in2 < p)
+ * On exit:
+ *   out < p
+ */
+static void felem_mul(felem out, const felem in1, const felem in2)
+{
+    limb t[2 * NLIMBS], carry;
+    uint128_t acc;
+    unsigned i, j;
+
+    carry = 0;
+    for (j = 0; j < NLIMBS; j++) {
+        acc = (uint128_t)in1[j] * in2[0] + carry;
+        t[j] = (limb)acc;
+        carry = (limb)(acc >> 64);
+    }
+    t[NLIMBS] = carry;
+    for (i = 1; i < NLIMBS; i++) {
+        carry = 0;
+        for (j = 0; j < NLIMBS; j++) {
+            acc = (uint128_t)in1[j] * in2[i] + t[i + j] + carry;
+            t[i + j] = (limb)acc;
+            carry = (limb)(acc >> 64);
+        }
+        t[i + NLIMBS] = carry;
+    }
+    felem_reduce(out, t);
+}
+
+/*-
+ * felem_square sets out = in * in * 2^-384 mod p
+ * On entry:
+ *   in < p
+ * On exit:
+ *   out < p
+ */
+static void felem_square(felem out, const felem in)
+{
+    limb t[2 * NLIMBS], carry, top;
+    uint128_t acc, sq;
+    unsigned i, j;
+
+    /* the products in[i] * in[j] for i < j */
+    memset(t, 0, sizeof(t));
+    for (i = 0; i < NLIMBS - 1; i++) {
+        carry = 0;
+        for (j = i + 1; j < NLIMBS; j++) {
+            acc = (uint128_t)in[i] * in[j] + t[i + j] + carry;
+            t[i + j] = (limb)acc;
+            carry = (limb)(acc >> 64);
+        }
+        t[i + NLIMBS] = carry;
+    }
+
+    /* double them and add the squares in[i]^2 */
+    top = 0;
+    carry = 0;
+    for (i = 0; i < NLIMBS; i++) {
+        sq = (uint128_t)in[i] * in[i];
+        acc = (uint128_t)((t[2 * i] << 1) | top) + (limb)sq + carry;
+        top = t[2 * i] >> 63;
+        t[2 * i] = (limb)acc;
+        acc = (uint128_t)((t[2 * i + 1] << 1) | top) + (limb)(sq >> 64)
+              + (limb)(acc >> 64);
+        top = t[2 * i + 1] >> 63;
+        t[2 * i + 1] = (limb)acc;
+        carry = (limb)(acc >> 64);
+    }
+    felem_reduce(out, t);
+}
+
+/* felem_sqr_n sets out = in^(2^n) */
+static void felem_sqr_n(felem out, const felem in, unsigned n)
+{
+    felem_square(out, in);
+    while (--n > 0)
+        felem_square(out, out);
+}
+
+/*-
+ * felem_inv calculates |out| = |in|^{-1}
+ *
+ * Based on Fermat's Little Theorem:
+ *   a^p = a (mod p)
+ *   a^{p-1} = 1 (mod p)
+ *   a^{p-2} = a^{-1} (mod p)
+ *
+ * p-2 is, from the top, 255 ones, a zero, 32 ones, 64 zeros, 30 ones, a
+ * zero and a one, so the chain below builds up runs of ones x_n = in^(2^n-1).
+ */
+static void felem_inv(felem out, const felem in)
+{
+    felem x2, x3, x6, x12, x15, x30, x32, x60, x120, ftmp;
+
+    felem_square(ftmp, in);
+    felem_mul(x2, ftmp, in);            /* 2^2 - 1 */
+    felem_square(ftmp, x2);
+    felem_mul(x3, ftmp, in);            /* 2^3 - 1 */
+    felem_sqr_n(ftmp, x3, 3);
+    felem_mul(x6, ftmp, x3);            /* 2^6 - 1 */
+    felem_sqr_n(ftmp, x6, 6);
+    felem_mul(x12, ftmp, x6);           /* 2^12 - 1 */
+    felem_sqr_n(ftmp, x12, 3);
+    felem_mul(x15, ftmp, x3);           /* 2^15 - 1 */
+    felem_sqr_n(ftmp, x15, 15);
+    felem_mul(x30, ftmp, x15);          /* 2^30 - 1 */
+    felem_sqr_n(ftmp, x30, 2);
+    felem_mul(x32, ftmp, x2);           /* 2^32 - 1 */
+    felem_sqr_n(ftmp, x30, 30);
+    felem_mul(x60, ftmp, x30);          /* 2^60 - 1 */
+    felem_sqr_n(ftmp, x60, 60);
+    felem_mul(x120, ftmp, x60);         /* 2^120 - 1 */
+    felem_sqr_n(ftmp, x120, 120);
+    felem_mul(ftmp, ftmp, x120);        /* 2^240 - 1 */
+    felem_sqr_n(ftmp, ftmp, 15);
+    felem_mul(ftmp, ftmp, x15);         /* 2^255 - 1 */
+    felem_sqr_n(ftmp, ftmp, 33);
+    felem_mul(ftmp, ftmp, x32);         /* 2^288 - 2^32 - 1 */
+    felem_sqr_n(ftmp, ftmp, 94);
+    felem_mul(ftmp, ftmp, x30);         /* 2^382 - 2^126 - 2^94 + 2^30 - 1 */
+    felem_sqr_n(ftmp, ftmp, 2);
+    felem_mul(out, ftmp, in);           /* 2^384 - 2^128 - 2^96 + 2^32 - 3 */
+}
+
+/*
+ * felem_is_zero returns a limb with all bits set if |in| == 0 (mod p) and 0
+ * otherwise.  Field elements are fully reduced, so zero has a single
+ * representation.
+ */
+static limb felem_is_zero(const felem in)
+{
+    limb is_zero = in[0] | in[1] | in[2] | in[3] | in[4] | in[5];
+
+    is_zero = ((is_zero >> 1) | (is_zero & 1)) - 1;
+    return 0 - (is_zero >> 63);
+}
+
+static int felem_is_zero_int(const void *in)
+{
+    return (int)(felem_is_zero(in) & ((limb) 1));
+}
+
+/* BN_to_felem converts an OpenSSL BIGNUM into Montgomery form */
+static int BN_to_felem(felem out, const BIGNUM *bn)
+{
+    felem_bytearray b_out;
+    felem tmp;
+    int num_bytes;
+
+    if (BN_is_negative(bn)) {
+        ERR_raise(ERR_LIB_EC, EC_R_BIGNUM_OUT_OF_RANGE);
+        return 0;
+    }
+    num_bytes = BN_bn2lebinpad(bn, b_out, sizeof(b_out));
+    if (num_bytes < 0) {
+        ERR_raise(ERR_LIB_EC, EC_R_BIGNUM_OUT_OF_RANGE);
+        return 0;
+    }
+    bin48_to_felem(tmp, b_out);
+    /* any input below 2^384 comes out fully reduced */
+    felem_mul(out, tmp, kRR);
+    return 1;
+}
+
+/* felem_to_BN converts an felem out of Montgomery form into an OpenSSL BIGNUM */
+static BIGNUM *felem_to_BN(BIGNUM *out, const felem in)
+{
+    static const felem one = { 1 };
+    felem_bytearray b_out;
+    felem tmp;
+
+    felem_mul(tmp, in, one);
+    felem_to_bin48(b_out, tmp);
+    return BN_lebin2bn(b_out, sizeof(b_out), out);
+}
+
+/*-
+ * Group operations
+ * ----------------
+ *
+ * Building on top of the field operations we have the operations on the
+ * elliptic curve group itself. Points on the curve are represented in Jacobian
+ * coordinates */
+
+/*-
+ * point_double calculates 2*(x_in, y_in, z_in)
+ *
+ * The method is taken from:
+ *   http://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian-3.html#doubling-dbl-2001-b
+ *
+ * Outputs can equal corresponding inputs, i.e., x_out == x_in is allowed.
+ * while x_out == y_in is not (maybe this works, but it's not tested). */
+static void
+point_double(felem x_out, felem y_out, felem z_out,
+             const felem x_in, const felem y_in, const felem z_in)
+{
+    felem delta, gamma, beta, alpha, ftmp, ftmp2;
+
+    /* delta = z^2 */
+    felem_square(delta, z_in);
+
+    /* gamma = y^2 */
+    felem_square(gamma, y_in);
+
+    /* beta = x*gamma */
+    felem_mul(beta, x_in, gamma);
+
+    /* alpha = 3*(x-delta)*(x+delta) */
+    felem_sub(ftmp, x_in, delta);
+    felem_add(ftmp2, x_in, delta);
+    felem_add(alpha, ftmp2, ftmp2);
+    felem_add(ftmp2, alpha, ftmp2);
+    felem_mul(alpha, ftmp, ftmp2);
+
+    /* z' = (y + z)^2 - gamma - delta */
+    felem_add(ftmp, y_in, z_in);
+    felem_square(ftmp, ftmp);
+    felem_sub(ftmp, ftmp, gamma);
+    felem_sub(z_out, ftmp, delta);
+
+    /* x' = alpha^2 - 8*beta */
+    felem_add(beta, beta, beta);
+    felem_add(beta, beta, beta);
+    /* beta is now 4*beta */
+    felem_add(ftmp, beta, beta);
+    felem_square(ftmp2, alpha);
+    felem_sub(x_out, ftmp2, ftmp);
+
+    /* y' = alpha*(4*beta - x') - 8*gamma^2 */
+    felem_sub(beta, beta, x_out);
+    felem_mul(ftmp, alpha, beta);
+    felem_square(ftmp2, gamma);
+    felem_add(ftmp2, ftmp2, ftmp2);
+    felem_add(ftmp2, ftmp2, ftmp2);
+    felem_add(ftmp2, ftmp2, ftmp2);
+    felem_sub(y_out, ftmp, ftmp2);
+}
+
+/* copy_conditional copies in to out iff mask is all ones. */
+static void copy_conditional(felem out, const felem in, limb mask)
+{
+    unsigned i;
+    for (i = 0; i < NLIMBS; ++i) {
+        const limb tmp = mask & (in[i] ^ out[i]);
+        out[i] ^= tmp;
+    }
+}
+
+/*-
+ * point_add calculates (x1, y1, z1) + (x2, y2, z2)
+ *
+ * The method is taken from
+ *   http://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian-3.html#addition-add-2007-bl,
+ * adapted for mixed addition (z2 = 1, or z2 = 0 for the point at infinity).
+ *
+ * This function includes a branch for checking whether the two input points
+ * are equal (while not equal to the point at infinity). See comment below
+ * on constant-time.
+ */
+static void point_add(felem x3, felem y3, felem z3,
+                      const felem x1, const felem y1, const felem z1,
+                      const int mixed, const felem x2, const felem y2,
+                      const felem z2)
+{
+    felem ftmp, ftmp2, ftmp3, ftmp4, ftmp5, ftmp6, x_out, y_out, z_out;
+    limb x_equal, y_equal, z1_is_zero, z2_is_zero;
+    limb points_equal;
+
+    z1_is_zero = felem_is_zero(z1);
+    z2_is_zero = felem_is_zero(z2);
+
+    /* ftmp = z1z1 = z1**2 */
+    felem_square(ftmp, z1);
+
+    if (!mixed) {
+        /* ftmp2 = z2z2 = z2**2 */
+        felem_square(ftmp2, z2);
+
+        /* u1 = ftmp3 = x1*z2z2 */
+        felem_mul(ftmp3, x1, ftmp2);
+
+        /* ftmp5 = (z1 + z2)**2 - z1z1 - z2z2 = 2*z1z2 */
+        felem_add(ftmp5, z1, z2);
+        felem_square(ftmp5, ftmp5);
+        felem_sub(ftmp5, ftmp5, ftmp);
+        felem_sub(ftmp5, ftmp5, ftmp2);
+
+        /* ftmp2 = z2 * z2z2 */
+        felem_mul(ftmp2, ftmp2, z2);
+
+        /* s1 = ftmp6 = y1 * z2**3 */
+        felem_mul(ftmp6, y1, ftmp2);
+    } else {
+        /*
+         * We'll assume z2 = 1 (special case z2 = 0 is handled later)
+         */
+
+        /* u1 = ftmp3 = x1*z2z2 */
+        felem_assign(ftmp3, x1);
+
+        /* ftmp5 = 2*z1z2 */
+        felem_add(ftmp5, z1, z1);
+
+        /* s1 = ftmp6 = y1 * z2**3 */
+        felem_assign(ftmp6, y1);
+    }
+
+    /* u2 = x2*z1z1 */
+    felem_mul(ftmp2, x2, ftmp);
+
+    /* h = ftmp4 = u2 - u1 */
+    felem_sub(ftmp4, ftmp2, ftmp3);
+
+    x_equal = felem_is_zero(ftmp4);
+
+    /* z_out = ftmp5 * h */
+    felem_mul(z_out, ftmp5, ftmp4);
+
+    /* ftmp = z1 * z1z1 */
+    felem_mul(ftmp, ftmp, z1);
+
+    /* s2 = ftmp2 = y2 * z1**3 */
+    felem_mul(ftmp2, y2, ftmp);
+
+    /* r = ftmp5 = (s2 - s1)*2 */
+    felem_sub(ftmp5, ftmp2, ftmp6);
+    y_equal = felem_is_zero(ftmp5);
+    felem_add(ftmp5, ftmp5, ftmp5);
+
+    /*
+     * The formulae are incorrect if the points are equal, in affine coordinates
+     * (X_1, Y_1) == (X_2, Y_2), so we check for this and do doubling if this
+     * happens.
+     *
+     * We use bitwise operations to avoid potential side-channels introduced by
+     * the short-circuiting behaviour of boolean operators.
+     *
+     * The special case of either point being the point at infinity (z1 and/or
+     * z2 are zero), is handled separately later on in this function, so we
+     * avoid jumping to point_double here in those special cases.
+     *
+     * Notice the comment below on the implications of this branching for timing
+     * leaks and why it is considered practically irrelevant.
+     */
+    points_equal = (x_equal & y_equal & (~z1_is_zero) & (~z2_is_zero));
+
+    if (points_equal) {
+        /*
+         * This is obviously not constant-time but it will almost-never happen
+         * for ECDH / ECDSA. The case where it can happen is during scalar-mult
+         * where the intermediate value gets very close to the group order.
+         * Since |ossl_ec_GFp_nistp_recode_scalar_bits| produces signed digits
+         * for the scalar, it's possible for the intermediate value to be a small
+         * negative multiple of the base point, and for the final signed digit
+         * to be the same value. As in ecp_nistp521.c, this only happens for a
+         * single scalar, so the timing leak is irrelevant.
+         */
+        point_double(x3, y3, z3, x1, y1, z1);
+        return;
+    }
+
+    /* I = ftmp = (2h)**2 */
+    felem_add(ftmp, ftmp4, ftmp4);
+    felem_square(ftmp, ftmp);
+
+    /* J = ftmp2 = h * I */
+    felem_mul(ftmp2, ftmp4, ftmp);
+
+    /* V = ftmp4 = U1 * I */
+    felem_mul(ftmp4, ftmp3, ftmp);
+
+    /* x_out = r**2 - J - 2V */
+    felem_square(x_out, ftmp5);
+    felem_sub(x_out, x_out, ftmp2);
+    felem_add(ftmp3, ftmp4, ftmp4);
+    felem_sub(x_out, x_out, ftmp3);
+
+    /* y_out = r(V-x_out) - 2 * s1 * J */
+    felem_sub(ftmp4, ftmp4, x_out);
+    felem_mul(y_out, ftmp5, ftmp4);
+    felem_mul(ftmp, ftmp6, ftmp2);
+    felem_add(ftmp, ftmp, ftmp);
+    felem_sub(y_out, y_out, ftmp);
+
+    copy_conditional(x_out, x2, z1_is_zero);
+    copy_conditional(x_out, x1, z2_is_zero);
+    copy_conditional(y_out, y2, z1_is_zero);
+    copy_conditional(y_out, y1, z2_is_zero);
+    copy_conditional(z_out, z2, z1_is_zero);
+    copy_conditional(z_out, z1, z2_is_zero);
+    felem_assign(x3, x_out);
+    felem_assign(y3, y_out);
+    felem_assign(z3, z_out);
+}
+
+/*-
+ * Base point pre computation
+ * --------------------------
+ *
+ * Two different sorts of precomputed tables are used in the following code.
+ * Each contain various points on the curve, where each point is three field
+ * elements (x, y, z).
+ *
+ * For the base point table, z is usually 1 (0 for the point at infinity).
+ * This table has 2 * 16 elements, starting with the following:
+ * index | bits    | point
+ * ------+---------+------------------------------
+ *     0 | 0 0 0 0 | 0G
+ *     1 | 0 0 0 1 | 1G
+ *     2 | 0 0 1 0 | 2^96G
+ *     3 | 0 0 1 1 | (2^96 + 1)G
+ *     4 | 0 1 0 0 | 2^192G
+ *     5 | 0 1 0 1 | (2^192 + 1)G
+ *     6 | 0 1 1 0 | (2^192 + 2^96)G
+ *     7 | 0 1 1 1 | (2^192 + 2^96 + 1)G
+ *     8 | 1 0 0 0 | 2^288G
+ *     9 | 1 0 0 1 | (2^288 + 1)G
+ *    10 | 1 0 1 0 | (2^288 + 2^96)G
+ *    11 | 1 0 1 1 | (2^288 + 2^96 + 1)G
+ *    12 | 1 1 0 0 | (2^288 + 2^192)G
+ *    13 | 1 1 0 1 | (2^288 + 2^192 + 1)G
+ *    14 | 1 1 1 0 | (2^288 + 2^192 + 2^96)G
+ *    15 | 1 1 1 1 | (2^288 + 2^192 + 2^96 + 1)G
+ * followed by a copy of this with each element multiplied by 2^48.
+ *
+ * The reason for this is so that we can clock bits into eight different
+ * locations when doing simple scalar multiplies against the base point: a
+ * comb with eight teeth spaced 48 bits apart, so that a multiplication by the
+ * generator takes only 47 doublings.
+ *
+ * The table is in Montgomery form, so "z = 1" is stored as 2^384 mod p.
+ *
+ * Tables for other points have table[i] = iG for i in 0 .. 16. */
+
+/* gmul is the table of precomputed base points */
+static const felem gmul[2][16][3] = {
+ {{{0, 0, 0, 0, 0, 0},
+   {0, 0, 0, 0, 0, 0},
+   {0, 0, 0, 0, 0, 0}},
+  {{0x3dd0756649c0b528, 0x20e378e2a0d6ce38, 0x879c3afc541b4d6e,
+    0x6454868459a30eff, 0x812ff723614ede2b, 0x4d3aadc2299e1513},
+   {0x23043dad4b03a4fe, 0xa1bfa8bf7bb4a9ac, 0x8bade7562e83b050,
+    0xc6c3521968f4ffd9, 0xdd8002263969a840, 0x2b78abc25a15c5e9},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0x24480c57f26feef9, 0xc31a26943a0e1240, 0x735002c3273e2bc7,
+    0x8c42e9c53ef1ed4c, 0x028babf67f4948e8, 0x6a502f438a978632},
+   {0xf5f13a46b74536fe, 0x1d218babd8a9f0eb, 0x30f36bcc37232768,
+    0xc5317b31576e8c18, 0xef1d57a69bbcb766, 0x917c4930b3e3d4dc},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0x11426e2ee349ddd0, 0x9f117ef99b2fc250, 0xff36b480ec0174a6,
+    0x4f4bde7618458466, 0x2f2edb6d05806049, 0x8adc75d119dfca92},
+   {0xa619d097b7d5a7ce, 0x874275e5a34411e9, 0x5403e0470da4b4ef,
+    0x2ebaafd977901d8f, 0x5e63ebcea747170f, 0x12a369447f9d8036},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0x378205de2f9fbe67, 0xc4afcb837f728e44, 0xdbcec06c682e00f1,
+    0xf2a145c3114d5423, 0xa01d98747a52463e, 0xfc0935b17d717b0a},
+   {0x9653bc4fd4d01f95, 0x9aa83ea89560ad34, 0xf77943dcaf8e3f3f,
+    0x70774a10e86fe16e, 0x6b62e6f1bf9ffdcf, 0x8a72f39e588745c9},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0x73ade4da2341c342, 0xdd326e54ea704422, 0x336c7d983741cef3,
+    0x1eafa00d59e61549, 0xcd3ed892bd9a3efd, 0x03faf26cc5c6c7e4},
+   {0x087e2fcf3045f8ac, 0x14a65532174f1e73, 0x2cf84f28fe0af9a7,
+    0xddfd7a842cdc935b, 0x4c0f117b6929c895, 0x356572d64c8bcfcc},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0xfab086073f3b236f, 0x19e9d41d81e221da, 0xf3f6571e3927b428,
+    0x4348a9337550f1f6, 0x7167b996a85e62f0, 0x62d437597f5452bf},
+   {0xd85feb9ef2955926, 0x440a561f6df78353, 0x389668ec9ca36b59,
+    0x052bf1a1a22da016, 0xbdfbff72f6093254, 0x94e50f28e22209f3},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0x90b2e5b33062e8af, 0xa8572375e8a3d369, 0x3fe1b00b201db7b1,
+    0xe926def0ee651aa2, 0x6542c9beb9b10ad7, 0x098e309ba2fcbe74},
+   {0x779deeb3fff1d63f, 0x23d0e80a20bfd374, 0x8452bb3b8768f797,
+    0xcf75bb4d1f952856, 0x8fe6b40029ea3faa, 0x12bd3e4081373a53},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0x070d34e116973cf4, 0x20aee08b7e4f34f7, 0x269af9b95eb8ad29,
+    0xdde0a036a6a45dda, 0xa18b528e63df41e0, 0x03cc71b2a260df2a},
+   {0x24a6770aa06b1dd7, 0x5bfa9c119d2675d3, 0x73c1e2a196844432,
+    0x3660558d131a6cf0, 0xb0289c832ee79454, 0xa6aefb01c6d8ddcd},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0xba1464b401ab5245, 0x9b8d0b6dc48d93ff, 0x939867dc93ad272c,
+    0xbebe085eae9fdc77, 0x73ae5103894ea8bd, 0x740fc89a39ac22e1},
+   {0x5e28b0a328e23b23, 0x2352722ee13104d0, 0xf4667a18b0a2640d,
+    0xac74a72e49bb37c3, 0x79f734f0e81e183a, 0xbffe5b6c3fd9c0eb},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0x03cf292200623f3b, 0x095c71115f29ebff, 0x42d7224780aa6823,
+    0x044c7ba17458c0b0, 0xca62f7ef0959ec20, 0x40ae2ab7f8ca929f},
+   {0xb8c5377aa927b102, 0x398a86a0dc031771, 0x04908f9dc216a406,
+    0xb423a73a918d3300, 0x634b0ff1e0b94739, 0xe29de7252d69f697},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0x744d14008435af04, 0x5f255b1dfec192da, 0x1f17dc12336dc542,
+    0x5c90c2a7636a68a8, 0x960c9eb77704ca1e, 0x9de8cf1e6fb3d65a},
+   {0xc60fee0d511d3d06, 0x466e2313f9eb52c7, 0x743c0f5f206b0914,
+    0x42f55bac2191aa4d, 0xcefc7c8fffebdbc2, 0xd4fa6081e6e8ed1c},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0x867db63998683186, 0xfb5cf424ddcc4ea9, 0xcc9a7ffed4f0e7bd,
+    0x7c57f71c7a779f7e, 0x90774079d6b25ef2, 0x90eae903b4081680},
+   {0xdf2aae5e0ee1fceb, 0x3ff1da24e86c1a1f, 0x80f587d6ca193edf,
+    0xa5695523dc9b9d6a, 0x7b84090085920303, 0x1efa4dfcba6dbdef},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0xfbd838f9e0540015, 0x2c323946c39077dc, 0x8b1fb9e6ad619124,
+    0x9612440c0ca62ea8, 0x9ad9b52c2dbe00ff, 0xf52abaa1ae197643},
+   {0xd0e898942cac32ad, 0xdfb79e4262a98f91, 0x65452ecf276f55cb,
+    0xdb1ac0d27ad23e12, 0xf68c5f6ade4986f0, 0x389ac37b82ce327d},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0xcd96866db8a9e8c9, 0xa11963b85bb8091e, 0xc7f90d53045b3cd2,
+    0x755a72b580f36504, 0x46f8b39921d3751c, 0x4bffdc9153c193de},
+   {0xcd15c049b89554e7, 0x353c6754f7a26be6, 0x79602370bd41d970,
+    0xde16470b12b176c0, 0x56ba117540c8809d, 0xe2db35c3e435fb1e},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0xd71e4aab6328e33f, 0x5486782baf8136d1, 0x07a4995f86d57231,
+    0xf1f0a5bd1651a968, 0xa5dc5b2476803b6d, 0x5c587cbc42dda935},
+   {0x2b6cdb32bae8b4c0, 0x66d1598bb1331138, 0x4a23b2d25d7e9614,
+    0x93e402a674a8c05d, 0x45ac94e6da7ce82e, 0xeb9f8281e463d465},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}}},
+ {{{0, 0, 0, 0, 0, 0},
+   {0, 0, 0, 0, 0, 0},
+   {0, 0, 0, 0, 0, 0}},
+  {{0x298647532b0c535b, 0x90dd695370506296, 0x038cd6b4216ab9ac,
+    0x3df9b7b7be12d76a, 0x13f4d9785f347bdb, 0x222c5c9c13e94489},
+   {0x5f8e796f2680dc64, 0x120e7cb758352417, 0x254b5d8ad10740b8,
+    0xc38b8efb5337dee6, 0xf688c2e194f02247, 0x7b5c75f36c25bc4c},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0x5584cbb3893b9a2d, 0x820c660b00850c5d, 0x4126d8267df2d43d,
+    0xdd5bbbf00109e801, 0x85b92ee338172f1c, 0x609d4f93f31430d9},
+   {0x1e059a07eadaf9d6, 0x70e6536c0f125fb0, 0xd6220751560f20e7,
+    0xa59489ae7aaf3a9a, 0x7b70e2f664bae14e, 0x0dd0370176d08249},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0xc07611f4df5bdf53, 0x45d331a758b11a6d, 0x58965daf1c4ee394,
+    0xba8bebe75a5878d1, 0xaecc0a1882dd3025, 0xcf2a3899a923eb8b},
+   {0xf98c9281d24fd048, 0x841bfb598bbb025d, 0xb8ddf8cec9ab9d53,
+    0x538a4cb67fef044e, 0x092ac21f23236662, 0xa919d3850b66f065},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0xc0426b775e3c647b, 0xbfcbd9398cf05348, 0x31d312e3172c0d3d,
+    0x5f49fde6ee754737, 0x895530f06da7ee61, 0xcf281b0ae8b3a5fb},
+   {0xfd14973541b8a543, 0x41a625a73080dd30, 0xe2baae07653908cf,
+    0xc3d01436ba02a278, 0xa0d0222e7b21b8f8, 0xfdc270e9d7ec1297},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0x4e50430efc14ab48, 0x195b7f4f26706a74, 0x2fe8a228cc881ff6,
+    0xb1b968e2d945013d, 0x936aa5794b92162b, 0x4fb766b7364e754a},
+   {0x13f93bca31e1ff7f, 0x696eb5cace4f2691, 0xff754bf8a2b09e02,
+    0x58f13c9ce58e3ff8, 0xb757346f1678c0b0, 0xd54200dba86692b3},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0x5cd9f5a87237cac0, 0x93f0b59d43586794, 0x4384a764e94f6c4e,
+    0x8304ed2bb62782d3, 0x0b8db8b3cde06015, 0x4336dd535dbe190f},
+   {0x5744355392ab473a, 0x031c7275be5ed046, 0x3e78678c21909aa4,
+    0x4ab7e04f99202ddb, 0x2648d2066977e635, 0xd427d184093198be},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0x8e74dc3579efdc58, 0x456bd3694ff68ddb, 0x724e74ccd32096a5,
+    0xe41cff42386783d0, 0xa04c7f217c70d8a4, 0x41199d2fe61a19a2},
+   {0xd389a3e029c05dd2, 0x535f2a6be7e3fda9, 0x26ecf72d7c2b4df8,
+    0x678275f4fe745294, 0x6319c9cc9d23f519, 0x1e05a02d88048fc4},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0x87c7dd7d139b3239, 0x8b57824e4d833bae, 0xbcbc48789fff0015,
+    0x8ffcef8b909eaf1a, 0x9905f4eef1443a78, 0x020dd4a2e15cbfed},
+   {0xca2969eca306d695, 0xdf940cadb93caf60, 0x67f7fab787ea6e39,
+    0x0d0ee10ff98c4fe5, 0xc646879ac19cb91e, 0x4b4ea50c7d1d7ab4},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0xd6d9aec823e4712c, 0x7ca8376cc3c198ee, 0xe6d8318731bebd8a,
+    0xed57aff3d88bfef3, 0x72a645eecf44edc7, 0xd4e63d0b5cbb1517},
+   {0x98ce7a1cceee0ecf, 0x8f0126335383ee8e, 0x3b879078a6b455e8,
+    0xcbcd3d96c7658c06, 0x721d6fe70783336a, 0xf21a72635a677136},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0x18482cec9b3f5034, 0x962d445acd9e68fd, 0x266fb1d695746f23,
+    0xc66ade5a58c94a4b, 0xdbbda826ed68a5b6, 0x05664a4d7ab0d6ae},
+   {0xbcd4fe51025e32fc, 0x61a5aebfa96df252, 0xd88a07e231592a31,
+    0x5d9d94de98905517, 0x96bb40105fd440e7, 0x1b0c47a2e807db4c},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0xc1004cff44b2e045, 0x91b5e1364b1c05d4, 0x53ae409088a48a07,
+    0x73fb2995ea11bb1a, 0x320485703d93a4ea, 0xcce45de83bfc8a5f},
+   {0xaff4a97ec2b3106e, 0x9069c630b6848b4f, 0xeda837a6ed76241c,
+    0x8a0daf136cc3f6cf, 0x199d049d3da018a8, 0xf867c6b1d9093ba3},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0x5285d116141d161c, 0x67cd2e0e93c4ed17, 0x12c62a647c36187e,
+    0xf5329539ed2584ca, 0xc4c777c442fbbd69, 0x107de7761bdfc50a},
+   {0x9976dcc5e96beebd, 0xbe2aff95a865a151, 0x0e0a9da19d8872af,
+    0x5e357a3da63c17cc, 0xd31fdfd8e15cc67c, 0xc44bbefd7970c6d8},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0x1a60d1522ca8f2fe, 0x61640948491bd41f, 0x6dae29a558dfe035,
+    0x9a615bea278e4863, 0xbbdb44779ad7c8e5, 0x1c7066302ceac2fc},
+   {0x5e2b54c699699b4b, 0xb509ca6d239e17e8, 0x728165feea063a82,
+    0x6b5e609db6a22e02, 0x12813905b26ee1df, 0x07b9f722439491fa},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0xaa9da167b8153a9d, 0xa49fe3ac9e83ecf0, 0x14c18f8e1b661384,
+    0x61c24dab38434de1, 0x3d973c3a283dae96, 0xc99baa0182754fc9},
+   {0x477d198f4c26b1e3, 0x12e8e186a7516202, 0x386e52f6362addfa,
+    0x31e8f695c3962853, 0xdec2af136aaedb60, 0xfcfdb4c629cf74ac},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+  {{0xe361a1987ffa0a5f, 0xf4b26102c63fe109, 0x264acbc56c74e111,
+    0x4af445fa77abebaf, 0x448c4fdd24cddb75, 0x0b13157d44506eea},
+   {0x22a6b15972e9993d, 0x2c3c57e485e5ecbe, 0xa673560bfd83e1a1,
+    0x6be23f82c3b8c83b, 0x40b13a9640bbe38e, 0x66eea033ad17399b},
+   {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000000}}}
+};
+
+/*
+ * select_point selects the |idx|th point from a precomputation table and
+ * copies it to out.
+ */
+ /* pre_comp below is of the size provided in |size| */
+static void select_point(const limb idx, unsigned int size,
+                         const felem pre_comp[][3], felem out[3])
+{
+    unsigned i, j;
+    limb *outlimbs = &out[0][0];
+
+    memset(out, 0, sizeof(*out) * 3);
+
+    for (i = 0; i < size; i++) {
+        const limb *inlimbs = &pre_comp[i][0][0];
+        limb mask = i ^ idx;
+        mask |= mask >> 4;
+        mask |= mask >> 2;
+        mask |= mask >> 1;
+        mask &= 1;
+        mask--;
+        for (j = 0; j < NLIMBS * 3; j++)
+            outlimbs[j] |= inlimbs[j] & mask;
+    }
+}
+
+/* get_bit returns the |i|th bit in |in| */
+static char get_bit(const felem_bytearray in, int i)
+{
+    if ((i < 0) || (i >= 384))
+        return 0;
+    return (in[i >> 3] >> (i & 7)) & 1;
+}
+
+/*
+ * Interleaved point multiplication using precomputed point multiples: The
+ * small point multiples 0*P, 1*P, ..., 16*P are in pre_comp[], the scalars
+ * in scalars[]. If g_scalar is non-NULL, we also add this multiple of the
+ * generator, using certain (large) precomputed multiples in g_pre_comp.
+ * Output point (X, Y, Z) is stored in x_out, y_out, z_out
+ */
+static void batch_mul(felem x_out, felem y_out, felem z_out,
+                      const felem_bytearray scalars[],
+                      const unsigned num_points, const u8 *g_scalar,
+                      const int mixed, const felem pre_comp[][17][3],
+                      const felem g_pre_comp[2][16][3])
+{
+    int i, skip;
+    unsigned num, gen_mul = (g_scalar != NULL);
+    felem nq[3], tmp[4];
+    limb bits;
+    u8 sign, digit;
+
+    /* set nq to the point at infinity */
+    memset(nq, 0, sizeof(nq));
+
+    /*
+     * Loop over all scalars msb-to-lsb, interleaving additions of multiples
+     * of the generator (two in each of the last 48 rounds) and additions of
+     * other points multiples (every 5th round).
+     */
+    skip = 1;                   /* save two point operations in the first
+                                 * round */
+    for (i = (num_points ? 383 : 47); i >= 0; --i) {
+        /* double */
+        if (!skip)
+            point_double(nq[0], nq[1], nq[2], nq[0], nq[1], nq[2]);
+
+        /* add multiples of the generator */
+        if (gen_mul && (i <= 47)) {
+            /* first, look 48 bits upwards */
+            bits = get_bit(g_scalar, i + 336) << 3;
+            bits |= get_bit(g_scalar, i + 240) << 2;
+            bits |= get_bit(g_scalar, i + 144) << 1;
+            bits |= get_bit(g_scalar, i + 48);
+            /* select the point to add, in constant time */
+            select_point(bits, 16, g_pre_comp[1], tmp);
+            if (!skip) {
+                /* The 1 argument below is for "mixed" */
+                point_add(nq[0], nq[1], nq[2],
+                          nq[0], nq[1], nq[2], 1, tmp[0], tmp[1], tmp[2]);
+            } else {
+                memcpy(nq, tmp, 3 * sizeof(felem));
+                skip = 0;
+            }
+
+            /* second, look at the current position */
+            bits = get_bit(g_scalar, i + 288) << 3;
+            bits |= get_bit(g_scalar, i + 192) << 2;
+            bits |= get_bit(g_scalar, i + 96) << 1;
+            bits |= get_bit(g_scalar, i);
+            /* select the point to add, in constant time */
+            select_point(bits, 16, g_pre_comp[0], tmp);
+            /* The 1 argument below is for "mixed" */
+            point_add(nq[0], nq[1], nq[2],
+                      nq[0], nq[1], nq[2], 1, tmp[0], tmp[1], tmp[2]);
+        }
+
+        /* do other additions every 5 doublings */
+        if (num_points && (i % 5 == 0)) {
+            /* loop over all scalars */
+            for (num = 0; num < num_points; ++num) {
+                bits = get_bit(scalars[num], i + 4) << 5;
+                bits |= get_bit(scalars[num], i + 3) << 4;
+                bits |= get_bit(scalars[num], i + 2) << 3;
+                bits |= get_bit(scalars[num], i + 1) << 2;
+                bits |= get_bit(scalars[num], i) << 1;
+                bits |= get_bit(scalars[num], i - 1);
+                ossl_ec_GFp_nistp_recode_scalar_bits(&sign, &digit, bits);
+
+                /*
+                 * select the point to add or subtract, in constant time
+                 */
+                select_point(digit, 17, pre_comp[num], tmp);
+                felem_neg(tmp[3], tmp[1]); /* (X, -Y, Z) is the negative
+                                            * point */
+                copy_conditional(tmp[1], tmp[3], (-(limb) sign));
+
+                if (!skip) {
+                    point_add(nq[0], nq[1], nq[2],
+                              nq[0], nq[1], nq[2],
+                              mixed, tmp[0], tmp[1], tmp[2]);
+                } else {
+                    memcpy(nq, tmp, 3 * sizeof(felem));
+                    skip = 0;
+                }
+            }
+        }
+    }
+    felem_assign(x_out, nq[0]);
+    felem_assign(y_out, nq[1]);
+    felem_assign(z_out, nq[2]);
+}
+
+/* Precomputation for the group generator. */
+struct nistp384_pre_comp_st {
+    felem g_pre_comp[2][16][3];
+    CRYPTO_REF_COUNT references;
+    CRYPTO_RWLOCK *lock;
+};
+
+const EC_METHOD *ossl_ec_GFp_nistp384_method(void)
+{
+    static const EC_METHOD ret = {
+        EC_FLAGS_DEFAULT_OCT,
+        NID_X9_62_prime_field,
+        ossl_ec_GFp_nistp384_group_init,
+        ossl_ec_GFp_simple_group_finish,
+        ossl_ec_GFp_simple_group_clear_finish,
+        ossl_ec_GFp_nist_group_copy,
+        ossl_ec_GFp_nistp384_group_set_curve,
+        ossl_ec_GFp_simple_group_get_curve,
+        ossl_ec_GFp_simple_group_get_degree,
+        ossl_ec_group_simple_order_bits,
+        ossl_ec_GFp_simple_group_check_discriminant,
+        ossl_ec_GFp_simple_point_init,
+        ossl_ec_GFp_simple_point_finish,
+        ossl_ec_GFp_simple_point_clear_finish,
+        ossl_ec_GFp_simple_point_copy,
+        ossl_ec_GFp_simple_point_set_to_infinity,
+        ossl_ec_GFp_simple_point_set_affine_coordinates,
+        ossl_ec_GFp_nistp384_point_get_affine_coordinates,
+        0 /* point_set_compressed_coordinates */ ,
+        0 /* point2oct */ ,
+        0 /* oct2point */ ,
+        ossl_ec_GFp_simple_add,
+        ossl_ec_GFp_simple_dbl,
+        ossl_ec_GFp_simple_invert,
+        ossl_ec_GFp_simple_is_at_infinity,
+        ossl_ec_GFp_simple_is_on_curve,
+        ossl_ec_GFp_simple_cmp,
+        ossl_ec_GFp_simple_make_affine,
+        ossl_ec_GFp_simple_points_make_affine,
+        ossl_ec_GFp_nistp384_points_mul,
+        ossl_ec_GFp_nistp384_precompute_mult,
+        ossl_ec_GFp_nistp384_have_precompute_mult,
+        ossl_ec_GFp_nist_field_mul,
+        ossl_ec_GFp_nist_field_sqr,
+        0 /* field_div */ ,
+        ossl_ec_GFp_simple_field_inv,
+        0 /* field_encode */ ,
+        0 /* field_decode */ ,
+        0,                      /* field_set_to_one */
+        ossl_ec_key_simple_priv2oct,
+        ossl_ec_key_simple_oct2priv,
+        0, /* set private */
+        ossl_ec_key_simple_generate_key,
+        ossl_ec_key_simple_check_key,
+        ossl_ec_key_simple_generate_public_key,
+        0, /* keycopy */
+        0, /* keyfinish */
+        ossl_ecdh_simple_compute_key,
+        ossl_ecdsa_simple_sign_setup,
+        ossl_ecdsa_simple_sign_sig,
+        ossl_ecdsa_simple_verify_sig,
+        0, /* field_inverse_mod_ord */
+        0, /* blind_coordinates */
+        0, /* ladder_pre */
+        0, /* ladder_step */
+        0  /* ladder_post */
+    };
+
+    return &ret;
+}
+/******************************************************************************/
+/*
+ * FUNCTIONS TO MANAGE PRECOMPUTATION
+ */
+
+static NISTP384_PRE_COMP *nistp384_pre_comp_new(void)
+{
+    NISTP384_PRE_COMP *ret = OPENSSL_zalloc(sizeof(*ret));
+
+    if (ret == NULL) {
+        ERR_raise(ERR_LIB_EC, ERR_R_MALLOC_FAILURE);
+        return ret;
+    }
+
+    ret->references = 1;
+
+    ret->lock = CRYPTO_THREAD_lock_new();
+    if (ret->lock == NULL) {
+        ERR_raise(ERR_LIB_EC, ERR_R_MALLOC_FAILURE);
+        OPENSSL_free(ret);
+        return NULL;
+    }
+    return ret;
+}
+
+NISTP384_PRE_COMP *EC_nistp384_pre_comp_dup(NISTP384_PRE_COMP *p)
+{
+    int i;
+    if (p != NULL)
+        CRYPTO_UP_REF(&p->references, &i, p->lock);
+    return p;
+}
+
+void EC_nistp384_pre_comp_free(NISTP384_PRE_COMP *p)
+{
+    int i;
+
+    if (p == NULL)
+        return;
+
+    CRYPTO_DOWN_REF(&p->references, &i, p->lock);
+    REF_PRINT_COUNT("EC_nistp384", x);
+    if (i > 0)
+        return;
+    REF_ASSERT_ISNT(i < 0);
+
+    CRYPTO_THREAD_lock_free(p->lock);
+    OPENSSL_free(p);
+}
+
+/******************************************************************************/
+/*
+ * OPENSSL EC_METHOD FUNCTIONS
+ */
+
+int ossl_ec_GFp_nistp384_group_init(EC_GROUP *group)
+{
+    int ret;
+    ret = ossl_ec_GFp_simple_group_init(group);
+    group->a_is_minus3 = 1;
+    return ret;
+}
+
+int ossl_ec_GFp_nistp384_group_set_curve(EC_GROUP *group, const BIGNUM *p,
+                                         const BIGNUM *a, const BIGNUM *b,
+                                         BN_CTX *ctx)
+{
+    int ret = 0;
+    BIGNUM *curve_p, *curve_a, *curve_b;
+#ifndef FIPS_MODULE
+    BN_CTX *new_ctx = NULL;
+
+    if (ctx == NULL)
+        ctx = new_ctx = BN_CTX_new();
+#endif
+    if (ctx == NULL)
+        return 0;
+
+    BN_CTX_start(ctx);
+    curve_p = BN_CTX_get(ctx);
+    curve_a = BN_CTX_get(ctx);
+    curve_b = BN_CTX_get(ctx);
+    if (curve_b == NULL)
+        goto err;
+    BN_bin2bn(nistp384_curve_params[0], sizeof(felem_bytearray), curve_p);
+    BN_bin2bn(nistp384_curve_params[1], sizeof(felem_bytearray), curve_a);
+    BN_bin2bn(nistp384_curve_params[2], sizeof(felem_bytearray), curve_b);
+    if ((BN_cmp(curve_p, p)) || (BN_cmp(curve_a, a)) || (BN_cmp(curve_b, b))) {
+        ERR_raise(ERR_LIB_EC, EC_R_WRONG_CURVE_PARAMETERS);
+        goto err;
+    }
+    group->field_mod_func = BN_nist_mod_384;
+    ret = ossl_ec_GFp_simple_group_set_curve(group, p, a, b, ctx);
+ err:
+    BN_CTX_end(ctx);
+#ifndef FIPS_MODULE
+    BN_CTX_free(new_ctx);
+#endif
+    return ret;
+}
+
+/*
+ * Takes the Jacobian coordinates (X, Y, Z) of a point and returns (X', Y') =
+ * (X/Z^2, Y/Z^3)
+ */
+int ossl_ec_GFp_nistp384_point_get_affine_coordinates(const EC_GROUP *group,
+                                                      const EC_POINT *point,
+                                                      BIGNUM *x, BIGNUM *y,
+                                                      BN_CTX *ctx)
+{
+    felem z1, z2, x_in, y_in;
+
+    if (EC_POINT_is_at_infinity(group, point)) {
+        ERR_raise(ERR_LIB_EC, EC_R_POINT_AT_INFINITY);
+        return 0;
+    }
+    if ((!BN_to_felem(x_in, point->X)) || (!BN_to_felem(y_in, point->Y)) ||
+        (!BN_to_felem(z1, point->Z)))
+        return 0;
+    felem_inv(z2, z1);
+    felem_square(z1, z2);
+    felem_mul(x_in, x_in, z1);
+    if (x != NULL) {
+        if (!felem_to_BN(x, x_in)) {
+            ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+            return 0;
+        }
+    }
+    felem_mul(z1, z1, z2);
+    felem_mul(y_in, y_in, z1);
+    if (y != NULL) {
+        if (!felem_to_BN(y, y_in)) {
+            ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * points below is of size |num|, and tmp_felems is of size |num+1|.  They are
+ * plain pointers rather than array parameters, for which gcc's
+ * -Wstringop-overflow misjudges the size of the caller's buffers.
+ */
+static void make_points_affine(size_t num, felem (*points)[3],
+                               felem *tmp_felems)
+{
+    /*
+     * Runs in constant time, unless an input is the point at infinity (which
+     * normally shouldn't happen). Field elements are always fully reduced,
+     * so felem_assign serves as the contraction.
+     */
+    ossl_ec_GFp_nistp_points_make_affine_internal(num,
+                                                  points,
+                                                  sizeof(felem),
+                                                  tmp_felems,
+                                                  (void (*)(void *))felem_one,
+                                                  felem_is_zero_int,
+                                                  (void (*)(void *, const void *))
+                                                  felem_assign,
+                                                  (void (*)(void *, const void *))
+                                                  felem_square,
+                                                  (void (*)
+                                                   (void *, const void *,
+                                                    const void *))
+                                                  felem_mul,
+                                                  (void (*)(void *, const void *))
+                                                  felem_inv,
+                                                  (void (*)(void *, const void *))
+                                                  felem_assign);
+}
+
+/*
+ * Computes scalar*generator + \sum scalars[i]*points[i], ignoring NULL
+ * values Result is stored in r (r can equal one of the inputs).
+ */
+int ossl_ec_GFp_nistp384_points_mul(const EC_GROUP *group, EC_POINT *r,
+                                    const BIGNUM *scalar, size_t num,
+                                    const EC_POINT *points[],
+                                    const BIGNUM *scalars[], BN_CTX *ctx)
+{
+    int ret = 0;
+    int j;
+    int mixed = 0;
+    BIGNUM *x, *y, *z, *tmp_scalar;
+    felem_bytearray g_secret;
+    felem_bytearray *secrets = NULL;
+    felem (*pre_comp)[17][3] = NULL;
+    felem *tmp_felems = NULL;
+    unsigned i;
+    int num_bytes;
+    int have_pre_comp = 0;
+    size_t num_points = num;
+    felem x_out, y_out, z_out;
+    NISTP384_PRE_COMP *pre = NULL;
+    felem(*g_pre_comp)[16][3] = NULL;
+    EC_POINT *generator = NULL;
+    const EC_POINT *p = NULL;
+    const BIGNUM *p_scalar = NULL;
+
+    BN_CTX_start(ctx);
+    x = BN_CTX_get(ctx);
+    y = BN_CTX_get(ctx);
+    z = BN_CTX_get(ctx);
+    tmp_scalar = BN_CTX_get(ctx);
+    if (tmp_scalar == NULL)
+        goto err;
+
+    if (scalar != NULL) {
+        pre = group->pre_comp.nistp384;
+        if (pre)
+            /* we have precomputation, try to use it */
+            g_pre_comp = &pre->g_pre_comp[0];
+        else
+            /* try to use the standard precomputation */
+            g_pre_comp = (felem(*)[16][3]) gmul;
+        generator = EC_POINT_new(group);
+        if (generator == NULL)
+            goto err;
+        /* get the generator from precomputation */
+        if (!felem_to_BN(x, g_pre_comp[0][1][0]) ||
+            !felem_to_BN(y, g_pre_comp[0][1][1]) ||
+            !felem_to_BN(z, g_pre_comp[0][1][2])) {
+            ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+            goto err;
+        }
+        if (!ossl_ec_GFp_simple_set_Jprojective_coordinates_GFp(group,
+                                                                generator,
+                                                                x, y, z, ctx))
+            goto err;
+        if (0 == EC_POINT_cmp(group, generator, group->generator, ctx))
+            /* precomputation matches generator */
+            have_pre_comp = 1;
+        else
+            /*
+             * we don't have valid precomputation: treat the generator as a
+             * random point
+             */
+            num_points++;
+    }
+
+    if (num_points > 0) {
+        if (num_points >= 2) {
+            /*
+             * unless we precompute multiples for just one point, converting
+             * those into affine form is time well spent
+             */
+            mixed = 1;
+        }
+        secrets = OPENSSL_zalloc(sizeof(*secrets) * num_points);
+        pre_comp = OPENSSL_zalloc(sizeof(*pre_comp) * num_points);
+        if (mixed)
+            tmp_felems =
+                OPENSSL_malloc(sizeof(*tmp_felems) * (num_points * 17 + 1));
+        if ((secrets == NULL) || (pre_comp == NULL)
+            || (mixed && (tmp_felems == NULL))) {
+            ERR_raise(ERR_LIB_EC, ERR_R_MALLOC_FAILURE);
+            goto err;
+        }
+
+        /*
+         * we treat NULL scalars as 0, and NULL points as points at infinity,
+         * i.e., they contribute nothing to the linear combination
+         */
+        for (i = 0; i < num_points; ++i) {
+            if (i == num) {
+                /*
+                 * we didn't have a valid precomputation, so we pick the
+                 * generator
+                 */
+                p = EC_GROUP_get0_generator(group);
+                p_scalar = scalar;
+            } else {
+                /* the i^th point */
+                p = points[i];
+                p_scalar = scalars[i];
+            }
+            if ((p_scalar != NULL) && (p != NULL)) {
+                /* reduce scalar to 0 <= scalar < 2^384 */
+                if ((BN_num_bits(p_scalar) > 384)
+                    || (BN_is_negative(p_scalar))) {
+                    /*
+                     * this is an unusual input, and we don't guarantee
+                     * constant-timeness
+                     */
+                    if (!BN_nnmod(tmp_scalar, p_scalar, group->order, ctx)) {
+                        ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+                        goto err;
+                    }
+                    num_bytes = BN_bn2lebinpad(tmp_scalar,
+                                               secrets[i], sizeof(secrets[i]));
+                } else {
+                    num_bytes = BN_bn2lebinpad(p_scalar,
+                                               secrets[i], sizeof(secrets[i]));
+                }
+                if (num_bytes < 0) {
+                    ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+                    goto err;
+                }
+                /* precompute multiples */
+                if ((!BN_to_felem(x_out, p->X)) ||
+                    (!BN_to_felem(y_out, p->Y)) ||
+                    (!BN_to_felem(z_out, p->Z)))
+                    goto err;
+                memcpy(pre_comp[i][1][0], x_out, sizeof(felem));
+                memcpy(pre_comp[i][1][1], y_out, sizeof(felem));
+                memcpy(pre_comp[i][1][2], z_out, sizeof(felem));
+                for (j = 2; j <= 16; ++j) {
+                    if (j & 1) {
+                        point_add(pre_comp[i][j][0], pre_comp[i][j][1],
+                                  pre_comp[i][j][2], pre_comp[i][1][0],
+                                  pre_comp[i][1][1], pre_comp[i][1][2], 0,
+                                  pre_comp[i][j - 1][0],
+                                  pre_comp[i][j - 1][1],
+                                  pre_comp[i][j - 1][2]);
+                    } else {
+                        point_double(pre_comp[i][j][0], pre_comp[i][j][1],
+                                     pre_comp[i][j][2], pre_comp[i][j / 2][0],
+                                     pre_comp[i][j / 2][1],
+                                     pre_comp[i][j / 2][2]);
+                    }
+                }
+            }
+        }
+        if (mixed)
+            make_points_affine(num_points * 17, pre_comp[0], tmp_felems);
+    }
+
+    /* the scalar for the generator */
+    if ((scalar != NULL) && (have_pre_comp)) {
+        memset(g_secret, 0, sizeof(g_secret));
+        /* reduce scalar to 0 <= scalar < 2^384 */
+        if ((BN_num_bits(scalar) > 384) || (BN_is_negative(scalar))) {
+            /*
+             * this is an unusual input, and we don't guarantee
+             * constant-timeness
+             */
+            if (!BN_nnmod(tmp_scalar, scalar, group->order, ctx)) {
+                ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+                goto err;
+            }
+            num_bytes = BN_bn2lebinpad(tmp_scalar, g_secret, sizeof(g_secret));
+        } else {
+            num_bytes = BN_bn2lebinpad(scalar, g_secret, sizeof(g_secret));
+        }
+        /* do the multiplication with generator precomputation */
+        batch_mul(x_out, y_out, z_out,
+                  (const felem_bytearray(*))secrets, num_points,
+                  g_secret,
+                  mixed, (const felem(*)[17][3])pre_comp,
+                  (const felem(*)[16][3])g_pre_comp);
+    } else {
+        /* do the multiplication without generator precomputation */
+        batch_mul(x_out, y_out, z_out,
+                  (const felem_bytearray(*))secrets, num_points,
+                  NULL, mixed, (const felem(*)[17][3])pre_comp, NULL);
+    }
+    if ((!felem_to_BN(x, x_out)) || (!felem_to_BN(y, y_out)) ||
+        (!felem_to_BN(z, z_out))) {
+        ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+        goto err;
+    }
+    ret = ossl_ec_GFp_simple_set_Jprojective_coordinates_GFp(group, r, x, y, z,
+                                                             ctx);
+
+ err:
+    BN_CTX_end(ctx);
+    EC_POINT_free(generator);
+    OPENSSL_free(secrets);
+    OPENSSL_free(pre_comp);
+    OPENSSL_free(tmp_felems);
+    return ret;
+}
+
+int ossl_ec_GFp_nistp384_precompute_mult(EC_GROUP *group, BN_CTX *ctx)
+{
+    int ret = 0;
+    NISTP384_PRE_COMP *pre = NULL;
+    int i, j;
+    BIGNUM *x, *y;
+    EC_POINT *generator = NULL;
+    felem tmp_felems[32];
+#ifndef FIPS_MODULE
+    BN_CTX *new_ctx = NULL;
+#endif
+
+    /* throw away old precomputation */
+    EC_pre_comp_free(group);
+
+#ifndef FIPS_MODULE
+    if (ctx == NULL)
+        ctx = new_ctx = BN_CTX_new();
+#endif
+    if (ctx == NULL)
+        return 0;
+
+    BN_CTX_start(ctx);
+    x = BN_CTX_get(ctx);
+    y = BN_CTX_get(ctx);
+    if (y == NULL)
+        goto err;
+    /* get the generator */
+    if (group->generator == NULL)
+        goto err;
+    generator = EC_POINT_new(group);
+    if (generator == NULL)
+        goto err;
+    BN_bin2bn(nistp384_curve_params[3], sizeof(felem_bytearray), x);
+    BN_bin2bn(nistp384_curve_params[4], sizeof(felem_bytearray), y);
+    if (!EC_POINT_set_affine_coordinates(group, generator, x, y, ctx))
+        goto err;
+    if ((pre = nistp384_pre_comp_new()) == NULL)
+        goto err;
+    /*
+     * if the generator is the standard one, use built-in precomputation
+     */
+    if (0 == EC_POINT_cmp(group, generator, group->generator, ctx)) {
+        memcpy(pre->g_pre_comp, gmul, sizeof(pre->g_pre_comp));
+        goto done;
+    }
+    if ((!BN_to_felem(pre->g_pre_comp[0][1][0], group->generator->X)) ||
+        (!BN_to_felem(pre->g_pre_comp[0][1][1], group->generator->Y)) ||
+        (!BN_to_felem(pre->g_pre_comp[0][1][2], group->generator->Z)))
+        goto err;
+    /*
+     * compute 2^96*G, 2^192*G, 2^288*G for the first table, 2^48*G, 2^144*G,
+     * 2^240*G, 2^336*G for the second one
+     */
+    for (i = 1; i <= 8; i <<= 1) {
+        point_double(pre->g_pre_comp[1][i][0], pre->g_pre_comp[1][i][1],
+                     pre->g_pre_comp[1][i][2], pre->g_pre_comp[0][i][0],
+                     pre->g_pre_comp[0][i][1], pre->g_pre_comp[0][i][2]);
+        for (j = 0; j < 47; ++j) {
+            point_double(pre->g_pre_comp[1][i][0], pre->g_pre_comp[1][i][1],
+                         pre->g_pre_comp[1][i][2], pre->g_pre_comp[1][i][0],
+                         pre->g_pre_comp[1][i][1], pre->g_pre_comp[1][i][2]);
+        }
+        if (i == 8)
+            break;
+        point_double(pre->g_pre_comp[0][2 * i][0],
+                     pre->g_pre_comp[0][2 * i][1],
+                     pre->g_pre_comp[0][2 * i][2], pre->g_pre_comp[1][i][0],
+                     pre->g_pre_comp[1][i][1], pre->g_pre_comp[1][i][2]);
+        for (j = 0; j < 47; ++j) {
+            point_double(pre->g_pre_comp[0][2 * i][0],
+                         pre->g_pre_comp[0][2 * i][1],
+                         pre->g_pre_comp[0][2 * i][2],
+                         pre->g_pre_comp[0][2 * i][0],
+                         pre->g_pre_comp[0][2 * i][1],
+                         pre->g_pre_comp[0][2 * i][2]);
+        }
+    }
+    for (i = 0; i < 2; i++) {
+        /* g_pre_comp[i][0] is the point at infinity */
+        memset(pre->g_pre_comp[i][0], 0, sizeof(pre->g_pre_comp[i][0]));
+        /* the remaining multiples */
+        /* 2^96*G + 2^192*G resp. 2^144*G + 2^240*G */
+        point_add(pre->g_pre_comp[i][6][0], pre->g_pre_comp[i][6][1],
+                  pre->g_pre_comp[i][6][2], pre->g_pre_comp[i][4][0],
+                  pre->g_pre_comp[i][4][1], pre->g_pre_comp[i][4][2],
+                  0, pre->g_pre_comp[i][2][0], pre->g_pre_comp[i][2][1],
+                  pre->g_pre_comp[i][2][2]);
+        /* 2^96*G + 2^288*G resp. 2^144*G + 2^336*G */
+        point_add(pre->g_pre_comp[i][10][0], pre->g_pre_comp[i][10][1],
+                  pre->g_pre_comp[i][10][2], pre->g_pre_comp[i][8][0],
+                  pre->g_pre_comp[i][8][1], pre->g_pre_comp[i][8][2],
+                  0, pre->g_pre_comp[i][2][0], pre->g_pre_comp[i][2][1],
+                  pre->g_pre_comp[i][2][2]);
+        /* 2^192*G + 2^288*G resp. 2^240*G + 2^336*G */
+        point_add(pre->g_pre_comp[i][12][0], pre->g_pre_comp[i][12][1],
+                  pre->g_pre_comp[i][12][2], pre->g_pre_comp[i][8][0],
+                  pre->g_pre_comp[i][8][1], pre->g_pre_comp[i][8][2],
+                  0, pre->g_pre_comp[i][4][0], pre->g_pre_comp[i][4][1],
+                  pre->g_pre_comp[i][4][2]);
+        /*
+         * 2^96*G + 2^192*G + 2^288*G resp. 2^144*G + 2^240*G + 2^336*G
+         */
+        point_add(pre->g_pre_comp[i][14][0], pre->g_pre_comp[i][14][1],
+                  pre->g_pre_comp[i][14][2], pre->g_pre_comp[i][12][0],
+                  pre->g_pre_comp[i][12][1], pre->g_pre_comp[i][12][2],
+                  0, pre->g_pre_comp[i][2][0], pre->g_pre_comp[i][2][1],
+                  pre->g_pre_comp[i][2][2]);
+        for (j = 1; j < 8; ++j) {
+            /* odd multiples: add G resp. 2^48*G */
+            point_add(pre->g_pre_comp[i][2 * j + 1][0],
+                      pre->g_pre_comp[i][2 * j + 1][1],
+                      pre->g_pre_comp[i][2 * j + 1][2],
+                      pre->g_pre_comp[i][2 * j][0],
+                      pre->g_pre_comp[i][2 * j][1],
+                      pre->g_pre_comp[i][2 * j][2], 0,
+                      pre->g_pre_comp[i][1][0], pre->g_pre_comp[i][1][1],
+                      pre->g_pre_comp[i][1][2]);
+        }
+    }
+    make_points_affine(31, &(pre->g_pre_comp[0][1]), tmp_felems);
+
+ done:
+    SETPRECOMP(group, nistp384, pre);
+    ret = 1;
+    pre = NULL;
+ err:
+    BN_CTX_end(ctx);
+    EC_POINT_free(generator);
+#ifndef FIPS_MODULE
+    BN_CTX_free(new_ctx);
+#endif
+    EC_nistp384_pre_comp_free(pre);
+    return ret;
+}
+
+int ossl_ec_GFp_nistp384_have_precompute_mult(const EC_GROUP *group)
+{
+    return HAVEPRECOMP(group, nistp384);
+}
@@ -17,6 +17,8 @@
 #include <openssl/trace.h>
 #include "crypto/evp.h"
 #include "crypto/decoder.h"
+#include "internal/cryptlib.h"
+#include "internal/provider.h"
 #include "encoder_local.h"
 #include "e_os.h"                /* strcasecmp on Windows */
 
@@ -269,28 +271,54 @@ static void collect_decoder(OSSL_DECODER *decoder, void *arg)
     data->error_occurred = 0;         /* All is good now */
 }
 
+/* Sets up the construction of an EVP_PKEY, if there are decoders at all */
+static int decoder_ctx_set_construct_pkey(OSSL_DECODER_CTX *ctx,
+                                          EVP_PKEY **pkey,
+                                          OSSL_LIB_CTX *libctx,
+                                          const char *propquery)
+{
+    struct decoder_pkey_data_st *process_data = NULL;
+
+    if (OSSL_DECODER_CTX_get_num_decoders(ctx) == 0)
+        return 1;
+
+    if ((process_data = OPENSSL_zalloc(sizeof(*process_data))) == NULL
+        || (propquery != NULL
+            && (process_data->propq = OPENSSL_strdup(propquery)) == NULL)) {
+        ERR_raise(ERR_LIB_OSSL_DECODER, ERR_R_MALLOC_FAILURE);
+        goto err;
+    }
+
+    process_data->object = (void **)pkey;
+    process_data->libctx = libctx;
+
+    if (!OSSL_DECODER_CTX_set_construct(ctx, decoder_construct_pkey)
+        || !OSSL_DECODER_CTX_set_construct_data(ctx, process_data)
+        || !OSSL_DECODER_CTX_set_cleanup(ctx,
+                                         decoder_clean_pkey_construct_arg))
+        goto err;
+
+    return 1;
+ err:
+    decoder_clean_pkey_construct_arg(process_data);
+    return 0;
+}
+
 int ossl_decoder_ctx_setup_for_pkey(OSSL_DECODER_CTX *ctx,
                                     EVP_PKEY **pkey, const char *keytype,
                                     OSSL_LIB_CTX *libctx,
                                     const char *propquery)
 {
-    struct decoder_pkey_data_st *process_data = NULL;
     STACK_OF(EVP_KEYMGMT) *keymgmts = NULL;
     STACK_OF(OPENSSL_CSTRING) *names = NULL;
     int ok = 0;
 
-    if ((process_data = OPENSSL_zalloc(sizeof(*process_data))) == NULL
-        || (propquery != NULL
-            && (process_data->propq = OPENSSL_strdup(propquery)) == NULL)
-        || (keymgmts = sk_EVP_KEYMGMT_new_null()) == NULL
+    if ((keymgmts = sk_EVP_KEYMGMT_new_null()) == NULL
         || (names = sk_OPENSSL_CSTRING_new_null()) == NULL) {
         ERR_raise(ERR_LIB_OSSL_DECODER, ERR_R_MALLOC_FAILURE);
         goto err;
     }
 
-    process_data->object = (void **)pkey;
-    process_data->libctx = libctx;
-
     /* First, find all keymgmts to form goals */
     EVP_KEYMGMT_do_all_provided(libctx, collect_keymgmt, keymgmts);
 
@@ -305,13 +333,13 @@ int ossl_decoder_ctx_setup_for_pkey(OSSL_DECODER_CTX *ctx,
         if (keytype == NULL || EVP_KEYMGMT_is_a(keymgmt, keytype)) {
             if (!EVP_KEYMGMT_names_do_all(keymgmt, collect_name, names)) {
                 ERR_raise(ERR_LIB_OSSL_DECODER, ERR_R_INTERNAL_ERROR);
+                EVP_KEYMGMT_free(keymgmt);
                 goto err;
             }
         }
 
         EVP_KEYMGMT_free(keymgmt);
     }
-    sk_EVP_KEYMGMT_free(keymgmts);
 
     /*
      * Finally, find all decoders that have any keymgmt of the collected
@@ -324,26 +352,252 @@ int ossl_decoder_ctx_setup_for_pkey(OSSL_DECODER_CTX *ctx,
         collect_decoder_data.ctx = ctx;
         OSSL_DECODER_do_all_provided(libctx,
                                      collect_decoder, &collect_decoder_data);
-        sk_OPENSSL_CSTRING_free(names);
 
         if (collect_decoder_data.error_occurred)
             goto err;
     }
 
-    if (OSSL_DECODER_CTX_get_num_decoders(ctx) != 0) {
-        if (!OSSL_DECODER_CTX_set_construct(ctx, decoder_construct_pkey)
-            || !OSSL_DECODER_CTX_set_construct_data(ctx, process_data)
-            || !OSSL_DECODER_CTX_set_cleanup(ctx,
-                                             decoder_clean_pkey_construct_arg))
-            goto err;
+    ok = decoder_ctx_set_construct_pkey(ctx, pkey, libctx, propquery);
+ err:
+    sk_EVP_KEYMGMT_pop_free(keymgmts, EVP_KEYMGMT_free);
+    sk_OPENSSL_CSTRING_free(names);
+    return ok;
+}
 
-        process_data = NULL; /* Avoid it being freed */
+/*
+ * Cache of the decoder chains built by ossl_decoder_ctx_setup_for_pkey()
+ * and OSSL_DECODER_CTX_add_extra(), one per library context.  Finding the
+ * decoders means going through all the keymgmts and decoders of all the
+ * providers, which costs much more than the decoding itself.  A chain is
+ * only reused for as long as the same providers are activated, with the same
+ * default properties, as when it was built.  Once that changes, the whole
+ * cache is emptied, so that it doesn't keep unloaded providers alive.
+ */
+#define DECODER_CACHE_MAX       32
+
+typedef struct decoder_cache_st {
+    CRYPTO_RWLOCK *lock;
+    unsigned int generation;
+    struct {
+        char *key;
+        STACK_OF(OSSL_DECODER_INSTANCE) *decoder_insts;
+    } entry[DECODER_CACHE_MAX];
+} DECODER_CACHE;
+
+/* Requires that cache->lock is locked for write */
+static void decoder_cache_flush(DECODER_CACHE *cache)
+{
+    size_t i;
+
+    for (i = 0; i < DECODER_CACHE_MAX; i++) {
+        OPENSSL_free(cache->entry[i].key);
+        cache->entry[i].key = NULL;
+        sk_OSSL_DECODER_INSTANCE_pop_free(cache->entry[i].decoder_insts,
+                                          ossl_decoder_instance_free);
+        cache->entry[i].decoder_insts = NULL;
     }
+}
 
-    ok = 1;
- err:
-    decoder_clean_pkey_construct_arg(process_data);
-    return ok;
+static void *decoder_cache_new(OSSL_LIB_CTX *libctx)
+{
+    DECODER_CACHE *cache = OPENSSL_zalloc(sizeof(*cache));
+
+    if (cache == NULL)
+        return NULL;
+    if ((cache->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+        OPENSSL_free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+static void decoder_cache_free(void *vcache)
+{
+    DECODER_CACHE *cache = vcache;
+
+    if (cache == NULL)
+        return;
+    decoder_cache_flush(cache);
+    CRYPTO_THREAD_lock_free(cache->lock);
+    OPENSSL_free(cache);
+}
+
+static const OSSL_LIB_CTX_METHOD decoder_cache_method = {
+    decoder_cache_new,
+    decoder_cache_free,
+};
+
+#define OPT_STR(s)      (s) == NULL ? "" : "=", (s) == NULL ? "" : (s)
+
+/*
+ * The chain that gets built depends on the settings of |ctx|, on the
+ * arguments, and on the input types of the decoders that |ctx| already has,
+ * since OSSL_DECODER_CTX_add_extra() adds decoders for those too.
+ */
+static int decoder_cache_key(char *key, size_t keysize,
+                             const OSSL_DECODER_CTX *ctx,
+                             const char *keytype, const char *propquery)
+{
+    int i, len;
+    size_t off;
+
+    len = BIO_snprintf(key, keysize, "%d;%s%s;%s%s;%s%s;%s%s;",
+                       ctx->selection, OPT_STR(ctx->start_input_type),
+                       OPT_STR(ctx->input_structure), OPT_STR(keytype),
+                       OPT_STR(propquery));
+    for (i = 0; i < sk_OSSL_DECODER_INSTANCE_num(ctx->decoder_insts); i++) {
+        OSSL_DECODER_INSTANCE *di =
+            sk_OSSL_DECODER_INSTANCE_value(ctx->decoder_insts, i);
+
+        if (len <= 0 || (size_t)len >= keysize)
+            return 0;
+        off = (size_t)len;
+        len = BIO_snprintf(key + off, keysize - off, "%s,", di->input_type);
+        if (len > 0)
+            len += (int)off;
+    }
+    return len > 0 && (size_t)len < keysize;
+}
+
+/*
+ * Copies the decoder instances of |src| from index |first| on, and pushes
+ * them on |*dest|, creating it if needed.
+ */
+static int decoder_insts_dup(STACK_OF(OSSL_DECODER_INSTANCE) **dest,
+                             const STACK_OF(OSSL_DECODER_INSTANCE) *src,
+                             int first)
+{
+    OSSL_DECODER_INSTANCE *di;
+    int i;
+
+    if (*dest == NULL
+        && (*dest = sk_OSSL_DECODER_INSTANCE_new_null()) == NULL) {
+        ERR_raise(ERR_LIB_OSSL_DECODER, ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+    for (i = first; i < sk_OSSL_DECODER_INSTANCE_num(src); i++) {
+        if ((di = ossl_decoder_instance_dup(
+                      sk_OSSL_DECODER_INSTANCE_value(src, i))) == NULL)
+            return 0;
+        if (!sk_OSSL_DECODER_INSTANCE_push(*dest, di)) {
+            ERR_raise(ERR_LIB_OSSL_DECODER, ERR_R_MALLOC_FAILURE);
+            ossl_decoder_instance_free(di);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Adds a copy of the cached chain for |key| to |ctx|.  Returns 1 if it did,
+ * 0 if there is no such chain and -1 on error.  If the cache is outdated,
+ * it is emptied.
+ */
+static int decoder_cache_get(DECODER_CACHE *cache, const char *key,
+                             unsigned int generation, OSSL_DECODER_CTX *ctx)
+{
+    size_t i;
+    int ret = 0;
+
+    if (!CRYPTO_THREAD_read_lock(cache->lock))
+        return 0;
+    if (cache->generation != generation) {
+        CRYPTO_THREAD_unlock(cache->lock);
+        if (!CRYPTO_THREAD_write_lock(cache->lock))
+            return 0;
+        if (cache->generation != generation) {
+            decoder_cache_flush(cache);
+            cache->generation = generation;
+        }
+        CRYPTO_THREAD_unlock(cache->lock);
+        return 0;
+    }
+    for (i = 0; i < DECODER_CACHE_MAX && cache->entry[i].key != NULL; i++) {
+        if (strcmp(cache->entry[i].key, key) == 0) {
+            ret = decoder_insts_dup(&ctx->decoder_insts,
+                                    cache->entry[i].decoder_insts, 0)
+                ? 1 : -1;
+            break;
+        }
+    }
+    CRYPTO_THREAD_unlock(cache->lock);
+    return ret;
+}
+
+/*
+ * Puts a copy of the decoder instances of |ctx| from index |first| on in
+ * the cache, emptying it first if it is outdated.  If there's no room, the
+ * chain simply isn't cached.
+ */
+static void decoder_cache_put(DECODER_CACHE *cache, const char *key,
+                              unsigned int generation,
+                              const OSSL_DECODER_CTX *ctx, int first)
+{
+    STACK_OF(OSSL_DECODER_INSTANCE) *decoder_insts = NULL;
+    char *keycopy;
+    size_t i;
+
+    if ((keycopy = OPENSSL_strdup(key)) == NULL
+        || !decoder_insts_dup(&decoder_insts, ctx->decoder_insts, first))
+        goto end;
+
+    if (CRYPTO_THREAD_write_lock(cache->lock)) {
+        if (cache->generation != generation) {
+            decoder_cache_flush(cache);
+            cache->generation = generation;
+        }
+        for (i = 0; i < DECODER_CACHE_MAX; i++) {
+            if (cache->entry[i].key == NULL
+                    || strcmp(cache->entry[i].key, key) == 0)
+                break;
+        }
+        if (i < DECODER_CACHE_MAX) {
+            OPENSSL_free(cache->entry[i].key);
+            sk_OSSL_DECODER_INSTANCE_pop_free(cache->entry[i].decoder_insts,
+                                              ossl_decoder_instance_free);
+            cache->entry[i].key = keycopy;
+            cache->entry[i].decoder_insts = decoder_insts;
+            keycopy = NULL;
+            decoder_insts = NULL;
+        }
+        CRYPTO_THREAD_unlock(cache->lock);
+    }
+ end:
+    OPENSSL_free(keycopy);
+    sk_OSSL_DECODER_INSTANCE_pop_free(decoder_insts,
+                                      ossl_decoder_instance_free);
+}
+
+int ossl_decoder_ctx_setup_for_pkey_cached(OSSL_DECODER_CTX *ctx,
+                                           EVP_PKEY **pkey,
+                                           const char *keytype,
+                                           OSSL_LIB_CTX *libctx,
+                                           const char *propquery)
+{
+    DECODER_CACHE *cache;
+    unsigned int generation = ossl_provider_store_generation(libctx);
+    int first = OSSL_DECODER_CTX_get_num_decoders(ctx);
+    char key[256];
+    int cached;
+
+    cache = ossl_lib_ctx_get_data(libctx, OSSL_LIB_CTX_DECODER_CACHE_INDEX,
+                                  &decoder_cache_method);
+    if (cache == NULL
+            || !decoder_cache_key(key, sizeof(key), ctx, keytype, propquery))
+        return ossl_decoder_ctx_setup_for_pkey(ctx, pkey, keytype,
+                                               libctx, propquery)
+            && OSSL_DECODER_CTX_add_extra(ctx, libctx, propquery);
+
+    if ((cached = decoder_cache_get(cache, key, generation, ctx)) != 0)
+        return cached > 0
+            && decoder_ctx_set_construct_pkey(ctx, pkey, libctx, propquery);
+
+    if (!ossl_decoder_ctx_setup_for_pkey(ctx, pkey, keytype,
+                                         libctx, propquery)
+            || !OSSL_DECODER_CTX_add_extra(ctx, libctx, propquery))
+        return 0;
+    decoder_cache_put(cache, key, generation, ctx, first);
+    return 1;
 }
 
 OSSL_DECODER_CTX *
@@ -371,9 +625,8 @@ OSSL_DECODER_CTX_new_for_pkey(EVP_PKEY **pkey,
     if (OSSL_DECODER_CTX_set_input_type(ctx, input_type)
         && OSSL_DECODER_CTX_set_input_structure(ctx, input_structure)
         && OSSL_DECODER_CTX_set_selection(ctx, selection)
-        && ossl_decoder_ctx_setup_for_pkey(ctx, pkey, keytype,
-                                           libctx, propquery)
-        && OSSL_DECODER_CTX_add_extra(ctx, libctx, propquery)) {
+        && ossl_decoder_ctx_setup_for_pkey_cached(ctx, pkey, keytype,
+                                                  libctx, propquery)) {
         OSSL_TRACE_BEGIN(DECODER) {
             BIO_printf(trc_out, "(ctx %p) Got %d decoders\n",
                        (void *)ctx, OSSL_DECODER_CTX_get_num_decoders(ctx));
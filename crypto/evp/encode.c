@@ -20,6 +20,8 @@ static int evp_encodeblock_int(EVP_ENCODE_CTX *ctx, unsigned char *t,
                                const unsigned char *f, int dlen);
 static int evp_decodeblock_int(EVP_ENCODE_CTX *ctx, unsigned char *t,
                                const unsigned char *f, int n);
+static int evp_decode_groups(unsigned char *t, const unsigned char *f, int n,
+                             const unsigned char *table);
 
 #ifndef CHARSET_EBCDIC
 # define conv_bin2ascii(a, table)       ((table)[(a)&0x3f])
@@ -328,6 +330,22 @@ int EVP_DecodeUpdate(EVP_ENCODE_CTX *ctx, unsigned char *out, int *outl,
         table = data_ascii2bin;
 
     for (i = 0; i < inl; i++) {
+        /*
+         * Between groups, decode as much as possible straight from the input
+         * and only collect what is left over, such as line endings, padding
+         * or a partial group, in ctx->enc_data.
+         */
+        if (n == 0 && eof == 0) {
+            v = evp_decode_groups(out, in, inl - i, table);
+            in += v;
+            i += v;
+            decoded_len = v / 4 * 3;
+            out += decoded_len;
+            ret += decoded_len;
+            if (i == inl)
+                break;
+        }
+
         tmp = *(in++);
         v = conv_ascii2bin(tmp, table);
         if (v == B64_ERROR) {
@@ -456,6 +474,36 @@ static int evp_decodeblock_int(EVP_ENCODE_CTX *ctx, unsigned char *t,
     return ret;
 }
 
+/*
+ * Decode complete groups of four base64 characters from |f| for as long as
+ * they contain nothing but base64 characters, without padding.
+ * Returns the number of characters that were consumed.
+ */
+static int evp_decode_groups(unsigned char *t, const unsigned char *f, int n,
+                             const unsigned char *table)
+{
+    int i;
+    unsigned int a, b, c, d;
+    unsigned long l;
+
+    for (i = 0; i + 4 <= n; i += 4, f += 4) {
+        a = conv_ascii2bin(f[0], table);
+        b = conv_ascii2bin(f[1], table);
+        c = conv_ascii2bin(f[2], table);
+        d = conv_ascii2bin(f[3], table);
+        /* Whitespace, EOF and errors all have one of the top bits set */
+        if (((a | b | c | d) & 0xC0) != 0
+                || f[0] == '=' || f[1] == '=' || f[2] == '=' || f[3] == '=')
+            break;
+        l = ((unsigned long)a << 18) | ((unsigned long)b << 12)
+            | ((unsigned long)c << 6) | d;
+        *(t++) = (unsigned char)(l >> 16);
+        *(t++) = (unsigned char)(l >> 8);
+        *(t++) = (unsigned char)l;
+    }
+    return i;
+}
+
 int EVP_DecodeBlock(unsigned char *t, const unsigned char *f, int n)
 {
     return evp_decodeblock_int(NULL, t, f, n);
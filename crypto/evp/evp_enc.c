@@ -81,6 +81,18 @@ static int evp_cipher_init_internal(EVP_CIPHER_CTX *ctx,
 #if !defined(OPENSSL_NO_ENGINE) && !defined(FIPS_MODULE)
     ENGINE *tmpimpl = NULL;
 #endif
+
+    /*
+     * A new IV for a provided cipher that is already set up in the same
+     * direction, as a protocol does for every record, goes straight to the
+     * provider if it can take it.
+     */
+    if (cipher == NULL && key == NULL && iv != NULL && params == NULL
+            && ctx->cipher != NULL && ctx->cipher->set_iv != NULL
+            && ctx->provctx != NULL
+            && (enc == -1 || (enc != 0) == (ctx->encrypt != 0)))
+        return ctx->cipher->set_iv(ctx->provctx, iv);
+
     /*
      * enc == 1 means we are encrypting.
      * enc == 0 means we are decrypting.
@@ -1100,8 +1112,21 @@ int EVP_CIPHER_CTX_ctrl(EVP_CIPHER_CTX *ctx, int type, int arg, void *ptr)
         params[0] = OSSL_PARAM_construct_uint(OSSL_CIPHER_PARAM_SPEED, &i);
         break;
     case EVP_CTRL_AEAD_GET_TAG:
-        set_params = 0; /* Fall thru */
+        if (ctx->cipher->get_tag != NULL) {
+            if (arg < 0)
+                return 0;
+            return ctx->cipher->get_tag(ctx->provctx, ptr, sz);
+        }
+        set_params = 0;
+        params[0] = OSSL_PARAM_construct_octet_string(OSSL_CIPHER_PARAM_AEAD_TAG,
+                                                      ptr, sz);
+        break;
     case EVP_CTRL_AEAD_SET_TAG:
+        if (ctx->cipher->set_tag != NULL) {
+            if (arg < 0)
+                return 0;
+            return ctx->cipher->set_tag(ctx->provctx, ptr, sz);
+        }
         params[0] = OSSL_PARAM_construct_octet_string(OSSL_CIPHER_PARAM_AEAD_TAG,
                                                       ptr, sz);
         break;
@@ -1545,6 +1570,21 @@ static void *evp_cipher_from_dispatch(const int name_id,
             cipher->settable_ctx_params =
                 OSSL_FUNC_cipher_settable_ctx_params(fns);
             break;
+        case OSSL_FUNC_CIPHER_GET_TAG:
+            if (cipher->get_tag != NULL)
+                break;
+            cipher->get_tag = OSSL_FUNC_cipher_get_tag(fns);
+            break;
+        case OSSL_FUNC_CIPHER_SET_TAG:
+            if (cipher->set_tag != NULL)
+                break;
+            cipher->set_tag = OSSL_FUNC_cipher_set_tag(fns);
+            break;
+        case OSSL_FUNC_CIPHER_SET_IV:
+            if (cipher->set_iv != NULL)
+                break;
+            cipher->set_iv = OSSL_FUNC_cipher_set_iv(fns);
+            break;
         }
     }
     if ((fnciphcnt != 0 && fnciphcnt != 3 && fnciphcnt != 4)
@@ -392,6 +392,7 @@ static int evp_set_parsed_default_properties(OSSL_LIB_CTX *libctx,
         *plp = def_prop;
         if (store != NULL)
             ossl_method_store_flush_cache(store, 0);
+        ossl_provider_store_new_generation(libctx);
         return 1;
     }
     ERR_raise(ERR_LIB_EVP, ERR_R_INTERNAL_ERROR);
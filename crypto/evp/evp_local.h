@@ -72,6 +72,7 @@ struct evp_rand_ctx_st {
     EVP_RAND_CTX *parent;       /* Parent EVP_RAND or NULL if none */
     CRYPTO_REF_COUNT refcnt;    /* Context reference count */
     CRYPTO_RWLOCK *refcnt_lock;
+    size_t max_request;         /* Cached maximum request size or 0 */
 } /* EVP_RAND_CTX */ ;
 
 struct evp_keymgmt_st {
@@ -130,6 +131,7 @@ struct evp_keyexch_st {
     OSSL_FUNC_keyexch_settable_ctx_params_fn *settable_ctx_params;
     OSSL_FUNC_keyexch_get_ctx_params_fn *get_ctx_params;
     OSSL_FUNC_keyexch_gettable_ctx_params_fn *gettable_ctx_params;
+    OSSL_FUNC_keyexch_derive_batch_fn *derive_batch;
 } /* EVP_KEYEXCH */;
 
 struct evp_signature_st {
@@ -153,6 +155,7 @@ struct evp_signature_st {
     OSSL_FUNC_signature_digest_verify_update_fn *digest_verify_update;
     OSSL_FUNC_signature_digest_verify_final_fn *digest_verify_final;
     OSSL_FUNC_signature_digest_verify_fn *digest_verify;
+    OSSL_FUNC_signature_digest_verify_batch_fn *digest_verify_batch;
     OSSL_FUNC_signature_freectx_fn *freectx;
     OSSL_FUNC_signature_dupctx_fn *dupctx;
     OSSL_FUNC_signature_get_ctx_params_fn *get_ctx_params;
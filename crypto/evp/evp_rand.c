@@ -403,6 +403,8 @@ int EVP_RAND_get_ctx_params(EVP_RAND_CTX *ctx, OSSL_PARAM params[])
 static int evp_rand_set_ctx_params_locked(EVP_RAND_CTX *ctx,
                                           const OSSL_PARAM params[])
 {
+    /* Any parameter change can alter the maximum request size */
+    ctx->max_request = 0;
     if (ctx->meth->set_ctx_params != NULL)
         return ctx->meth->set_ctx_params(ctx->data, params);
     return 1;
@@ -489,6 +491,7 @@ static int evp_rand_instantiate_locked
     (EVP_RAND_CTX *ctx, unsigned int strength, int prediction_resistance,
      const unsigned char *pstr, size_t pstr_len, const OSSL_PARAM params[])
 {
+    ctx->max_request = 0;
     return ctx->meth->instantiate(ctx->data, strength, prediction_resistance,
                                   pstr, pstr_len, params);
 }
@@ -530,15 +533,23 @@ static int evp_rand_generate_locked(EVP_RAND_CTX *ctx, unsigned char *out,
                                     const unsigned char *addin,
                                     size_t addin_len)
 {
-    size_t chunk, max_request = 0;
+    size_t chunk, max_request = ctx->max_request;
     OSSL_PARAM params[2] = { OSSL_PARAM_END, OSSL_PARAM_END };
 
-    params[0] = OSSL_PARAM_construct_size_t(OSSL_RAND_PARAM_MAX_REQUEST,
-                                            &max_request);
-    if (!evp_rand_get_ctx_params_locked(ctx, params)
-            || max_request == 0) {
-        ERR_raise(ERR_LIB_EVP, EVP_R_UNABLE_TO_GET_MAXIMUM_REQUEST_SIZE);
-        return 0;
+    /*
+     * Querying the maximum request size is a parameter round trip into the
+     * provider, so only do it once and reuse the answer for subsequent
+     * generate calls.  It is reset whenever the context is reconfigured.
+     */
+    if (max_request == 0) {
+        params[0] = OSSL_PARAM_construct_size_t(OSSL_RAND_PARAM_MAX_REQUEST,
+                                                &max_request);
+        if (!evp_rand_get_ctx_params_locked(ctx, params)
+                || max_request == 0) {
+            ERR_raise(ERR_LIB_EVP, EVP_R_UNABLE_TO_GET_MAXIMUM_REQUEST_SIZE);
+            return 0;
+        }
+        ctx->max_request = max_request;
     }
     for (; outlen > 0; outlen -= chunk, out += chunk) {
         chunk = outlen > max_request ? max_request : outlen;
@@ -77,6 +77,11 @@ static void *evp_keyexch_from_dispatch(int name_id,
             exchange->derive = OSSL_FUNC_keyexch_derive(fns);
             fncnt++;
             break;
+        case OSSL_FUNC_KEYEXCH_DERIVE_BATCH:
+            if (exchange->derive_batch != NULL)
+                break;
+            exchange->derive_batch = OSSL_FUNC_keyexch_derive_batch(fns);
+            break;
         case OSSL_FUNC_KEYEXCH_FREECTX:
             if (exchange->freectx != NULL)
                 break;
@@ -125,7 +130,7 @@ static void *evp_keyexch_from_dispatch(int name_id,
          * and freectx. The set_ctx_params and settable_ctx_params functions are
          * optional, but if one of them is present then the other one must also
          * be present. Same goes for get_ctx_params and gettable_ctx_params.
-         * The dupctx and set_peer functions are optional.
+         * The dupctx, set_peer and derive_batch functions are optional.
          */
         ERR_raise(ERR_LIB_EVP, EVP_R_INVALID_PROVIDER_FUNCTIONS);
         goto err;
@@ -441,6 +446,33 @@ int EVP_PKEY_derive(EVP_PKEY_CTX *ctx, unsigned char *key, size_t *pkeylen)
         return ctx->pmeth->derive(ctx, key, pkeylen);
 }
 
+int EVP_PKEY_derive_batch(EVP_PKEY_CTX *ctx, size_t num,
+                          const unsigned char *const peers[],
+                          const size_t peerlens[],
+                          unsigned char *const secrets[], size_t *secretlen,
+                          int results[])
+{
+    if (ctx == NULL || secretlen == NULL) {
+        ERR_raise(ERR_LIB_EVP, ERR_R_PASSED_NULL_PARAMETER);
+        return -1;
+    }
+
+    if (!EVP_PKEY_CTX_IS_DERIVE_OP(ctx)) {
+        ERR_raise(ERR_LIB_EVP, EVP_R_OPERATION_NOT_INITIALIZED);
+        return -1;
+    }
+
+    if (ctx->op.kex.exchprovctx == NULL
+            || ctx->op.kex.exchange->derive_batch == NULL) {
+        ERR_raise(ERR_LIB_EVP, EVP_R_OPERATION_NOT_SUPPORTED_FOR_THIS_KEYTYPE);
+        return -2;
+    }
+
+    return ctx->op.kex.exchange->derive_batch(ctx->op.kex.exchprovctx, num,
+                                              peers, peerlens, secrets,
+                                              secretlen, *secretlen, results);
+}
+
 int EVP_KEYEXCH_number(const EVP_KEYEXCH *keyexch)
 {
     return keyexch->name_id;
@@ -305,15 +305,23 @@ int EVP_DigestSignInit_ex(EVP_MD_CTX *ctx, EVP_PKEY_CTX **pctx,
                           const char *props, EVP_PKEY *pkey,
                           OSSL_PARAM params[])
 {
-    return do_sigver_init(ctx, pctx, NULL, mdname, libctx, props, NULL, pkey, 0,
-                          params);
+    int traced = CRYPTO_alloc_trace_enter("EVP_DigestSignInit");
+    int ret = do_sigver_init(ctx, pctx, NULL, mdname, libctx, props, NULL,
+                             pkey, 0, params);
+
+    CRYPTO_alloc_trace_leave(traced);
+    return ret;
 }
 
 int EVP_DigestSignInit(EVP_MD_CTX *ctx, EVP_PKEY_CTX **pctx,
                        const EVP_MD *type, ENGINE *e, EVP_PKEY *pkey)
 {
-    return do_sigver_init(ctx, pctx, type, NULL, NULL, NULL, e, pkey, 0,
-                          NULL);
+    int traced = CRYPTO_alloc_trace_enter("EVP_DigestSignInit");
+    int ret = do_sigver_init(ctx, pctx, type, NULL, NULL, NULL, e, pkey, 0,
+                             NULL);
+
+    CRYPTO_alloc_trace_leave(traced);
+    return ret;
 }
 
 int EVP_DigestVerifyInit_ex(EVP_MD_CTX *ctx, EVP_PKEY_CTX **pctx,
@@ -589,4 +597,46 @@ int EVP_DigestVerify(EVP_MD_CTX *ctx, const unsigned char *sigret,
         return -1;
     return EVP_DigestVerifyFinal(ctx, sigret, siglen);
 }
+
+int EVP_DigestVerifyBatch(EVP_MD_CTX *ctx, size_t num,
+                          const unsigned char *const sigs[],
+                          const size_t siglens[],
+                          const unsigned char *const tbs[],
+                          const size_t tbslens[], int results[])
+{
+    EVP_PKEY_CTX *pctx = ctx->pctx;
+    size_t i;
+    int ret = 1;
+
+    if (pctx == NULL) {
+        ERR_raise(ERR_LIB_EVP, EVP_R_NO_OPERATION_SET);
+        return -1;
+    }
+
+    if (pctx->operation == EVP_PKEY_OP_VERIFYCTX
+            && pctx->op.sig.sigprovctx != NULL
+            && pctx->op.sig.signature != NULL) {
+        if (pctx->op.sig.signature->digest_verify_batch != NULL)
+            return pctx->op.sig.signature->digest_verify_batch(
+                       pctx->op.sig.sigprovctx, num, sigs, siglens,
+                       tbs, tbslens, results);
+        if (pctx->op.sig.signature->digest_verify == NULL)
+            goto unsupported;
+    } else if (pctx->pmeth == NULL || pctx->pmeth->digestverify == NULL) {
+        goto unsupported;
+    }
+
+    /* One-shot verification can be repeated, so do that for each item */
+    for (i = 0; i < num; i++) {
+        results[i] = EVP_DigestVerify(ctx, sigs[i], siglens[i],
+                                      tbs[i], tbslens[i]) == 1;
+        if (!results[i])
+            ret = 0;
+    }
+    return ret;
+
+ unsupported:
+    ERR_raise(ERR_LIB_EVP, EVP_R_OPERATION_NOT_SUPPORTED_FOR_THIS_KEYTYPE);
+    return -2;
+}
 #endif /* FIPS_MODULE */
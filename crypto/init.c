@@ -455,6 +455,9 @@ void OPENSSL_cleanup(void)
     OSSL_TRACE(INIT, "OPENSSL_cleanup: ossl_trace_cleanup()\n");
     ossl_trace_cleanup();
 
+    OSSL_TRACE(INIT, "OPENSSL_cleanup: ossl_alloc_trace_cleanup()\n");
+    ossl_alloc_trace_cleanup();
+
     base_inited = 0;
 }
 
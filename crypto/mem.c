@@ -14,6 +14,7 @@
 #include <stdlib.h>
 #include <limits.h>
 #include <openssl/crypto.h>
+#include "internal/thread_once.h"
 
 /*
  * the following pointers may be changed as long as 'allow_customize' is set
@@ -23,6 +24,18 @@ static CRYPTO_malloc_fn malloc_impl = CRYPTO_malloc;
 static CRYPTO_realloc_fn realloc_impl = CRYPTO_realloc;
 static CRYPTO_free_fn free_impl = CRYPTO_free;
 
+/*
+ * Allocation tracing.  When a callback is set, every call to CRYPTO_malloc(),
+ * CRYPTO_realloc() and CRYPTO_free() is reported to it, along with the name
+ * of the outermost public function that the calling thread is in, as set by
+ * CRYPTO_alloc_trace_enter().
+ */
+static CRYPTO_alloc_trace_cb alloc_trace_cb = NULL;
+static void *alloc_trace_arg;
+static CRYPTO_ONCE alloc_trace_once = CRYPTO_ONCE_STATIC_INIT;
+static CRYPTO_THREAD_LOCAL alloc_trace_api;
+static int alloc_trace_inited = 0;
+
 #if !defined(OPENSSL_NO_CRYPTO_MDEBUG) && !defined(FIPS_MODULE)
 # include "internal/tsan_assist.h"
 
@@ -75,6 +88,56 @@ void CRYPTO_get_mem_functions(CRYPTO_malloc_fn *malloc_fn,
         *free_fn = free_impl;
 }
 
+DEFINE_RUN_ONCE_STATIC(do_alloc_trace_init)
+{
+    alloc_trace_inited = CRYPTO_THREAD_init_local(&alloc_trace_api, NULL);
+    return alloc_trace_inited;
+}
+
+void ossl_alloc_trace_cleanup(void)
+{
+    alloc_trace_cb = NULL;
+    if (alloc_trace_inited) {
+        CRYPTO_THREAD_cleanup_local(&alloc_trace_api);
+        alloc_trace_inited = 0;
+    }
+}
+
+int CRYPTO_set_alloc_trace_cb(CRYPTO_alloc_trace_cb cb, void *arg)
+{
+    if (cb != NULL
+            && (!RUN_ONCE(&alloc_trace_once, do_alloc_trace_init)
+                || !alloc_trace_inited))
+        return 0;
+    alloc_trace_arg = arg;
+    alloc_trace_cb = cb;
+    return 1;
+}
+
+int CRYPTO_alloc_trace_enter(const char *api)
+{
+    /* Only the outermost function gets the allocations */
+    if (alloc_trace_cb == NULL
+            || CRYPTO_THREAD_get_local(&alloc_trace_api) != NULL)
+        return 0;
+    return CRYPTO_THREAD_set_local(&alloc_trace_api, (void *)api);
+}
+
+void CRYPTO_alloc_trace_leave(int entered)
+{
+    if (entered)
+        CRYPTO_THREAD_set_local(&alloc_trace_api, NULL);
+}
+
+static void alloc_trace(int op, size_t num, const char *file, int line)
+{
+    CRYPTO_alloc_trace_cb cb = alloc_trace_cb;
+
+    if (cb != NULL)
+        cb(op, CRYPTO_THREAD_get_local(&alloc_trace_api), num, file, line,
+           alloc_trace_arg);
+}
+
 #if !defined(OPENSSL_NO_CRYPTO_MDEBUG) && !defined(FIPS_MODULE)
 void CRYPTO_get_alloc_counts(int *mcount, int *rcount, int *fcount)
 {
@@ -165,6 +228,8 @@ void ossl_malloc_setup_failures(void)
 void *CRYPTO_malloc(size_t num, const char *file, int line)
 {
     INCREMENT(malloc_count);
+    if (alloc_trace_cb != NULL)
+        alloc_trace(CRYPTO_ALLOC_TRACE_MALLOC, num, file, line);
     if (malloc_impl != CRYPTO_malloc)
         return malloc_impl(num, file, line);
 
@@ -199,10 +264,14 @@ void *CRYPTO_zalloc(size_t num, const char *file, int line)
 void *CRYPTO_realloc(void *str, size_t num, const char *file, int line)
 {
     INCREMENT(realloc_count);
-    if (realloc_impl != CRYPTO_realloc)
+    if (realloc_impl != CRYPTO_realloc) {
+        if (alloc_trace_cb != NULL)
+            alloc_trace(CRYPTO_ALLOC_TRACE_REALLOC, num, file, line);
         return realloc_impl(str, num, file, line);
+    }
 
     FAILTEST();
+    /* These two are only reported as the malloc or free they turn into */
     if (str == NULL)
         return CRYPTO_malloc(num, file, line);
 
@@ -211,6 +280,8 @@ void *CRYPTO_realloc(void *str, size_t num, const char *file, int line)
         return NULL;
     }
 
+    if (alloc_trace_cb != NULL)
+        alloc_trace(CRYPTO_ALLOC_TRACE_REALLOC, num, file, line);
     return realloc(str, num);
 }
 
@@ -244,6 +315,8 @@ void *CRYPTO_clear_realloc(void *str, size_t old_len, size_t num,
 void CRYPTO_free(void *str, const char *file, int line)
 {
     INCREMENT(free_count);
+    if (alloc_trace_cb != NULL && str != NULL)
+        alloc_trace(CRYPTO_ALLOC_TRACE_FREE, 0, file, line);
     if (free_impl != CRYPTO_free) {
         free_impl(str, file, line);
         return;
@@ -17,6 +17,7 @@
  */
 #include "e_os.h"
 #include <openssl/crypto.h>
+#include "crypto/cryptlib.h"
 
 #include <string.h>
 
@@ -66,6 +67,9 @@ static int secure_mem_initialized;
 
 static CRYPTO_RWLOCK *sec_malloc_lock = NULL;
 
+/* The number of times sec_malloc_lock was taken to allocate or free */
+static uint64_t secure_mem_lock_count;
+
 /*
  * These are the functions that must be implemented by a secure heap (sh).
  */
@@ -75,6 +79,144 @@ static void sh_free(void *ptr);
 static void sh_done(void);
 static size_t sh_actual_size(char *ptr);
 static int sh_allocated(const char *ptr);
+static size_t sh_arena_size(void);
+static size_t sh_minsize(void);
+static size_t sh_used(void);
+static size_t sh_largest_free(void);
+
+/*
+ * Each thread keeps a few freed blocks of the smallest sizes, so that most
+ * allocations and frees of short-lived secrets do not have to take
+ * sec_malloc_lock.  The blocks in these caches are cleansed, and remain
+ * allocated as far as the secure heap is concerned.
+ *
+ * As secure_mem_used is then updated without the lock, the caches are only
+ * used where that can be done atomically.
+ */
+# if defined(__GNUC__) && defined(__ATOMIC_RELAXED) \
+     && defined(__GCC_ATOMIC_POINTER_LOCK_FREE) \
+     && __GCC_ATOMIC_POINTER_LOCK_FREE >= 2
+#  define SH_THREAD_CACHE
+#  define sh_used_add(n) __atomic_add_fetch(&secure_mem_used, (n), __ATOMIC_RELAXED)
+#  define sh_used_sub(n) __atomic_sub_fetch(&secure_mem_used, (n), __ATOMIC_RELAXED)
+#  define sh_used_get() __atomic_load_n(&secure_mem_used, __ATOMIC_RELAXED)
+# else
+#  define sh_used_add(n) (secure_mem_used += (n))
+#  define sh_used_sub(n) (secure_mem_used -= (n))
+#  define sh_used_get() (secure_mem_used)
+# endif
+
+# ifdef SH_THREAD_CACHE
+/* Blocks of up to minsize << (SH_CACHE_CLASSES - 1) bytes are cached */
+#  define SH_CACHE_CLASSES  6
+#  define SH_CACHE_DEPTH    8
+/* A thread holds no more than 1 / SH_CACHE_SHARE of the secure heap */
+#  define SH_CACHE_SHARE    256
+
+typedef struct sh_cache_st {
+    unsigned int generation;
+    size_t size;                /* Bytes held in |blocks| */
+    int count[SH_CACHE_CLASSES];
+    char *blocks[SH_CACHE_CLASSES][SH_CACHE_DEPTH];
+} SH_CACHE;
+
+static CRYPTO_THREAD_LOCAL sec_thread_local;
+
+/*
+ * Bumped whenever the secure heap is torn down, so that the thread caches
+ * still referring to it can tell.
+ */
+static unsigned int secure_mem_generation;
+
+/* Must be called with sec_malloc_lock held */
+static void sh_cache_flush(SH_CACHE *tcache)
+{
+    int i;
+
+    for (i = 0; i < SH_CACHE_CLASSES; i++)
+        while (tcache->count[i] > 0)
+            sh_free(tcache->blocks[i][--tcache->count[i]]);
+    tcache->size = 0;
+}
+
+static void sh_cache_delete_thread_state(void *arg)
+{
+    SH_CACHE *tcache = arg;
+
+    if (secure_mem_initialized && tcache->generation == secure_mem_generation) {
+        CRYPTO_THREAD_set_local(&sec_thread_local, NULL);
+        if (CRYPTO_THREAD_write_lock(sec_malloc_lock)) {
+            sh_cache_flush(tcache);
+            CRYPTO_THREAD_unlock(sec_malloc_lock);
+        }
+    }
+    OPENSSL_free(tcache);
+}
+
+static SH_CACHE *sh_cache_get(void)
+{
+    SH_CACHE *tcache = CRYPTO_THREAD_get_local(&sec_thread_local);
+
+    if (tcache != NULL)
+        return tcache;
+
+    if (!OPENSSL_init_crypto(OPENSSL_INIT_BASE_ONLY, NULL)
+            || (tcache = OPENSSL_zalloc(sizeof(*tcache))) == NULL)
+        return NULL;
+    tcache->generation = secure_mem_generation;
+    if (!CRYPTO_THREAD_set_local(&sec_thread_local, tcache)) {
+        OPENSSL_free(tcache);
+        return NULL;
+    }
+    /* The handler is given |tcache| rather than a library context */
+    if (!ossl_init_thread_start(NULL, tcache, sh_cache_delete_thread_state)) {
+        CRYPTO_THREAD_set_local(&sec_thread_local, NULL);
+        OPENSSL_free(tcache);
+        return NULL;
+    }
+    return tcache;
+}
+
+/* Return the cache class of blocks of |size| bytes, or -1 if not cached */
+static int sh_cache_class(size_t size)
+{
+    size_t i;
+    int cls = 0;
+
+    for (i = sh_minsize(); i < size; i <<= 1)
+        if (++cls == SH_CACHE_CLASSES)
+            return -1;
+    return cls;
+}
+
+static void *sh_cache_pop(size_t num)
+{
+    SH_CACHE *tcache;
+    int cls = sh_cache_class(num);
+
+    if (cls < 0
+            || (tcache = CRYPTO_THREAD_get_local(&sec_thread_local)) == NULL
+            || tcache->count[cls] == 0)
+        return NULL;
+    tcache->size -= sh_minsize() << cls;
+    return tcache->blocks[cls][--tcache->count[cls]];
+}
+
+static int sh_cache_push(char *ptr, size_t actual_size)
+{
+    SH_CACHE *tcache;
+    int cls = sh_cache_class(actual_size);
+
+    if (cls < 0
+            || (tcache = sh_cache_get()) == NULL
+            || tcache->count[cls] == SH_CACHE_DEPTH
+            || tcache->size + actual_size > sh_arena_size() / SH_CACHE_SHARE)
+        return 0;
+    tcache->blocks[cls][tcache->count[cls]++] = ptr;
+    tcache->size += actual_size;
+    return 1;
+}
+# endif
 #endif
 
 int CRYPTO_secure_malloc_init(size_t size, size_t minsize)
@@ -86,9 +228,19 @@ int CRYPTO_secure_malloc_init(size_t size, size_t minsize)
         sec_malloc_lock = CRYPTO_THREAD_lock_new();
         if (sec_malloc_lock == NULL)
             return 0;
+# ifdef SH_THREAD_CACHE
+        if (!CRYPTO_THREAD_init_local(&sec_thread_local, NULL)) {
+            CRYPTO_THREAD_lock_free(sec_malloc_lock);
+            sec_malloc_lock = NULL;
+            return 0;
+        }
+# endif
         if ((ret = sh_init(size, minsize)) != 0) {
             secure_mem_initialized = 1;
         } else {
+# ifdef SH_THREAD_CACHE
+            CRYPTO_THREAD_cleanup_local(&sec_thread_local);
+# endif
             CRYPTO_THREAD_lock_free(sec_malloc_lock);
             sec_malloc_lock = NULL;
         }
@@ -100,12 +252,23 @@ int CRYPTO_secure_malloc_init(size_t size, size_t minsize)
 #endif /* OPENSSL_NO_SECURE_MEMORY */
 }
 
+/*
+ * Blocks in the thread caches do not count as used, so this may tear down
+ * the secure heap while they refer to it.  The caches are marked stale by
+ * bumping secure_mem_generation, and freed when their threads stop.
+ */
 int CRYPTO_secure_malloc_done(void)
 {
 #ifndef OPENSSL_NO_SECURE_MEMORY
-    if (secure_mem_used == 0) {
+    if (sh_used_get() == 0) {
+# ifdef SH_THREAD_CACHE
+        secure_mem_generation++;
+        CRYPTO_THREAD_set_local(&sec_thread_local, NULL);
+        CRYPTO_THREAD_cleanup_local(&sec_thread_local);
+# endif
         sh_done();
         secure_mem_initialized = 0;
+        secure_mem_lock_count = 0;
         CRYPTO_THREAD_lock_free(sec_malloc_lock);
         sec_malloc_lock = NULL;
         return 1;
@@ -132,11 +295,29 @@ void *CRYPTO_secure_malloc(size_t num, const char *file, int line)
     if (!secure_mem_initialized) {
         return CRYPTO_malloc(num, file, line);
     }
+# ifdef SH_THREAD_CACHE
+    if ((ret = sh_cache_pop(num)) != NULL) {
+        sh_used_add(sh_actual_size(ret));
+        return ret;
+    }
+# endif
     if (!CRYPTO_THREAD_write_lock(sec_malloc_lock))
         return NULL;
+    secure_mem_lock_count++;
     ret = sh_malloc(num);
+# ifdef SH_THREAD_CACHE
+    if (ret == NULL) {
+        SH_CACHE *tcache = CRYPTO_THREAD_get_local(&sec_thread_local);
+
+        /* Give this thread's cached blocks back and try again */
+        if (tcache != NULL && tcache->size > 0) {
+            sh_cache_flush(tcache);
+            ret = sh_malloc(num);
+        }
+    }
+# endif
     actual_size = ret ? sh_actual_size(ret) : 0;
-    secure_mem_used += actual_size;
+    sh_used_add(actual_size);
     CRYPTO_THREAD_unlock(sec_malloc_lock);
     return ret;
 #else
@@ -154,24 +335,38 @@ void *CRYPTO_secure_zalloc(size_t num, const char *file, int line)
     return CRYPTO_zalloc(num, file, line);
 }
 
+#ifndef OPENSSL_NO_SECURE_MEMORY
+/* Cleanse and free |ptr|, which must have been allocated from the arena */
+static void secure_free(void *ptr)
+{
+    size_t actual_size = sh_actual_size(ptr);
+
+    CLEAR(ptr, actual_size);
+# ifdef SH_THREAD_CACHE
+    if (sh_cache_push(ptr, actual_size)) {
+        sh_used_sub(actual_size);
+        return;
+    }
+# endif
+    if (!CRYPTO_THREAD_write_lock(sec_malloc_lock))
+        return;
+    secure_mem_lock_count++;
+    sh_used_sub(actual_size);
+    sh_free(ptr);
+    CRYPTO_THREAD_unlock(sec_malloc_lock);
+}
+#endif
+
 void CRYPTO_secure_free(void *ptr, const char *file, int line)
 {
 #ifndef OPENSSL_NO_SECURE_MEMORY
-    size_t actual_size;
-
     if (ptr == NULL)
         return;
     if (!CRYPTO_secure_allocated(ptr)) {
         CRYPTO_free(ptr, file, line);
         return;
     }
-    if (!CRYPTO_THREAD_write_lock(sec_malloc_lock))
-        return;
-    actual_size = sh_actual_size(ptr);
-    CLEAR(ptr, actual_size);
-    secure_mem_used -= actual_size;
-    sh_free(ptr);
-    CRYPTO_THREAD_unlock(sec_malloc_lock);
+    secure_free(ptr);
 #else
     CRYPTO_free(ptr, file, line);
 #endif /* OPENSSL_NO_SECURE_MEMORY */
@@ -181,8 +376,6 @@ void CRYPTO_secure_clear_free(void *ptr, size_t num,
                               const char *file, int line)
 {
 #ifndef OPENSSL_NO_SECURE_MEMORY
-    size_t actual_size;
-
     if (ptr == NULL)
         return;
     if (!CRYPTO_secure_allocated(ptr)) {
@@ -190,13 +383,7 @@ void CRYPTO_secure_clear_free(void *ptr, size_t num,
         CRYPTO_free(ptr, file, line);
         return;
     }
-    if (!CRYPTO_THREAD_write_lock(sec_malloc_lock))
-        return;
-    actual_size = sh_actual_size(ptr);
-    CLEAR(ptr, actual_size);
-    secure_mem_used -= actual_size;
-    sh_free(ptr);
-    CRYPTO_THREAD_unlock(sec_malloc_lock);
+    secure_free(ptr);
 #else
     if (ptr == NULL)
         return;
@@ -205,18 +392,16 @@ void CRYPTO_secure_clear_free(void *ptr, size_t num,
 #endif /* OPENSSL_NO_SECURE_MEMORY */
 }
 
+/*
+ * The bounds of the arena do not change while the secure heap is
+ * initialised, so there is no need to take the lock to check them.
+ */
 int CRYPTO_secure_allocated(const void *ptr)
 {
 #ifndef OPENSSL_NO_SECURE_MEMORY
-    int ret;
-
     if (!secure_mem_initialized)
         return 0;
-    if (!CRYPTO_THREAD_write_lock(sec_malloc_lock))
-        return 0;
-    ret = sh_allocated(ptr);
-    CRYPTO_THREAD_unlock(sec_malloc_lock);
-    return ret;
+    return sh_allocated(ptr);
 #else
     return 0;
 #endif /* OPENSSL_NO_SECURE_MEMORY */
@@ -225,7 +410,7 @@ int CRYPTO_secure_allocated(const void *ptr)
 size_t CRYPTO_secure_used(void)
 {
 #ifndef OPENSSL_NO_SECURE_MEMORY
-    return secure_mem_used;
+    return sh_used_get();
 #else
     return 0;
 #endif /* OPENSSL_NO_SECURE_MEMORY */
@@ -234,18 +419,40 @@ size_t CRYPTO_secure_used(void)
 size_t CRYPTO_secure_actual_size(void *ptr)
 {
 #ifndef OPENSSL_NO_SECURE_MEMORY
-    size_t actual_size;
-
-    if (!CRYPTO_THREAD_write_lock(sec_malloc_lock))
-        return 0;
-    actual_size = sh_actual_size(ptr);
-    CRYPTO_THREAD_unlock(sec_malloc_lock);
-    return actual_size;
+    return sh_actual_size(ptr);
 #else
     return 0;
 #endif
 }
 
+void CRYPTO_secure_get_stats(size_t *free_size, size_t *largest_free,
+                             size_t *cached, uint64_t *lock_count)
+{
+    size_t fsize = 0, lfree = 0, csize = 0;
+    uint64_t lcount = 0;
+
+#ifndef OPENSSL_NO_SECURE_MEMORY
+    if (secure_mem_initialized && CRYPTO_THREAD_read_lock(sec_malloc_lock)) {
+        fsize = sh_arena_size() - sh_used();
+        lfree = sh_largest_free();
+        /* The cached blocks are the allocated ones nobody is using */
+        csize = sh_used() - CRYPTO_secure_used();
+        if (csize > sh_used())
+            csize = 0;
+        lcount = secure_mem_lock_count;
+        CRYPTO_THREAD_unlock(sec_malloc_lock);
+    }
+#endif /* OPENSSL_NO_SECURE_MEMORY */
+    if (free_size != NULL)
+        *free_size = fsize;
+    if (largest_free != NULL)
+        *largest_free = lfree;
+    if (cached != NULL)
+        *cached = csize;
+    if (lock_count != NULL)
+        *lock_count = lcount;
+}
+
 /*
  * SECURE HEAP IMPLEMENTATION
  */
@@ -297,6 +504,12 @@ typedef struct sh_st
     unsigned char *bittable;
     unsigned char *bitmalloc;
     size_t bittable_size; /* size in bits */
+    /*
+     * The list of the block allocated at each "sh.minsize" unit, so that the
+     * size of a block can be found by its owner without taking the lock.
+     */
+    unsigned char *blocklist;
+    size_t used; /* Bytes allocated from the free lists */
 } SH;
 
 static SH sh;
@@ -455,6 +668,11 @@ static int sh_init(size_t size, size_t minsize)
     if (sh.bitmalloc == NULL)
         goto err;
 
+    sh.blocklist = OPENSSL_zalloc(sh.arena_size / sh.minsize);
+    OPENSSL_assert(sh.blocklist != NULL);
+    if (sh.blocklist == NULL)
+        goto err;
+
     /* Allocate space for heap, and two extra pages as guards */
 #if defined(_SC_PAGE_SIZE) || defined (_SC_PAGESIZE)
     {
@@ -560,6 +778,7 @@ static void sh_done(void)
     OPENSSL_free(sh.freelist);
     OPENSSL_free(sh.bittable);
     OPENSSL_free(sh.bitmalloc);
+    OPENSSL_free(sh.blocklist);
 #if !defined(_WIN32)
     if (sh.map_result != MAP_FAILED && sh.map_size)
         munmap(sh.map_result, sh.map_size);
@@ -575,6 +794,21 @@ static int sh_allocated(const char *ptr)
     return WITHIN_ARENA(ptr) ? 1 : 0;
 }
 
+static size_t sh_arena_size(void)
+{
+    return sh.arena_size;
+}
+
+static size_t sh_minsize(void)
+{
+    return sh.minsize;
+}
+
+static size_t sh_used(void)
+{
+    return sh.used;
+}
+
 static char *sh_find_my_buddy(char *ptr, int list)
 {
     size_t bit;
@@ -651,6 +885,8 @@ static void *sh_malloc(size_t size)
     /* zero the free list header as a precaution against information leakage */
     memset(chunk, 0, sizeof(SH_LIST));
 
+    sh.blocklist[(chunk - sh.arena) / sh.minsize] = (unsigned char)list;
+    sh.used += sh.arena_size >> list;
     return chunk;
 }
 
@@ -669,6 +905,7 @@ static void sh_free(void *ptr)
     OPENSSL_assert(sh_testbit(ptr, list, sh.bittable));
     sh_clearbit(ptr, list, sh.bitmalloc);
     sh_add_to_list(&sh.freelist[list], ptr);
+    sh.used -= sh.arena_size >> list;
 
     /* Try to coalesce two adjacent free areas. */
     while ((buddy = sh_find_my_buddy(ptr, list)) != NULL) {
@@ -695,15 +932,26 @@ static void sh_free(void *ptr)
     }
 }
 
+/*
+ * This only reads the entry of |ptr| in the block list, which does not
+ * change while the block is allocated, so its owner can call it without
+ * holding the lock.
+ */
 static size_t sh_actual_size(char *ptr)
 {
-    int list;
-
     OPENSSL_assert(WITHIN_ARENA(ptr));
     if (!WITHIN_ARENA(ptr))
         return 0;
-    list = sh_getlist(ptr);
-    OPENSSL_assert(sh_testbit(ptr, list, sh.bittable));
-    return sh.arena_size / (ONE << list);
+    return sh.arena_size >> sh.blocklist[(ptr - sh.arena) / sh.minsize];
+}
+
+static size_t sh_largest_free(void)
+{
+    ossl_ssize_t list;
+
+    for (list = 0; list < sh.freelist_size; list++)
+        if (sh.freelist[list] != NULL)
+            return sh.arena_size >> list;
+    return 0;
 }
 #endif /* OPENSSL_NO_SECURE_MEMORY */
@@ -97,6 +97,25 @@ static size_t maxmaxsize(size_t lenbytes)
     return ((size_t)1 << (lenbytes * 8)) - 1 + lenbytes;
 }
 
+static WPACKET_SUB *wpacket_sub_new(WPACKET *pkt)
+{
+    WPACKET_SUB *sub;
+
+    if (pkt->arena != NULL)
+        sub = ossl_arena_zalloc(pkt->arena, sizeof(*sub));
+    else
+        sub = OPENSSL_zalloc(sizeof(*sub));
+    if (sub == NULL)
+        ERR_raise(ERR_LIB_SSL, ERR_R_MALLOC_FAILURE);
+    return sub;
+}
+
+static void wpacket_sub_free(WPACKET *pkt, WPACKET_SUB *sub)
+{
+    if (pkt->arena == NULL)
+        OPENSSL_free(sub);
+}
+
 static int wpacket_intern_init_len(WPACKET *pkt, size_t lenbytes)
 {
     unsigned char *lenchars;
@@ -104,10 +123,8 @@ static int wpacket_intern_init_len(WPACKET *pkt, size_t lenbytes)
     pkt->curr = 0;
     pkt->written = 0;
 
-    if ((pkt->subs = OPENSSL_zalloc(sizeof(*pkt->subs))) == NULL) {
-        ERR_raise(ERR_LIB_SSL, ERR_R_MALLOC_FAILURE);
+    if ((pkt->subs = wpacket_sub_new(pkt)) == NULL)
         return 0;
-    }
 
     if (lenbytes == 0)
         return 1;
@@ -116,7 +133,7 @@ static int wpacket_intern_init_len(WPACKET *pkt, size_t lenbytes)
     pkt->subs->lenbytes = lenbytes;
 
     if (!WPACKET_allocate_bytes(pkt, lenbytes, &lenchars)) {
-        OPENSSL_free(pkt->subs);
+        wpacket_sub_free(pkt, pkt->subs);
         pkt->subs = NULL;
         return 0;
     }
@@ -138,6 +155,7 @@ int WPACKET_init_static_len(WPACKET *pkt, unsigned char *buf, size_t len,
     pkt->buf = NULL;
     pkt->maxsize = (max < len) ? max : len;
     pkt->endfirst = 0;
+    pkt->arena = NULL;
 
     return wpacket_intern_init_len(pkt, lenbytes);
 }
@@ -152,6 +170,7 @@ int WPACKET_init_der(WPACKET *pkt, unsigned char *buf, size_t len)
     pkt->buf = NULL;
     pkt->maxsize = len;
     pkt->endfirst = 1;
+    pkt->arena = NULL;
 
     return wpacket_intern_init_len(pkt, 0);
 }
@@ -166,6 +185,7 @@ int WPACKET_init_len(WPACKET *pkt, BUF_MEM *buf, size_t lenbytes)
     pkt->buf = buf;
     pkt->maxsize = maxmaxsize(lenbytes);
     pkt->endfirst = 0;
+    pkt->arena = NULL;
 
     return wpacket_intern_init_len(pkt, lenbytes);
 }
@@ -175,12 +195,28 @@ int WPACKET_init(WPACKET *pkt, BUF_MEM *buf)
     return WPACKET_init_len(pkt, buf, 0);
 }
 
+int WPACKET_init_arena(WPACKET *pkt, BUF_MEM *buf, OSSL_ARENA *arena)
+{
+    /* Internal API, so should not fail */
+    if (!ossl_assert(buf != NULL && arena != NULL))
+        return 0;
+
+    pkt->staticbuf = NULL;
+    pkt->buf = buf;
+    pkt->maxsize = maxmaxsize(0);
+    pkt->endfirst = 0;
+    pkt->arena = arena;
+
+    return wpacket_intern_init_len(pkt, 0);
+}
+
 int WPACKET_init_null(WPACKET *pkt, size_t lenbytes)
 {
     pkt->staticbuf = NULL;
     pkt->buf = NULL;
     pkt->maxsize = maxmaxsize(lenbytes);
     pkt->endfirst = 0;
+    pkt->arena = NULL;
 
     return wpacket_intern_init_len(pkt, 0);
 }
@@ -191,6 +227,7 @@ int WPACKET_init_null_der(WPACKET *pkt)
     pkt->buf = NULL;
     pkt->maxsize = SIZE_MAX;
     pkt->endfirst = 1;
+    pkt->arena = NULL;
 
     return wpacket_intern_init_len(pkt, 0);
 }
@@ -285,7 +322,7 @@ static int wpacket_intern_close(WPACKET *pkt, WPACKET_SUB *sub, int doclose)
 
     if (doclose) {
         pkt->subs = sub->parent;
-        OPENSSL_free(sub);
+        wpacket_sub_free(pkt, sub);
     }
 
     return 1;
@@ -331,7 +368,7 @@ int WPACKET_finish(WPACKET *pkt)
 
     ret = wpacket_intern_close(pkt, pkt->subs, 1);
     if (ret) {
-        OPENSSL_free(pkt->subs);
+        wpacket_sub_free(pkt, pkt->subs);
         pkt->subs = NULL;
     }
 
@@ -351,10 +388,8 @@ int WPACKET_start_sub_packet_len__(WPACKET *pkt, size_t lenbytes)
     if (lenbytes > 0 && pkt->endfirst)
         return 0;
 
-    if ((sub = OPENSSL_zalloc(sizeof(*sub))) == NULL) {
-        ERR_raise(ERR_LIB_SSL, ERR_R_MALLOC_FAILURE);
+    if ((sub = wpacket_sub_new(pkt)) == NULL)
         return 0;
-    }
 
     sub->parent = pkt->subs;
     pkt->subs = sub;
@@ -506,7 +541,7 @@ void WPACKET_cleanup(WPACKET *pkt)
 
     for (sub = pkt->subs; sub != NULL; sub = parent) {
         parent = sub->parent;
-        OPENSSL_free(sub);
+        wpacket_sub_free(pkt, sub);
     }
     pkt->subs = NULL;
 }
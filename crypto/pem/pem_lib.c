@@ -793,21 +793,32 @@ enum header_status {
     POST_HEADER
 };
 
+/* Append the NUL terminated |line| to |buf|. */
+static int append_line(BUF_MEM *buf, const char *line)
+{
+    size_t used = buf->length, len = strlen(line);
+
+    if (BUF_MEM_grow_clean(buf, used + len) == 0)
+        return 0;
+    memcpy(buf->data + used, line, len);
+    return 1;
+}
+
 /**
  * Extract the optional PEM header, with details on the type of content and
  * any encryption used on the contents, and the bulk of the data from the bio.
  * The end of the header is marked by a blank line; if the end-of-input marker
  * is reached prior to a blank line, there is no header.
  *
- * The header and data arguments are BIO** since we may have to swap them
+ * The header and data arguments are BUF_MEM** since we may have to swap them
  * if there is no header, for efficiency.
  *
  * We need the name of the PEM-encoded type to verify the end string.
  */
-static int get_header_and_data(BIO *bp, BIO **header, BIO **data, char *name,
-                               unsigned int flags)
+static int get_header_and_data(BIO *bp, BUF_MEM **header, BUF_MEM **data,
+                               char *name, unsigned int flags)
 {
-    BIO *tmp = *header;
+    BUF_MEM *tmp = *header;
     char *linebuf, *p;
     int len, line, ret = 0, end = 0, prev_partial_line_read = 0, partial_line_read = 0;
     /* 0 if not seen (yet), 1 if reading header, 2 if finished header */
@@ -888,7 +899,7 @@ static int get_header_and_data(BIO *bp, BIO **header, BIO **data, char *name,
          * Else, a line of text -- could be header or data; we don't
          * know yet.  Just pass it through.
          */
-        if (BIO_puts(tmp, linebuf) < 0)
+        if (!append_line(tmp, linebuf))
             goto err;
         /*
          * Only encrypted files need the line length check applied.
@@ -918,11 +929,10 @@ int PEM_read_bio_ex(BIO *bp, char **name_out, char **header,
                     unsigned char **data, long *len_out, unsigned int flags)
 {
     EVP_ENCODE_CTX *ctx = NULL;
-    const BIO_METHOD *bmeth;
-    BIO *headerB = NULL, *dataB = NULL;
+    unsigned long bflags;
+    BUF_MEM *headerB = NULL, *dataB = NULL;
     char *name = NULL;
-    int len, taillen, headerlen, ret = 0;
-    BUF_MEM * buf_mem;
+    int len, taillen, ret = 0;
 
     *len_out = 0;
     *name_out = *header = NULL;
@@ -932,10 +942,10 @@ int PEM_read_bio_ex(BIO *bp, char **name_out, char **header,
         ERR_raise(ERR_LIB_PEM, ERR_R_PASSED_INVALID_ARGUMENT);
         goto end;
     }
-    bmeth = (flags & PEM_FLAG_SECURE) ? BIO_s_secmem() : BIO_s_mem();
+    bflags = (flags & PEM_FLAG_SECURE) ? BUF_MEM_FLAG_SECURE : 0;
 
-    headerB = BIO_new(bmeth);
-    dataB = BIO_new(bmeth);
+    headerB = BUF_MEM_new_ex(bflags);
+    dataB = BUF_MEM_new_ex(bflags);
     if (headerB == NULL || dataB == NULL) {
         ERR_raise(ERR_LIB_PEM, ERR_R_MALLOC_FAILURE);
         goto end;
@@ -946,8 +956,7 @@ int PEM_read_bio_ex(BIO *bp, char **name_out, char **header,
     if (!get_header_and_data(bp, &headerB, &dataB, name, flags))
         goto end;
 
-    BIO_get_mem_ptr(dataB, &buf_mem);
-    len = buf_mem->length;
+    len = dataB->length;
 
     /* There was no data in the PEM file */
     if (len == 0)
@@ -959,28 +968,27 @@ int PEM_read_bio_ex(BIO *bp, char **name_out, char **header,
         goto end;
     }
 
+    /* Decode in place, the buffers are then handed over without copying */
     EVP_DecodeInit(ctx);
-    if (EVP_DecodeUpdate(ctx, (unsigned char*)buf_mem->data, &len,
-                         (unsigned char*)buf_mem->data, len) < 0
-            || EVP_DecodeFinal(ctx, (unsigned char*)&(buf_mem->data[len]),
+    if (EVP_DecodeUpdate(ctx, (unsigned char*)dataB->data, &len,
+                         (unsigned char*)dataB->data, len) < 0
+            || EVP_DecodeFinal(ctx, (unsigned char*)&(dataB->data[len]),
                                &taillen) < 0) {
         ERR_raise(ERR_LIB_PEM, PEM_R_BAD_BASE64_DECODE);
         goto end;
     }
     len += taillen;
-    buf_mem->length = len;
-
-    headerlen = BIO_get_mem_data(headerB, NULL);
-    *header = pem_malloc(headerlen + 1, flags);
-    *data = pem_malloc(len, flags);
-    if (*header == NULL || *data == NULL) {
-        pem_free(*header, flags, 0);
-        pem_free(*data, flags, 0);
+
+    /* NUL terminate the header */
+    if (BUF_MEM_grow_clean(headerB, headerB->length + 1) == 0)
         goto end;
-    }
-    BIO_read(headerB, *header, headerlen);
-    (*header)[headerlen] = '\0';
-    BIO_read(dataB, *data, len);
+    /* What follows the data is the rest of the base64 text, don't leak it */
+    OPENSSL_cleanse(dataB->data + len, dataB->max - len);
+
+    *header = headerB->data;
+    headerB->data = NULL;
+    *data = (unsigned char *)dataB->data;
+    dataB->data = NULL;
     *len_out = len;
     *name_out = name;
     name = NULL;
@@ -989,8 +997,8 @@ int PEM_read_bio_ex(BIO *bp, char **name_out, char **header,
 end:
     EVP_ENCODE_CTX_free(ctx);
     pem_free(name, flags, 0);
-    BIO_free(headerB);
-    BIO_free(dataB);
+    BUF_MEM_free(headerB);
+    BUF_MEM_free(dataB);
     return ret;
 }
 
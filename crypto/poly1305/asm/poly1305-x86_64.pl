@@ -2913,6 +2913,7 @@ poly1305_blocks_vpmadd52:
 	test		$len,$len
 	jnz		.Lblocks_vpmadd52_4x
 
+	vzeroupper
 .Lno_data_vpmadd52:
 	ret
 .cfi_endproc
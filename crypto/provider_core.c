@@ -21,6 +21,7 @@
 #include "internal/thread_once.h"
 #include "internal/provider.h"
 #include "internal/refcount.h"
+#include "internal/tsan_assist.h"
 #include "internal/bio.h"
 #include "provider_local.h"
 #ifndef FIPS_MODULE
@@ -116,6 +117,11 @@ struct provider_store_st {
     STACK_OF(OSSL_PROVIDER) *providers;
     CRYPTO_RWLOCK *lock;
     char *default_path;
+    /*
+     * Changes whenever a provider gets activated or deactivated, or the
+     * default properties change
+     */
+    TSAN_QUALIFIER unsigned int generation;
     unsigned int use_fallbacks:1;
 };
 
@@ -201,6 +207,21 @@ static struct provider_store_st *get_provider_store(OSSL_LIB_CTX *libctx)
     return store;
 }
 
+unsigned int ossl_provider_store_generation(OSSL_LIB_CTX *libctx)
+{
+    struct provider_store_st *store = get_provider_store(libctx);
+
+    return store == NULL ? 0 : tsan_load(&store->generation);
+}
+
+void ossl_provider_store_new_generation(OSSL_LIB_CTX *libctx)
+{
+    struct provider_store_st *store = get_provider_store(libctx);
+
+    if (store != NULL)
+        tsan_counter(&store->generation);
+}
+
 int ossl_provider_disable_fallback_loading(OSSL_LIB_CTX *libctx)
 {
     struct provider_store_st *store;
@@ -679,6 +700,8 @@ static int provider_deactivate(OSSL_PROVIDER *prov)
             return 0;
         prov->flag_activated = 0;
         CRYPTO_THREAD_unlock(prov->flag_lock);
+        if (prov->store != NULL)
+            tsan_counter(&prov->store->generation);
     }
 
     /* We don't deinit here, that's done in ossl_provider_free() */
@@ -697,6 +720,8 @@ static int provider_activate(OSSL_PROVIDER *prov)
             return 0;
         prov->flag_activated = 1;
         CRYPTO_THREAD_unlock(prov->flag_lock);
+        if (ref == 1 && prov->store != NULL)
+            tsan_counter(&prov->store->generation);
 
         return 1;
     }
@@ -417,6 +417,9 @@ typedef struct rand_global_st {
     /* Allow the randomness source to be changed */
     char *seed_name;
     char *seed_propq;
+
+    /* Size of the output buffer of the <public> DRBGs, zero for none */
+    size_t public_buffer_size;
 } RAND_GLOBAL;
 
 /*
@@ -672,6 +675,22 @@ EVP_RAND_CTX *RAND_get0_public(OSSL_LIB_CTX *ctx)
             return NULL;
         rand = rand_new_drbg(ctx, primary, SECONDARY_RESEED_INTERVAL,
                              SECONDARY_RESEED_TIME_INTERVAL);
+        /*
+         * The <public> DRBG only produces non-secret output, so it can
+         * serve small requests from a buffer of pre-generated output.
+         * Not all DRBGs support this, so a failure isn't fatal.
+         */
+        if (rand != NULL && dgbl->public_buffer_size > 0) {
+            OSSL_PARAM params[2];
+
+            params[0] =
+                OSSL_PARAM_construct_size_t(OSSL_DRBG_PARAM_BUFFER_SIZE,
+                                            &dgbl->public_buffer_size);
+            params[1] = OSSL_PARAM_construct_end();
+            ERR_set_mark();
+            EVP_RAND_set_ctx_params(rand, params);
+            ERR_pop_to_mark();
+        }
         CRYPTO_THREAD_set_local(&dgbl->public, rand);
     }
     return rand;
@@ -767,6 +786,18 @@ static int random_conf_init(CONF_IMODULE *md, const CONF *cnf)
         } else if (strcasecmp(cval->name, "seed_properties") == 0) {
             if (!random_set_string(&dgbl->seed_propq, cval->value))
                 return 0;
+        } else if (strcasecmp(cval->name, "public_buffer_size") == 0) {
+            long size;
+
+            if (!NCONF_get_number_e(cnf, CONF_imodule_get_value(md),
+                                    cval->name, &size)
+                    || size < 0) {
+                ERR_raise_data(ERR_LIB_CRYPTO,
+                               CRYPTO_R_RANDOM_SECTION_ERROR,
+                               "name=%s, value=%s", cval->name, cval->value);
+                return 0;
+            }
+            dgbl->public_buffer_size = (size_t)size;
         } else {
             ERR_raise_data(ERR_LIB_CRYPTO,
                            CRYPTO_R_UNKNOWN_NAME_IN_RANDOM_SECTION,
@@ -16,6 +16,7 @@
 #include <stdio.h>
 #include <openssl/crypto.h>
 #include "internal/cryptlib.h"
+#include "crypto/cryptlib.h"
 #include "crypto/bn.h"
 #include <openssl/rand.h>
 #include "rsa_local.h"
@@ -173,3 +174,176 @@ BN_BLINDING *RSA_setup_blinding(RSA *rsa, BN_CTX *in_ctx)
 
     return ret;
 }
+
+/*
+ * Each thread keeps blinding parameters of its own for the last few keys it
+ * used, so that a key shared between threads can be used for private key
+ * operations without taking its lock.  Entries are matched on the public
+ * key rather than on the RSA object, so that a freed key whose address is
+ * reused can never pass its blinding on to a different key.
+ */
+#define RSA_BLINDING_CACHE_SIZE 8
+
+typedef struct rsa_blinding_entry_st {
+    BIGNUM *n;
+    BIGNUM *e;
+    BN_MONT_CTX *mont;
+    BN_BLINDING *blinding;
+} RSA_BLINDING_ENTRY;
+
+typedef struct rsa_blinding_thread_cache_st {
+    /* Most recently used first, unused entries at the end */
+    RSA_BLINDING_ENTRY entries[RSA_BLINDING_CACHE_SIZE];
+} RSA_BLINDING_THREAD_CACHE;
+
+typedef struct rsa_blinding_cache_st {
+    CRYPTO_THREAD_LOCAL local;
+} RSA_BLINDING_CACHE;
+
+static void rsa_blinding_entry_free(RSA_BLINDING_ENTRY *ent)
+{
+    BN_BLINDING_free(ent->blinding);
+    BN_MONT_CTX_free(ent->mont);
+    BN_free(ent->n);
+    BN_free(ent->e);
+    memset(ent, 0, sizeof(*ent));
+}
+
+static void *rsa_blinding_cache_new(OSSL_LIB_CTX *libctx)
+{
+    RSA_BLINDING_CACHE *cache = OPENSSL_zalloc(sizeof(*cache));
+
+    if (cache == NULL)
+        return NULL;
+
+#ifndef FIPS_MODULE
+    /* Make sure the base libcrypto thread handling has been initialised */
+    OPENSSL_init_crypto(OPENSSL_INIT_BASE_ONLY, NULL);
+#endif
+
+    if (!CRYPTO_THREAD_init_local(&cache->local, NULL)) {
+        OPENSSL_free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+static void rsa_blinding_cache_free(void *vcache)
+{
+    RSA_BLINDING_CACHE *cache = vcache;
+
+    if (cache == NULL)
+        return;
+    CRYPTO_THREAD_cleanup_local(&cache->local);
+    OPENSSL_free(cache);
+}
+
+static const OSSL_LIB_CTX_METHOD rsa_blinding_cache_method = {
+    rsa_blinding_cache_new,
+    rsa_blinding_cache_free,
+};
+
+static RSA_BLINDING_CACHE *rsa_blinding_get_cache(OSSL_LIB_CTX *libctx)
+{
+    return ossl_lib_ctx_get_data(libctx, OSSL_LIB_CTX_RSA_BLINDING_INDEX,
+                                 &rsa_blinding_cache_method);
+}
+
+static void rsa_blinding_delete_thread_state(void *arg)
+{
+    RSA_BLINDING_CACHE *cache = rsa_blinding_get_cache(arg);
+    RSA_BLINDING_THREAD_CACHE *tcache;
+    int i;
+
+    if (cache == NULL)
+        return;
+
+    tcache = CRYPTO_THREAD_get_local(&cache->local);
+    CRYPTO_THREAD_set_local(&cache->local, NULL);
+    if (tcache != NULL) {
+        for (i = 0; i < RSA_BLINDING_CACHE_SIZE; i++)
+            rsa_blinding_entry_free(&tcache->entries[i]);
+        OPENSSL_free(tcache);
+    }
+}
+
+static RSA_BLINDING_THREAD_CACHE *
+rsa_blinding_get_thread_cache(OSSL_LIB_CTX *libctx, RSA_BLINDING_CACHE *cache)
+{
+    RSA_BLINDING_THREAD_CACHE *tcache = CRYPTO_THREAD_get_local(&cache->local);
+
+    if (tcache != NULL)
+        return tcache;
+
+    libctx = ossl_lib_ctx_get_concrete(libctx);
+    if ((tcache = OPENSSL_zalloc(sizeof(*tcache))) == NULL)
+        return NULL;
+    if (!ossl_init_thread_start(NULL, libctx,
+                                rsa_blinding_delete_thread_state)
+            || !CRYPTO_THREAD_set_local(&cache->local, tcache)) {
+        OPENSSL_free(tcache);
+        return NULL;
+    }
+    return tcache;
+}
+
+/*
+ * Get the calling thread's blinding for |rsa|, creating it if needed.  The
+ * result belongs to this thread alone, so it can be converted and inverted
+ * without locking and keeps the unblinding factor inside the BN_BLINDING.
+ * Returns NULL if there is none to be had, in particular when the public
+ * exponent isn't known.
+ */
+BN_BLINDING *ossl_rsa_get_thread_blinding(RSA *rsa, BN_CTX *ctx)
+{
+    RSA_BLINDING_CACHE *cache;
+    RSA_BLINDING_THREAD_CACHE *tcache;
+    RSA_BLINDING_ENTRY *ents, ent;
+    BIGNUM *n;
+    int i;
+
+    if (rsa->n == NULL || rsa->e == NULL
+            || (cache = rsa_blinding_get_cache(rsa->libctx)) == NULL
+            || (tcache = rsa_blinding_get_thread_cache(rsa->libctx,
+                                                       cache)) == NULL)
+        return NULL;
+    ents = tcache->entries;
+
+    for (i = 0; i < RSA_BLINDING_CACHE_SIZE && ents[i].blinding != NULL; i++) {
+        if (BN_cmp(ents[i].n, rsa->n) != 0 || BN_cmp(ents[i].e, rsa->e) != 0)
+            continue;
+        if (i > 0) {
+            ent = ents[i];
+            memmove(&ents[1], &ents[0], i * sizeof(*ents));
+            ents[0] = ent;
+        }
+        return ents[0].blinding;
+    }
+
+    /*
+     * Not seen on this thread yet.  The entry gets a Montgomery context of
+     * its own, since it may well outlive the key's one.
+     */
+    memset(&ent, 0, sizeof(ent));
+    if ((ent.n = BN_dup(rsa->n)) == NULL
+            || (ent.e = BN_dup(rsa->e)) == NULL
+            || (ent.mont = BN_MONT_CTX_new()) == NULL
+            || !BN_MONT_CTX_set(ent.mont, rsa->n, ctx)
+            || (n = BN_new()) == NULL)
+        goto err;
+    BN_with_flags(n, rsa->n, BN_FLG_CONSTTIME);
+    ent.blinding = BN_BLINDING_create_param(NULL, rsa->e, n, ctx,
+                                            rsa->meth->bn_mod_exp, ent.mont);
+    BN_free(n);
+    if (ent.blinding == NULL)
+        goto err;
+
+    rsa_blinding_entry_free(&ents[RSA_BLINDING_CACHE_SIZE - 1]);
+    memmove(&ents[1], &ents[0], (RSA_BLINDING_CACHE_SIZE - 1) * sizeof(*ents));
+    ents[0] = ent;
+    return ents[0].blinding;
+
+ err:
+    rsa_blinding_entry_free(&ent);
+    return NULL;
+}
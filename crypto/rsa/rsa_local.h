@@ -168,6 +168,8 @@ RSA_PRIME_INFO *ossl_rsa_multip_info_new(void);
 int ossl_rsa_multip_calc_product(RSA *rsa);
 int ossl_rsa_multip_cap(int bits);
 
+BN_BLINDING *ossl_rsa_get_thread_blinding(RSA *rsa, BN_CTX *ctx);
+
 int ossl_rsa_sp800_56b_validate_strength(int nbits, int strength);
 int ossl_rsa_check_pminusq_diff(BIGNUM *diff, const BIGNUM *p, const BIGNUM *q,
                                 int nbits);
@@ -13,8 +13,10 @@
  */
 #include "internal/deprecated.h"
 
+#include <openssl/trace.h>
 #include "internal/cryptlib.h"
 #include "crypto/bn.h"
+#include "crypto/rsa.h"
 #include "rsa_local.h"
 #include "internal/constant_time.h"
 
@@ -71,6 +73,89 @@ const RSA_METHOD *RSA_null_method(void)
     return NULL;
 }
 
+/*
+ * Set up the Montgomery context |*pmont| for |mod| if it isn't there yet.
+ * On keys prepared with ossl_rsa_precompute() this never has anything to do,
+ * so having to do it on the operation path is worth a trace message.
+ */
+static BN_MONT_CTX *rsa_mont_ctx_set(BN_MONT_CTX **pmont, RSA *rsa,
+                                     const BIGNUM *mod, BN_CTX *ctx,
+                                     const char *what)
+{
+#ifndef FIPS_MODULE
+    OSSL_TRACE_BEGIN(RSA) {
+        BN_MONT_CTX *mont = NULL;
+
+        if (CRYPTO_THREAD_read_lock(rsa->lock)) {
+            mont = *pmont;
+            CRYPTO_THREAD_unlock(rsa->lock);
+        }
+        if (mont == NULL)
+            BIO_printf(trc_out, "RSA key %p: setting up Montgomery context"
+                       " for %s\n", (void *)rsa, what);
+    } OSSL_TRACE_END(RSA);
+#endif
+    return BN_MONT_CTX_set_locked(pmont, rsa->lock, mod, ctx);
+}
+
+/*
+ * Build the Montgomery contexts that the operations on |rsa| need, so that
+ * the first of them doesn't have to.  Keys with a method of their own are
+ * left alone, as that method may not use them.
+ */
+int ossl_rsa_precompute(RSA *rsa)
+{
+    BN_CTX *ctx;
+    BIGNUM *factor = NULL;
+    int ret = 0;
+#ifndef FIPS_MODULE
+    RSA_PRIME_INFO *pinfo;
+    int i;
+#endif
+
+    if (rsa->meth != &rsa_pkcs1_ossl_meth || rsa->n == NULL)
+        return 1;
+
+    if ((ctx = ossl_bn_ctx_acquire(rsa->libctx, 0)) == NULL)
+        return 0;
+
+    if ((rsa->flags & RSA_FLAG_CACHE_PUBLIC)
+            && !BN_MONT_CTX_set_locked(&rsa->_method_mod_n, rsa->lock,
+                                       rsa->n, ctx))
+        goto err;
+
+    if ((rsa->flags & RSA_FLAG_CACHE_PRIVATE) == 0
+            || rsa->p == NULL || rsa->q == NULL) {
+        ret = 1;
+        goto err;
+    }
+
+    if ((factor = BN_new()) == NULL)
+        goto err;
+    /* As in rsa_ossl_mod_exp(), the inversions must be constant time */
+    BN_with_flags(factor, rsa->p, BN_FLG_CONSTTIME);
+    if (!BN_MONT_CTX_set_locked(&rsa->_method_mod_p, rsa->lock, factor, ctx))
+        goto err;
+    BN_with_flags(factor, rsa->q, BN_FLG_CONSTTIME);
+    if (!BN_MONT_CTX_set_locked(&rsa->_method_mod_q, rsa->lock, factor, ctx))
+        goto err;
+#ifndef FIPS_MODULE
+    for (i = 0; i < sk_RSA_PRIME_INFO_num(rsa->prime_infos); i++) {
+        pinfo = sk_RSA_PRIME_INFO_value(rsa->prime_infos, i);
+        BN_with_flags(factor, pinfo->r, BN_FLG_CONSTTIME);
+        if (!BN_MONT_CTX_set_locked(&pinfo->m, rsa->lock, factor, ctx))
+            goto err;
+    }
+#endif
+    ret = 1;
+
+ err:
+    /* We MUST free |factor| before any further use of the prime factors */
+    BN_free(factor);
+    ossl_bn_ctx_release(ctx);
+    return ret;
+}
+
 static int rsa_ossl_public_encrypt(int flen, const unsigned char *from,
                                   unsigned char *to, RSA *rsa, int padding)
 {
@@ -97,7 +182,7 @@ static int rsa_ossl_public_encrypt(int flen, const unsigned char *from,
         }
     }
 
-    if ((ctx = BN_CTX_new_ex(rsa->libctx)) == NULL)
+    if ((ctx = ossl_bn_ctx_acquire(rsa->libctx, 0)) == NULL)
         goto err;
     BN_CTX_start(ctx);
     f = BN_CTX_get(ctx);
@@ -139,8 +224,7 @@ static int rsa_ossl_public_encrypt(int flen, const unsigned char *from,
     }
 
     if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
-        if (!BN_MONT_CTX_set_locked(&rsa->_method_mod_n, rsa->lock,
-                                    rsa->n, ctx))
+        if (!rsa_mont_ctx_set(&rsa->_method_mod_n, rsa, rsa->n, ctx, "n"))
             goto err;
 
     if (!rsa->meth->bn_mod_exp(ret, f, rsa->e, rsa->n, ctx,
@@ -154,7 +238,7 @@ static int rsa_ossl_public_encrypt(int flen, const unsigned char *from,
     r = BN_bn2binpad(ret, to, num);
  err:
     BN_CTX_end(ctx);
-    BN_CTX_free(ctx);
+    ossl_bn_ctx_release(ctx);
     OPENSSL_clear_free(buf, num);
     return r;
 }
@@ -163,6 +247,12 @@ static BN_BLINDING *rsa_get_blinding(RSA *rsa, int *local, BN_CTX *ctx)
 {
     BN_BLINDING *ret;
 
+    /* Normally the calling thread has blinding of its own for this key */
+    if ((ret = ossl_rsa_get_thread_blinding(rsa, ctx)) != NULL) {
+        *local = 1;
+        return ret;
+    }
+
     if (!CRYPTO_THREAD_write_lock(rsa->lock))
         return NULL;
 
@@ -252,7 +342,7 @@ static int rsa_ossl_private_encrypt(int flen, const unsigned char *from,
     BIGNUM *unblind = NULL;
     BN_BLINDING *blinding = NULL;
 
-    if ((ctx = BN_CTX_new_ex(rsa->libctx)) == NULL)
+    if ((ctx = ossl_bn_ctx_acquire(rsa->libctx, 0)) == NULL)
         goto err;
     BN_CTX_start(ctx);
     f = BN_CTX_get(ctx);
@@ -291,8 +381,7 @@ static int rsa_ossl_private_encrypt(int flen, const unsigned char *from,
     }
 
     if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
-        if (!BN_MONT_CTX_set_locked(&rsa->_method_mod_n, rsa->lock,
-                                    rsa->n, ctx))
+        if (!rsa_mont_ctx_set(&rsa->_method_mod_n, rsa, rsa->n, ctx, "n"))
             goto err;
 
     if (!(rsa->flags & RSA_FLAG_NO_BLINDING)) {
@@ -363,7 +452,7 @@ static int rsa_ossl_private_encrypt(int flen, const unsigned char *from,
     r = BN_bn2binpad(res, to, num);
  err:
     BN_CTX_end(ctx);
-    BN_CTX_free(ctx);
+    ossl_bn_ctx_release(ctx);
     OPENSSL_clear_free(buf, num);
     return r;
 }
@@ -384,7 +473,7 @@ static int rsa_ossl_private_decrypt(int flen, const unsigned char *from,
     BIGNUM *unblind = NULL;
     BN_BLINDING *blinding = NULL;
 
-    if ((ctx = BN_CTX_new_ex(rsa->libctx)) == NULL)
+    if ((ctx = ossl_bn_ctx_acquire(rsa->libctx, 0)) == NULL)
         goto err;
     BN_CTX_start(ctx);
     f = BN_CTX_get(ctx);
@@ -453,8 +542,8 @@ static int rsa_ossl_private_decrypt(int flen, const unsigned char *from,
         BN_with_flags(d, rsa->d, BN_FLG_CONSTTIME);
 
         if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
-            if (!BN_MONT_CTX_set_locked(&rsa->_method_mod_n, rsa->lock,
-                                        rsa->n, ctx)) {
+            if (!rsa_mont_ctx_set(&rsa->_method_mod_n, rsa, rsa->n, ctx,
+                                  "n")) {
                 BN_free(d);
                 goto err;
             }
@@ -501,7 +590,7 @@ static int rsa_ossl_private_decrypt(int flen, const unsigned char *from,
 
  err:
     BN_CTX_end(ctx);
-    BN_CTX_free(ctx);
+    ossl_bn_ctx_release(ctx);
     OPENSSL_clear_free(buf, num);
     return r;
 }
@@ -533,7 +622,7 @@ static int rsa_ossl_public_decrypt(int flen, const unsigned char *from,
         }
     }
 
-    if ((ctx = BN_CTX_new_ex(rsa->libctx)) == NULL)
+    if ((ctx = ossl_bn_ctx_acquire(rsa->libctx, 0)) == NULL)
         goto err;
     BN_CTX_start(ctx);
     f = BN_CTX_get(ctx);
@@ -563,8 +652,7 @@ static int rsa_ossl_public_decrypt(int flen, const unsigned char *from,
     }
 
     if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
-        if (!BN_MONT_CTX_set_locked(&rsa->_method_mod_n, rsa->lock,
-                                    rsa->n, ctx))
+        if (!rsa_mont_ctx_set(&rsa->_method_mod_n, rsa, rsa->n, ctx, "n"))
             goto err;
 
     if (!rsa->meth->bn_mod_exp(ret, f, rsa->e, rsa->n, ctx,
@@ -598,7 +686,7 @@ static int rsa_ossl_public_decrypt(int flen, const unsigned char *from,
 
  err:
     BN_CTX_end(ctx);
-    BN_CTX_free(ctx);
+    ossl_bn_ctx_release(ctx);
     OPENSSL_clear_free(buf, num);
     return r;
 }
@@ -642,11 +730,10 @@ static int rsa_ossl_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
          * BN_FLG_CONSTTIME flag
          */
         if (!(BN_with_flags(factor, rsa->p, BN_FLG_CONSTTIME),
-              BN_MONT_CTX_set_locked(&rsa->_method_mod_p, rsa->lock,
-                                     factor, ctx))
+              rsa_mont_ctx_set(&rsa->_method_mod_p, rsa, factor, ctx, "p"))
             || !(BN_with_flags(factor, rsa->q, BN_FLG_CONSTTIME),
-                 BN_MONT_CTX_set_locked(&rsa->_method_mod_q, rsa->lock,
-                                        factor, ctx))) {
+                 rsa_mont_ctx_set(&rsa->_method_mod_q, rsa, factor, ctx,
+                                  "q"))) {
             BN_free(factor);
             goto err;
         }
@@ -654,7 +741,8 @@ static int rsa_ossl_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
         for (i = 0; i < ex_primes; i++) {
             pinfo = sk_RSA_PRIME_INFO_value(rsa->prime_infos, i);
             BN_with_flags(factor, pinfo->r, BN_FLG_CONSTTIME);
-            if (!BN_MONT_CTX_set_locked(&pinfo->m, rsa->lock, factor, ctx)) {
+            if (!rsa_mont_ctx_set(&pinfo->m, rsa, factor, ctx,
+                                  "a further prime")) {
                 BN_free(factor);
                 goto err;
             }
@@ -673,8 +761,7 @@ static int rsa_ossl_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
     }
 
     if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
-        if (!BN_MONT_CTX_set_locked(&rsa->_method_mod_n, rsa->lock,
-                                    rsa->n, ctx))
+        if (!rsa_mont_ctx_set(&rsa->_method_mod_n, rsa, rsa->n, ctx, "n"))
             goto err;
 
     if (smooth) {
@@ -688,15 +775,17 @@ static int rsa_ossl_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
         if (/* m1 = I moq q */
             !bn_from_mont_fixed_top(m1, I, rsa->_method_mod_q, ctx)
             || !bn_to_mont_fixed_top(m1, m1, rsa->_method_mod_q, ctx)
-            /* m1 = m1^dmq1 mod q */
-            || !BN_mod_exp_mont_consttime(m1, m1, rsa->dmq1, rsa->q, ctx,
-                                          rsa->_method_mod_q)
             /* r1 = I mod p */
             || !bn_from_mont_fixed_top(r1, I, rsa->_method_mod_p, ctx)
             || !bn_to_mont_fixed_top(r1, r1, rsa->_method_mod_p, ctx)
-            /* r1 = r1^dmp1 mod p */
-            || !BN_mod_exp_mont_consttime(r1, r1, rsa->dmp1, rsa->p, ctx,
-                                          rsa->_method_mod_p)
+            /*
+             * m1 = m1^dmq1 mod q and r1 = r1^dmp1 mod p, computed in
+             * parallel where the platform supports it
+             */
+            || !ossl_bn_mod_exp_mont_consttime_x2(m1, m1, rsa->dmq1, rsa->q,
+                                                  rsa->_method_mod_q,
+                                                  r1, r1, rsa->dmp1, rsa->p,
+                                                  rsa->_method_mod_p, ctx)
             /* r1 = (r1 - m1) mod p */
             /*
              * bn_mod_sub_fixed_top is not regular modular subtraction,
@@ -380,6 +380,130 @@ static int check_sig_alg_match(const EVP_PKEY *issuer_key, const X509 *subject)
     return X509_V_ERR_SIGNATURE_ALGORITHM_MISMATCH;
 }
 
+/*
+ * Extensions that are kept decoded in the X509 structure can also be
+ * decoded one at a time, so that looking at one of them does not cost
+ * decoding all the others.  x->ex_lazy records which have been decoded,
+ * and which of those turned out to be invalid.
+ */
+#define LAZY_SKID       0
+#define LAZY_AKID       1
+#define LAZY_ALTNAME    2
+#define LAZY_NC         3
+#define LAZY_ADDR       4
+#define LAZY_ASID       5
+#define LAZY_DONE(w)    (1 << (w))
+#define LAZY_INVALID(w) (1 << ((w) + 8))
+
+/*
+ * Decode extension |which| of |x| unless that has already been done.
+ * x->lock must be held for writing.
+ * Returns 0 if the extension is present but invalid, or 1 otherwise.
+ */
+static int cache_ext_locked(X509 *x, int which)
+{
+    int lazy = x->ex_lazy;
+    void *val = NULL;
+    int i = -1;
+
+    if ((lazy & LAZY_DONE(which)) != 0)
+        return (lazy & LAZY_INVALID(which)) == 0;
+
+    switch (which) {
+    case LAZY_SKID:
+        val = x->skid =
+            X509_get_ext_d2i(x, NID_subject_key_identifier, &i, NULL);
+        break;
+    case LAZY_AKID:
+        val = x->akid =
+            X509_get_ext_d2i(x, NID_authority_key_identifier, &i, NULL);
+        break;
+    case LAZY_ALTNAME:
+        val = x->altname = X509_get_ext_d2i(x, NID_subject_alt_name, &i, NULL);
+        break;
+    case LAZY_NC:
+        val = x->nc = X509_get_ext_d2i(x, NID_name_constraints, &i, NULL);
+        break;
+#ifndef OPENSSL_NO_RFC3779
+    case LAZY_ADDR:
+        val = x->rfc3779_addr =
+            X509_get_ext_d2i(x, NID_sbgp_ipAddrBlock, &i, NULL);
+        break;
+    case LAZY_ASID:
+        val = x->rfc3779_asid =
+            X509_get_ext_d2i(x, NID_sbgp_autonomousSysNum, &i, NULL);
+        break;
+#endif
+    default:
+        break;
+    }
+
+    lazy |= LAZY_DONE(which);
+    if (val == NULL && i != -1)
+        lazy |= LAZY_INVALID(which);
+#ifdef tsan_st_rel
+    /* Publish the new value only after the decoded extension is visible */
+    tsan_st_rel((TSAN_QUALIFIER int *)&x->ex_lazy, lazy);
+#else
+    x->ex_lazy = lazy;
+#endif
+    return (lazy & LAZY_INVALID(which)) == 0;
+}
+
+/*
+ * Decode extension |which| of |x| on first use, without looking at any
+ * other extension.
+ * Returns 0 if the extension is present but invalid, or 1 otherwise.
+ */
+static int cache_ext(X509 *x, int which)
+{
+    int ret;
+
+#ifdef tsan_ld_acq
+    /* Fast lock-free check, pairs with the release store above */
+    int lazy = tsan_ld_acq((TSAN_QUALIFIER int *)&x->ex_lazy);
+
+    if ((lazy & LAZY_DONE(which)) != 0)
+        return (lazy & LAZY_INVALID(which)) == 0;
+#endif
+
+    if (!CRYPTO_THREAD_write_lock(x->lock))
+        return 0;
+    ERR_set_mark();
+    ret = cache_ext_locked(x, which);
+    ERR_pop_to_mark();
+    CRYPTO_THREAD_unlock(x->lock);
+    return ret;
+}
+
+const STACK_OF(GENERAL_NAME) *ossl_x509_get0_altname(X509 *x)
+{
+    if (!cache_ext(x, LAZY_ALTNAME))
+        return NULL;
+    return x->altname;
+}
+
+/*
+ * Called when the extensions of |x| have been changed.  Host name checks
+ * used to decode the subject alternative name afresh each time, so if it
+ * has been cached already, decode it again to keep them in line with the
+ * extensions.
+ */
+void ossl_x509_extensions_changed(X509 *x)
+{
+    if (!CRYPTO_THREAD_write_lock(x->lock))
+        return;
+    if ((x->ex_lazy & LAZY_DONE(LAZY_ALTNAME)) != 0) {
+        GENERAL_NAMES_free(x->altname);
+        x->altname = NULL;
+        x->ex_lazy &= ~(LAZY_DONE(LAZY_ALTNAME) | LAZY_INVALID(LAZY_ALTNAME));
+        ERR_set_mark();
+        cache_ext_locked(x, LAZY_ALTNAME);
+        ERR_pop_to_mark();
+    }
+    CRYPTO_THREAD_unlock(x->lock);
+}
+
 #define V1_ROOT (EXFLAG_V1|EXFLAG_SS)
 #define ku_reject(x, usage) \
     (((x)->ex_flags & EXFLAG_KUSAGE) != 0 && ((x)->ex_kusage & (usage)) == 0)
@@ -544,12 +668,9 @@ int ossl_x509v3_cache_extensions(X509 *x)
     }
 
     /* Handle subject key identifier and issuer/authority key identifier */
-    x->skid = X509_get_ext_d2i(x, NID_subject_key_identifier, &i, NULL);
-    if (x->skid == NULL && i != -1)
+    if (!cache_ext_locked(x, LAZY_SKID))
         x->ex_flags |= EXFLAG_INVALID;
-
-    x->akid = X509_get_ext_d2i(x, NID_authority_key_identifier, &i, NULL);
-    if (x->akid == NULL && i != -1)
+    if (!cache_ext_locked(x, LAZY_AKID))
         x->ex_flags |= EXFLAG_INVALID;
 
     /* Check if subject name matches issuer */
@@ -563,11 +684,9 @@ int ossl_x509v3_cache_extensions(X509 *x)
     }
 
     /* Handle subject alternative names and various other extensions */
-    x->altname = X509_get_ext_d2i(x, NID_subject_alt_name, &i, NULL);
-    if (x->altname == NULL && i != -1)
+    if (!cache_ext_locked(x, LAZY_ALTNAME))
         x->ex_flags |= EXFLAG_INVALID;
-    x->nc = X509_get_ext_d2i(x, NID_name_constraints, &i, NULL);
-    if (x->nc == NULL && i != -1)
+    if (!cache_ext_locked(x, LAZY_NC))
         x->ex_flags |= EXFLAG_INVALID;
 
     /* Handle CRL distribution point entries */
@@ -578,11 +697,9 @@ int ossl_x509v3_cache_extensions(X509 *x)
         goto err;
 
 #ifndef OPENSSL_NO_RFC3779
-    x->rfc3779_addr = X509_get_ext_d2i(x, NID_sbgp_ipAddrBlock, &i, NULL);
-    if (x->rfc3779_addr == NULL && i != -1)
+    if (!cache_ext_locked(x, LAZY_ADDR))
         x->ex_flags |= EXFLAG_INVALID;
-    x->rfc3779_asid = X509_get_ext_d2i(x, NID_sbgp_autonomousSysNum, &i, NULL);
-    if (x->rfc3779_asid == NULL && i != -1)
+    if (!cache_ext_locked(x, LAZY_ASID))
         x->ex_flags |= EXFLAG_INVALID;
 #endif
     for (i = 0; i < X509_get_ext_count(x); i++) {
@@ -1015,32 +1132,29 @@ uint32_t X509_get_extended_key_usage(X509 *x)
 
 const ASN1_OCTET_STRING *X509_get0_subject_key_id(X509 *x)
 {
-    /* Call for side-effect of computing hash and caching extensions */
-    if (X509_check_purpose(x, -1, 0) != 1)
+    /* Decode just this extension, the rest is left for when it's needed */
+    if (!cache_ext(x, LAZY_SKID))
         return NULL;
     return x->skid;
 }
 
 const ASN1_OCTET_STRING *X509_get0_authority_key_id(X509 *x)
 {
-    /* Call for side-effect of computing hash and caching extensions */
-    if (X509_check_purpose(x, -1, 0) != 1)
+    if (!cache_ext(x, LAZY_AKID))
         return NULL;
     return (x->akid != NULL ? x->akid->keyid : NULL);
 }
 
 const GENERAL_NAMES *X509_get0_authority_issuer(X509 *x)
 {
-    /* Call for side-effect of computing hash and caching extensions */
-    if (X509_check_purpose(x, -1, 0) != 1)
+    if (!cache_ext(x, LAZY_AKID))
         return NULL;
     return (x->akid != NULL ? x->akid->issuer : NULL);
 }
 
 const ASN1_INTEGER *X509_get0_authority_serial(X509 *x)
 {
-    /* Call for side-effect of computing hash and caching extensions */
-    if (X509_check_purpose(x, -1, 0) != 1)
+    if (!cache_ext(x, LAZY_AKID))
         return NULL;
     return (x->akid != NULL ? x->akid->serial : NULL);
 }
@@ -826,7 +826,7 @@ static int do_check_string(const ASN1_STRING *a, int cmp_type, equal_fn equal,
 static int do_x509_check(X509 *x, const char *chk, size_t chklen,
                          unsigned int flags, int check_type, char **peername)
 {
-    GENERAL_NAMES *gens = NULL;
+    const GENERAL_NAMES *gens;
     const X509_NAME *name = NULL;
     int i;
     int cnid = NID_undef;
@@ -859,7 +859,8 @@ static int do_x509_check(X509 *x, const char *chk, size_t chklen,
     if (chklen == 0)
         chklen = strlen(chk);
 
-    gens = X509_get_ext_d2i(x, NID_subject_alt_name, NULL, NULL);
+    /* The decoded names are kept with |x| for later checks */
+    gens = ossl_x509_get0_altname(x);
     if (gens) {
         for (i = 0; i < sk_GENERAL_NAME_num(gens); i++) {
             GENERAL_NAME *gen;
@@ -894,7 +895,6 @@ static int do_x509_check(X509 *x, const char *chk, size_t chklen,
                                       chk, chklen, peername)) != 0)
                 break;
         }
-        GENERAL_NAMES_free(gens);
         if (rv != 0)
             return rv;
         if (san_present && !(flags & X509_CHECK_FLAG_ALWAYS_CHECK_SUBJECT))
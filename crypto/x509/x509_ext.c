@@ -91,12 +91,19 @@ X509_EXTENSION *X509_get_ext(const X509 *x, int loc)
 
 X509_EXTENSION *X509_delete_ext(X509 *x, int loc)
 {
-    return X509v3_delete_ext(x->cert_info.extensions, loc);
+    X509_EXTENSION *ret = X509v3_delete_ext(x->cert_info.extensions, loc);
+
+    if (ret != NULL)
+        ossl_x509_extensions_changed(x);
+    return ret;
 }
 
 int X509_add_ext(X509 *x, X509_EXTENSION *ex, int loc)
 {
-    return (X509v3_add_ext(&(x->cert_info.extensions), ex, loc) != NULL);
+    if (X509v3_add_ext(&(x->cert_info.extensions), ex, loc) == NULL)
+        return 0;
+    ossl_x509_extensions_changed(x);
+    return 1;
 }
 
 void *X509_get_ext_d2i(const X509 *x, int nid, int *crit, int *idx)
@@ -107,8 +114,12 @@ void *X509_get_ext_d2i(const X509 *x, int nid, int *crit, int *idx)
 int X509_add1_ext_i2d(X509 *x, int nid, void *value, int crit,
                       unsigned long flags)
 {
-    return X509V3_add1_i2d(&x->cert_info.extensions, nid, value, crit,
-                           flags);
+    int ret = X509V3_add1_i2d(&x->cert_info.extensions, nid, value, crit,
+                              flags);
+
+    if (ret > 0)
+        ossl_x509_extensions_changed(x);
+    return ret;
 }
 
 int X509_REVOKED_get_ext_count(const X509_REVOKED *x)
@@ -257,7 +257,7 @@ int X509_STORE_CTX_verify(X509_STORE_CTX *ctx)
     return X509_verify_cert(ctx);
 }
 
-int X509_verify_cert(X509_STORE_CTX *ctx)
+static int x509_verify_cert(X509_STORE_CTX *ctx)
 {
     int ret;
 
@@ -303,6 +303,15 @@ int X509_verify_cert(X509_STORE_CTX *ctx)
     return ret;
 }
 
+int X509_verify_cert(X509_STORE_CTX *ctx)
+{
+    int traced = CRYPTO_alloc_trace_enter("X509_verify_cert");
+    int ret = x509_verify_cert(ctx);
+
+    CRYPTO_alloc_trace_leave(traced);
+    return ret;
+}
+
 static int sk_X509_contains(STACK_OF(X509) *sk, X509 *cert)
 {
     int i, n = sk_X509_num(sk);
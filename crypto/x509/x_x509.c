@@ -59,6 +59,7 @@ static int x509_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
 
     case ASN1_OP_NEW_POST:
         ret->ex_cached = 0;
+        ret->ex_lazy = 0;
         ret->ex_kusage = 0;
         ret->ex_xkusage = 0;
         ret->ex_nscert = 0;
@@ -126,6 +127,7 @@ X509 *d2i_X509(X509 **a, const unsigned char **in, long len)
 {
     X509 *cert = NULL;
     int free_on_error = a != NULL && *a == NULL;
+    int traced = CRYPTO_alloc_trace_enter("d2i_X509");
 
     cert = (X509 *)ASN1_item_d2i((ASN1_VALUE **)a, in, len, (X509_it()));
     /* Only cache the extensions if the cert object was passed in */
@@ -136,6 +138,7 @@ X509 *d2i_X509(X509 **a, const unsigned char **in, long len)
             cert = NULL;
         }
     }
+    CRYPTO_alloc_trace_leave(traced);
     return cert;
 }
 int i2d_X509(const X509 *a, unsigned char **out)
@@ -88,6 +88,23 @@ int bn_rshift_fixed_top(BIGNUM *r, const BIGNUM *a, int n);
 int bn_div_fixed_top(BIGNUM *dv, BIGNUM *rem, const BIGNUM *m,
                      const BIGNUM *d, BN_CTX *ctx);
 
+int ossl_bn_mod_exp_mont_consttime_x2(BIGNUM *rr1, const BIGNUM *a1,
+                                      const BIGNUM *p1, const BIGNUM *m1,
+                                      BN_MONT_CTX *in_mont1,
+                                      BIGNUM *rr2, const BIGNUM *a2,
+                                      const BIGNUM *p2, const BIGNUM *m2,
+                                      BN_MONT_CTX *in_mont2, BN_CTX *ctx);
+
+typedef struct bn_comb_st BN_COMB;
+
+BN_COMB *ossl_bn_comb_new(const BIGNUM *g, const BIGNUM *m, int bits,
+                          BN_CTX *ctx);
+void ossl_bn_comb_free(BN_COMB *comb);
+int ossl_bn_comb_matches(const BN_COMB *comb, const BIGNUM *g,
+                         const BIGNUM *m, int bits);
+int ossl_bn_comb_mod_exp(BIGNUM *r, const BN_COMB *comb, const BIGNUM *p,
+                         BN_CTX *ctx);
+
 #define BN_PRIMETEST_COMPOSITE                    0
 #define BN_PRIMETEST_COMPOSITE_WITH_FACTOR        1
 #define BN_PRIMETEST_COMPOSITE_NOT_POWER_OF_PRIME 2
@@ -112,6 +129,11 @@ int ossl_bn_rsa_fips186_4_derive_prime(BIGNUM *Y, BIGNUM *X, const BIGNUM *Xin,
 
 OSSL_LIB_CTX *ossl_bn_get_libctx(BN_CTX *ctx);
 
+BN_CTX *ossl_bn_ctx_acquire(OSSL_LIB_CTX *libctx, int secure);
+void ossl_bn_ctx_release(BN_CTX *ctx);
+void ossl_bn_ctx_cache_get_stats(OSSL_LIB_CTX *libctx, int *acquired,
+                                 int *allocated);
+
 extern const BIGNUM ossl_bn_inv_sqrt_2;
 
 #endif
@@ -28,6 +28,8 @@ void *ossl_decoder_from_dispatch(int id, const OSSL_ALGORITHM *algodef,
 
 OSSL_DECODER_INSTANCE *
 ossl_decoder_instance_new(OSSL_DECODER *decoder, void *decoderctx);
+OSSL_DECODER_INSTANCE *
+ossl_decoder_instance_dup(const OSSL_DECODER_INSTANCE *src);
 void ossl_decoder_instance_free(OSSL_DECODER_INSTANCE *decoder_inst);
 int ossl_decoder_ctx_add_decoder_inst(OSSL_DECODER_CTX *ctx,
                                       OSSL_DECODER_INSTANCE *di);
@@ -36,6 +38,16 @@ int ossl_decoder_ctx_setup_for_pkey(OSSL_DECODER_CTX *ctx,
                                     EVP_PKEY **pkey, const char *keytype,
                                     OSSL_LIB_CTX *libctx,
                                     const char *propquery);
+/*
+ * Like ossl_decoder_ctx_setup_for_pkey() followed by
+ * OSSL_DECODER_CTX_add_extra(), but reuses the decoders found by earlier
+ * calls with the same settings.
+ */
+int ossl_decoder_ctx_setup_for_pkey_cached(OSSL_DECODER_CTX *ctx,
+                                           EVP_PKEY **pkey,
+                                           const char *keytype,
+                                           OSSL_LIB_CTX *libctx,
+                                           const char *propquery);
 
 #endif
 
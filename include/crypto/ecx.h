@@ -85,6 +85,10 @@ int ossl_ecx_key_up_ref(ECX_KEY *key);
 
 int ossl_x25519(uint8_t out_shared_key[32], const uint8_t private_key[32],
                 const uint8_t peer_public_value[32]);
+int ossl_x25519_batch(int *results, size_t num,
+                      uint8_t *const out_shared_keys[],
+                      const uint8_t private_key[32],
+                      const uint8_t *const peer_public_values[]);
 void ossl_x25519_public_from_private(uint8_t out_public_value[32],
                                      const uint8_t private_key[32]);
 
@@ -100,6 +104,13 @@ int
 ossl_ed25519_verify(const uint8_t *message, size_t message_len,
                     const uint8_t signature[64], const uint8_t public_key[32],
                     OSSL_LIB_CTX *libctx, const char *propq);
+int
+ossl_ed25519_verify_batch(int *results, size_t num,
+                          const uint8_t *const messages[],
+                          const size_t message_lens[],
+                          const uint8_t *const signatures[],
+                          const uint8_t public_key[32],
+                          OSSL_LIB_CTX *libctx, const char *propq);
 
 int
 ossl_ed448_public_from_private(OSSL_LIB_CTX *ctx, uint8_t out_public_key[57],
@@ -320,6 +320,9 @@ struct evp_cipher_st {
     OSSL_FUNC_cipher_gettable_params_fn *gettable_params;
     OSSL_FUNC_cipher_gettable_ctx_params_fn *gettable_ctx_params;
     OSSL_FUNC_cipher_settable_ctx_params_fn *settable_ctx_params;
+    OSSL_FUNC_cipher_get_tag_fn *get_tag;
+    OSSL_FUNC_cipher_set_tag_fn *set_tag;
+    OSSL_FUNC_cipher_set_iv_fn *set_iv;
 } /* EVP_CIPHER */ ;
 
 /* Macros to code block cipher wrappers */
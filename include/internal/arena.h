@@ -0,0 +1,35 @@
+/*
+ * Copyright 2021 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#ifndef OSSL_INTERNAL_ARENA_H
+# define OSSL_INTERNAL_ARENA_H
+# pragma once
+
+# include <stddef.h>
+
+/*
+ * A region allocator for short-lived objects that all die together.
+ * See doc/internal/man3/ossl_arena_new.pod
+ */
+typedef struct ossl_arena_st OSSL_ARENA;
+
+OSSL_ARENA *ossl_arena_new(size_t chunk_size);
+void ossl_arena_free(OSSL_ARENA *arena);
+
+void *ossl_arena_alloc(OSSL_ARENA *arena, size_t num);
+void *ossl_arena_zalloc(OSSL_ARENA *arena, size_t num);
+
+size_t ossl_arena_mark(const OSSL_ARENA *arena);
+void ossl_arena_release(OSSL_ARENA *arena, size_t mark);
+void ossl_arena_reset(OSSL_ARENA *arena);
+
+void ossl_arena_get_stats(const OSSL_ARENA *arena, size_t *allocs,
+                          size_t *heap_allocs, size_t *high_water);
+
+#endif
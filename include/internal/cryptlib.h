@@ -162,7 +162,11 @@ typedef struct ossl_ex_data_global_st {
 # define OSSL_LIB_CTX_BIO_PROV_INDEX                13
 # define OSSL_LIB_CTX_GLOBAL_PROPERTIES             14
 # define OSSL_LIB_CTX_STORE_LOADER_STORE_INDEX      15
-# define OSSL_LIB_CTX_MAX_INDEXES                   16
+# define OSSL_LIB_CTX_BN_CTX_CACHE_INDEX            16
+# define OSSL_LIB_CTX_RSA_BLINDING_INDEX            17
+# define OSSL_LIB_CTX_DH_FIXED_BASE_INDEX           18
+# define OSSL_LIB_CTX_DECODER_CACHE_INDEX           19
+# define OSSL_LIB_CTX_MAX_INDEXES                   20
 
 typedef struct ossl_lib_ctx_method {
     void *(*new_func)(OSSL_LIB_CTX *ctx);
@@ -18,6 +18,7 @@
 # include <openssl/e_os2.h>
 
 # include "internal/numbers.h"
+# include "internal/arena.h"
 
 typedef struct {
     /* Pointer to where we are currently reading from */
@@ -640,6 +641,12 @@ struct wpacket_st {
     /* Our sub-packets (always at least one if not finished) */
     WPACKET_SUB *subs;
 
+    /*
+     * Where the sub-packets are allocated from, or NULL for the heap.  They
+     * are not given back to the arena, which its owner releases as a whole.
+     */
+    OSSL_ARENA *arena;
+
     /* Writing from the end first? */
     unsigned int endfirst : 1;
 };
@@ -673,6 +680,13 @@ int WPACKET_init_len(WPACKET *pkt, BUF_MEM *buf, size_t lenbytes);
  */
 int WPACKET_init(WPACKET *pkt, BUF_MEM *buf);
 
+/*
+ * Same as WPACKET_init except that the sub-packets are allocated from
+ * |arena|, which must not be released until the WPACKET has been finished
+ * or cleaned up.
+ */
+int WPACKET_init_arena(WPACKET *pkt, BUF_MEM *buf, OSSL_ARENA *arena);
+
 /*
  * Same as WPACKET_init_len except there is no underlying buffer. No data is
  * ever actually written. We just keep track of how much data would have been
@@ -45,6 +45,14 @@ int ossl_provider_add_parameter(OSSL_PROVIDER *prov, const char *name,
 /* Disable fallback loading */
 int ossl_provider_disable_fallback_loading(OSSL_LIB_CTX *libctx);
 
+/*
+ * Changes whenever the set of activated providers in |libctx| or its default
+ * properties change, so that caches of fetched implementations can tell that
+ * they are outdated
+ */
+unsigned int ossl_provider_store_generation(OSSL_LIB_CTX *libctx);
+void ossl_provider_store_new_generation(OSSL_LIB_CTX *libctx);
+
 /*
  * Activate the Provider
  * If the Provider is a module, the module will be loaded
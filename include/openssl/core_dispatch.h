@@ -284,6 +284,9 @@ OSSL_CORE_MAKE_FUNC(const OSSL_PARAM *, digest_gettable_ctx_params,
 # define OSSL_FUNC_CIPHER_GETTABLE_PARAMS           12
 # define OSSL_FUNC_CIPHER_GETTABLE_CTX_PARAMS       13
 # define OSSL_FUNC_CIPHER_SETTABLE_CTX_PARAMS       14
+# define OSSL_FUNC_CIPHER_GET_TAG                   15
+# define OSSL_FUNC_CIPHER_SET_TAG                   16
+# define OSSL_FUNC_CIPHER_SET_IV                    17
 
 OSSL_CORE_MAKE_FUNC(void *, cipher_newctx, (void *provctx))
 OSSL_CORE_MAKE_FUNC(int, cipher_encrypt_init, (void *cctx,
@@ -322,6 +325,12 @@ OSSL_CORE_MAKE_FUNC(const OSSL_PARAM *, cipher_settable_ctx_params,
                     (void *cctx, void *provctx))
 OSSL_CORE_MAKE_FUNC(const OSSL_PARAM *, cipher_gettable_ctx_params,
                     (void *cctx, void *provctx))
+OSSL_CORE_MAKE_FUNC(int, cipher_get_tag,
+                    (void *cctx, unsigned char *tag, size_t taglen))
+OSSL_CORE_MAKE_FUNC(int, cipher_set_tag,
+                    (void *cctx, const unsigned char *tag, size_t taglen))
+OSSL_CORE_MAKE_FUNC(int, cipher_set_iv,
+                    (void *cctx, const unsigned char *iv))
 
 /* MACs */
 
@@ -613,6 +622,7 @@ OSSL_CORE_MAKE_FUNC(int, keymgmt_copy,
 # define OSSL_FUNC_KEYEXCH_SETTABLE_CTX_PARAMS         8
 # define OSSL_FUNC_KEYEXCH_GET_CTX_PARAMS              9
 # define OSSL_FUNC_KEYEXCH_GETTABLE_CTX_PARAMS        10
+# define OSSL_FUNC_KEYEXCH_DERIVE_BATCH               11
 
 OSSL_CORE_MAKE_FUNC(void *, keyexch_newctx, (void *provctx))
 OSSL_CORE_MAKE_FUNC(int, keyexch_init, (void *ctx, void *provkey,
@@ -630,6 +640,10 @@ OSSL_CORE_MAKE_FUNC(int, keyexch_get_ctx_params, (void *ctx,
                                                      OSSL_PARAM params[]))
 OSSL_CORE_MAKE_FUNC(const OSSL_PARAM *, keyexch_gettable_ctx_params,
                     (void *ctx, void *provctx))
+OSSL_CORE_MAKE_FUNC(int, keyexch_derive_batch,
+                    (void *ctx, size_t num, const unsigned char *const peers[],
+                     const size_t peerlens[], unsigned char *const secrets[],
+                     size_t *secretlen, size_t outlen, int results[]))
 
 /* Signature */
 
@@ -658,6 +672,7 @@ OSSL_CORE_MAKE_FUNC(const OSSL_PARAM *, keyexch_gettable_ctx_params,
 # define OSSL_FUNC_SIGNATURE_GETTABLE_CTX_MD_PARAMS 23
 # define OSSL_FUNC_SIGNATURE_SET_CTX_MD_PARAMS      24
 # define OSSL_FUNC_SIGNATURE_SETTABLE_CTX_MD_PARAMS 25
+# define OSSL_FUNC_SIGNATURE_DIGEST_VERIFY_BATCH    26
 
 OSSL_CORE_MAKE_FUNC(void *, signature_newctx, (void *provctx,
                                                   const char *propq))
@@ -700,6 +715,10 @@ OSSL_CORE_MAKE_FUNC(int, signature_digest_verify_final,
 OSSL_CORE_MAKE_FUNC(int, signature_digest_verify,
                     (void *ctx, const unsigned char *sig, size_t siglen,
                      const unsigned char *tbs, size_t tbslen))
+OSSL_CORE_MAKE_FUNC(int, signature_digest_verify_batch,
+                    (void *ctx, size_t num, const unsigned char *const sigs[],
+                     const size_t siglens[], const unsigned char *const tbs[],
+                     const size_t tbslens[], int results[]))
 OSSL_CORE_MAKE_FUNC(void, signature_freectx, (void *ctx))
 OSSL_CORE_MAKE_FUNC(void *, signature_dupctx, (void *ctx))
 OSSL_CORE_MAKE_FUNC(int, signature_get_ctx_params,
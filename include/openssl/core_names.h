@@ -255,6 +255,7 @@ extern "C" {
 #define OSSL_DRBG_PARAM_CIPHER                  OSSL_ALG_PARAM_CIPHER
 #define OSSL_DRBG_PARAM_MAC                     OSSL_ALG_PARAM_MAC
 #define OSSL_DRBG_PARAM_USE_DF                  "use_derivation_function"
+#define OSSL_DRBG_PARAM_BUFFER_SIZE             "buffer_size"
 
 /* DRBG call back parameters */
 #define OSSL_DRBG_PARAM_ENTROPY_REQUIRED        "entropy_required"
@@ -413,6 +414,8 @@ extern "C" {
 #define OSSL_PKEY_PARAM_EC_POINT_CONVERSION_FORMAT "point-format"
 #define OSSL_PKEY_PARAM_EC_GROUP_CHECK_TYPE        "group-check"
 #define OSSL_PKEY_PARAM_EC_INCLUDE_PUBLIC          "include-public"
+#define OSSL_PKEY_PARAM_EC_VERIFY_PRECOMPUTE_THRESHOLD \
+    "verify-precompute-threshold"
 
 /* OSSL_PKEY_PARAM_EC_ENCODING values */
 #define OSSL_PKEY_EC_ENCODING_EXPLICIT  "explicit"
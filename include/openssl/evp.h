@@ -768,6 +768,11 @@ __owur int EVP_VerifyFinal_ex(EVP_MD_CTX *ctx, const unsigned char *sigbuf,
 __owur int EVP_DigestVerify(EVP_MD_CTX *ctx, const unsigned char *sigret,
                             size_t siglen, const unsigned char *tbs,
                             size_t tbslen);
+__owur int EVP_DigestVerifyBatch(EVP_MD_CTX *ctx, size_t num,
+                                 const unsigned char *const sigs[],
+                                 const size_t siglens[],
+                                 const unsigned char *const tbs[],
+                                 const size_t tbslens[], int results[]);
 
 int EVP_DigestSignInit_ex(EVP_MD_CTX *ctx, EVP_PKEY_CTX **pctx,
                           const char *mdname, OSSL_LIB_CTX *libctx,
@@ -1826,6 +1831,11 @@ int EVP_PKEY_derive_init(EVP_PKEY_CTX *ctx);
 int EVP_PKEY_derive_init_ex(EVP_PKEY_CTX *ctx, const OSSL_PARAM params[]);
 int EVP_PKEY_derive_set_peer(EVP_PKEY_CTX *ctx, EVP_PKEY *peer);
 int EVP_PKEY_derive(EVP_PKEY_CTX *ctx, unsigned char *key, size_t *keylen);
+int EVP_PKEY_derive_batch(EVP_PKEY_CTX *ctx, size_t num,
+                          const unsigned char *const peers[],
+                          const size_t peerlens[],
+                          unsigned char *const secrets[], size_t *secretlen,
+                          int results[]);
 
 int EVP_PKEY_encapsulate_init(EVP_PKEY_CTX *ctx, const OSSL_PARAM params[]);
 int EVP_PKEY_encapsulate(EVP_PKEY_CTX *ctx,
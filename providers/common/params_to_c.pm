@@ -0,0 +1,177 @@
+#! /usr/bin/env perl
+# Copyright 2021 The OpenSSL Project Authors. All Rights Reserved.
+#
+# Licensed under the Apache License 2.0 (the "License").  You may not use
+# this file except in compliance with the License.  You can obtain a copy
+# in the file LICENSE in the source distribution or at
+# https://www.openssl.org/source/license.html
+
+use strict;
+use warnings;
+
+package params_to_c;
+
+use Carp;
+use File::Spec;
+
+# Produce C code to find the parameters that a get_params or set_params
+# function is interested in with a single pass over an OSSL_PARAM array.
+#
+# The parameter names are resolved at build time from the OSSL_*_PARAM_*
+# macros in include/openssl/core_names.h, and matched with a decision tree
+# over their characters (a trie), rather than with a strcmp() against each
+# of them in turn as OSSL_PARAM_locate() does.
+#
+# For a decoder called NAME, this produces:
+#
+#   struct NAME_st {
+#       OSSL_PARAM *field;          (const OSSL_PARAM with const => 1)
+#       ...
+#   };
+#
+#   static ossl_inline void NAME_decoder(OSSL_PARAM *p, struct NAME_st *r);
+#
+# which sets each field to the first parameter in |p| with the name of the
+# corresponding macro, or NULL if there is none.
+
+my %names;
+
+sub _read_names {
+    my $dir = shift;
+    my $file = File::Spec->catfile($dir, 'include', 'openssl', 'core_names.h');
+    my %defs;
+
+    open my $fh, '<', $file or croak "Can't open $file: $!";
+    local $/;
+    my $text = <$fh>;
+    close $fh;
+
+    $text =~ s|\\\n| |g;
+    $text =~ s|/\*.*?\*/| |gs;
+    foreach (split /\n/, $text) {
+        $defs{$1} = $2 if m|^\s*#\s*define\s+(OSSL_\w+)\s+(\S+)\s*$|;
+    }
+    foreach my $macro (keys %defs) {
+        my $value = $defs{$macro};
+        my %seen;
+
+        while (defined $defs{$value} && !$seen{$value}++) {
+            $value = $defs{$value};
+        }
+        $names{$macro} = $1 if $value =~ m|^"(.*)"$|;
+    }
+}
+
+sub _c_string {
+    my $s = shift;
+
+    $s =~ s|(["\\])|\\$1|g;
+    return "\"$s\"";
+}
+
+sub _c_char {
+    my $c = shift;
+
+    return "'\\''" if $c eq "'";
+    return "'\\\\'" if $c eq "\\";
+    return "'$c'";
+}
+
+# Count the names below a trie node
+sub _count {
+    my $node = shift;
+    my $n = defined $node->{field} ? 1 : 0;
+
+    $n += _count($node->{next}->{$_}) foreach keys %{$node->{next}};
+    return $n;
+}
+
+sub _assign {
+    my ($field, $indent) = @_;
+
+    return "${indent}if (r->$field == NULL)\n"
+        . "${indent}    r->$field = p;\n";
+}
+
+sub _emit {
+    my ($node, $depth, $suffix, $indent) = @_;
+    my $out = '';
+
+    # A branch with a single name left is finished off with one compare
+    if (_count($node) == 1) {
+        while (!defined $node->{field}) {
+            my ($c) = keys %{$node->{next}};
+
+            $suffix .= $c;
+            $node = $node->{next}->{$c};
+        }
+        my $cmp = $suffix eq ''
+            ? "s[$depth] == '\\0'"
+            : "strcmp(" . _c_string($suffix) . ", s + $depth) == 0";
+
+        return "${indent}if ($cmp) {\n"
+            . _assign($node->{field}, "$indent    ")
+            . "${indent}}\n";
+    }
+
+    $out .= "${indent}switch (s[$depth]) {\n";
+    $out .= "${indent}default:\n${indent}    break;\n";
+    if (defined $node->{field}) {
+        $out .= "${indent}case '\\0':\n"
+            . _assign($node->{field}, "$indent    ")
+            . "${indent}    break;\n";
+    }
+    foreach my $c (sort keys %{$node->{next}}) {
+        $out .= "${indent}case " . _c_char($c) . ":\n"
+            . _emit($node->{next}->{$c}, $depth + 1, '', "$indent    ")
+            . "${indent}    break;\n";
+    }
+    $out .= "${indent}}\n";
+    return $out;
+}
+
+sub produce_decoder {
+    my %opts = @_;
+    my $name = $opts{name} or croak "No decoder name";
+    my @params = @{$opts{params}};
+    my $type = $opts{const} ? 'const OSSL_PARAM' : 'OSSL_PARAM';
+    my %trie = ( next => {} );
+    my $fields = '';
+
+    _read_names($opts{dir}) unless %names;
+    croak "Odd number of elements in parameter list for $name"
+        if scalar @params % 2 != 0;
+    while (@params) {
+        my $field = shift @params;
+        my $macro = shift @params;
+        my $key = $names{$macro};
+        my $node = \%trie;
+
+        croak "$macro is not a known parameter name" unless defined $key;
+        $fields .= "    $type *$field; /* $macro */\n";
+        foreach my $c (split //, $key) {
+            $node = $node->{next}->{$c} //= { next => {} };
+        }
+        croak "$macro is given twice for $name" if defined $node->{field};
+        $node->{field} = $field;
+    }
+
+    return <<"_____"
+struct ${name}_st {
+$fields};
+
+static ossl_inline void
+${name}_decoder($type *p, struct ${name}_st *r)
+{
+    const char *s;
+
+    memset(r, 0, sizeof(*r));
+    if (p == NULL)
+        return;
+    for (; (s = p->key) != NULL; p++) {
+@{[ _emit(\%trie, 0, '', '        ') ]}    }
+}
+_____
+}
+
+1;
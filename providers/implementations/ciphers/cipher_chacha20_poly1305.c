@@ -13,6 +13,7 @@
 #include "cipher_chacha20_poly1305.h"
 #include "prov/implementations.h"
 #include "prov/providercommon.h"
+#include "prov/cipher_params.h"
 
 
 #define CHACHA20_POLY1305_KEYLEN CHACHA_KEY_SIZE
@@ -29,6 +30,9 @@ static OSSL_FUNC_cipher_decrypt_init_fn chacha20_poly1305_dinit;
 static OSSL_FUNC_cipher_get_params_fn chacha20_poly1305_get_params;
 static OSSL_FUNC_cipher_get_ctx_params_fn chacha20_poly1305_get_ctx_params;
 static OSSL_FUNC_cipher_set_ctx_params_fn chacha20_poly1305_set_ctx_params;
+static OSSL_FUNC_cipher_get_tag_fn chacha20_poly1305_get_tag;
+static OSSL_FUNC_cipher_set_tag_fn chacha20_poly1305_set_tag;
+static OSSL_FUNC_cipher_set_iv_fn chacha20_poly1305_set_iv;
 static OSSL_FUNC_cipher_cipher_fn chacha20_poly1305_cipher;
 static OSSL_FUNC_cipher_final_fn chacha20_poly1305_final;
 static OSSL_FUNC_cipher_gettable_ctx_params_fn chacha20_poly1305_gettable_ctx_params;
@@ -81,46 +85,42 @@ static int chacha20_poly1305_get_params(OSSL_PARAM params[])
 static int chacha20_poly1305_get_ctx_params(void *vctx, OSSL_PARAM params[])
 {
     PROV_CHACHA20_POLY1305_CTX *ctx = (PROV_CHACHA20_POLY1305_CTX *)vctx;
+    struct chacha20_poly1305_get_ctx_params_st r;
     OSSL_PARAM *p;
 
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_IVLEN);
+    chacha20_poly1305_get_ctx_params_decoder(params, &r);
+
+    p = r.ivlen;
     if (p != NULL) {
         if (!OSSL_PARAM_set_size_t(p, ctx->nonce_len)) {
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SET_PARAMETER);
             return 0;
         }
     }
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_KEYLEN);
+    p = r.keylen;
     if (p != NULL && !OSSL_PARAM_set_size_t(p, CHACHA20_POLY1305_KEYLEN)) {
         ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SET_PARAMETER);
         return 0;
     }
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_AEAD_TAGLEN);
+    p = r.taglen;
     if (p != NULL && !OSSL_PARAM_set_size_t(p, ctx->tag_len)) {
         ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SET_PARAMETER);
         return 0;
     }
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_AEAD_TLS1_AAD_PAD);
+    p = r.pad;
     if (p != NULL && !OSSL_PARAM_set_size_t(p, ctx->tls_aad_pad_sz)) {
         ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SET_PARAMETER);
         return 0;
     }
 
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_AEAD_TAG);
+    p = r.tag;
     if (p != NULL) {
         if (p->data_type != OSSL_PARAM_OCTET_STRING) {
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SET_PARAMETER);
             return 0;
         }
-        if (!ctx->base.enc) {
-            ERR_raise(ERR_LIB_PROV, PROV_R_TAG_NOT_SET);
-            return 0;
-        }
-        if (p->data_size == 0 || p->data_size > POLY1305_BLOCK_SIZE) {
-            ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_TAG_LENGTH);
+        if (!chacha20_poly1305_get_tag(ctx, p->data, p->data_size))
             return 0;
-        }
-        memcpy(p->data, ctx->tag, p->data_size);
     }
 
     return 1;
@@ -148,11 +148,13 @@ static int chacha20_poly1305_set_ctx_params(void *vctx,
     PROV_CHACHA20_POLY1305_CTX *ctx = (PROV_CHACHA20_POLY1305_CTX *)vctx;
     PROV_CIPHER_HW_CHACHA20_POLY1305 *hw =
         (PROV_CIPHER_HW_CHACHA20_POLY1305 *)ctx->base.hw;
+    struct chacha20_poly1305_set_ctx_params_st r;
 
     if (params == NULL)
         return 1;
+    chacha20_poly1305_set_ctx_params_decoder(params, &r);
 
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_KEYLEN);
+    p = r.keylen;
     if (p != NULL) {
         if (!OSSL_PARAM_get_size_t(p, &len)) {
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_GET_PARAMETER);
@@ -163,7 +165,7 @@ static int chacha20_poly1305_set_ctx_params(void *vctx,
             return 0;
         }
     }
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_IVLEN);
+    p = r.ivlen;
     if (p != NULL) {
         if (!OSSL_PARAM_get_size_t(p, &len)) {
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_GET_PARAMETER);
@@ -176,27 +178,17 @@ static int chacha20_poly1305_set_ctx_params(void *vctx,
         ctx->nonce_len = len;
     }
 
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_AEAD_TAG);
+    p = r.tag;
     if (p != NULL) {
         if (p->data_type != OSSL_PARAM_OCTET_STRING) {
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_GET_PARAMETER);
             return 0;
         }
-        if (p->data_size == 0 || p->data_size > POLY1305_BLOCK_SIZE) {
-            ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_TAG_LENGTH);
+        if (!chacha20_poly1305_set_tag(ctx, p->data, p->data_size))
             return 0;
-        }
-        if (p->data != NULL) {
-            if (ctx->base.enc) {
-                ERR_raise(ERR_LIB_PROV, PROV_R_TAG_NOT_NEEDED);
-                return 0;
-            }
-            memcpy(ctx->tag, p->data, p->data_size);
-        }
-        ctx->tag_len = p->data_size;
     }
 
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_AEAD_TLS1_AAD);
+    p = r.aad;
     if (p != NULL) {
         if (p->data_type != OSSL_PARAM_OCTET_STRING) {
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_GET_PARAMETER);
@@ -210,7 +202,7 @@ static int chacha20_poly1305_set_ctx_params(void *vctx,
         ctx->tls_aad_pad_sz = len;
     }
 
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_AEAD_TLS1_IV_FIXED);
+    p = r.fixed;
     if (p != NULL) {
         if (p->data_type != OSSL_PARAM_OCTET_STRING) {
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_GET_PARAMETER);
@@ -265,6 +257,64 @@ static int chacha20_poly1305_dinit(void *vctx, const unsigned char *key,
     return ret;
 }
 
+static int chacha20_poly1305_get_tag(void *vctx, unsigned char *tag,
+                                     size_t taglen)
+{
+    PROV_CHACHA20_POLY1305_CTX *ctx = (PROV_CHACHA20_POLY1305_CTX *)vctx;
+
+    if (!ctx->base.enc) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_TAG_NOT_SET);
+        return 0;
+    }
+    if (taglen == 0 || taglen > POLY1305_BLOCK_SIZE) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_TAG_LENGTH);
+        return 0;
+    }
+    memcpy(tag, ctx->tag, taglen);
+    return 1;
+}
+
+/* A NULL |tag| only sets the tag length */
+static int chacha20_poly1305_set_tag(void *vctx, const unsigned char *tag,
+                                     size_t taglen)
+{
+    PROV_CHACHA20_POLY1305_CTX *ctx = (PROV_CHACHA20_POLY1305_CTX *)vctx;
+
+    if (taglen == 0 || taglen > POLY1305_BLOCK_SIZE) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_TAG_LENGTH);
+        return 0;
+    }
+    if (tag != NULL) {
+        if (ctx->base.enc) {
+            ERR_raise(ERR_LIB_PROV, PROV_R_TAG_NOT_NEEDED);
+            return 0;
+        }
+        memcpy(ctx->tag, tag, taglen);
+    }
+    ctx->tag_len = taglen;
+    return 1;
+}
+
+/* The same as an init call with only an IV, in the current direction */
+static int chacha20_poly1305_set_iv(void *vctx, const unsigned char *iv)
+{
+    PROV_CIPHER_CTX *ctx = (PROV_CIPHER_CTX *)vctx;
+    PROV_CHACHA20_POLY1305_CTX *cctx = (PROV_CHACHA20_POLY1305_CTX *)vctx;
+    PROV_CIPHER_HW_CHACHA20_POLY1305 *hw =
+        (PROV_CIPHER_HW_CHACHA20_POLY1305 *)ctx->hw;
+
+    if (!ossl_prov_is_running())
+        return 0;
+
+    ctx->num = 0;
+    ctx->bufsz = 0;
+    ctx->updated = 0;
+    if (!ossl_cipher_generic_initiv(ctx, iv, cctx->nonce_len))
+        return 0;
+    hw->initiv(ctx);
+    return 1;
+}
+
 static int chacha20_poly1305_cipher(void *vctx, unsigned char *out,
                                     size_t *outl, size_t outsize,
                                     const unsigned char *in, size_t inl)
@@ -330,6 +380,9 @@ const OSSL_DISPATCH ossl_chacha20_ossl_poly1305_functions[] = {
         (void (*)(void))chacha20_poly1305_set_ctx_params },
     { OSSL_FUNC_CIPHER_SETTABLE_CTX_PARAMS,
         (void (*)(void))chacha20_poly1305_settable_ctx_params },
+    { OSSL_FUNC_CIPHER_GET_TAG, (void (*)(void))chacha20_poly1305_get_tag },
+    { OSSL_FUNC_CIPHER_SET_TAG, (void (*)(void))chacha20_poly1305_set_tag },
+    { OSSL_FUNC_CIPHER_SET_IV, (void (*)(void))chacha20_poly1305_set_iv },
     { 0, NULL }
 };
 
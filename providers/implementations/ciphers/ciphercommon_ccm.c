@@ -12,6 +12,7 @@
 #include <openssl/proverr.h>
 #include "prov/ciphercommon.h"
 #include "prov/ciphercommon_ccm.h"
+#include "prov/cipher_params.h"
 #include "prov/providercommon.h"
 
 static int ccm_cipher_internal(PROV_CCM_CTX *ctx, unsigned char *out,
@@ -71,32 +72,23 @@ int ossl_ccm_set_ctx_params(void *vctx, const OSSL_PARAM params[])
     const OSSL_PARAM *p;
     size_t sz;
 
+    struct aead_ccm_set_ctx_params_st r;
+
     if (params == NULL)
         return 1;
+    aead_ccm_set_ctx_params_decoder(params, &r);
 
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_AEAD_TAG);
+    p = r.tag;
     if (p != NULL) {
         if (p->data_type != OSSL_PARAM_OCTET_STRING) {
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_GET_PARAMETER);
             return 0;
         }
-        if ((p->data_size & 1) || (p->data_size < 4) || p->data_size > 16) {
-            ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_TAG_LENGTH);
+        if (!ossl_ccm_set_tag(ctx, p->data, p->data_size))
             return 0;
-        }
-
-        if (p->data != NULL) {
-            if (ctx->enc) {
-                ERR_raise(ERR_LIB_PROV, PROV_R_TAG_NOT_NEEDED);
-                return 0;
-            }
-            memcpy(ctx->buf, p->data, p->data_size);
-            ctx->tag_set = 1;
-        }
-        ctx->m = p->data_size;
     }
 
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_AEAD_IVLEN);
+    p = r.ivlen;
     if (p != NULL) {
         size_t ivlen;
 
@@ -112,7 +104,7 @@ int ossl_ccm_set_ctx_params(void *vctx, const OSSL_PARAM params[])
         ctx->l = ivlen;
     }
 
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_AEAD_TLS1_AAD);
+    p = r.aad;
     if (p != NULL) {
         if (p->data_type != OSSL_PARAM_OCTET_STRING) {
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_GET_PARAMETER);
@@ -126,7 +118,7 @@ int ossl_ccm_set_ctx_params(void *vctx, const OSSL_PARAM params[])
         ctx->tls_aad_pad_sz = sz;
     }
 
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_AEAD_TLS1_IV_FIXED);
+    p = r.fixed;
     if (p != NULL) {
         if (p->data_type != OSSL_PARAM_OCTET_STRING) {
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_GET_PARAMETER);
@@ -144,15 +136,18 @@ int ossl_ccm_set_ctx_params(void *vctx, const OSSL_PARAM params[])
 int ossl_ccm_get_ctx_params(void *vctx, OSSL_PARAM params[])
 {
     PROV_CCM_CTX *ctx = (PROV_CCM_CTX *)vctx;
+    struct aead_ccm_get_ctx_params_st r;
     OSSL_PARAM *p;
 
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_IVLEN);
+    aead_ccm_get_ctx_params_decoder(params, &r);
+
+    p = r.ivlen;
     if (p != NULL && !OSSL_PARAM_set_size_t(p, ccm_get_ivlen(ctx))) {
         ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SET_PARAMETER);
         return 0;
     }
 
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_AEAD_TAGLEN);
+    p = r.taglen;
     if (p != NULL) {
         size_t m = ctx->m;
 
@@ -162,7 +157,7 @@ int ossl_ccm_get_ctx_params(void *vctx, OSSL_PARAM params[])
         }
     }
 
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_IV);
+    p = r.iv;
     if (p != NULL) {
         if (ccm_get_ivlen(ctx) > p->data_size) {
             ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_IV_LENGTH);
@@ -175,7 +170,7 @@ int ossl_ccm_get_ctx_params(void *vctx, OSSL_PARAM params[])
         }
     }
 
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_UPDATED_IV);
+    p = r.updiv;
     if (p != NULL) {
         if (ccm_get_ivlen(ctx) > p->data_size) {
             ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_IV_LENGTH);
@@ -188,19 +183,19 @@ int ossl_ccm_get_ctx_params(void *vctx, OSSL_PARAM params[])
         }
     }
 
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_KEYLEN);
+    p = r.keylen;
     if (p != NULL && !OSSL_PARAM_set_size_t(p, ctx->keylen)) {
         ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SET_PARAMETER);
         return 0;
     }
 
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_AEAD_TLS1_AAD_PAD);
+    p = r.pad;
     if (p != NULL && !OSSL_PARAM_set_size_t(p, ctx->tls_aad_pad_sz)) {
         ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SET_PARAMETER);
         return 0;
     }
 
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_AEAD_TAG);
+    p = r.tag;
     if (p != NULL) {
         if (!ctx->enc || !ctx->tag_set) {
             ERR_raise(ERR_LIB_PROV, PROV_R_TAG_NOT_SET);
@@ -210,15 +205,76 @@ int ossl_ccm_get_ctx_params(void *vctx, OSSL_PARAM params[])
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SET_PARAMETER);
             return 0;
         }
-        if (!ctx->hw->gettag(ctx, p->data, p->data_size))
+        if (!ossl_ccm_get_tag(ctx, p->data, p->data_size))
+            return 0;
+    }
+    return 1;
+}
+
+/*
+ * The tag and IV functions are also offered to libcrypto directly, for the
+ * per-record calls of a protocol that would otherwise use OSSL_PARAMs.
+ */
+int ossl_ccm_get_tag(void *vctx, unsigned char *tag, size_t taglen)
+{
+    PROV_CCM_CTX *ctx = (PROV_CCM_CTX *)vctx;
+
+    if (!ctx->enc || !ctx->tag_set) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_TAG_NOT_SET);
+        return 0;
+    }
+    if (!ctx->hw->gettag(ctx, tag, taglen))
+        return 0;
+    ctx->tag_set = 0;
+    ctx->iv_set = 0;
+    ctx->len_set = 0;
+    return 1;
+}
+
+/* A NULL |tag| only sets the tag length */
+int ossl_ccm_set_tag(void *vctx, const unsigned char *tag, size_t taglen)
+{
+    PROV_CCM_CTX *ctx = (PROV_CCM_CTX *)vctx;
+
+    if ((taglen & 1) || (taglen < 4) || taglen > 16) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_TAG_LENGTH);
+        return 0;
+    }
+
+    if (tag != NULL) {
+        if (ctx->enc) {
+            ERR_raise(ERR_LIB_PROV, PROV_R_TAG_NOT_NEEDED);
             return 0;
-        ctx->tag_set = 0;
-        ctx->iv_set = 0;
-        ctx->len_set = 0;
+        }
+        memcpy(ctx->buf, tag, taglen);
+        ctx->tag_set = 1;
+    }
+    ctx->m = taglen;
+    return 1;
+}
+
+static int ccm_init_iv(PROV_CCM_CTX *ctx, const unsigned char *iv,
+                       size_t ivlen)
+{
+    if (ivlen != ccm_get_ivlen(ctx)) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_IV_LENGTH);
+        return 0;
     }
+    memcpy(ctx->iv, iv, ivlen);
+    ctx->iv_set = 1;
     return 1;
 }
 
+int ossl_ccm_set_iv(void *vctx, const unsigned char *iv)
+{
+    PROV_CCM_CTX *ctx = (PROV_CCM_CTX *)vctx;
+
+    if (!ossl_prov_is_running())
+        return 0;
+
+    return ccm_init_iv(ctx, iv, ccm_get_ivlen(ctx));
+}
+
 static int ccm_init(void *vctx, const unsigned char *key, size_t keylen,
                     const unsigned char *iv, size_t ivlen,
                     const OSSL_PARAM params[], int enc)
@@ -230,14 +286,8 @@ static int ccm_init(void *vctx, const unsigned char *key, size_t keylen,
 
     ctx->enc = enc;
 
-    if (iv != NULL) {
-        if (ivlen != ccm_get_ivlen(ctx)) {
-            ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_IV_LENGTH);
-            return 0;
-        }
-        memcpy(ctx->iv, iv, ivlen);
-        ctx->iv_set = 1;
-    }
+    if (iv != NULL && !ccm_init_iv(ctx, iv, ivlen))
+        return 0;
     if (key != NULL) {
         if (keylen != ctx->keylen) {
             ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_KEY_LENGTH);
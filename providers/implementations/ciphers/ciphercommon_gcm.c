@@ -13,6 +13,7 @@
 #include <openssl/proverr.h>
 #include "prov/ciphercommon.h"
 #include "prov/ciphercommon_gcm.h"
+#include "prov/cipher_params.h"
 #include "prov/providercommon.h"
 #include "prov/provider_ctx.h"
 
@@ -39,6 +40,19 @@ void ossl_gcm_initctx(void *provctx, PROV_GCM_CTX *ctx, size_t keybits,
     ctx->libctx = PROV_LIBCTX_OF(provctx);
 }
 
+static int gcm_init_iv(PROV_GCM_CTX *ctx, const unsigned char *iv,
+                       size_t ivlen)
+{
+    if (ivlen < ctx->ivlen_min || ivlen > sizeof(ctx->iv)) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_IV_LENGTH);
+        return 0;
+    }
+    ctx->ivlen = ivlen;
+    memcpy(ctx->iv, iv, ivlen);
+    ctx->iv_state = IV_STATE_BUFFERED;
+    return 1;
+}
+
 static int gcm_init(void *vctx, const unsigned char *key, size_t keylen,
                     const unsigned char *iv, size_t ivlen,
                     const OSSL_PARAM params[], int enc)
@@ -50,15 +64,8 @@ static int gcm_init(void *vctx, const unsigned char *key, size_t keylen,
 
     ctx->enc = enc;
 
-    if (iv != NULL) {
-        if (ivlen < ctx->ivlen_min || ivlen > sizeof(ctx->iv)) {
-            ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_IV_LENGTH);
-            return 0;
-        }
-        ctx->ivlen = ivlen;
-        memcpy(ctx->iv, iv, ivlen);
-        ctx->iv_state = IV_STATE_BUFFERED;
-    }
+    if (iv != NULL && !gcm_init_iv(ctx, iv, ivlen))
+        return 0;
 
     if (key != NULL) {
         if (keylen != ctx->keylen) {
@@ -85,6 +92,54 @@ int ossl_gcm_dinit(void *vctx, const unsigned char *key, size_t keylen,
     return gcm_init(vctx, key, keylen, iv, ivlen, params, 0);
 }
 
+/*
+ * The following three are shortcuts for the per-record calls of a protocol
+ * that would otherwise go through the OSSL_PARAM functions below.  Those use
+ * the tag functions too, so the checks are the same either way.
+ */
+int ossl_gcm_get_tag(void *vctx, unsigned char *tag, size_t taglen)
+{
+    PROV_GCM_CTX *ctx = (PROV_GCM_CTX *)vctx;
+
+    if (tag == NULL
+        || taglen == 0
+        || taglen > EVP_GCM_TLS_TAG_LEN
+        || !ctx->enc
+        || ctx->taglen == UNINITIALISED_SIZET) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_TAG);
+        return 0;
+    }
+    memcpy(tag, ctx->buf, taglen);
+    return 1;
+}
+
+int ossl_gcm_set_tag(void *vctx, const unsigned char *tag, size_t taglen)
+{
+    PROV_GCM_CTX *ctx = (PROV_GCM_CTX *)vctx;
+
+    if (tag == NULL || taglen > EVP_GCM_TLS_TAG_LEN) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_GET_PARAMETER);
+        return 0;
+    }
+    if (taglen == 0 || ctx->enc) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_TAG);
+        return 0;
+    }
+    memcpy(ctx->buf, tag, taglen);
+    ctx->taglen = taglen;
+    return 1;
+}
+
+int ossl_gcm_set_iv(void *vctx, const unsigned char *iv)
+{
+    PROV_GCM_CTX *ctx = (PROV_GCM_CTX *)vctx;
+
+    if (!ossl_prov_is_running())
+        return 0;
+
+    return gcm_init_iv(ctx, iv, ctx->ivlen);
+}
+
 /* increment counter (64-bit int) by 1 */
 static void ctr64_inc(unsigned char *counter)
 {
@@ -136,20 +191,22 @@ static int setivinv(PROV_GCM_CTX *ctx, unsigned char *in, size_t inl)
 int ossl_gcm_get_ctx_params(void *vctx, OSSL_PARAM params[])
 {
     PROV_GCM_CTX *ctx = (PROV_GCM_CTX *)vctx;
+    struct aead_gcm_get_ctx_params_st r;
     OSSL_PARAM *p;
-    size_t sz;
 
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_IVLEN);
+    aead_gcm_get_ctx_params_decoder(params, &r);
+
+    p = r.ivlen;
     if (p != NULL && !OSSL_PARAM_set_size_t(p, ctx->ivlen)) {
         ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SET_PARAMETER);
         return 0;
     }
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_KEYLEN);
+    p = r.keylen;
     if (p != NULL && !OSSL_PARAM_set_size_t(p, ctx->keylen)) {
         ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SET_PARAMETER);
         return 0;
     }
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_AEAD_TAGLEN);
+    p = r.taglen;
     if (p != NULL) {
         size_t taglen = (ctx->taglen != UNINITIALISED_SIZET) ? ctx->taglen :
                          GCM_TAG_MAX_SIZE;
@@ -160,7 +217,7 @@ int ossl_gcm_get_ctx_params(void *vctx, OSSL_PARAM params[])
         }
     }
 
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_IV);
+    p = r.iv;
     if (p != NULL) {
         if (ctx->iv_state == IV_STATE_UNINITIALISED)
             return 0;
@@ -175,7 +232,7 @@ int ossl_gcm_get_ctx_params(void *vctx, OSSL_PARAM params[])
         }
     }
 
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_UPDATED_IV);
+    p = r.updiv;
     if (p != NULL) {
         if (ctx->iv_state == IV_STATE_UNINITIALISED)
             return 0;
@@ -190,27 +247,22 @@ int ossl_gcm_get_ctx_params(void *vctx, OSSL_PARAM params[])
         }
     }
 
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_AEAD_TLS1_AAD_PAD);
+    p = r.pad;
     if (p != NULL && !OSSL_PARAM_set_size_t(p, ctx->tls_aad_pad_sz)) {
         ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SET_PARAMETER);
         return 0;
     }
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_AEAD_TAG);
+    p = r.tag;
     if (p != NULL) {
-        sz = p->data_size;
-        if (sz == 0
-            || sz > EVP_GCM_TLS_TAG_LEN
-            || !ctx->enc
-            || ctx->taglen == UNINITIALISED_SIZET) {
-            ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_TAG);
-            return 0;
-        }
-        if (!OSSL_PARAM_set_octet_string(p, ctx->buf, sz)) {
+        if (p->data_type != OSSL_PARAM_OCTET_STRING) {
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SET_PARAMETER);
             return 0;
         }
+        if (!ossl_gcm_get_tag(ctx, p->data, p->data_size))
+            return 0;
+        p->return_size = p->data_size;
     }
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_AEAD_TLS1_GET_IV_GEN);
+    p = r.ivgen;
     if (p != NULL) {
         if (p->data == NULL
             || p->data_type != OSSL_PARAM_OCTET_STRING
@@ -225,26 +277,23 @@ int ossl_gcm_set_ctx_params(void *vctx, const OSSL_PARAM params[])
     PROV_GCM_CTX *ctx = (PROV_GCM_CTX *)vctx;
     const OSSL_PARAM *p;
     size_t sz;
-    void *vp;
+    struct aead_gcm_set_ctx_params_st r;
 
     if (params == NULL)
         return 1;
+    aead_gcm_set_ctx_params_decoder(params, &r);
 
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_AEAD_TAG);
+    p = r.tag;
     if (p != NULL) {
-        vp = ctx->buf;
-        if (!OSSL_PARAM_get_octet_string(p, &vp, EVP_GCM_TLS_TAG_LEN, &sz)) {
+        if (p->data_type != OSSL_PARAM_OCTET_STRING) {
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_GET_PARAMETER);
             return 0;
         }
-        if (sz == 0 || ctx->enc) {
-            ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_TAG);
+        if (!ossl_gcm_set_tag(ctx, p->data, p->data_size))
             return 0;
-        }
-        ctx->taglen = sz;
     }
 
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_AEAD_IVLEN);
+    p = r.ivlen;
     if (p != NULL) {
         if (!OSSL_PARAM_get_size_t(p, &sz)) {
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_GET_PARAMETER);
@@ -257,7 +306,7 @@ int ossl_gcm_set_ctx_params(void *vctx, const OSSL_PARAM params[])
         ctx->ivlen = sz;
     }
 
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_AEAD_TLS1_AAD);
+    p = r.aad;
     if (p != NULL) {
         if (p->data_type != OSSL_PARAM_OCTET_STRING) {
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_GET_PARAMETER);
@@ -271,7 +320,7 @@ int ossl_gcm_set_ctx_params(void *vctx, const OSSL_PARAM params[])
         ctx->tls_aad_pad_sz = sz;
     }
 
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_AEAD_TLS1_IV_FIXED);
+    p = r.fixed;
     if (p != NULL) {
         if (p->data_type != OSSL_PARAM_OCTET_STRING) {
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_GET_PARAMETER);
@@ -282,7 +331,7 @@ int ossl_gcm_set_ctx_params(void *vctx, const OSSL_PARAM params[])
             return 0;
         }
     }
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_AEAD_TLS1_SET_IV_INV);
+    p = r.inviv;
     if (p != NULL) {
         if (p->data == NULL
             || p->data_type != OSSL_PARAM_OCTET_STRING
@@ -25,6 +25,7 @@
 #include <openssl/proverr.h>
 #include "internal/cryptlib.h"   /* ossl_assert() */
 #include "internal/asn1.h"
+#include "crypto/asn1.h"
 #include "crypto/dh.h"
 #include "crypto/dsa.h"
 #include "crypto/ec.h"
@@ -106,6 +107,58 @@ static int der_from_p8(unsigned char **new_der, long *new_der_len,
     return ok;
 }
 
+/*
+ * Looks at the outer layers of |der| to see if it's a PKCS#8 PrivateKeyInfo
+ * or a SubjectPublicKeyInfo, and if so, returns the EVP_PKEY type given by
+ * its AlgorithmIdentifier and sets |*structure| to the matching input
+ * structure name.  Nothing is decoded beyond that, so this is cheap.
+ * NID_undef is returned if the input isn't recognised, which includes
+ * type-specific structures and EncryptedPrivateKeyInfo.
+ */
+static int der2key_peek_keytype(const unsigned char *der, long der_len,
+                                const char **structure)
+{
+    const unsigned char *p = der;
+    long len = der_len;
+    int tag, xclass, inf;
+    int type = NID_undef;
+    ASN1_OBJECT algorithm;
+
+    /* Keep parse errors from truncated input out of the error queue */
+    ERR_set_mark();
+
+    /* SEQUENCE { [ version INTEGER, ] SEQUENCE { algorithm OBJECT, ... */
+    inf = ASN1_get_object(&p, &len, &tag, &xclass, len);
+    if ((inf & 0x81) != 0 || tag != V_ASN1_SEQUENCE
+        || xclass != V_ASN1_UNIVERSAL)
+        goto end;
+    inf = ASN1_get_object(&p, &len, &tag, &xclass, len);
+    if ((inf & 0x81) != 0 || xclass != V_ASN1_UNIVERSAL)
+        goto end;
+    *structure = "SubjectPublicKeyInfo";
+    if (tag == V_ASN1_INTEGER) {
+        *structure = "pkcs8";
+        p += len;
+        inf = ASN1_get_object(&p, &len, &tag, &xclass, der + der_len - p);
+        if ((inf & 0x81) != 0 || xclass != V_ASN1_UNIVERSAL)
+            goto end;
+    }
+    if (tag != V_ASN1_SEQUENCE)
+        goto end;
+    inf = ASN1_get_object(&p, &len, &tag, &xclass, len);
+    if ((inf & 0x81) != 0 || tag != V_ASN1_OBJECT
+        || xclass != V_ASN1_UNIVERSAL || len > INT_MAX)
+        goto end;
+
+    memset(&algorithm, 0, sizeof(algorithm));
+    algorithm.data = p;
+    algorithm.length = (int)len;
+    type = EVP_PKEY_type(OBJ_obj2nid(&algorithm));
+ end:
+    ERR_pop_to_mark();
+    return type;
+}
+
 /* ---------------------------------------------------------------------- */
 
 static OSSL_FUNC_decoder_freectx_fn der2key_freectx;
@@ -246,6 +299,29 @@ static int der2key_check_selection(int selection,
     return 0;
 }
 
+/*
+ * Checks if the key type and structure found by der2key_peek_keytype() are
+ * for another decoder than |ctx|.  Decoders are tried one after the other
+ * until one succeeds, so this spares all the others a full decoding attempt.
+ */
+static int der2key_is_other_keytype(struct der2key_ctx_st *ctx, int type,
+                                    const char *structure)
+{
+    int our_type = ctx->desc->evp_type;
+
+    if (type == NID_undef)
+        return 0;
+
+    /* SM2 keys come with the id-ecPublicKey algorithm too */
+    if (type == EVP_PKEY_SM2)
+        type = EVP_PKEY_EC;
+    if (our_type == EVP_PKEY_SM2)
+        our_type = EVP_PKEY_EC;
+
+    return type != our_type
+        || strcasecmp(structure, ctx->desc->structure_name) != 0;
+}
+
 static int der2key_decode(void *vctx, OSSL_CORE_BIO *cin, int selection,
                           OSSL_CALLBACK *data_cb, void *data_cbarg,
                           OSSL_PASSPHRASE_CALLBACK *pw_cb, void *pw_cbarg)
@@ -260,6 +336,8 @@ static int der2key_decode(void *vctx, OSSL_CORE_BIO *cin, int selection,
     EVP_PKEY *pkey = NULL;
     void *key = NULL;
     int orig_selection = selection;
+    const char *structure = NULL;
+    int keytype;
     int dec_err;
     int ok = 0;
 
@@ -281,6 +359,9 @@ static int der2key_decode(void *vctx, OSSL_CORE_BIO *cin, int selection,
     SET_ERR_MARK();
     if (!read_der(ctx->provctx, cin, &der, &der_len))
         goto end;
+    keytype = der2key_peek_keytype(der, der_len, &structure);
+    if (der2key_is_other_keytype(ctx, keytype, structure))
+        goto end;
 
     if (ctx->desc->extract_key == NULL) {
         /*
@@ -311,14 +392,20 @@ static int der2key_decode(void *vctx, OSSL_CORE_BIO *cin, int selection,
          */
 
         /*
-         * Opportunistic attempt to decrypt.  If it doesn't work, we try
-         * to decode our input unencrypted.
+         * Opportunistic attempt to decrypt, unless we already know that
+         * the input isn't encrypted.  If it doesn't work, we try to decode
+         * our input unencrypted.
          */
-        if (der_from_p8(&new_der, &new_der_len, der, der_len,
-                        pw_cb, pw_cbarg)) {
+        if (keytype == NID_undef
+            && der_from_p8(&new_der, &new_der_len, der, der_len,
+                           pw_cb, pw_cbarg)) {
             OPENSSL_free(der);
             der = new_der;
             der_len = new_der_len;
+
+            keytype = der2key_peek_keytype(der, der_len, &structure);
+            if (der2key_is_other_keytype(ctx, keytype, structure))
+                goto end;
         }
         /* decryption errors are fatal and should be reported */
         dec_err = ERR_peek_last_error();
@@ -26,6 +26,7 @@ static OSSL_FUNC_keyexch_newctx_fn x448_newctx;
 static OSSL_FUNC_keyexch_init_fn ecx_init;
 static OSSL_FUNC_keyexch_set_peer_fn ecx_set_peer;
 static OSSL_FUNC_keyexch_derive_fn ecx_derive;
+static OSSL_FUNC_keyexch_derive_batch_fn ecx_derive_batch;
 static OSSL_FUNC_keyexch_freectx_fn ecx_freectx;
 static OSSL_FUNC_keyexch_dupctx_fn ecx_dupctx;
 
@@ -113,6 +114,24 @@ static int ecx_set_peer(void *vecxctx, void *vkey)
     return 1;
 }
 
+static int ecx_compute_key(PROV_ECX_CTX *ecxctx, unsigned char *secret,
+                           const unsigned char *peer)
+{
+    if (ecxctx->keylen == X25519_KEYLEN) {
+#ifdef S390X_EC_ASM
+        if (OPENSSL_s390xcap_P.pcc[1]
+                & S390X_CAPBIT(S390X_SCALAR_MULTIPLY_X25519))
+            return s390x_x25519_mul(secret, peer, ecxctx->key->privkey);
+#endif
+        return ossl_x25519(secret, ecxctx->key->privkey, peer);
+    }
+#ifdef S390X_EC_ASM
+    if (OPENSSL_s390xcap_P.pcc[1] & S390X_CAPBIT(S390X_SCALAR_MULTIPLY_X448))
+        return s390x_x448_mul(secret, peer, ecxctx->key->privkey);
+#endif
+    return ossl_x448(secret, ecxctx->key->privkey, peer);
+}
+
 static int ecx_derive(void *vecxctx, unsigned char *secret, size_t *secretlen,
                       size_t outlen)
 {
@@ -143,44 +162,74 @@ static int ecx_derive(void *vecxctx, unsigned char *secret, size_t *secretlen,
         return 0;
     }
 
-    if (ecxctx->keylen == X25519_KEYLEN) {
-#ifdef S390X_EC_ASM
-        if (OPENSSL_s390xcap_P.pcc[1]
-                & S390X_CAPBIT(S390X_SCALAR_MULTIPLY_X25519)) {
-            if (s390x_x25519_mul(secret, ecxctx->peerkey->pubkey,
-                                 ecxctx->key->privkey) == 0) {
-                ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_DURING_DERIVATION);
-                return 0;
-            }
-        } else
-#endif
-        if (ossl_x25519(secret, ecxctx->key->privkey,
-                        ecxctx->peerkey->pubkey) == 0) {
-            ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_DURING_DERIVATION);
-            return 0;
-        }
-    } else {
-#ifdef S390X_EC_ASM
-        if (OPENSSL_s390xcap_P.pcc[1]
-                & S390X_CAPBIT(S390X_SCALAR_MULTIPLY_X448)) {
-            if (s390x_x448_mul(secret, ecxctx->peerkey->pubkey,
-                               ecxctx->key->privkey) == 0) {
-                ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_DURING_DERIVATION);
-                return 0;
-            }
-        } else
-#endif
-        if (ossl_x448(secret, ecxctx->key->privkey,
-                      ecxctx->peerkey->pubkey) == 0) {
-            ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_DURING_DERIVATION);
-            return 0;
-        }
+    if (!ecx_compute_key(ecxctx, secret, ecxctx->peerkey->pubkey)) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_DURING_DERIVATION);
+        return 0;
     }
 
     *secretlen = ecxctx->keylen;
     return 1;
 }
 
+#define ECX_DERIVE_BATCH_SIZE 32
+
+static int ecx_derive_batch(void *vecxctx, size_t num,
+                            const unsigned char *const peers[],
+                            const size_t peerlens[],
+                            unsigned char *const secrets[], size_t *secretlen,
+                            size_t outlen, int results[])
+{
+    /* Stands in for malformed peer keys: u = 0 is of small order */
+    static const unsigned char bad_peer[X25519_KEYLEN] = { 0 };
+    PROV_ECX_CTX *ecxctx = (PROV_ECX_CTX *)vecxctx;
+    const unsigned char *chunk[ECX_DERIVE_BATCH_SIZE];
+    size_t i, n, done;
+    int ret = 1;
+
+    if (!ossl_prov_is_running())
+        return -1;
+
+    if (ecxctx->key == NULL || ecxctx->key->privkey == NULL) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_MISSING_KEY);
+        return -1;
+    }
+
+    if (outlen < ecxctx->keylen) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_OUTPUT_BUFFER_TOO_SMALL);
+        return -1;
+    }
+    *secretlen = ecxctx->keylen;
+
+#ifdef S390X_EC_ASM
+    if (OPENSSL_s390xcap_P.pcc[1] & S390X_CAPBIT(S390X_SCALAR_MULTIPLY_X25519))
+        goto one_by_one;
+#endif
+    if (ecxctx->keylen != X25519_KEYLEN)
+        goto one_by_one;
+
+    for (done = 0; done < num; done += n) {
+        n = num - done;
+        if (n > ECX_DERIVE_BATCH_SIZE)
+            n = ECX_DERIVE_BATCH_SIZE;
+        for (i = 0; i < n; i++)
+            chunk[i] = peerlens[done + i] == X25519_KEYLEN ? peers[done + i]
+                                                           : bad_peer;
+        if (!ossl_x25519_batch(results + done, n, secrets + done,
+                               ecxctx->key->privkey, chunk))
+            ret = 0;
+    }
+    return ret;
+
+ one_by_one:
+    for (i = 0; i < num; i++) {
+        results[i] = peerlens[i] == ecxctx->keylen
+                     && ecx_compute_key(ecxctx, secrets[i], peers[i]);
+        if (!results[i])
+            ret = 0;
+    }
+    return ret;
+}
+
 static void ecx_freectx(void *vecxctx)
 {
     PROV_ECX_CTX *ecxctx = (PROV_ECX_CTX *)vecxctx;
@@ -226,6 +275,7 @@ const OSSL_DISPATCH ossl_x25519_keyexch_functions[] = {
     { OSSL_FUNC_KEYEXCH_NEWCTX, (void (*)(void))x25519_newctx },
     { OSSL_FUNC_KEYEXCH_INIT, (void (*)(void))ecx_init },
     { OSSL_FUNC_KEYEXCH_DERIVE, (void (*)(void))ecx_derive },
+    { OSSL_FUNC_KEYEXCH_DERIVE_BATCH, (void (*)(void))ecx_derive_batch },
     { OSSL_FUNC_KEYEXCH_SET_PEER, (void (*)(void))ecx_set_peer },
     { OSSL_FUNC_KEYEXCH_FREECTX, (void (*)(void))ecx_freectx },
     { OSSL_FUNC_KEYEXCH_DUPCTX, (void (*)(void))ecx_dupctx },
@@ -236,6 +286,7 @@ const OSSL_DISPATCH ossl_x448_keyexch_functions[] = {
     { OSSL_FUNC_KEYEXCH_NEWCTX, (void (*)(void))x448_newctx },
     { OSSL_FUNC_KEYEXCH_INIT, (void (*)(void))ecx_init },
     { OSSL_FUNC_KEYEXCH_DERIVE, (void (*)(void))ecx_derive },
+    { OSSL_FUNC_KEYEXCH_DERIVE_BATCH, (void (*)(void))ecx_derive_batch },
     { OSSL_FUNC_KEYEXCH_SET_PEER, (void (*)(void))ecx_set_peer },
     { OSSL_FUNC_KEYEXCH_FREECTX, (void (*)(void))ecx_freectx },
     { OSSL_FUNC_KEYEXCH_DUPCTX, (void (*)(void))ecx_dupctx },
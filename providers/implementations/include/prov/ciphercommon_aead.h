@@ -43,5 +43,8 @@ const OSSL_DISPATCH ossl_##alg##kbits##lc##_functions[] = {                    \
       (void (*)(void))ossl_cipher_aead_gettable_ctx_params },                  \
     { OSSL_FUNC_CIPHER_SETTABLE_CTX_PARAMS,                                    \
       (void (*)(void))ossl_cipher_aead_settable_ctx_params },                  \
+    { OSSL_FUNC_CIPHER_GET_TAG, (void (*)(void))ossl_##lc##_get_tag },        \
+    { OSSL_FUNC_CIPHER_SET_TAG, (void (*)(void))ossl_##lc##_set_tag },        \
+    { OSSL_FUNC_CIPHER_SET_IV, (void (*)(void))ossl_##lc##_set_iv },          \
     { 0, NULL }                                                                \
 }
@@ -82,6 +82,9 @@ OSSL_FUNC_cipher_encrypt_init_fn ossl_ccm_einit;
 OSSL_FUNC_cipher_decrypt_init_fn ossl_ccm_dinit;
 OSSL_FUNC_cipher_get_ctx_params_fn ossl_ccm_get_ctx_params;
 OSSL_FUNC_cipher_set_ctx_params_fn ossl_ccm_set_ctx_params;
+OSSL_FUNC_cipher_get_tag_fn ossl_ccm_get_tag;
+OSSL_FUNC_cipher_set_tag_fn ossl_ccm_set_tag;
+OSSL_FUNC_cipher_set_iv_fn ossl_ccm_set_iv;
 OSSL_FUNC_cipher_update_fn ossl_ccm_stream_update;
 OSSL_FUNC_cipher_final_fn ossl_ccm_stream_final;
 OSSL_FUNC_cipher_cipher_fn ossl_ccm_cipher;
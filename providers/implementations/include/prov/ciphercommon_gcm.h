@@ -106,6 +106,9 @@ OSSL_FUNC_cipher_encrypt_init_fn ossl_gcm_einit;
 OSSL_FUNC_cipher_decrypt_init_fn ossl_gcm_dinit;
 OSSL_FUNC_cipher_get_ctx_params_fn ossl_gcm_get_ctx_params;
 OSSL_FUNC_cipher_set_ctx_params_fn ossl_gcm_set_ctx_params;
+OSSL_FUNC_cipher_get_tag_fn ossl_gcm_get_tag;
+OSSL_FUNC_cipher_set_tag_fn ossl_gcm_set_tag;
+OSSL_FUNC_cipher_set_iv_fn ossl_gcm_set_iv;
 OSSL_FUNC_cipher_cipher_fn ossl_gcm_cipher;
 OSSL_FUNC_cipher_update_fn ossl_gcm_stream_update;
 OSSL_FUNC_cipher_final_fn ossl_gcm_stream_final;
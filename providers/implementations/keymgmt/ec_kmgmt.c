@@ -757,6 +757,7 @@ static const OSSL_PARAM ec_known_settable_params[] = {
     OSSL_PARAM_octet_string(OSSL_PKEY_PARAM_EC_SEED, NULL, 0),
     OSSL_PARAM_int(OSSL_PKEY_PARAM_EC_INCLUDE_PUBLIC, NULL),
     OSSL_PARAM_utf8_string(OSSL_PKEY_PARAM_EC_GROUP_CHECK_TYPE, NULL, 0),
+    OSSL_PARAM_int(OSSL_PKEY_PARAM_EC_VERIFY_PRECOMPUTE_THRESHOLD, NULL),
     OSSL_PARAM_END
 };
 
@@ -795,6 +796,16 @@ int ec_set_params(void *key, const OSSL_PARAM params[])
             return 0;
     }
 
+    p = OSSL_PARAM_locate_const(params,
+                                OSSL_PKEY_PARAM_EC_VERIFY_PRECOMPUTE_THRESHOLD);
+    if (p != NULL) {
+        int threshold;
+
+        if (!OSSL_PARAM_get_int(p, &threshold)
+            || !ossl_ec_key_set_verify_precomp_threshold(eck, threshold))
+            return 0;
+    }
+
     return ossl_ec_key_otherparams_fromdata(eck, params);
 }
 
@@ -72,6 +72,18 @@ static int pss_params_fromdata(RSA_PSS_PARAMS_30 *pss_params, int *defaults_set,
     return 1;
 }
 
+/*
+ * Prepare a private key for use, so that its first operation is as fast as
+ * the following ones.  This is only an optimisation: a key that can't be
+ * prepared (because it's inconsistent, say) is caught when it's used.
+ */
+static void rsa_precompute(RSA *rsa)
+{
+    ERR_set_mark();
+    ossl_rsa_precompute(rsa);
+    ERR_pop_to_mark();
+}
+
 static void *rsa_newdata(void *provctx)
 {
     OSSL_LIB_CTX *libctx = PROV_LIBCTX_OF(provctx);
@@ -171,6 +183,8 @@ static int rsa_import(void *keydata, int selection, const OSSL_PARAM params[])
                                        ossl_rsa_get0_libctx(rsa));
     if ((selection & OSSL_KEYMGMT_SELECT_KEYPAIR) != 0)
         ok = ok && ossl_rsa_fromdata(rsa, params);
+    if (ok && (selection & OSSL_KEYMGMT_SELECT_PRIVATE_KEY) != 0)
+        rsa_precompute(rsa);
 
     return ok;
 }
@@ -584,6 +598,7 @@ static void *rsa_gen(void *genctx, OSSL_CALLBACK *osslcb, void *cbarg)
     if (!ossl_rsa_pss_params_30_copy(ossl_rsa_get0_pss_params_30(rsa_tmp),
                                      &gctx->pss_params))
         goto err;
+    rsa_precompute(rsa_tmp);
 
     RSA_clear_flags(rsa_tmp, RSA_FLAG_TYPE_MASK);
     RSA_set_flags(rsa_tmp, gctx->rsa_type);
@@ -619,6 +634,7 @@ void *rsa_load(const void *reference, size_t reference_sz)
         rsa = *(RSA **)reference;
         /* We grabbed, so we detach it */
         *(RSA **)reference = NULL;
+        rsa_precompute(rsa);
         return rsa;
     }
     return NULL;
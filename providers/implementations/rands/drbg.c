@@ -112,6 +112,15 @@ static unsigned int get_parent_reseed_count(PROV_DRBG *drbg)
     void *parent = drbg->parent;
     unsigned int r = 0;
 
+    /*
+     * If the parent is one of our own DRBGs, its reseed counter can be read
+     * atomically without taking the parent's lock.  This keeps the lock out
+     * of the generate path of the per thread DRBGs, which check this on
+     * every request.
+     */
+    if (drbg->parent_is_drbg)
+        return tsan_load(&((PROV_DRBG *)parent)->reseed_counter);
+
     *params = OSSL_PARAM_construct_uint(OSSL_DRBG_PARAM_RESEED_COUNTER, &r);
     if (!ossl_drbg_lock_parent(drbg)) {
         ERR_raise(ERR_LIB_PROV, PROV_R_UNABLE_TO_LOCK_PARENT);
@@ -477,6 +486,77 @@ int ossl_prov_drbg_instantiate(PROV_DRBG *drbg, unsigned int strength,
     return 0;
 }
 
+/*
+ * Discard any buffered output of |drbg|.
+ */
+static void drbg_clear_buffer(PROV_DRBG *drbg)
+{
+    if (drbg->outbuf != NULL)
+        OPENSSL_cleanse(drbg->outbuf, drbg->outbuf_size);
+    drbg->outbuf_avail = 0;
+}
+
+/*
+ * Set up an output buffer of |size| bytes for |drbg|, or remove it if |size|
+ * is zero.  Each refill of the buffer is a single generate request, so the
+ * buffer cannot be larger than the maximum request size.
+ *
+ * Requires that drbg->lock is already locked for write, if non-null.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int drbg_set_buffer_size(PROV_DRBG *drbg, size_t size)
+{
+    unsigned char *outbuf = NULL;
+
+    if (size == drbg->outbuf_size)
+        return 1;
+    if (size > drbg->max_request) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_REQUEST_TOO_LARGE_FOR_DRBG);
+        return 0;
+    }
+    if (size > 0 && (outbuf = OPENSSL_malloc(size)) == NULL) {
+        ERR_raise(ERR_LIB_PROV, ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+    OPENSSL_clear_free(drbg->outbuf, drbg->outbuf_size);
+    drbg->outbuf = outbuf;
+    drbg->outbuf_size = size;
+    drbg->outbuf_avail = 0;
+    return 1;
+}
+
+/*
+ * Serve a small request from the output buffer of |drbg|, refilling it with
+ * a single generate request when it doesn't hold enough bytes.  Bytes are
+ * wiped from the buffer as soon as they have been handed out.
+ *
+ * Requires that drbg->lock is already locked for write, if non-null.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int drbg_generate_buffered(PROV_DRBG *drbg, unsigned char *out,
+                                  size_t outlen)
+{
+    unsigned char *p;
+
+    if (drbg->outbuf_avail < outlen) {
+        if (!drbg->generate(drbg, drbg->outbuf, drbg->outbuf_size, NULL, 0)) {
+            drbg_clear_buffer(drbg);
+            drbg->state = EVP_RAND_STATE_ERROR;
+            ERR_raise(ERR_LIB_PROV, PROV_R_GENERATE_ERROR);
+            return 0;
+        }
+        drbg->generate_counter++;
+        drbg->outbuf_avail = drbg->outbuf_size;
+    }
+    p = drbg->outbuf + drbg->outbuf_size - drbg->outbuf_avail;
+    memcpy(out, p, outlen);
+    OPENSSL_cleanse(p, outlen);
+    drbg->outbuf_avail -= outlen;
+    return 1;
+}
+
 /*
  * Uninstantiate |drbg|. Must be instantiated before it can be used.
  *
@@ -486,6 +566,7 @@ int ossl_prov_drbg_instantiate(PROV_DRBG *drbg, unsigned int strength,
  */
 int ossl_prov_drbg_uninstantiate(PROV_DRBG *drbg)
 {
+    drbg_clear_buffer(drbg);
     drbg->state = EVP_RAND_STATE_UNINITIALISED;
     return 1;
 }
@@ -542,6 +623,7 @@ int ossl_prov_drbg_reseed(PROV_DRBG *drbg, int prediction_resistance,
     }
 
     drbg->state = EVP_RAND_STATE_ERROR;
+    drbg_clear_buffer(drbg);
 
     drbg->reseed_next_counter = tsan_load(&drbg->reseed_counter);
     if (drbg->reseed_next_counter) {
@@ -616,7 +698,7 @@ int ossl_prov_drbg_generate(PROV_DRBG *drbg, unsigned char *out, size_t outlen,
                             const unsigned char *adin, size_t adinlen)
 {
     int fork_id;
-    int reseed_required = 0;
+    int reseed_required = 0, buffered;
 
     if (!ossl_prov_is_running())
         return 0;
@@ -648,6 +730,15 @@ int ossl_prov_drbg_generate(PROV_DRBG *drbg, unsigned char *out, size_t outlen,
         return 0;
     }
 
+    /*
+     * Requests with additional input or prediction resistance always get
+     * output generated for them alone.
+     */
+    buffered = drbg->outbuf != NULL && !prediction_resistance
+               && (adin == NULL || adinlen == 0)
+               && outlen <= DRBG_MAX_BUFFERED_REQUEST
+               && outlen <= drbg->outbuf_size;
+
     fork_id = openssl_get_fork_id();
 
     if (drbg->fork_id != fork_id) {
@@ -679,6 +770,9 @@ int ossl_prov_drbg_generate(PROV_DRBG *drbg, unsigned char *out, size_t outlen,
         adinlen = 0;
     }
 
+    if (buffered)
+        return drbg_generate_buffered(drbg, out, outlen);
+
     if (!drbg->generate(drbg, out, outlen, adin, adinlen)) {
         drbg->state = EVP_RAND_STATE_ERROR;
         ERR_raise(ERR_LIB_PROV, PROV_R_GENERATE_ERROR);
@@ -800,6 +894,9 @@ PROV_DRBG *ossl_rand_drbg_new
         drbg->parent_enable_locking = OSSL_FUNC_rand_enable_locking(pfunc);
     if ((pfunc = find_call(p_dispatch, OSSL_FUNC_RAND_LOCK)) != NULL)
         drbg->parent_lock = OSSL_FUNC_rand_lock(pfunc);
+    /* Only our own DRBGs use ossl_drbg_lock() */
+    drbg->parent_is_drbg = parent != NULL
+                           && drbg->parent_lock == ossl_drbg_lock;
     if ((pfunc = find_call(p_dispatch, OSSL_FUNC_RAND_UNLOCK)) != NULL)
         drbg->parent_unlock = OSSL_FUNC_rand_unlock(pfunc);
     if ((pfunc = find_call(p_dispatch, OSSL_FUNC_RAND_GET_CTX_PARAMS)) != NULL)
@@ -848,6 +945,7 @@ void ossl_rand_drbg_free(PROV_DRBG *drbg)
     if (drbg == NULL)
         return;
 
+    OPENSSL_clear_free(drbg->outbuf, drbg->outbuf_size);
     CRYPTO_THREAD_lock_free(drbg->lock);
     OPENSSL_free(drbg);
 }
@@ -908,6 +1006,10 @@ int ossl_drbg_get_ctx_params(PROV_DRBG *drbg, OSSL_PARAM params[])
     if (p != NULL
             && !OSSL_PARAM_set_uint(p, tsan_load(&drbg->reseed_counter)))
         return 0;
+
+    p = OSSL_PARAM_locate(params, OSSL_DRBG_PARAM_BUFFER_SIZE);
+    if (p != NULL && !OSSL_PARAM_set_size_t(p, drbg->outbuf_size))
+        return 0;
     return 1;
 }
 
@@ -925,5 +1027,14 @@ int ossl_drbg_set_ctx_params(PROV_DRBG *drbg, const OSSL_PARAM params[])
     p = OSSL_PARAM_locate_const(params, OSSL_DRBG_PARAM_RESEED_TIME_INTERVAL);
     if (p != NULL && !OSSL_PARAM_get_time_t(p, &drbg->reseed_time_interval))
         return 0;
+
+    p = OSSL_PARAM_locate_const(params, OSSL_DRBG_PARAM_BUFFER_SIZE);
+    if (p != NULL) {
+        size_t size;
+
+        if (!OSSL_PARAM_get_size_t(p, &size)
+                || !drbg_set_buffer_size(drbg, size))
+            return 0;
+    }
     return 1;
 }
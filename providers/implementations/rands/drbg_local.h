@@ -26,6 +26,12 @@
 # define MAX_RESEED_INTERVAL                     (1 << 24)
 # define MAX_RESEED_TIME_INTERVAL                (1 << 20) /* approx. 12 days */
 
+/*
+ * Largest request that is served from the output buffer, if there is one.
+ * Anything bigger goes through a full generate cycle anyway.
+ */
+# define DRBG_MAX_BUFFERED_REQUEST               256
+
 /* Default reseed intervals */
 # define RESEED_INTERVAL                         (1 << 8)
 # define TIME_INTERVAL                           (60*60)   /* 1 hour */
@@ -96,6 +102,8 @@ struct prov_drbg_st {
     OSSL_FUNC_rand_clear_seed_fn *parent_clear_seed;
 
     const OSSL_DISPATCH *parent_dispatch;
+    /* Set if |parent| is a PROV_DRBG from this provider */
+    int parent_is_drbg;
 
     /*
      * Stores the return value of openssl_get_fork_id() as of when we last
@@ -167,6 +175,17 @@ struct prov_drbg_st {
     size_t seedlen;
     DRBG_STATUS state;
 
+    /*
+     * Optional buffer of pre-generated output.  When it is set up, small
+     * requests without additional input are served from it, so that they
+     * cost a copy rather than a complete generate cycle each.  The buffer
+     * is wiped whenever the DRBG is reseeded or uninstantiated, which also
+     * covers reseeds caused by a fork or by the parent being reseeded.
+     */
+    unsigned char *outbuf;
+    size_t outbuf_size;
+    size_t outbuf_avail;
+
     /* DRBG specific data */
     void *data;
 
@@ -231,7 +250,8 @@ int ossl_drbg_set_ctx_params(PROV_DRBG *drbg, const OSSL_PARAM params[]);
 
 #define OSSL_PARAM_DRBG_SETTABLE_CTX_COMMON                                      \
     OSSL_PARAM_uint(OSSL_DRBG_PARAM_RESEED_REQUESTS, NULL),             \
-    OSSL_PARAM_uint64(OSSL_DRBG_PARAM_RESEED_TIME_INTERVAL, NULL)
+    OSSL_PARAM_uint64(OSSL_DRBG_PARAM_RESEED_TIME_INTERVAL, NULL),      \
+    OSSL_PARAM_size_t(OSSL_DRBG_PARAM_BUFFER_SIZE, NULL)
 
 #define OSSL_PARAM_DRBG_GETTABLE_CTX_COMMON                             \
     OSSL_PARAM_int(OSSL_RAND_PARAM_STATE, NULL),                        \
@@ -246,7 +266,8 @@ int ossl_drbg_set_ctx_params(PROV_DRBG *drbg, const OSSL_PARAM params[]);
     OSSL_PARAM_uint(OSSL_DRBG_PARAM_RESEED_COUNTER, NULL),              \
     OSSL_PARAM_time_t(OSSL_DRBG_PARAM_RESEED_TIME, NULL),               \
     OSSL_PARAM_uint(OSSL_DRBG_PARAM_RESEED_REQUESTS, NULL),             \
-    OSSL_PARAM_uint64(OSSL_DRBG_PARAM_RESEED_TIME_INTERVAL, NULL)
+    OSSL_PARAM_uint64(OSSL_DRBG_PARAM_RESEED_TIME_INTERVAL, NULL),      \
+    OSSL_PARAM_size_t(OSSL_DRBG_PARAM_BUFFER_SIZE, NULL)
 
 /* Continuous test "entropy" calls */
 size_t ossl_crngt_get_entropy(PROV_DRBG *drbg,
@@ -50,6 +50,7 @@ static OSSL_FUNC_signature_digest_sign_fn ed25519_digest_sign;
 static OSSL_FUNC_signature_digest_sign_fn ed448_digest_sign;
 static OSSL_FUNC_signature_digest_verify_fn ed25519_digest_verify;
 static OSSL_FUNC_signature_digest_verify_fn ed448_digest_verify;
+static OSSL_FUNC_signature_digest_verify_batch_fn ed25519_digest_verify_batch;
 static OSSL_FUNC_signature_freectx_fn eddsa_freectx;
 static OSSL_FUNC_signature_dupctx_fn eddsa_dupctx;
 static OSSL_FUNC_signature_get_ctx_params_fn eddsa_get_ctx_params;
@@ -218,6 +219,65 @@ int ed25519_digest_verify(void *vpeddsactx, const unsigned char *sig,
                                peddsactx->libctx, edkey->propq);
 }
 
+static int ed25519_digest_verify_batch(void *vpeddsactx, size_t num,
+                                       const unsigned char *const sigs[],
+                                       const size_t siglens[],
+                                       const unsigned char *const tbs[],
+                                       const size_t tbslens[], int results[])
+{
+    static const unsigned char bad_sig[ED25519_SIGSIZE] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+    };
+    PROV_EDDSA_CTX *peddsactx = (PROV_EDDSA_CTX *)vpeddsactx;
+    const ECX_KEY *edkey = peddsactx->key;
+    const unsigned char **fixed;
+    size_t i;
+    int ret = 1;
+
+    if (!ossl_prov_is_running())
+        return 0;
+
+#ifdef S390X_EC_ASM
+    if (S390X_CAN_SIGN(ED25519)) {
+        for (i = 0; i < num; i++) {
+            results[i] = ed25519_digest_verify(vpeddsactx, sigs[i], siglens[i],
+                                               tbs[i], tbslens[i]);
+            if (!results[i])
+                ret = 0;
+        }
+        return ret;
+    }
+#endif /* S390X_EC_ASM */
+
+    for (i = 0; i < num && siglens[i] == ED25519_SIGSIZE; i++)
+        continue;
+    if (i == num)
+        return ossl_ed25519_verify_batch(results, num, tbs, tbslens, sigs,
+                                         edkey->pubkey, peddsactx->libctx,
+                                         edkey->propq);
+
+    /*
+     * Signatures of the wrong size are invalid.  Replace them with one that
+     * has an out of range s, which is rejected before any other work.
+     */
+    if ((fixed = OPENSSL_malloc(num * sizeof(*fixed))) == NULL) {
+        ERR_raise(ERR_LIB_PROV, ERR_R_MALLOC_FAILURE);
+        return -1;
+    }
+    for (i = 0; i < num; i++)
+        fixed[i] = siglens[i] == ED25519_SIGSIZE ? sigs[i] : bad_sig;
+    ret = ossl_ed25519_verify_batch(results, num, tbs, tbslens, fixed,
+                                    edkey->pubkey, peddsactx->libctx,
+                                    edkey->propq);
+    OPENSSL_free(fixed);
+    return ret;
+}
+
 int ed448_digest_verify(void *vpeddsactx, const unsigned char *sig,
                         size_t siglen, const unsigned char *tbs,
                         size_t tbslen)
@@ -310,6 +370,8 @@ const OSSL_DISPATCH ossl_ed25519_signature_functions[] = {
       (void (*)(void))eddsa_digest_signverify_init },
     { OSSL_FUNC_SIGNATURE_DIGEST_VERIFY,
       (void (*)(void))ed25519_digest_verify },
+    { OSSL_FUNC_SIGNATURE_DIGEST_VERIFY_BATCH,
+      (void (*)(void))ed25519_digest_verify_batch },
     { OSSL_FUNC_SIGNATURE_FREECTX, (void (*)(void))eddsa_freectx },
     { OSSL_FUNC_SIGNATURE_DUPCTX, (void (*)(void))eddsa_dupctx },
     { OSSL_FUNC_SIGNATURE_GET_CTX_PARAMS, (void (*)(void))eddsa_get_ctx_params },
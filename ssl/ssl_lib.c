@@ -1190,6 +1190,7 @@ void SSL_free(SSL *s)
     s->rbio = NULL;
 
     BUF_MEM_free(s->init_buf);
+    ossl_arena_free(s->init_arena);
 
     /* add extra stuff */
     sk_SSL_CIPHER_free(s->cipher_list);
@@ -1811,6 +1812,8 @@ static int ssl_io_intern(void *vargs)
 
 int ssl_read_internal(SSL *s, void *buf, size_t num, size_t *readbytes)
 {
+    int ret, traced;
+
     if (s->handshake_func == NULL) {
         ERR_raise(ERR_LIB_SSL, SSL_R_UNINITIALIZED);
         return -1;
@@ -1832,9 +1835,9 @@ int ssl_read_internal(SSL *s, void *buf, size_t num, size_t *readbytes)
      */
     ossl_statem_check_finish_init(s, 0);
 
+    traced = CRYPTO_alloc_trace_enter("SSL_read");
     if ((s->mode & SSL_MODE_ASYNC) && ASYNC_get_current_job() == NULL) {
         struct ssl_async_args args;
-        int ret;
 
         args.s = s;
         args.buf = buf;
@@ -1844,10 +1847,11 @@ int ssl_read_internal(SSL *s, void *buf, size_t num, size_t *readbytes)
 
         ret = ssl_start_async_job(s, &args, ssl_io_intern);
         *readbytes = s->asyncrw;
-        return ret;
     } else {
-        return s->method->ssl_read(s, buf, num, readbytes);
+        ret = s->method->ssl_read(s, buf, num, readbytes);
     }
+    CRYPTO_alloc_trace_leave(traced);
+    return ret;
 }
 
 int SSL_read(SSL *s, void *buf, int num)
@@ -2002,6 +2006,8 @@ int SSL_peek_ex(SSL *s, void *buf, size_t num, size_t *readbytes)
 
 int ssl_write_internal(SSL *s, const void *buf, size_t num, size_t *written)
 {
+    int ret, traced;
+
     if (s->handshake_func == NULL) {
         ERR_raise(ERR_LIB_SSL, SSL_R_UNINITIALIZED);
         return -1;
@@ -2022,8 +2028,8 @@ int ssl_write_internal(SSL *s, const void *buf, size_t num, size_t *written)
     /* If we are a client and haven't sent the Finished we better do that */
     ossl_statem_check_finish_init(s, 1);
 
+    traced = CRYPTO_alloc_trace_enter("SSL_write");
     if ((s->mode & SSL_MODE_ASYNC) && ASYNC_get_current_job() == NULL) {
-        int ret;
         struct ssl_async_args args;
 
         args.s = s;
@@ -2034,10 +2040,11 @@ int ssl_write_internal(SSL *s, const void *buf, size_t num, size_t *written)
 
         ret = ssl_start_async_job(s, &args, ssl_io_intern);
         *written = s->asyncrw;
-        return ret;
     } else {
-        return s->method->ssl_write(s, buf, num, written);
+        ret = s->method->ssl_write(s, buf, num, written);
     }
+    CRYPTO_alloc_trace_leave(traced);
+    return ret;
 }
 
 ossl_ssize_t SSL_sendfile(SSL *s, int fd, off_t offset, size_t size, int flags)
@@ -3834,6 +3841,8 @@ int SSL_do_handshake(SSL *s)
     s->method->ssl_renegotiate_check(s, 0);
 
     if (SSL_in_init(s) || SSL_in_before(s)) {
+        int traced = CRYPTO_alloc_trace_enter("SSL_do_handshake");
+
         if ((s->mode & SSL_MODE_ASYNC) && ASYNC_get_current_job() == NULL) {
             struct ssl_async_args args;
 
@@ -3843,6 +3852,7 @@ int SSL_do_handshake(SSL *s)
         } else {
             ret = s->handshake_func(s);
         }
+        CRYPTO_alloc_trace_leave(traced);
     }
     return ret;
 }
@@ -1247,6 +1247,11 @@ struct ssl_st {
     OSSL_STATEM statem;
     SSL_EARLY_DATA_STATE early_data_state;
     BUF_MEM *init_buf;          /* buffer used during init */
+    /*
+     * Scratch space for the construction of a handshake message, which is
+     * released as a whole once the message has been written
+     */
+    OSSL_ARENA *init_arena;
     void *init_msg;             /* pointer to handshake message body, set by
                                  * ssl3_get_message() */
     size_t init_num;               /* amount read/written */
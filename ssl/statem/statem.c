@@ -152,6 +152,9 @@ void ossl_statem_fatal(SSL *s, int al, int reason, const char *fmt, ...)
             SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_R_MISSING_FATAL); \
     } while (0)
 
+/* Chunk size of the arena that handshake messages are constructed in */
+#define STATEM_ARENA_SIZE 1024
+
 /*
  * Discover whether the current connection is in the error state.
  *
@@ -833,7 +836,15 @@ static SUB_STATE_RETURN write_state_machine(SSL *s)
                 st->write_state_work = WORK_MORE_A;
                 break;
             }
-            if (!WPACKET_init(&pkt, s->init_buf)
+            if (s->init_arena == NULL
+                    && (s->init_arena = ossl_arena_new(STATEM_ARENA_SIZE))
+                       == NULL) {
+                SSLfatal(s, SSL_AD_INTERNAL_ERROR, ERR_R_MALLOC_FAILURE);
+                return SUB_STATE_ERROR;
+            }
+            /* Anything left from the previous message can go now */
+            ossl_arena_reset(s->init_arena);
+            if (!WPACKET_init_arena(&pkt, s->init_buf, s->init_arena)
                     || !ssl_set_handshake_header(s, &pkt, mt)) {
                 WPACKET_cleanup(&pkt);
                 SSLfatal(s, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
@@ -0,0 +1,512 @@
+/*
+ * Copyright 2021 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Allocation budgets for operations that are expected to be cheap.  The
+ * budgets are upper bounds with some room to spare; a test failing here
+ * means that a change made a hot path allocate (a lot) more than it did.
+ */
+
+#include <string.h>
+#include <openssl/crypto.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+#include "internal/nelem.h"
+#include "helpers/ssltestlib.h"
+#include "testutil.h"
+
+static char *certsdir = NULL;
+static char *cert = NULL;
+static char *privkey = NULL;
+
+/* Allocations and frees counted per traced API function */
+static struct {
+    const char *api;
+    size_t allocs;
+    size_t frees;
+} counts[16];
+
+static void count_cb(int op, const char *api, size_t num,
+                     const char *file, int line, void *arg)
+{
+    size_t i;
+
+    if (api == NULL)
+        return;
+    for (i = 0; i < OSSL_NELEM(counts); i++) {
+        if (counts[i].api == NULL)
+            counts[i].api = api;
+        if (strcmp(counts[i].api, api) == 0)
+            break;
+    }
+    if (i == OSSL_NELEM(counts))
+        return;
+    if (op == CRYPTO_ALLOC_TRACE_FREE)
+        counts[i].frees++;
+    else
+        counts[i].allocs++;
+}
+
+static void reset_counts(void)
+{
+    memset(counts, 0, sizeof(counts));
+}
+
+static size_t allocs(const char *api)
+{
+    size_t i;
+
+    for (i = 0; i < OSSL_NELEM(counts) && counts[i].api != NULL; i++)
+        if (strcmp(counts[i].api, api) == 0)
+            return counts[i].allocs;
+    return 0;
+}
+
+static size_t frees(const char *api)
+{
+    size_t i;
+
+    for (i = 0; i < OSSL_NELEM(counts) && counts[i].api != NULL; i++)
+        if (strcmp(counts[i].api, api) == 0)
+            return counts[i].frees;
+    return 0;
+}
+
+static int start_trace(void)
+{
+    reset_counts();
+    return CRYPTO_set_alloc_trace_cb(count_cb, NULL);
+}
+
+static void stop_trace(void)
+{
+    CRYPTO_set_alloc_trace_cb(NULL, NULL);
+}
+
+static int test_alloc_trace(void)
+{
+    char *p = NULL, *q;
+    int entered, res = 0;
+
+    stop_trace();
+    if (!TEST_false(CRYPTO_alloc_trace_enter("off"))
+            || !TEST_true(start_trace())
+            || !TEST_true(entered = CRYPTO_alloc_trace_enter("outer")))
+        goto err;
+
+    /* Nested functions don't take over */
+    if (!TEST_false(CRYPTO_alloc_trace_enter("inner")))
+        goto err;
+    OPENSSL_free(OPENSSL_malloc(10));
+    OPENSSL_free(NULL);
+    CRYPTO_alloc_trace_leave(0);
+    OPENSSL_free(OPENSSL_zalloc(10));
+    /* Reallocating from NULL or to nothing counts once */
+    if (!TEST_ptr(p = OPENSSL_realloc(NULL, 10))
+            || !TEST_ptr(q = OPENSSL_realloc(p, 20)))
+        goto err;
+    p = NULL;
+    if (!TEST_ptr_null(OPENSSL_realloc(q, 0)))
+        goto err;
+    CRYPTO_alloc_trace_leave(entered);
+    OPENSSL_free(OPENSSL_malloc(10));
+
+    if (!TEST_size_t_eq(allocs("outer"), 4)
+            || !TEST_size_t_eq(frees("outer"), 3)
+            || !TEST_size_t_eq(allocs("inner"), 0)
+            || !TEST_size_t_eq(allocs("off"), 0))
+        goto err;
+
+    res = 1;
+ err:
+    OPENSSL_free(p);
+    stop_trace();
+    return res;
+}
+
+/* Sealing a record with a keyed AES-GCM context must not allocate */
+static int test_aes_gcm_seal(void)
+{
+    static const unsigned char key[16] = { 0 };
+    unsigned char iv[12] = { 0 }, aad[13] = { 0 }, tag[16];
+    unsigned char in[1024] = { 0 }, out[sizeof(in)];
+    EVP_CIPHER *cipher = NULL;
+    EVP_CIPHER_CTX *ctx = NULL;
+    int i, outl, traced, res = 0;
+
+    if (!TEST_ptr(cipher = EVP_CIPHER_fetch(NULL, "AES-128-GCM", NULL))
+            || !TEST_ptr(ctx = EVP_CIPHER_CTX_new())
+            || !TEST_true(EVP_EncryptInit_ex2(ctx, cipher, key, NULL, NULL))
+            || !TEST_true(start_trace()))
+        goto err;
+
+    traced = CRYPTO_alloc_trace_enter("AES-GCM seal");
+    for (i = 0; i < 4; i++) {
+        iv[11] = (unsigned char)i;
+        if (!TEST_true(EVP_EncryptInit_ex2(ctx, NULL, NULL, iv, NULL))
+                || !TEST_true(EVP_EncryptUpdate(ctx, NULL, &outl,
+                                                aad, sizeof(aad)))
+                || !TEST_true(EVP_EncryptUpdate(ctx, out, &outl,
+                                                in, sizeof(in)))
+                || !TEST_true(EVP_EncryptFinal_ex(ctx, out + outl, &outl))
+                || !TEST_true(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG,
+                                                  sizeof(tag), tag))) {
+            CRYPTO_alloc_trace_leave(traced);
+            goto err;
+        }
+    }
+    CRYPTO_alloc_trace_leave(traced);
+
+    if (!TEST_size_t_eq(allocs("AES-GCM seal"), 0))
+        goto err;
+
+    res = 1;
+ err:
+    stop_trace();
+    EVP_CIPHER_CTX_free(ctx);
+    EVP_CIPHER_free(cipher);
+    return res;
+}
+
+#ifndef OPENSSL_NO_TLS1_3
+/*
+ * TLSv1.3 handshakes, counting both sides and the processing of the session
+ * tickets: 0 = full handshake, 1 = resumption.  Then writing a record.
+ */
+# define FULL_HANDSHAKE_BUDGET          1800
+# define RESUMPTION_HANDSHAKE_BUDGET    1600
+# define RECORD_BUDGET                  4
+# define RECORDS                        4
+
+static int test_tls13_budget(int idx)
+{
+    SSL_CTX *sctx = NULL, *cctx = NULL;
+    SSL *serverssl = NULL, *clientssl = NULL;
+    SSL_SESSION *sess = NULL;
+    unsigned char buf[1024] = { 0 };
+    size_t written, readbytes, handshake;
+    int i, res = 0;
+
+    if (!TEST_true(create_ssl_ctx_pair(NULL, TLS_server_method(),
+                                       TLS_client_method(), TLS1_3_VERSION,
+                                       TLS1_3_VERSION, &sctx, &cctx, cert,
+                                       privkey)))
+        goto err;
+
+    /* The first connection warms up the caches, and gets the session */
+    for (i = 0; i < 2; i++) {
+        if (i == 1 && !TEST_true(start_trace()))
+            goto err;
+        if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                          NULL, NULL))
+                || (i == 1 && idx == 1
+                    && !TEST_true(SSL_set_session(clientssl, sess)))
+                || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                    SSL_ERROR_NONE)))
+            goto err;
+        if (i == 0) {
+            if (!TEST_ptr(sess = SSL_get1_session(clientssl)))
+                goto err;
+            shutdown_ssl_connection(serverssl, clientssl);
+            serverssl = clientssl = NULL;
+        }
+    }
+    if (!TEST_int_eq(SSL_session_reused(clientssl), idx))
+        goto err;
+    handshake = allocs("SSL_do_handshake") + allocs("SSL_read");
+    TEST_info("%s handshake: %zu allocations",
+              idx == 0 ? "Full" : "Resumption", handshake);
+    if (!TEST_size_t_le(handshake, idx == 0 ? FULL_HANDSHAKE_BUDGET
+                                            : RESUMPTION_HANDSHAKE_BUDGET))
+        goto err;
+
+    /* Once the connection is up, records should take next to nothing */
+    reset_counts();
+    for (i = 0; i < RECORDS; i++) {
+        if (!TEST_true(SSL_write_ex(clientssl, buf, sizeof(buf), &written))
+                || !TEST_true(SSL_read_ex(serverssl, buf, sizeof(buf),
+                                          &readbytes)))
+            goto err;
+    }
+    TEST_info("SSL_write: %zu allocations, SSL_read: %zu allocations",
+              allocs("SSL_write"), allocs("SSL_read"));
+    if (!TEST_size_t_le(allocs("SSL_write"), RECORDS * RECORD_BUDGET)
+            || !TEST_size_t_le(allocs("SSL_read"), RECORDS * RECORD_BUDGET))
+        goto err;
+
+    res = 1;
+ err:
+    stop_trace();
+    SSL_SESSION_free(sess);
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    return res;
+}
+#endif
+
+#define D2I_X509_BUDGET                 150
+#define X509_VERIFY_CERT_BUDGET         150
+#define DIGEST_SIGN_INIT_BUDGET         25
+
+static X509 *load_cert(const char *name)
+{
+    char *path = test_mk_file_path(certsdir, name);
+    BIO *bio = NULL;
+    X509 *x = NULL;
+
+    if (TEST_ptr(path) && TEST_ptr(bio = BIO_new_file(path, "r")))
+        x = PEM_read_bio_X509(bio, NULL, NULL, NULL);
+    BIO_free(bio);
+    OPENSSL_free(path);
+    return x;
+}
+
+static int test_x509_budget(void)
+{
+    X509 *ee = NULL, *root = NULL, *x = NULL;
+    X509_STORE *store = NULL;
+    X509_STORE_CTX *ctx = NULL;
+    unsigned char *der = NULL;
+    const unsigned char *p;
+    int derlen, res = 0;
+
+    if (!TEST_ptr(ee = load_cert("servercert.pem"))
+            || !TEST_ptr(root = load_cert("rootcert.pem"))
+            || !TEST_int_gt(derlen = i2d_X509(ee, &der), 0)
+            || !TEST_ptr(store = X509_STORE_new())
+            || !TEST_true(X509_STORE_add_cert(store, root))
+            || !TEST_ptr(ctx = X509_STORE_CTX_new())
+            || !TEST_true(X509_STORE_CTX_init(ctx, store, ee, NULL))
+            || !TEST_true(start_trace()))
+        goto err;
+
+    p = der;
+    if (!TEST_ptr(x = d2i_X509(NULL, &p, derlen))
+            || !TEST_int_eq(X509_verify_cert(ctx), 1))
+        goto err;
+    TEST_info("d2i_X509: %zu allocations, X509_verify_cert: %zu allocations",
+              allocs("d2i_X509"), allocs("X509_verify_cert"));
+    if (!TEST_size_t_le(allocs("d2i_X509"), D2I_X509_BUDGET)
+            || !TEST_size_t_le(allocs("X509_verify_cert"),
+                               X509_VERIFY_CERT_BUDGET))
+        goto err;
+
+    res = 1;
+ err:
+    stop_trace();
+    X509_STORE_CTX_free(ctx);
+    X509_STORE_free(store);
+    OPENSSL_free(der);
+    X509_free(x);
+    X509_free(root);
+    X509_free(ee);
+    return res;
+}
+
+/*
+ * Decoding with borrowed strings must save at least an allocation per
+ * string, and give a certificate that works just as well.
+ */
+static int test_x509_borrowed_budget(void)
+{
+    X509 *ee = NULL, *root = NULL, *x = NULL, *bx = NULL;
+    X509_STORE *store = NULL;
+    X509_STORE_CTX *ctx = NULL;
+    unsigned char *der = NULL, *der2 = NULL;
+    const unsigned char *p;
+    int derlen, entered, res = 0;
+
+    if (!TEST_ptr(ee = load_cert("servercert.pem"))
+            || !TEST_ptr(root = load_cert("rootcert.pem"))
+            || !TEST_int_gt(derlen = i2d_X509(ee, &der), 0)
+            || !TEST_true(start_trace()))
+        goto err;
+
+    p = der;
+    if (!TEST_ptr(x = d2i_X509(NULL, &p, derlen)))
+        goto err;
+    entered = CRYPTO_alloc_trace_enter("ASN1_item_d2i_borrowed");
+    p = der;
+    bx = (X509 *)ASN1_item_d2i_borrowed(NULL, &p, derlen,
+                                        ASN1_ITEM_rptr(X509));
+    CRYPTO_alloc_trace_leave(entered);
+    stop_trace();
+    if (!TEST_ptr(bx))
+        goto err;
+    TEST_info("d2i_X509: %zu allocations, borrowed: %zu allocations",
+              allocs("d2i_X509"), allocs("ASN1_item_d2i_borrowed"));
+    if (!TEST_size_t_le(allocs("ASN1_item_d2i_borrowed"),
+                        allocs("d2i_X509") - 10))
+        goto err;
+
+    if (!TEST_int_eq(X509_cmp(bx, x), 0)
+            || !TEST_mem_eq(der, derlen, der2, i2d_X509(bx, &der2))
+            || !TEST_ptr(store = X509_STORE_new())
+            || !TEST_true(X509_STORE_add_cert(store, root))
+            || !TEST_ptr(ctx = X509_STORE_CTX_new())
+            || !TEST_true(X509_STORE_CTX_init(ctx, store, bx, NULL))
+            || !TEST_int_eq(X509_verify_cert(ctx), 1))
+        goto err;
+
+    res = 1;
+ err:
+    stop_trace();
+    X509_STORE_CTX_free(ctx);
+    X509_STORE_free(store);
+    X509_free(bx);
+    X509_free(x);
+    X509_free(root);
+    X509_free(ee);
+    OPENSSL_free(der2);
+    OPENSSL_free(der);
+    return res;
+}
+
+static int test_digest_sign_init_budget(void)
+{
+    BIO *bio = NULL;
+    EVP_PKEY *pkey = NULL;
+    EVP_MD_CTX *mctx = NULL;
+    int i, res = 0;
+
+    if (!TEST_ptr(bio = BIO_new_file(privkey, "r"))
+            || !TEST_ptr(pkey = PEM_read_bio_PrivateKey(bio, NULL, NULL, NULL))
+            || !TEST_ptr(mctx = EVP_MD_CTX_new()))
+        goto err;
+
+    /* The first round fetches the implementations */
+    for (i = 0; i < 2; i++) {
+        if (i == 1 && !TEST_true(start_trace()))
+            goto err;
+        if (!TEST_true(EVP_DigestSignInit_ex(mctx, NULL, "SHA256", NULL, NULL,
+                                             pkey, NULL))
+                || !TEST_true(EVP_MD_CTX_reset(mctx)))
+            goto err;
+    }
+    TEST_info("EVP_DigestSignInit: %zu allocations",
+              allocs("EVP_DigestSignInit"));
+    if (!TEST_size_t_le(allocs("EVP_DigestSignInit"), DIGEST_SIGN_INIT_BUDGET))
+        goto err;
+
+    res = 1;
+ err:
+    stop_trace();
+    EVP_MD_CTX_free(mctx);
+    EVP_PKEY_free(pkey);
+    BIO_free(bio);
+    return res;
+}
+
+/*
+ * Loading a PKCS#8 key must only involve the decoder for its key type, the
+ * others are supposed to see right away that the key isn't theirs.
+ */
+static const struct {
+    const char *file;
+    size_t budget;
+} key_loads[] = {
+    { "serverkey.pem", 260 },
+#ifndef OPENSSL_NO_EC
+    { "server-ecdsa-key.pem", 700 },
+    { "server-ed25519-key.pem", 280 },
+#endif
+#ifndef OPENSSL_NO_DSA
+    { "server-dsa-key.pem", 380 },
+#endif
+};
+
+static int test_key_load_budget(int idx)
+{
+    char *path = NULL;
+    BIO *bio = NULL;
+    EVP_PKEY *pkey = NULL, *loaded = NULL;
+    PKCS8_PRIV_KEY_INFO *p8inf = NULL;
+    unsigned char *der = NULL;
+    const unsigned char *p;
+    int derlen, entered, i, res = 0;
+
+    if (!TEST_ptr(path = test_mk_file_path(certsdir, key_loads[idx].file))
+            || !TEST_ptr(bio = BIO_new_file(path, "r"))
+            || !TEST_ptr(pkey = PEM_read_bio_PrivateKey(bio, NULL, NULL, NULL))
+            || !TEST_ptr(p8inf = EVP_PKEY2PKCS8(pkey))
+            || !TEST_int_gt(derlen = i2d_PKCS8_PRIV_KEY_INFO(p8inf, &der), 0))
+        goto err;
+
+    /* The first round finds the decoders */
+    for (i = 0; i < 2; i++) {
+        if (i == 1 && !TEST_true(start_trace()))
+            goto err;
+        entered = CRYPTO_alloc_trace_enter("d2i_AutoPrivateKey");
+        p = der;
+        loaded = d2i_AutoPrivateKey(NULL, &p, derlen);
+        CRYPTO_alloc_trace_leave(entered);
+        if (!TEST_ptr(loaded)
+                || !TEST_int_eq(EVP_PKEY_eq(loaded, pkey), 1)
+                || !TEST_ulong_eq(ERR_peek_error(), 0))
+            goto err;
+        EVP_PKEY_free(loaded);
+        loaded = NULL;
+    }
+    TEST_info("d2i_AutoPrivateKey(%s): %zu allocations", key_loads[idx].file,
+              allocs("d2i_AutoPrivateKey"));
+    if (!TEST_size_t_le(allocs("d2i_AutoPrivateKey"), key_loads[idx].budget))
+        goto err;
+
+    res = 1;
+ err:
+    stop_trace();
+    EVP_PKEY_free(loaded);
+    EVP_PKEY_free(pkey);
+    PKCS8_PRIV_KEY_INFO_free(p8inf);
+    OPENSSL_free(der);
+    BIO_free(bio);
+    OPENSSL_free(path);
+    return res;
+}
+
+OPT_TEST_DECLARE_USAGE("certdir\n")
+
+int setup_tests(void)
+{
+    if (!test_skip_common_options()) {
+        TEST_error("Error parsing test options\n");
+        return 0;
+    }
+
+    if (!TEST_ptr(certsdir = test_get_argument(0)))
+        return 0;
+
+    cert = test_mk_file_path(certsdir, "servercert.pem");
+    privkey = test_mk_file_path(certsdir, "serverkey.pem");
+    if (cert == NULL || privkey == NULL)
+        return 0;
+
+    ADD_TEST(test_alloc_trace);
+    ADD_TEST(test_aes_gcm_seal);
+#ifndef OPENSSL_NO_TLS1_3
+    ADD_ALL_TESTS(test_tls13_budget, 2);
+#endif
+    ADD_TEST(test_x509_budget);
+    ADD_TEST(test_x509_borrowed_budget);
+    ADD_TEST(test_digest_sign_init_budget);
+    ADD_ALL_TESTS(test_key_load_budget, OSSL_NELEM(key_loads));
+    return 1;
+}
+
+void cleanup_tests(void)
+{
+    OPENSSL_free(cert);
+    OPENSSL_free(privkey);
+}
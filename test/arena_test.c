@@ -0,0 +1,122 @@
+/*
+ * Copyright 2021 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+
+#include <openssl/crypto.h>
+
+#include "internal/arena.h"
+#include "internal/nelem.h"
+#include "testutil.h"
+
+static int is_aligned(const void *p)
+{
+    return ((size_t)p & 15) == 0;
+}
+
+static int test_arena_alloc(void)
+{
+    OSSL_ARENA *arena;
+    unsigned char *p[40];
+    size_t allocs, heap_allocs, high_water;
+    int i, j, res = 0;
+
+    if (!TEST_ptr(arena = ossl_arena_new(256))
+            || !TEST_ptr_null(ossl_arena_alloc(arena, 0)))
+        goto err;
+
+    /* Spread over several chunks, all distinct and suitably aligned */
+    for (i = 0; i < (int)OSSL_NELEM(p); i++) {
+        if (!TEST_ptr(p[i] = ossl_arena_zalloc(arena, i + 1))
+                || !TEST_true(is_aligned(p[i])))
+            goto err;
+        for (j = 0; j <= i; j++)
+            if (!TEST_uchar_eq(p[i][j], 0))
+                goto err;
+        memset(p[i], i, i + 1);
+    }
+    for (i = 0; i < (int)OSSL_NELEM(p); i++)
+        for (j = 0; j <= i; j++)
+            if (!TEST_uchar_eq(p[i][j], i))
+                goto err;
+
+    ossl_arena_get_stats(arena, &allocs, &heap_allocs, &high_water);
+    if (!TEST_size_t_eq(allocs, OSSL_NELEM(p))
+            || !TEST_size_t_gt(heap_allocs, 1)
+            || !TEST_size_t_ge(high_water, 40 * 41 / 2))
+        goto err;
+
+    /* Once reset, the same chunks are used again */
+    ossl_arena_reset(arena);
+    for (i = 0; i < (int)OSSL_NELEM(p); i++)
+        if (!TEST_ptr(ossl_arena_alloc(arena, i + 1)))
+            goto err;
+    ossl_arena_get_stats(arena, NULL, &allocs, NULL);
+    if (!TEST_size_t_eq(allocs, heap_allocs))
+        goto err;
+
+    res = 1;
+ err:
+    ossl_arena_free(arena);
+    return res;
+}
+
+static int test_arena_mark(void)
+{
+    OSSL_ARENA *arena;
+    unsigned char *p, *q, *big;
+    size_t mark, heap_allocs, heap_allocs2;
+    int i, res = 0;
+
+    if (!TEST_ptr(arena = ossl_arena_new(256))
+            || !TEST_ptr(p = ossl_arena_alloc(arena, 100))
+            || !TEST_size_t_eq(mark = ossl_arena_mark(arena), 112))
+        goto err;
+    memset(p, 'p', 100);
+
+    /* Releasing to a mark gives back what came after it, and only that */
+    for (i = 0; i < 2; i++) {
+        if (!TEST_ptr(q = ossl_arena_alloc(arena, 100))
+                || !TEST_ptr(ossl_arena_alloc(arena, 100))
+                || !TEST_ptr(big = ossl_arena_alloc(arena, 1000)))
+            goto err;
+        memset(big, 'b', 1000);
+        ossl_arena_release(arena, mark);
+        if (!TEST_size_t_eq(ossl_arena_mark(arena), mark)
+                || !TEST_ptr_eq(ossl_arena_alloc(arena, 100), q)
+                || !TEST_uchar_eq(p[99], 'p'))
+            goto err;
+        ossl_arena_release(arena, mark);
+    }
+
+    /* The oversized chunk is freed, the others are kept */
+    ossl_arena_get_stats(arena, NULL, &heap_allocs, NULL);
+    ossl_arena_release(arena, mark);
+    if (!TEST_ptr(ossl_arena_alloc(arena, 200)))
+        goto err;
+    ossl_arena_get_stats(arena, NULL, &heap_allocs2, NULL);
+    if (!TEST_size_t_eq(heap_allocs2, heap_allocs))
+        goto err;
+
+    ossl_arena_reset(arena);
+    if (!TEST_size_t_eq(ossl_arena_mark(arena), 0))
+        goto err;
+
+    res = 1;
+ err:
+    ossl_arena_free(arena);
+    return res;
+}
+
+int setup_tests(void)
+{
+    ADD_TEST(test_arena_alloc);
+    ADD_TEST(test_arena_mark);
+    return 1;
+}
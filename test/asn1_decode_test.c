@@ -12,6 +12,8 @@
 
 #include <openssl/rand.h>
 #include <openssl/asn1t.h>
+#include <openssl/evp.h>
+#include <openssl/x509v3.h>
 #include "internal/numbers.h"
 #include "testutil.h"
 
@@ -195,6 +197,193 @@ static int test_invalid_template(void)
     return 0;
 }
 
+/* Borrowed decoding ****************************************************** */
+
+typedef struct {
+    ASN1_OCTET_STRING *octets;
+    ASN1_BIT_STRING *bits;
+    ASN1_UTF8STRING *text;
+} ASN1_BORROW_DATA;
+
+ASN1_SEQUENCE(ASN1_BORROW_DATA) = {
+    ASN1_SIMPLE(ASN1_BORROW_DATA, octets, ASN1_OCTET_STRING),
+    ASN1_SIMPLE(ASN1_BORROW_DATA, bits, ASN1_BIT_STRING),
+    ASN1_SIMPLE(ASN1_BORROW_DATA, text, ASN1_UTF8STRING),
+} static_ASN1_SEQUENCE_END(ASN1_BORROW_DATA)
+
+IMPLEMENT_STATIC_ASN1_ALLOC_FUNCTIONS(ASN1_BORROW_DATA)
+
+static unsigned char t_borrow[] = {
+    0x30, 0x0d,                  /* SEQUENCE tag + length */
+    0x04, 0x03, 0x61, 0x62, 0x63, /* OCTET STRING "abc" */
+    0x03, 0x02, 0x01, 0xfe,      /* BIT STRING, 1 unused bit, clear */
+    0x0c, 0x02, 0x68, 0x69       /* UTF8String "hi" */
+};
+
+/* Same, but with an unused bit set, which has to be cleared in a copy */
+static unsigned char t_borrow_unclean[] = {
+    0x30, 0x0d,                  /* SEQUENCE tag + length */
+    0x04, 0x03, 0x61, 0x62, 0x63, /* OCTET STRING "abc" */
+    0x03, 0x02, 0x01, 0xff,      /* BIT STRING, 1 unused bit, set */
+    0x0c, 0x02, 0x68, 0x69       /* UTF8String "hi" */
+};
+
+static int is_borrowed(const ASN1_STRING *str, const unsigned char *der,
+                       size_t der_len)
+{
+    return (str->flags & ASN1_STRING_FLAG_BORROWED) != 0
+        && str->data >= der && str->data + str->length <= der + der_len;
+}
+
+static int test_borrowed(int idx)
+{
+    unsigned char der[sizeof(t_borrow)];
+    const unsigned char *p = der;
+    ASN1_BORROW_DATA *dectst = NULL;
+    int res = 0;
+
+    memcpy(der, idx == 0 ? t_borrow : t_borrow_unclean, sizeof(der));
+    if (!TEST_ptr(dectst = (ASN1_BORROW_DATA *)
+                  ASN1_item_d2i_borrowed(NULL, &p, sizeof(der),
+                                         ASN1_ITEM_rptr(ASN1_BORROW_DATA)))
+            || !TEST_ptr_eq(p, der + sizeof(der))
+            || !TEST_true(is_borrowed(dectst->octets, der, sizeof(der)))
+            || !TEST_true(is_borrowed(dectst->text, der, sizeof(der)))
+            || !TEST_mem_eq(ASN1_STRING_get0_data(dectst->text),
+                            ASN1_STRING_length(dectst->text), "hi", 2)
+            || !TEST_int_eq(ASN1_BIT_STRING_get_bit(dectst->bits, 7), 0))
+        goto err;
+
+    if (idx == 0) {
+        if (!TEST_true(is_borrowed(dectst->bits, der, sizeof(der))))
+            goto err;
+    } else if (!TEST_false(dectst->bits->flags & ASN1_STRING_FLAG_BORROWED)) {
+        goto err;
+    }
+
+    /* Changing a string must leave the input alone */
+    if (!TEST_true(ASN1_BIT_STRING_set_bit(dectst->bits, 0, 0))
+            || !TEST_true(ASN1_STRING_set(dectst->octets, "xy", 2))
+            || !TEST_false(dectst->bits->flags & ASN1_STRING_FLAG_BORROWED)
+            || !TEST_false(dectst->octets->flags & ASN1_STRING_FLAG_BORROWED)
+            || !TEST_mem_eq(der, sizeof(der),
+                            idx == 0 ? t_borrow : t_borrow_unclean,
+                            sizeof(der)))
+        goto err;
+
+    res = 1;
+ err:
+    ASN1_BORROW_DATA_free(dectst);
+    return res;
+}
+
+/* Make a small self-signed certificate, in DER */
+static int make_cert(EVP_PKEY *key, unsigned char **der)
+{
+    X509 *x = NULL;
+    X509_NAME *name;
+    ASN1_OCTET_STRING *kid = NULL;
+    int len = 0;
+
+    if (TEST_ptr(x = X509_new())
+            && TEST_true(X509_set_version(x, 2))
+            && TEST_true(ASN1_INTEGER_set(X509_get_serialNumber(x), 1))
+            && TEST_ptr(name = X509_get_subject_name(x))
+            && TEST_true(X509_NAME_add_entry_by_txt(name, "O", MBSTRING_UTF8,
+                                                    (unsigned char *)"org",
+                                                    -1, -1, 0))
+            && TEST_true(X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                                                    (unsigned char *)"name",
+                                                    -1, -1, 0))
+            && TEST_true(X509_set_issuer_name(x, name))
+            && TEST_ptr(X509_gmtime_adj(X509_getm_notBefore(x), 0))
+            && TEST_ptr(X509_gmtime_adj(X509_getm_notAfter(x), 3600))
+            && TEST_true(X509_set_pubkey(x, key))
+            && TEST_ptr(kid = ASN1_OCTET_STRING_new())
+            && TEST_true(ASN1_OCTET_STRING_set(kid, (unsigned char *)"kid", 3))
+            && TEST_true(X509_add1_ext_i2d(x, NID_subject_key_identifier,
+                                           kid, 0, 0))
+            && TEST_int_gt(X509_sign(x, key, EVP_sha256()), 0))
+        len = i2d_X509(x, der);
+    ASN1_OCTET_STRING_free(kid);
+    X509_free(x);
+    return len;
+}
+
+/*
+ * Every kind of string that a borrowed certificate holds can be changed
+ * without touching the input: names, times, octet and bit strings.
+ */
+static int test_borrowed_cert(void)
+{
+    EVP_PKEY_CTX *kctx = NULL;
+    EVP_PKEY *key = NULL;
+    X509 *x = NULL;
+    X509_NAME_ENTRY *o, *cn;
+    X509_EXTENSION *ext;
+    ASN1_OCTET_STRING *kid = NULL;
+    const ASN1_BIT_STRING *sig;
+    unsigned char *der = NULL, *copy = NULL;
+    const unsigned char *p;
+    int len, res = 0;
+
+    if (!TEST_ptr(kctx = EVP_PKEY_CTX_new_from_name(NULL, "EC", NULL))
+            || !TEST_int_gt(EVP_PKEY_keygen_init(kctx), 0)
+            || !TEST_int_gt(EVP_PKEY_CTX_set_group_name(kctx, "P-256"), 0)
+            || !TEST_int_gt(EVP_PKEY_keygen(kctx, &key), 0)
+            || !TEST_int_gt(len = make_cert(key, &der), 0)
+            || !TEST_ptr(copy = OPENSSL_memdup(der, len)))
+        goto err;
+
+    p = der;
+    if (!TEST_ptr(x = (X509 *)ASN1_item_d2i_borrowed(NULL, &p, len,
+                                                     ASN1_ITEM_rptr(X509)))
+            || !TEST_ptr(o = X509_NAME_get_entry(X509_get_subject_name(x), 0))
+            || !TEST_ptr(cn = X509_NAME_get_entry(X509_get_subject_name(x), 1))
+            || !TEST_ptr(ext = X509_get_ext(x, 0)))
+        goto err;
+    X509_get0_signature(&sig, NULL, x);
+    if (!TEST_true(is_borrowed(X509_NAME_ENTRY_get_data(o), der, len))
+            || !TEST_true(is_borrowed(X509_NAME_ENTRY_get_data(cn), der, len))
+            || !TEST_true(is_borrowed(X509_get0_notBefore(x), der, len))
+            || !TEST_true(is_borrowed(X509_get0_notAfter(x), der, len))
+            || !TEST_true(is_borrowed(X509_EXTENSION_get_data(ext), der, len))
+            || !TEST_true(is_borrowed(sig, der, len)))
+        goto err;
+
+    if (!TEST_true(X509_NAME_ENTRY_set_data(o, V_ASN1_UTF8STRING,
+                                            (unsigned char *)"other", -1))
+            || !TEST_true(X509_NAME_ENTRY_set_data(cn, MBSTRING_UTF8,
+                                                   (unsigned char *)"other",
+                                                   -1))
+            || !TEST_ptr(X509_gmtime_adj(X509_getm_notBefore(x), -60))
+            || !TEST_true(ASN1_TIME_set_string(X509_getm_notAfter(x),
+                                               "20500101000000Z"))
+            || !TEST_ptr(kid = ASN1_OCTET_STRING_new())
+            || !TEST_true(ASN1_OCTET_STRING_set(kid, (unsigned char *)"id", 2))
+            || !TEST_true(X509_EXTENSION_set_data(ext, kid))
+            || !TEST_true(ASN1_BIT_STRING_set_bit((ASN1_BIT_STRING *)sig,
+                                                  0, 1))
+            || !TEST_mem_eq(der, len, copy, len))
+        goto err;
+
+    /* Re-signing replaces the signature, and the certificate still works */
+    if (!TEST_int_gt(X509_sign(x, key, EVP_sha256()), 0)
+            || !TEST_int_gt(X509_verify(x, key), 0)
+            || !TEST_mem_eq(der, len, copy, len))
+        goto err;
+
+    res = 1;
+ err:
+    X509_free(x);
+    ASN1_OCTET_STRING_free(kid);
+    OPENSSL_free(der);
+    OPENSSL_free(copy);
+    EVP_PKEY_free(key);
+    EVP_PKEY_CTX_free(kctx);
+    return res;
+}
+
 int setup_tests(void)
 {
 #ifndef OPENSSL_NO_DEPRECATED_3_0
@@ -205,5 +394,7 @@ int setup_tests(void)
     ADD_TEST(test_int64);
     ADD_TEST(test_uint64);
     ADD_TEST(test_invalid_template);
+    ADD_ALL_TESTS(test_borrowed, 2);
+    ADD_TEST(test_borrowed_cert);
     return 1;
 }
@@ -21,6 +21,7 @@
 #include "testutil.h"
 #include "bn_prime.h"
 #include "crypto/bn.h"
+#include "bn_local.h"
 
 static BN_CTX *ctx;
 
@@ -86,6 +87,220 @@ err:
     return ret;
 }
 
+/*
+ * Check that the incremental sieve agrees with trial division of each
+ * candidate in the progression.
+ */
+static int test_bn_sieve(void)
+{
+    int ret = 0, i, j, factor;
+    BIGNUM *w = NULL, *step = NULL;
+    BN_SIEVE sieve = { 0, NULL, NULL };
+
+    if (!TEST_ptr(w = BN_new())
+            || !TEST_ptr(step = BN_new())
+            || !TEST_true(BN_rand(w, 1024, BN_RAND_TOP_ONE, BN_RAND_BOTTOM_ODD))
+            || !TEST_true(BN_rand(step, 512, BN_RAND_TOP_ONE, BN_RAND_BOTTOM_ANY))
+            || !TEST_true(BN_lshift1(step, step))
+            || !TEST_true(bn_sieve_init(&sieve, 1024))
+            || !TEST_true(bn_sieve_start(&sieve, w, step)))
+        goto err;
+
+    for (i = 0; i < 1000; i++) {
+        factor = 0;
+        for (j = 0; j < sieve.num && !factor; j++)
+            factor = BN_mod_word(w, primes[j]) == 0;
+        if (!TEST_int_eq(bn_sieve_has_small_factor(&sieve), factor)
+                || !TEST_true(BN_add(w, w, step)))
+            goto err;
+        bn_sieve_next(&sieve);
+    }
+    ret = 1;
+err:
+    bn_sieve_cleanup(&sieve);
+    BN_free(w);
+    BN_free(step);
+    return ret;
+}
+
+/*
+ * Check the dual exponentiation against single ones, with 1024-bit moduli
+ * that may take the two-lane path where the platform supports it.
+ */
+static int test_mod_exp_x2(int idx)
+{
+    int ret = 0, i;
+    BIGNUM *m[2] = { NULL, NULL }, *a[2] = { NULL, NULL };
+    BIGNUM *p[2] = { NULL, NULL }, *r[2] = { NULL, NULL };
+    BIGNUM *expected = NULL;
+    BN_MONT_CTX *mont[2] = { NULL, NULL };
+
+    for (i = 0; i < 2; i++) {
+        if (!TEST_ptr(m[i] = BN_new())
+                || !TEST_ptr(a[i] = BN_new())
+                || !TEST_ptr(p[i] = BN_new())
+                || !TEST_ptr(r[i] = BN_new())
+                || !TEST_true(BN_rand(m[i], 1024, BN_RAND_TOP_ONE,
+                                      BN_RAND_BOTTOM_ODD))
+                || !TEST_true(BN_rand_range(a[i], m[i]))
+                || !TEST_true(BN_rand(p[i], 1024, BN_RAND_TOP_ONE,
+                                      BN_RAND_BOTTOM_ANY)))
+            goto err;
+        /* Exercise both caller supplied and internal Montgomery contexts */
+        if (idx % 2 == 0
+                && (!TEST_ptr(mont[i] = BN_MONT_CTX_new())
+                    || !TEST_true(BN_MONT_CTX_set(mont[i], m[i], ctx))))
+            goto err;
+    }
+
+    if (!TEST_ptr(expected = BN_new())
+            || !TEST_true(ossl_bn_mod_exp_mont_consttime_x2(r[0], a[0], p[0],
+                                                            m[0], mont[0],
+                                                            r[1], a[1], p[1],
+                                                            m[1], mont[1],
+                                                            ctx)))
+        goto err;
+
+    for (i = 0; i < 2; i++)
+        if (!TEST_true(BN_mod_exp_simple(expected, a[i], p[i], m[i], ctx))
+                || !TEST_BN_eq(r[i], expected))
+            goto err;
+    ret = 1;
+err:
+    for (i = 0; i < 2; i++) {
+        BN_free(m[i]);
+        BN_free(a[i]);
+        BN_free(p[i]);
+        BN_free(r[i]);
+        BN_MONT_CTX_free(mont[i]);
+    }
+    BN_free(expected);
+    return ret;
+}
+
+/*
+ * Check fixed-base exponentiation against the generic code, for exponents
+ * of every length up to the maximum that the table allows.
+ */
+static const int comb_sizes[][2] = {
+    /* modulus bits, maximum exponent bits */
+    { 256, 256 }, { 1024, 160 }, { 2048, 2047 }, { 2048, 226 },
+    { 3072, 7 }, { 4096, 401 }
+};
+
+static int test_bn_comb(int idx)
+{
+    int ret = 0, i, bits = comb_sizes[idx][1];
+    BIGNUM *m = NULL, *g = NULL, *p = NULL, *r = NULL, *expected = NULL;
+    BN_COMB *comb = NULL;
+
+    if (!TEST_ptr(m = BN_new())
+            || !TEST_ptr(g = BN_new())
+            || !TEST_ptr(p = BN_new())
+            || !TEST_ptr(r = BN_new())
+            || !TEST_ptr(expected = BN_new())
+            || !TEST_true(BN_rand(m, comb_sizes[idx][0], BN_RAND_TOP_ONE,
+                                  BN_RAND_BOTTOM_ODD))
+            || !TEST_true(BN_rand_range(g, m))
+            || !TEST_ptr(comb = ossl_bn_comb_new(g, m, bits, ctx))
+            || !TEST_true(ossl_bn_comb_matches(comb, g, m, bits))
+            || !TEST_false(ossl_bn_comb_matches(comb, g, m, bits + 1)))
+        goto err;
+
+    for (i = 0; i <= bits; i += 1 + bits / 16) {
+        if (i == 0)
+            BN_zero(p);
+        else if (!TEST_true(BN_rand(p, i, BN_RAND_TOP_ONE, BN_RAND_BOTTOM_ANY)))
+            goto err;
+        if (!TEST_true(ossl_bn_comb_mod_exp(r, comb, p, ctx))
+                || !TEST_true(BN_mod_exp_simple(expected, g, p, m, ctx))
+                || !TEST_BN_eq(r, expected))
+            goto err;
+    }
+
+    /* The exponent must fit in the table */
+    if (!TEST_true(BN_rand(p, bits + 1, BN_RAND_TOP_ONE, BN_RAND_BOTTOM_ANY))
+            || !TEST_false(ossl_bn_comb_mod_exp(r, comb, p, ctx)))
+        goto err;
+    ret = 1;
+ err:
+    ossl_bn_comb_free(comb);
+    BN_free(m);
+    BN_free(g);
+    BN_free(p);
+    BN_free(r);
+    BN_free(expected);
+    return ret;
+}
+
+static int test_bn_ctx_cache(void)
+{
+    OSSL_LIB_CTX *libctx = NULL;
+    BN_CTX *c1 = NULL, *c2 = NULL, *c3 = NULL;
+    BIGNUM *a;
+    BN_ULONG *d;
+    int i, dmax, acquired, allocated, ret = 0;
+
+    if (!TEST_ptr(libctx = OSSL_LIB_CTX_new())
+            || !TEST_ptr(c1 = ossl_bn_ctx_acquire(libctx, 0)))
+        goto err;
+
+    /* Leave a value behind, which must be wiped when c1 is handed back */
+    BN_CTX_start(c1);
+    if (!TEST_ptr(a = BN_CTX_get(c1))
+            || !TEST_true(BN_set_word(a, 0x5a5a))
+            || !TEST_true(BN_lshift(a, a, 1000)))
+        goto err;
+    d = a->d;
+    dmax = a->dmax;
+    BN_CTX_end(c1);
+    ossl_bn_ctx_release(c1);
+    for (i = 0; i < dmax; i++)
+        if (!TEST_true(d[i] == 0))
+            goto err;
+
+    /* The same context comes back, and a nested one is a new one */
+    if (!TEST_ptr_eq(c2 = ossl_bn_ctx_acquire(libctx, 0), c1)
+            || !TEST_ptr(c3 = ossl_bn_ctx_acquire(libctx, 0))
+            || !TEST_ptr_ne(c3, c2))
+        goto err;
+    c1 = NULL;
+    ossl_bn_ctx_release(c3);
+    ossl_bn_ctx_release(c2);
+    c2 = NULL;
+    if (!TEST_ptr_eq(c1 = ossl_bn_ctx_acquire(libctx, 0), c3))
+        goto err;
+    c3 = NULL;
+
+    /* Secure contexts are cached separately */
+    if (!TEST_ptr(c2 = ossl_bn_ctx_acquire(libctx, 1))
+            || !TEST_ptr_ne(c2, c1))
+        goto err;
+    ossl_bn_ctx_release(c2);
+    if (!TEST_ptr_eq(c3 = ossl_bn_ctx_acquire(libctx, 1), c2))
+        goto err;
+    c2 = NULL;
+
+    /* A context with a frame left open is not kept */
+    BN_CTX_start(c1);
+    ossl_bn_ctx_release(c1);
+    if (!TEST_ptr(c1 = ossl_bn_ctx_acquire(libctx, 0)))
+        goto err;
+
+    ossl_bn_ctx_cache_get_stats(libctx, &acquired, &allocated);
+    if (!TEST_int_eq(acquired, 7)
+            || !TEST_int_eq(allocated, 4))
+        goto err;
+    ret = 1;
+
+ err:
+    ossl_bn_ctx_release(c1);
+    ossl_bn_ctx_release(c2);
+    ossl_bn_ctx_release(c3);
+    OSSL_LIB_CTX_free(libctx);
+    return ret;
+}
+
 int setup_tests(void)
 {
     if (!TEST_ptr(ctx = BN_CTX_new()))
@@ -94,6 +309,10 @@ int setup_tests(void)
     ADD_TEST(test_is_prime_enhanced);
     ADD_ALL_TESTS(test_is_composite_enhanced, (int)OSSL_NELEM(composites));
     ADD_TEST(test_bn_small_factors);
+    ADD_TEST(test_bn_sieve);
+    ADD_ALL_TESTS(test_mod_exp_x2, 10);
+    ADD_ALL_TESTS(test_bn_comb, OSSL_NELEM(comb_sizes));
+    ADD_TEST(test_bn_ctx_cache);
 
     return 1;
 }
@@ -143,6 +143,17 @@ static int test_is_zero_32(int i)
     return 1;
 }
 
+static int test_is_zero_64(int i)
+{
+    uint64_t a = test_values_64[i];
+
+    if (a == 0 && !TEST_true(constant_time_is_zero_64(a) == CONSTTIME_TRUE_64))
+        return 0;
+    if (a != 0 && !TEST_true(constant_time_is_zero_64(a) == CONSTTIME_FALSE_64))
+        return 0;
+    return 1;
+}
+
 static int test_is_zero_s(int i)
 {
     size_t a = test_values_s[i];
@@ -402,6 +413,7 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_is_zero, OSSL_NELEM(test_values));
     ADD_ALL_TESTS(test_is_zero_8, OSSL_NELEM(test_values_8));
     ADD_ALL_TESTS(test_is_zero_32, OSSL_NELEM(test_values_32));
+    ADD_ALL_TESTS(test_is_zero_64, OSSL_NELEM(test_values_64));
     ADD_ALL_TESTS(test_is_zero_s, OSSL_NELEM(test_values_s));
     ADD_ALL_TESTS(test_binops, OSSL_NELEM(test_values));
     ADD_ALL_TESTS(test_binops_8, OSSL_NELEM(test_values_8));
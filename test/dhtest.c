@@ -695,10 +695,37 @@ static int prime_groups[] = {
     NID_modp_6144,
 };
 
+/*
+ * Check that a key pair generated in a named group is consistent, which
+ * covers the precomputed tables used for the public key.
+ */
+static int dh_check_generated_key(DH *dh)
+{
+    int ok = 0;
+    BN_CTX *ctx = NULL;
+    BIGNUM *expected = NULL;
+    const BIGNUM *pub_key = NULL, *priv_key = NULL;
+
+    if (!TEST_true(DH_generate_key(dh))
+        || !TEST_ptr(ctx = BN_CTX_new())
+        || !TEST_ptr(expected = BN_new()))
+        goto err;
+    DH_get0_key(dh, &pub_key, &priv_key);
+    if (!TEST_true(BN_mod_exp(expected, DH_get0_g(dh), priv_key,
+                              DH_get0_p(dh), ctx))
+        || !TEST_BN_eq(pub_key, expected))
+        goto err;
+    ok = 1;
+err:
+    BN_free(expected);
+    BN_CTX_free(ctx);
+    return ok;
+}
+
 static int dh_test_prime_groups(int index)
 {
     int ok = 0;
-    DH *dh = NULL;
+    DH *dh = NULL, *dh2 = NULL;
     const BIGNUM *p, *q, *g;
     long len;
 
@@ -716,9 +743,17 @@ static int dh_test_prime_groups(int index)
         || !TEST_true(len <= BN_num_bits(q)))
         goto err;
 
+    /* Generate keys of the default and of the maximum length */
+    if (!dh_check_generated_key(dh)
+        || !TEST_ptr(dh2 = DH_new_by_nid(prime_groups[index]))
+        || !TEST_true(DH_set_length(dh2, 0))
+        || !dh_check_generated_key(dh2))
+        goto err;
+
     ok = 1;
 err:
     DH_free(dh);
+    DH_free(dh2);
     return ok;
 }
 
@@ -903,6 +903,262 @@ err:
     return ret;
 }
 
+static int set_buffer_size(EVP_RAND_CTX *drbg, size_t size)
+{
+    OSSL_PARAM params[2];
+
+    params[0] = OSSL_PARAM_construct_size_t(OSSL_DRBG_PARAM_BUFFER_SIZE,
+                                            &size);
+    params[1] = OSSL_PARAM_construct_end();
+    return EVP_RAND_set_ctx_params(drbg, params);
+}
+
+/*
+ * Test that small requests are served from the output buffer of a DRBG
+ * and that the buffer is discarded when the DRBG reseeds.
+ */
+static int test_rand_buffered(void)
+{
+    EVP_RAND_CTX *x = NULL, *y = NULL;
+    PROV_DRBG *p;
+    unsigned char buf1[16], buf2[sizeof(buf1)];
+    unsigned char big[DRBG_MAX_BUFFERED_REQUEST + 1];
+    unsigned int count;
+    int ret = 0;
+
+    if (!TEST_ptr(x = new_drbg(NULL))
+        || !TEST_true(disable_crngt(x))
+        || !TEST_true(EVP_RAND_instantiate(x, 0, 0, NULL, 0, NULL))
+        || !TEST_ptr(y = new_drbg(x))
+        || !TEST_true(EVP_RAND_instantiate(y, 0, 0, NULL, 0, NULL)))
+        goto err;
+    p = prov_rand(y);
+
+    /* The buffer can't be larger than a single request */
+    if (!TEST_false(set_buffer_size(y, p->max_request + 1))
+        || !TEST_true(set_buffer_size(y, 1024)))
+        goto err;
+    ERR_clear_error();
+
+    /* The first request fills the buffer, the second is served from it */
+    count = p->generate_counter;
+    if (!TEST_true(EVP_RAND_generate(y, buf1, sizeof(buf1), 0, 0, NULL, 0))
+        || !TEST_uint_eq(p->generate_counter, count + 1)
+        || !TEST_size_t_eq(p->outbuf_avail, 1024 - sizeof(buf1))
+        || !TEST_true(EVP_RAND_generate(y, buf2, sizeof(buf2), 0, 0, NULL, 0))
+        || !TEST_uint_eq(p->generate_counter, count + 1)
+        || !TEST_size_t_eq(p->outbuf_avail, 1024 - 2 * sizeof(buf1))
+        || !TEST_mem_ne(buf1, sizeof(buf1), buf2, sizeof(buf2)))
+        goto err;
+
+    /* Large requests and additional input bypass the buffer */
+    if (!TEST_true(EVP_RAND_generate(y, big, sizeof(big), 0, 0, NULL, 0))
+        || !TEST_uint_eq(p->generate_counter, count + 2)
+        || !TEST_true(EVP_RAND_generate(y, buf1, sizeof(buf1), 0, 0,
+                                        buf2, sizeof(buf2)))
+        || !TEST_uint_eq(p->generate_counter, count + 3)
+        || !TEST_size_t_eq(p->outbuf_avail, 1024 - 2 * sizeof(buf1)))
+        goto err;
+
+    /* A reseed of the parent discards the buffered output */
+    inc_reseed_counter(x);
+    if (!TEST_true(EVP_RAND_generate(y, buf1, sizeof(buf1), 0, 0, NULL, 0))
+        || !TEST_uint_eq(p->generate_counter, 2)
+        || !TEST_size_t_eq(p->outbuf_avail, 1024 - sizeof(buf1)))
+        goto err;
+
+    /* Removing the buffer goes back to unbuffered generation */
+    if (!TEST_true(set_buffer_size(y, 0))
+        || !TEST_ptr_null(p->outbuf)
+        || !TEST_true(EVP_RAND_generate(y, buf1, sizeof(buf1), 0, 0, NULL, 0))
+        || !TEST_uint_eq(p->generate_counter, 3))
+        goto err;
+
+    ret = 1;
+err:
+    EVP_RAND_CTX_free(y);
+    EVP_RAND_CTX_free(x);
+    return ret;
+}
+
+/*
+ * A straightforward block at a time implementation of the NIST SP 800-90A
+ * CTR_DRBG using AES-256 without the derivation function.  It is used to
+ * check that the provider's implementation, which generates its output
+ * with the AES-CTR stream cipher, produces the same output.
+ */
+#define CTR_REF_KEYLEN  32
+#define CTR_REF_SEEDLEN (CTR_REF_KEYLEN + AES_BLOCK_SIZE)
+
+typedef struct {
+    EVP_CIPHER_CTX *ctx;
+    unsigned char K[CTR_REF_KEYLEN];
+    unsigned char V[AES_BLOCK_SIZE];
+} CTR_REF;
+
+static void ctr_ref_inc(unsigned char *V)
+{
+    int i;
+
+    for (i = AES_BLOCK_SIZE - 1; i >= 0 && ++V[i] == 0; i--)
+        continue;
+}
+
+static int ctr_ref_block(CTR_REF *ref, unsigned char *out)
+{
+    int outl;
+
+    ctr_ref_inc(ref->V);
+    return EVP_EncryptUpdate(ref->ctx, out, &outl, ref->V, AES_BLOCK_SIZE)
+           && outl == AES_BLOCK_SIZE;
+}
+
+static int ctr_ref_update(CTR_REF *ref, const unsigned char *provided)
+{
+    unsigned char temp[CTR_REF_SEEDLEN];
+    size_t i;
+
+    for (i = 0; i < sizeof(temp); i += AES_BLOCK_SIZE)
+        if (!ctr_ref_block(ref, temp + i))
+            return 0;
+    for (i = 0; i < sizeof(temp); i++)
+        temp[i] ^= provided[i];
+    memcpy(ref->K, temp, CTR_REF_KEYLEN);
+    memcpy(ref->V, temp + CTR_REF_KEYLEN, AES_BLOCK_SIZE);
+    return EVP_EncryptInit_ex(ref->ctx, NULL, NULL, ref->K, NULL);
+}
+
+static int ctr_ref_instantiate(CTR_REF *ref, const unsigned char *entropy)
+{
+    memset(ref->K, 0, sizeof(ref->K));
+    memset(ref->V, 0, sizeof(ref->V));
+    return EVP_EncryptInit_ex(ref->ctx, EVP_aes_256_ecb(), NULL, ref->K, NULL)
+           && EVP_CIPHER_CTX_set_padding(ref->ctx, 0)
+           && ctr_ref_update(ref, entropy);
+}
+
+static int ctr_ref_generate(CTR_REF *ref, unsigned char *out, size_t outlen)
+{
+    static const unsigned char zero[CTR_REF_SEEDLEN] = { 0 };
+    unsigned char block[AES_BLOCK_SIZE];
+    size_t n;
+
+    for (; outlen > 0; outlen -= n, out += n) {
+        if (!ctr_ref_block(ref, block))
+            return 0;
+        n = outlen < sizeof(block) ? outlen : sizeof(block);
+        memcpy(out, block, n);
+    }
+    return ctr_ref_update(ref, zero);
+}
+
+/*
+ * Compare the output of CTR-DRBG against the reference implementation for
+ * a sequence of requests, both small and large enough to use the bulk
+ * AES-CTR code, and not all being a multiple of the block size.
+ * For |idx| 1, the entropy input is chosen such that the rightmost 32 bits
+ * of V are close to wrapping around, and the requests start with one of 265
+ * blocks, so that the counter overflows in the middle of it.  Every request
+ * ends with an update of V, so only the first one can be made to wrap.
+ */
+static int test_rand_ctr_bulk(int idx)
+{
+    static const size_t sizes[] = {
+        1, 16, 1000, 8 * AES_BLOCK_SIZE, 8 * AES_BLOCK_SIZE * 33 + 5, 1 << 16
+    };
+    const size_t maxlen = sizes[OSSL_NELEM(sizes) - 1];
+    /* Index in |sizes| of the first request */
+    const size_t first = idx == 1 ? 4 : 0;
+    unsigned int strength = 256;
+    int use_df = 0;
+    unsigned char entropy[CTR_REF_SEEDLEN];
+    unsigned char *got = NULL, *expected = NULL;
+    OSSL_PARAM params[3];
+    EVP_RAND *rand = NULL;
+    EVP_RAND_CTX *parent = NULL, *drbg = NULL;
+    CTR_REF ref;
+    size_t i, n;
+    int ret = 0;
+
+    if (!TEST_ptr(ref.ctx = EVP_CIPHER_CTX_new()))
+        return 0;
+    for (i = 0; i < sizeof(entropy); i++)
+        entropy[i] = (unsigned char)(i * 7 + 1);
+    if (idx == 1) {
+        /*
+         * With K and V both zero, instantiation sets V to E(0, 3) XOR the
+         * rightmost block of the entropy input.
+         */
+        static const unsigned char v[AES_BLOCK_SIZE] = {
+            0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+            0xfe, 0xdc, 0xba, 0x98, 0xff, 0xff, 0xff, 0xf0
+        };
+        unsigned char k[CTR_REF_KEYLEN] = { 0 }, ctr[AES_BLOCK_SIZE] = { 0 };
+        unsigned char e[AES_BLOCK_SIZE];
+        int outl;
+
+        ctr[AES_BLOCK_SIZE - 1] = 3;
+        if (!TEST_true(EVP_EncryptInit_ex(ref.ctx, EVP_aes_256_ecb(), NULL,
+                                          k, NULL))
+                || !TEST_true(EVP_EncryptUpdate(ref.ctx, e, &outl, ctr,
+                                                sizeof(ctr))))
+            goto err;
+        for (i = 0; i < AES_BLOCK_SIZE; i++)
+            entropy[CTR_REF_KEYLEN + i] = e[i] ^ v[i];
+    }
+
+    if (!TEST_ptr(got = OPENSSL_malloc(maxlen))
+            || !TEST_ptr(expected = OPENSSL_malloc(maxlen)))
+        goto err;
+
+    /* TEST-RAND supplies the entropy input */
+    if (!TEST_ptr(rand = EVP_RAND_fetch(NULL, "TEST-RAND", NULL))
+            || !TEST_ptr(parent = EVP_RAND_CTX_new(rand, NULL)))
+        goto err;
+    EVP_RAND_free(rand);
+    rand = NULL;
+    params[0] = OSSL_PARAM_construct_uint(OSSL_RAND_PARAM_STRENGTH, &strength);
+    params[1] = OSSL_PARAM_construct_octet_string(OSSL_RAND_PARAM_TEST_ENTROPY,
+                                                  entropy, sizeof(entropy));
+    params[2] = OSSL_PARAM_construct_end();
+    if (!TEST_true(EVP_RAND_set_ctx_params(parent, params))
+            || !TEST_true(EVP_RAND_instantiate(parent, strength, 0, NULL, 0,
+                                               params + 1)))
+        goto err;
+
+    if (!TEST_ptr(rand = EVP_RAND_fetch(NULL, "CTR-DRBG", NULL))
+            || !TEST_ptr(drbg = EVP_RAND_CTX_new(rand, parent)))
+        goto err;
+    params[0] = OSSL_PARAM_construct_utf8_string(OSSL_DRBG_PARAM_CIPHER,
+                                                 "AES-256-CTR", 0);
+    params[1] = OSSL_PARAM_construct_int(OSSL_DRBG_PARAM_USE_DF, &use_df);
+    params[2] = OSSL_PARAM_construct_end();
+    if (!TEST_true(EVP_RAND_instantiate(drbg, strength, 0,
+                                        (const unsigned char *)"", 0, params))
+            || !TEST_true(ctr_ref_instantiate(&ref, entropy)))
+        goto err;
+
+    for (i = 0; i < OSSL_NELEM(sizes); i++) {
+        n = sizes[(first + i) % OSSL_NELEM(sizes)];
+        if (!TEST_true(EVP_RAND_generate(drbg, got, n, strength, 0, NULL, 0))
+                || !TEST_true(ctr_ref_generate(&ref, expected, n))
+                || !TEST_mem_eq(got, n, expected, n)) {
+            TEST_info("request %zu of %zu bytes", i, n);
+            goto err;
+        }
+    }
+    ret = 1;
+
+ err:
+    EVP_RAND_CTX_free(drbg);
+    EVP_RAND_CTX_free(parent);
+    EVP_RAND_free(rand);
+    EVP_CIPHER_CTX_free(ref.ctx);
+    OPENSSL_free(got);
+    OPENSSL_free(expected);
+    return ret;
+}
+
 int setup_tests(void)
 {
     ADD_TEST(test_rand_reseed);
@@ -910,6 +1166,8 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_rand_fork_safety, RANDOM_SIZE);
 #endif
     ADD_TEST(test_rand_prediction_resistance);
+    ADD_TEST(test_rand_buffered);
+    ADD_ALL_TESTS(test_rand_ctr_bulk, 2);
 #if defined(OPENSSL_THREADS)
     ADD_TEST(test_multi_thread);
 #endif
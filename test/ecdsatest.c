@@ -22,6 +22,7 @@
 # include <openssl/bn.h>
 # include <openssl/ec.h>
 # include <openssl/rand.h>
+# include <openssl/core_names.h>
 # include "internal/nelem.h"
 # include "ecdsatest.h"
 
@@ -353,6 +354,65 @@ static int test_builtin_as_sm2(int n)
     return test_builtin(n, EVP_PKEY_SM2);
 }
 # endif
+
+static const char *verify_precomp_curves[] = {
+    "P-256", "P-384", "P-521", "secp256k1", "brainpoolP256r1",
+# ifndef OPENSSL_NO_EC2M
+    "sect233k1",
+# endif
+};
+
+/*
+ * Verify repeatedly with a key that builds a table for its public key after
+ * the second verification, so that the results before and after can be
+ * compared.
+ */
+static int test_verify_precomp(int n)
+{
+    const char *curve = verify_precomp_curves[n];
+    unsigned char tbs[32], *sig = NULL;
+    EVP_PKEY *pkey = NULL;
+    EVP_PKEY_CTX *gctx = NULL;
+    EVP_MD_CTX *mctx = NULL;
+    size_t sig_len;
+    int i, ret = 0;
+
+    if (!TEST_ptr(mctx = EVP_MD_CTX_new())
+        || !TEST_true(RAND_bytes(tbs, sizeof(tbs)))
+        || !TEST_ptr(gctx = EVP_PKEY_CTX_new_from_name(NULL, "EC", NULL))
+        || !TEST_int_gt(EVP_PKEY_keygen_init(gctx), 0)
+        || !TEST_true(EVP_PKEY_CTX_set_group_name(gctx, curve))
+        || !TEST_int_gt(EVP_PKEY_keygen(gctx, &pkey), 0)
+        || !TEST_false(EVP_PKEY_set_int_param(pkey,
+                           OSSL_PKEY_PARAM_EC_VERIFY_PRECOMPUTE_THRESHOLD, -1))
+        || !TEST_true(EVP_PKEY_set_int_param(pkey,
+                          OSSL_PKEY_PARAM_EC_VERIFY_PRECOMPUTE_THRESHOLD, 2))
+        || !TEST_ptr(sig = OPENSSL_malloc(sig_len = EVP_PKEY_size(pkey)))
+        || !TEST_true(EVP_DigestSignInit(mctx, NULL, NULL, NULL, pkey))
+        || !TEST_true(EVP_DigestSign(mctx, sig, &sig_len, tbs, sizeof(tbs))))
+        goto err;
+
+    for (i = 0; i < 4; i++) {
+        tbs[0] ^= 1;
+        if (!TEST_true(EVP_DigestVerifyInit(mctx, NULL, NULL, NULL, pkey))
+            || !TEST_int_eq(EVP_DigestVerify(mctx, sig, sig_len,
+                                             tbs, sizeof(tbs)), 0))
+            goto err;
+        tbs[0] ^= 1;
+        if (!TEST_true(EVP_DigestVerifyInit(mctx, NULL, NULL, NULL, pkey))
+            || !TEST_int_eq(EVP_DigestVerify(mctx, sig, sig_len,
+                                             tbs, sizeof(tbs)), 1))
+            goto err;
+    }
+
+    ret = 1;
+ err:
+    EVP_PKEY_free(pkey);
+    EVP_PKEY_CTX_free(gctx);
+    EVP_MD_CTX_free(mctx);
+    OPENSSL_free(sig);
+    return ret;
+}
 #endif /* OPENSSL_NO_EC */
 
 int setup_tests(void)
@@ -376,6 +436,7 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_builtin_as_sm2, crv_len);
 # endif
     ADD_ALL_TESTS(x9_62_tests, OSSL_NELEM(ecdsa_cavs_kats));
+    ADD_ALL_TESTS(test_verify_precomp, OSSL_NELEM(verify_precomp_curves));
 #endif
     return 1;
 }
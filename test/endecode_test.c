@@ -18,6 +18,7 @@
 #include <openssl/param_build.h>
 #include <openssl/encoder.h>
 #include <openssl/decoder.h>
+#include <openssl/provider.h>
 
 #include "internal/cryptlib.h"   /* ossl_assert */
 #include "crypto/pem.h"          /* For PVK and "blob" PEM headers */
@@ -965,6 +966,100 @@ IMPLEMENT_TEST_SUITE_UNPROTECTED_PVK(RSA, "RSA")
 IMPLEMENT_TEST_SUITE_PROTECTED_PVK(RSA, "RSA")
 #endif
 
+/*
+ * Decoder contexts for keys reuse the decoders found for earlier ones with
+ * the same settings, until the set of activated providers or the default
+ * properties change.  Check that they end up with the same decoders and
+ * still decode properly, even when a provider is loaded and unloaded in
+ * between.  The extra decoders are fetched, so they must be missing while
+ * the default properties rule out every provider.
+ */
+static void count_mallocs(int op, const char *api, size_t num,
+                          const char *file, int line, void *arg)
+{
+    if (op == CRYPTO_ALLOC_TRACE_MALLOC)
+        ++*(size_t *)arg;
+}
+
+static int test_decoder_ctx_reuse(void)
+{
+    size_t allocs[5];
+    OSSL_PROVIDER *nullprov = NULL;
+    OSSL_DECODER_CTX *dctx = NULL;
+    EVP_PKEY *pkey = NULL;
+    void *encoded = NULL;
+    long encoded_len = 0;
+    const unsigned char *data;
+    size_t data_len;
+    int num = 0, i, ok = 0;
+
+    if (!TEST_true(encode_EVP_PKEY_prov(&encoded, &encoded_len, key_RSA,
+                                        OSSL_KEYMGMT_SELECT_KEYPAIR
+                                        | OSSL_KEYMGMT_SELECT_DOMAIN_PARAMETERS,
+                                        "PEM", "pkcs8", NULL, NULL)))
+        goto end;
+
+    for (i = 0; i < 5; i++) {
+        if (i == 2 && !TEST_ptr(nullprov = OSSL_PROVIDER_load(NULL, "null")))
+            goto end;
+        if (i == 3) {
+            if (!TEST_true(OSSL_PROVIDER_unload(nullprov)))
+                goto end;
+            nullprov = NULL;
+        }
+
+        data = encoded;
+        data_len = (size_t)encoded_len;
+        allocs[i] = 0;
+        if (!TEST_true(CRYPTO_set_alloc_trace_cb(count_mallocs, &allocs[i])))
+            goto end;
+        dctx = OSSL_DECODER_CTX_new_for_pkey(&pkey, "PEM", NULL, "RSA",
+                                             EVP_PKEY_KEYPAIR, NULL, NULL);
+        CRYPTO_set_alloc_trace_cb(NULL, NULL);
+        if (!TEST_ptr(dctx)
+            || (i == 0
+                && !TEST_int_gt(num = OSSL_DECODER_CTX_get_num_decoders(dctx),
+                                0))
+            || !TEST_int_eq(OSSL_DECODER_CTX_get_num_decoders(dctx), num)
+            || !TEST_true(OSSL_DECODER_from_data(dctx, &data, &data_len))
+            || !TEST_int_eq(EVP_PKEY_eq(pkey, key_RSA), 1))
+            goto end;
+        OSSL_DECODER_CTX_free(dctx);
+        dctx = NULL;
+        EVP_PKEY_free(pkey);
+        pkey = NULL;
+    }
+
+    /*
+     * The second context reuses the chain that the first one built, which
+     * takes a fraction of the allocations.  Loading and unloading a provider
+     * outdates the cache, and it is filled again on the next use.
+     */
+    TEST_info("context allocations: %zu %zu %zu %zu %zu",
+              allocs[0], allocs[1], allocs[2], allocs[3], allocs[4]);
+    if (!TEST_size_t_lt(allocs[1] * 2, allocs[0])
+            || !TEST_size_t_lt(allocs[1] * 2, allocs[2])
+            || !TEST_size_t_lt(allocs[1] * 2, allocs[3])
+            || !TEST_size_t_lt(allocs[4] * 2, allocs[3]))
+        goto end;
+
+    if (!TEST_true(EVP_set_default_properties(NULL, "provider=nonexistent")))
+        goto end;
+    dctx = OSSL_DECODER_CTX_new_for_pkey(&pkey, "PEM", NULL, "RSA",
+                                         EVP_PKEY_KEYPAIR, NULL, NULL);
+    if (dctx != NULL
+            && !TEST_int_lt(OSSL_DECODER_CTX_get_num_decoders(dctx), num))
+        goto end;
+    ok = 1;
+ end:
+    EVP_set_default_properties(NULL, NULL);
+    OSSL_DECODER_CTX_free(dctx);
+    EVP_PKEY_free(pkey);
+    OSSL_PROVIDER_unload(nullprov);
+    OPENSSL_free(encoded);
+    return ok;
+}
+
 #ifndef OPENSSL_NO_EC
 /* Explicit parameters that match a named curve */
 static int do_create_ec_explicit_prime_params(OSSL_PARAM_BLD *bld,
@@ -1290,6 +1385,7 @@ int setup_tests(void)
             ADD_TEST_SUITE_PROTECTED_PVK(RSA);
         }
 # endif
+        ADD_TEST(test_decoder_ctx_reuse);
     }
 
     return 1;
@@ -30,6 +30,7 @@
 #include <openssl/aes.h>
 #include <openssl/decoder.h>
 #include <openssl/rsa.h>
+#include <openssl/rand.h>
 #include "testutil.h"
 #include "internal/nelem.h"
 #include "internal/sizes.h"
@@ -993,6 +994,247 @@ static int test_EVP_DigestVerifyInit(void)
     return ret;
 }
 
+#ifndef OPENSSL_NO_EC
+# define BATCH_NUM 150
+
+/*
+ * Test EVP_DigestVerifyBatch() with Ed25519, which has a provider batch
+ * implementation that works in chunks, and Ed448, which has not.
+ */
+static int test_EVP_DigestVerifyBatch(int idx)
+{
+    const char *keytype = idx == 0 ? "ED25519" : "ED448";
+    static unsigned char msgs[BATCH_NUM][32], sigbufs[BATCH_NUM][114];
+    const unsigned char *tbs[BATCH_NUM], *sigs[BATCH_NUM];
+    size_t tbslens[BATCH_NUM], siglens[BATCH_NUM];
+    int results[BATCH_NUM];
+    EVP_PKEY *pkey = NULL;
+    EVP_PKEY_CTX *pctx = NULL;
+    EVP_MD_CTX *md_ctx = NULL;
+    int i, ret = 0;
+
+    if (!TEST_ptr(pctx = EVP_PKEY_CTX_new_from_name(testctx, keytype,
+                                                    testpropq))
+            || !TEST_int_gt(EVP_PKEY_keygen_init(pctx), 0)
+            || !TEST_int_gt(EVP_PKEY_keygen(pctx, &pkey), 0)
+            || !TEST_ptr(md_ctx = EVP_MD_CTX_new())
+            || !TEST_true(EVP_DigestSignInit_ex(md_ctx, NULL, NULL, testctx,
+                                                testpropq, pkey, NULL)))
+        goto out;
+
+    for (i = 0; i < BATCH_NUM; i++) {
+        tbs[i] = msgs[i];
+        tbslens[i] = sizeof(msgs[i]) - i % 7;
+        sigs[i] = sigbufs[i];
+        siglens[i] = sizeof(sigbufs[i]);
+        if (!TEST_int_gt(RAND_bytes_ex(testctx, msgs[i],
+                                       sizeof(msgs[i])), 0)
+                || !TEST_true(EVP_DigestSign(md_ctx, sigbufs[i], &siglens[i],
+                                             tbs[i], tbslens[i])))
+            goto out;
+    }
+
+    if (!TEST_true(EVP_DigestVerifyInit_ex(md_ctx, NULL, NULL, testctx,
+                                           testpropq, pkey, NULL))
+            || !TEST_int_eq(EVP_DigestVerifyBatch(md_ctx, BATCH_NUM, sigs,
+                                                  siglens, tbs, tbslens,
+                                                  results), 1))
+        goto out;
+    for (i = 0; i < BATCH_NUM; i++)
+        if (!TEST_int_eq(results[i], 1))
+            goto out;
+
+    /* Bad message, bad R, bad length and s out of range */
+    msgs[3][0] ^= 1;
+    sigbufs[70][0] ^= 1;
+    siglens[100]--;
+    sigbufs[149][siglens[149] - 1] = 0xff;
+    if (!TEST_int_eq(EVP_DigestVerifyBatch(md_ctx, BATCH_NUM, sigs, siglens,
+                                           tbs, tbslens, results), 0))
+        goto out;
+    for (i = 0; i < BATCH_NUM; i++)
+        if (!TEST_int_eq(results[i],
+                         i != 3 && i != 70 && i != 100 && i != 149))
+            goto out;
+    ret = 1;
+
+ out:
+    EVP_MD_CTX_free(md_ctx);
+    EVP_PKEY_CTX_free(pctx);
+    EVP_PKEY_free(pkey);
+    return ret;
+}
+
+/*
+ * An Ed25519 signature by the key of RFC 8032 test 1 over "torsion", whose R
+ * has been moved by a point of order 8 (and s computed to match).  It passes
+ * the cofactored verification equation but not the cofactorless one.
+ */
+static const unsigned char ed25519_torsion_seed[] = {
+    0x9d, 0x61, 0xb1, 0x9d, 0xef, 0xfd, 0x5a, 0x60,
+    0xba, 0x84, 0x4a, 0xf4, 0x92, 0xec, 0x2c, 0xc4,
+    0x44, 0x49, 0xc5, 0x69, 0x7b, 0x32, 0x69, 0x19,
+    0x70, 0x3b, 0xac, 0x03, 0x1c, 0xae, 0x7f, 0x60
+};
+static const unsigned char ed25519_torsion_sig[] = {
+    0x18, 0x6e, 0xd2, 0xbd, 0xbd, 0x1a, 0x36, 0xf6,
+    0x43, 0x7c, 0x51, 0x68, 0xb0, 0x22, 0x19, 0x14,
+    0x01, 0x8e, 0xa4, 0xf3, 0x2a, 0x1c, 0x3f, 0xcd,
+    0x1c, 0x17, 0x94, 0xd6, 0x4f, 0xbd, 0x59, 0x6e,
+    0x3e, 0x3c, 0x81, 0x76, 0x08, 0x62, 0x3a, 0xdc,
+    0xea, 0xf7, 0xab, 0x01, 0x05, 0x57, 0x14, 0x43,
+    0x7b, 0x50, 0xd0, 0x47, 0x6d, 0x9e, 0x06, 0xa8,
+    0x2c, 0x40, 0xc7, 0xbb, 0x1b, 0x0c, 0xc3, 0x0e
+};
+
+/*
+ * The Ed25519 batch check is cofactored, so it must accept the signature
+ * above whether its chunk passes the batch equation or not.
+ * EVP_DigestVerify() uses the cofactorless equation and rejects it.
+ */
+static int test_EVP_DigestVerifyBatch_torsion(void)
+{
+    static const unsigned char msg[] = "torsion";
+    unsigned char sigbufs[3][64];
+    const unsigned char *tbs[3], *sigs[3];
+    size_t tbslens[3], siglens[3];
+    int results[3];
+    EVP_PKEY *pkey = NULL;
+    EVP_MD_CTX *md_ctx = NULL;
+    int i, ret = 0;
+
+    if (!TEST_ptr(pkey = EVP_PKEY_new_raw_private_key_ex(
+                             testctx, "ED25519", testpropq,
+                             ed25519_torsion_seed,
+                             sizeof(ed25519_torsion_seed)))
+            || !TEST_ptr(md_ctx = EVP_MD_CTX_new())
+            || !TEST_true(EVP_DigestSignInit_ex(md_ctx, NULL, NULL, testctx,
+                                                testpropq, pkey, NULL)))
+        goto out;
+
+    for (i = 0; i < 3; i++) {
+        tbs[i] = msg;
+        tbslens[i] = sizeof(msg) - 1;
+        sigs[i] = sigbufs[i];
+        siglens[i] = sizeof(sigbufs[i]);
+        if (!TEST_true(EVP_DigestSign(md_ctx, sigbufs[i], &siglens[i],
+                                      tbs[i], tbslens[i])))
+            goto out;
+    }
+    sigs[1] = ed25519_torsion_sig;
+
+    /* A chunk that passes the batch equation */
+    if (!TEST_true(EVP_DigestVerifyInit_ex(md_ctx, NULL, NULL, testctx,
+                                           testpropq, pkey, NULL))
+            || !TEST_int_eq(EVP_DigestVerifyBatch(md_ctx, 3, sigs, siglens,
+                                                  tbs, tbslens, results), 1)
+            || !TEST_int_eq(results[0], 1)
+            || !TEST_int_eq(results[1], 1)
+            || !TEST_int_eq(results[2], 1))
+        goto out;
+
+    /* A chunk that fails it, so that each signature is checked alone */
+    sigbufs[2][0] ^= 1;
+    if (!TEST_int_eq(EVP_DigestVerifyBatch(md_ctx, 3, sigs, siglens,
+                                           tbs, tbslens, results), 0)
+            || !TEST_int_eq(results[0], 1)
+            || !TEST_int_eq(results[1], 1)
+            || !TEST_int_eq(results[2], 0))
+        goto out;
+
+    if (!TEST_true(EVP_DigestVerifyInit_ex(md_ctx, NULL, NULL, testctx,
+                                           testpropq, pkey, NULL))
+            || !TEST_int_eq(EVP_DigestVerify(md_ctx, ed25519_torsion_sig,
+                                             sizeof(ed25519_torsion_sig),
+                                             msg, sizeof(msg) - 1), 0))
+        goto out;
+    ret = 1;
+
+ out:
+    EVP_MD_CTX_free(md_ctx);
+    EVP_PKEY_free(pkey);
+    return ret;
+}
+
+# define DERIVE_BATCH_NUM 70
+
+/*
+ * Test EVP_PKEY_derive_batch() against EVP_PKEY_derive(), with X25519 that
+ * shares work across a batch and X448 that derives one secret at a time.
+ */
+static int test_EVP_PKEY_derive_batch(int idx)
+{
+    const char *keytype = idx == 0 ? "X25519" : "X448";
+    static unsigned char pubbufs[DERIVE_BATCH_NUM][56];
+    static unsigned char expected[DERIVE_BATCH_NUM][56];
+    static unsigned char secretbufs[DERIVE_BATCH_NUM][56];
+    const unsigned char *peers[DERIVE_BATCH_NUM];
+    unsigned char *secrets[DERIVE_BATCH_NUM];
+    size_t peerlens[DERIVE_BATCH_NUM], len;
+    int results[DERIVE_BATCH_NUM];
+    EVP_PKEY *pkey = NULL, *peer = NULL;
+    EVP_PKEY_CTX *genctx = NULL, *ctx = NULL;
+    int i, ret = 0;
+
+    if (!TEST_ptr(genctx = EVP_PKEY_CTX_new_from_name(testctx, keytype,
+                                                      testpropq))
+            || !TEST_int_gt(EVP_PKEY_keygen_init(genctx), 0)
+            || !TEST_int_gt(EVP_PKEY_keygen(genctx, &pkey), 0)
+            || !TEST_ptr(ctx = EVP_PKEY_CTX_new_from_pkey(testctx, pkey,
+                                                          testpropq))
+            || !TEST_int_gt(EVP_PKEY_derive_init(ctx), 0))
+        goto out;
+
+    for (i = 0; i < DERIVE_BATCH_NUM; i++) {
+        peers[i] = pubbufs[i];
+        peerlens[i] = sizeof(pubbufs[i]);
+        secrets[i] = secretbufs[i];
+        len = sizeof(expected[i]);
+        if (!TEST_int_gt(EVP_PKEY_keygen(genctx, &peer), 0)
+                || !TEST_true(EVP_PKEY_get_raw_public_key(peer, pubbufs[i],
+                                                          &peerlens[i]))
+                || !TEST_int_gt(EVP_PKEY_derive_set_peer(ctx, peer), 0)
+                || !TEST_int_gt(EVP_PKEY_derive(ctx, expected[i], &len), 0))
+            goto out;
+        EVP_PKEY_free(peer);
+        peer = NULL;
+    }
+
+    len = sizeof(secretbufs[0]);
+    if (!TEST_int_eq(EVP_PKEY_derive_batch(ctx, DERIVE_BATCH_NUM, peers,
+                                           peerlens, secrets, &len,
+                                           results), 1)
+            || !TEST_size_t_eq(len, peerlens[0]))
+        goto out;
+    for (i = 0; i < DERIVE_BATCH_NUM; i++)
+        if (!TEST_int_eq(results[i], 1)
+                || !TEST_mem_eq(secretbufs[i], len, expected[i], len))
+            goto out;
+
+    /* A peer key of the wrong length and one of small order */
+    peerlens[5]--;
+    memset(pubbufs[40], 0, sizeof(pubbufs[40]));
+    if (!TEST_int_eq(EVP_PKEY_derive_batch(ctx, DERIVE_BATCH_NUM, peers,
+                                           peerlens, secrets, &len,
+                                           results), 0))
+        goto out;
+    for (i = 0; i < DERIVE_BATCH_NUM; i++) {
+        if (!TEST_int_eq(results[i], i != 5 && i != 40)
+                || (results[i]
+                    && !TEST_mem_eq(secretbufs[i], len, expected[i], len)))
+            goto out;
+    }
+    ret = 1;
+
+ out:
+    EVP_PKEY_free(peer);
+    EVP_PKEY_CTX_free(ctx);
+    EVP_PKEY_CTX_free(genctx);
+    EVP_PKEY_free(pkey);
+    return ret;
+}
+#endif
+
 /*
  * Test corner cases of EVP_DigestInit/Update/Final API call behavior.
  */
@@ -2487,6 +2729,120 @@ err:
     return ret;
 }
 
+static const char *aead_record_ciphers[] = {
+    "AES-128-GCM",
+    "AES-128-CCM",
+#if !defined(OPENSSL_NO_CHACHA) && !defined(OPENSSL_NO_POLY1305)
+    "ChaCha20-Poly1305",
+#endif
+};
+
+static int aead_record(EVP_CIPHER_CTX *ctx, int enc, int ccm,
+                       const unsigned char *iv, unsigned char *tag,
+                       const unsigned char *in, unsigned char *out, int inl)
+{
+    static const unsigned char aad[5] = { 0x17, 0x03, 0x03, 0x00, 0x20 };
+    int len, lenf;
+
+    if (ccm && enc && !TEST_int_gt(EVP_CIPHER_CTX_ctrl(ctx,
+                                                       EVP_CTRL_AEAD_SET_TAG,
+                                                       16, NULL), 0))
+        return 0;
+    if (!TEST_true(EVP_CipherInit_ex(ctx, NULL, NULL, NULL, iv, enc))
+            || (!enc
+                && !TEST_int_gt(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG,
+                                                    16, tag), 0))
+            || (ccm && !TEST_true(EVP_CipherUpdate(ctx, NULL, &len, NULL, inl)))
+            || !TEST_true(EVP_CipherUpdate(ctx, NULL, &len, aad, sizeof(aad))))
+        return 0;
+    /* A bad tag is caught by the update for CCM and by the final otherwise */
+    if (EVP_CipherUpdate(ctx, out, &len, in, inl) <= 0
+            || EVP_CipherFinal_ex(ctx, out + len, &lenf) <= 0)
+        return 0;
+    return !enc
+        || TEST_int_gt(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, 16, tag),
+                       0);
+}
+
+/* The CCM tag length is fixed when the key is set */
+static int aead_record_init(EVP_CIPHER_CTX *ctx, EVP_CIPHER *type, int enc,
+                            int ccm, const unsigned char *key)
+{
+    return TEST_true(EVP_CipherInit_ex(ctx, type, NULL, NULL, NULL, enc))
+        && (!ccm
+            || TEST_int_gt(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, 16,
+                                               NULL), 0))
+        && TEST_true(EVP_CipherInit_ex(ctx, NULL, NULL, key, NULL, enc));
+}
+
+/*
+ * Test that a context that is kept for several records and only given a
+ * new IV and tag for each of them, as the TLS record layer does, gives the
+ * same results as a context that is set up afresh for each record.
+ */
+static int test_evp_aead_records(int idx)
+{
+    int ret = 0, i, ccm = (idx == 1);
+    EVP_CIPHER *type = NULL;
+    EVP_CIPHER_CTX *ctx = NULL, *dctx = NULL, *ref = NULL;
+    unsigned char key[32] = { 0x42 };
+    unsigned char iv[12] = { 0x01, 0x02, 0x03 };
+    unsigned char msg[32], ct[32], refct[32], pt[32], tag[16], reftag[16];
+
+    memset(msg, 0x5a, sizeof(msg));
+    if (!TEST_ptr(type = EVP_CIPHER_fetch(testctx, aead_record_ciphers[idx],
+                                          testpropq))
+            || !TEST_ptr(ctx = EVP_CIPHER_CTX_new())
+            || !TEST_ptr(dctx = EVP_CIPHER_CTX_new())
+            || !TEST_ptr(ref = EVP_CIPHER_CTX_new())
+            || !TEST_true(aead_record_init(ctx, type, 1, ccm, key))
+            || !TEST_true(aead_record_init(dctx, type, 0, ccm, key)))
+        goto err;
+
+    for (i = 0; i < 3; i++) {
+        iv[0] = (unsigned char)i;
+        if (!TEST_true(aead_record_init(ref, type, 1, ccm, key))
+                || !TEST_true(aead_record(ref, 1, ccm, iv, reftag, msg, refct,
+                                          sizeof(msg)))
+                || !TEST_true(aead_record(ctx, 1, ccm, iv, tag, msg, ct,
+                                          sizeof(msg)))
+                || !TEST_mem_eq(ct, sizeof(ct), refct, sizeof(refct))
+                || !TEST_mem_eq(tag, sizeof(tag), reftag, sizeof(reftag)))
+            goto err;
+
+        /* A bad tag must not stop the next record from being accepted */
+        tag[0] ^= 1;
+        if (!TEST_false(aead_record(dctx, 0, ccm, iv, tag, ct, pt, sizeof(ct))))
+            goto err;
+        tag[0] ^= 1;
+        if (!TEST_true(aead_record(dctx, 0, ccm, iv, tag, ct, pt, sizeof(ct)))
+                || !TEST_mem_eq(pt, sizeof(pt), msg, sizeof(msg)))
+            goto err;
+    }
+
+    /*
+     * Changing the direction with a new IV must do a full init.  A CCM
+     * context can't change direction once it has a key.
+     */
+    if (!ccm
+            && (!TEST_true(aead_record(ctx, 0, ccm, iv, tag, ct, pt,
+                                       sizeof(ct)))
+                || !TEST_mem_eq(pt, sizeof(pt), msg, sizeof(msg))
+                || !TEST_true(aead_record(ctx, 1, ccm, iv, tag, msg, ct,
+                                          sizeof(msg)))
+                || !TEST_mem_eq(ct, sizeof(ct), refct, sizeof(refct))
+                || !TEST_mem_eq(tag, sizeof(tag), reftag, sizeof(reftag))))
+        goto err;
+
+    ret = 1;
+ err:
+    EVP_CIPHER_CTX_free(ctx);
+    EVP_CIPHER_CTX_free(dctx);
+    EVP_CIPHER_CTX_free(ref);
+    EVP_CIPHER_free(type);
+    return ret;
+}
+
 #ifndef OPENSSL_NO_EC
 static int ecpub_nids[] = { NID_brainpoolP256r1, NID_X9_62_prime256v1,
     NID_secp384r1, NID_secp521r1, NID_sect233k1, NID_sect233r1, NID_sect283r1,
@@ -2670,6 +3026,11 @@ int setup_tests(void)
     ADD_TEST(test_EVP_set_default_properties);
     ADD_ALL_TESTS(test_EVP_DigestSignInit, 9);
     ADD_TEST(test_EVP_DigestVerifyInit);
+#ifndef OPENSSL_NO_EC
+    ADD_ALL_TESTS(test_EVP_DigestVerifyBatch, 2);
+    ADD_TEST(test_EVP_DigestVerifyBatch_torsion);
+    ADD_ALL_TESTS(test_EVP_PKEY_derive_batch, 2);
+#endif
     ADD_TEST(test_EVP_Digest);
     ADD_TEST(test_EVP_Enveloped);
     ADD_ALL_TESTS(test_d2i_AutoPrivateKey, OSSL_NELEM(keydata));
@@ -2731,6 +3092,7 @@ int setup_tests(void)
 
     ADD_TEST(test_rand_agglomeration);
     ADD_ALL_TESTS(test_evp_iv, 10);
+    ADD_ALL_TESTS(test_evp_aead_records, OSSL_NELEM(aead_record_ciphers));
     ADD_TEST(test_EVP_rsa_pss_with_keygen_bits);
 #ifndef OPENSSL_NO_EC
     ADD_ALL_TESTS(test_ecpub, OSSL_NELEM(ecpub_nids));
@@ -198,9 +198,73 @@ static int test_mod_exp(int round)
     return ret;
 }
 
+/*
+ * Moduli of the sizes that have a dedicated constant time implementation on
+ * some platforms, with full length and short exponents and with bases of
+ * various lengths.
+ */
+static const int large_mod_bits[] = { 2048, 3072, 4096 };
+#define LARGE_MOD_CASES 4
+
+static int test_mod_exp_large(int idx)
+{
+    BN_CTX *ctx = NULL;
+    BIGNUM *a = NULL, *p = NULL, *m = NULL;
+    BIGNUM *r_mont = NULL, *r_mont_const = NULL;
+    int bits = large_mod_bits[idx / LARGE_MOD_CASES];
+    int ret = 0;
+
+    if (!TEST_ptr(ctx = BN_CTX_new())
+        || !TEST_ptr(a = BN_new())
+        || !TEST_ptr(p = BN_new())
+        || !TEST_ptr(m = BN_new())
+        || !TEST_ptr(r_mont = BN_new())
+        || !TEST_ptr(r_mont_const = BN_new())
+        || !TEST_true(BN_rand(m, bits, BN_RAND_TOP_ONE, BN_RAND_BOTTOM_ODD))
+        || !TEST_true(BN_rand_range(a, m))
+        || !TEST_true(BN_rand(p, bits, BN_RAND_TOP_ANY, BN_RAND_BOTTOM_ANY)))
+        goto err;
+
+    switch (idx % LARGE_MOD_CASES) {
+    case 1:
+        /* A short exponent, as used with the FFDHE groups */
+        if (!TEST_true(BN_rand(p, 225, BN_RAND_TOP_ONE, BN_RAND_BOTTOM_ANY)))
+            goto err;
+        break;
+    case 2:
+        /* A base that is shorter than the modulus by more than a word */
+        if (!TEST_true(BN_rshift(a, a, 200)))
+            goto err;
+        break;
+    case 3:
+        /* The largest base, m - 1 */
+        if (!TEST_true(BN_sub(a, m, BN_value_one())))
+            goto err;
+        break;
+    }
+
+    if (!TEST_true(BN_mod_exp_mont(r_mont, a, p, m, ctx, NULL))
+        || !TEST_true(BN_mod_exp_mont_consttime(r_mont_const, a, p, m,
+                                                ctx, NULL))
+        || !TEST_BN_eq(r_mont, r_mont_const))
+        goto err;
+
+    ret = 1;
+ err:
+    BN_free(r_mont);
+    BN_free(r_mont_const);
+    BN_free(a);
+    BN_free(p);
+    BN_free(m);
+    BN_CTX_free(ctx);
+    return ret;
+}
+
 int setup_tests(void)
 {
     ADD_TEST(test_mod_exp_zero);
     ADD_ALL_TESTS(test_mod_exp, 200);
+    ADD_ALL_TESTS(test_mod_exp_large,
+                  (int)OSSL_NELEM(large_mod_bits) * LARGE_MOD_CASES);
     return 1;
 }
@@ -83,9 +83,41 @@ static int test_invalid(void)
     return 1;
 }
 
+/* Objects spanning many lines, with and without a header */
+static int test_roundtrip(int idx)
+{
+    static const char hdr[] = "Comment: test\n";
+    BIO *b = BIO_new(BIO_s_mem());
+    char *name = NULL, *header = NULL;
+    unsigned char raw[5000];
+    unsigned char *data = NULL;
+    long len;
+    size_t i;
+    int ret = 0;
+
+    for (i = 0; i < sizeof(raw); i++)
+        raw[i] = (unsigned char)(i * 7 + (i >> 8));
+    if (!TEST_ptr(b)
+        || !TEST_int_gt(PEM_write_bio(b, pemtype, idx == 0 ? "" : hdr,
+                                      raw, sizeof(raw)), 0)
+        || !TEST_true(PEM_read_bio(b, &name, &header, &data, &len))
+        || !TEST_str_eq(name, pemtype)
+        || !TEST_str_eq(header, idx == 0 ? "" : hdr)
+        || !TEST_mem_eq(data, len, raw, sizeof(raw)))
+        goto err;
+    ret = 1;
+ err:
+    BIO_free(b);
+    OPENSSL_free(name);
+    OPENSSL_free(header);
+    OPENSSL_free(data);
+    return ret;
+}
+
 int setup_tests(void)
 {
     ADD_ALL_TESTS(test_b64, OSSL_NELEM(b64_pem_data));
     ADD_TEST(test_invalid);
+    ADD_ALL_TESTS(test_roundtrip, 2);
     return 1;
 }
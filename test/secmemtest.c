@@ -7,6 +7,7 @@
  * https://www.openssl.org/source/license.html
  */
 
+#include <string.h>
 #include <openssl/crypto.h>
 
 #include "testutil.h"
@@ -175,9 +176,88 @@ err:
 #endif
 }
 
+static int test_sec_mem_stats(void)
+{
+#ifndef OPENSSL_NO_SECURE_MEMORY
+    const size_t arena = 65536;
+    size_t free_size, largest, cached;
+    uint64_t locks, locks2;
+    unsigned char *p = NULL;
+    int i, res = 0;
+
+    /* Everything is zero while there is no secure heap */
+    CRYPTO_secure_get_stats(&free_size, &largest, &cached, &locks);
+    if (!TEST_size_t_eq(free_size, 0)
+            || !TEST_size_t_eq(largest, 0)
+            || !TEST_size_t_eq(cached, 0)
+            || !TEST_true(locks == 0))
+        goto err;
+
+    if (!TEST_true(CRYPTO_secure_malloc_init(arena, 16)))
+        goto err;
+    CRYPTO_secure_get_stats(&free_size, &largest, &cached, &locks);
+    if (!TEST_size_t_eq(free_size, arena)
+            || !TEST_size_t_eq(largest, arena)
+            || !TEST_size_t_eq(cached, 0)
+            || !TEST_true(locks == 0))
+        goto err;
+
+    /* The first allocation has to split the arena */
+    if (!TEST_ptr(p = OPENSSL_secure_malloc(20)))
+        goto err;
+    CRYPTO_secure_get_stats(&free_size, &largest, &cached, &locks);
+    if (!TEST_size_t_eq(free_size, arena - 32)
+            || !TEST_size_t_eq(largest, arena / 2)
+            || !TEST_size_t_eq(cached, 0)
+            || !TEST_true(locks == 1))
+        goto err;
+
+    memset(p, 0xa5, 32);
+    OPENSSL_secure_free(p);
+    p = NULL;
+    CRYPTO_secure_get_stats(&free_size, NULL, &cached, &locks);
+    if (!TEST_size_t_eq(CRYPTO_secure_used(), 0)
+            || !TEST_size_t_eq(free_size + cached, arena))
+        goto err;
+
+    /* A block from this thread's cache has to be as clean as any other */
+    if (!TEST_ptr(p = OPENSSL_secure_malloc(20))
+            || !TEST_size_t_eq(CRYPTO_secure_used(), 32))
+        goto err;
+    for (i = 0; i < 32; i++)
+        if (!TEST_uchar_eq(p[i], 0))
+            goto err;
+    CRYPTO_secure_get_stats(NULL, NULL, NULL, &locks2);
+    if (cached > 0 && !TEST_true(locks2 == locks))
+        goto err;
+    OPENSSL_secure_free(p);
+    p = NULL;
+
+    /* Cached blocks do not stop the heap from being torn down and rebuilt */
+    if (!TEST_true(CRYPTO_secure_malloc_done())
+            || !TEST_true(CRYPTO_secure_malloc_init(arena, 16))
+            || !TEST_ptr(p = OPENSSL_secure_malloc(20))
+            || !TEST_true(CRYPTO_secure_allocated(p)))
+        goto err;
+    CRYPTO_secure_get_stats(&free_size, NULL, &cached, NULL);
+    if (!TEST_size_t_eq(free_size, arena - 32)
+            || !TEST_size_t_eq(cached, 0))
+        goto err;
+
+    res = 1;
+err:
+    OPENSSL_secure_free(p);
+    CRYPTO_secure_malloc_done();
+    return res;
+#else
+    return 1;
+#endif
+}
+
 int setup_tests(void)
 {
     ADD_TEST(test_sec_mem);
     ADD_TEST(test_sec_mem_clear);
+    ADD_TEST(test_sec_mem_stats);
     return 1;
 }
@@ -404,6 +404,43 @@ static void thread_shared_evp_pkey(void)
         multi_success = 0;
 }
 
+/*
+ * Sign with the shared key often enough for the blinding to be refreshed on
+ * every thread, and check the signatures
+ */
+static void thread_shared_evp_pkey_sign(void)
+{
+    unsigned char tbs[32] = { 0 };
+    unsigned char sig[256];
+    size_t siglen;
+    EVP_PKEY_CTX *ctx = NULL;
+    int success = 0;
+    int i;
+
+    if (!TEST_ptr(ctx = EVP_PKEY_CTX_new_from_pkey(multi_libctx,
+                                                   shared_evp_pkey, NULL)))
+        goto err;
+
+    for (i = 0; i < 40; i++) {
+        tbs[0] = (unsigned char)i;
+        siglen = sizeof(sig);
+        if (!TEST_int_gt(EVP_PKEY_sign_init(ctx), 0)
+                || !TEST_int_gt(EVP_PKEY_sign(ctx, sig, &siglen,
+                                              tbs, sizeof(tbs)), 0)
+                || !TEST_int_gt(EVP_PKEY_verify_init(ctx), 0)
+                || !TEST_int_gt(EVP_PKEY_verify(ctx, sig, siglen,
+                                                tbs, sizeof(tbs)), 0))
+            goto err;
+    }
+
+    success = 1;
+
+ err:
+    EVP_PKEY_CTX_free(ctx);
+    if (!success)
+        multi_success = 0;
+}
+
 static void thread_downgrade_shared_evp_pkey(void)
 {
 #ifndef OPENSSL_NO_DEPRECATED_3_0
@@ -427,6 +464,7 @@ static void thread_downgrade_shared_evp_pkey(void)
  * Test 2: Simple fetch worker
  * Test 3: Worker downgrading a shared EVP_PKEY
  * Test 4: Worker using a shared EVP_PKEY
+ * Test 5: Worker signing with a shared EVP_PKEY
  */
 static int test_multi(int idx)
 {
@@ -475,6 +513,11 @@ static int test_multi(int idx)
             goto err;
         worker = thread_shared_evp_pkey;
         break;
+    case 5:
+        if (!TEST_ptr(shared_evp_pkey = load_pkey_pem(privkey, multi_libctx)))
+            goto err;
+        worker = thread_shared_evp_pkey_sign;
+        break;
     default:
         TEST_error("Invalid test index");
         goto err;
@@ -578,7 +621,7 @@ int setup_tests(void)
     ADD_TEST(test_thread_local);
     ADD_TEST(test_atomic);
     ADD_TEST(test_multi_load);
-    ADD_ALL_TESTS(test_multi, 5);
+    ADD_ALL_TESTS(test_multi, 6);
     return 1;
 }
 
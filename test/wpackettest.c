@@ -424,6 +424,53 @@ static int test_WPACKET_init_der(void)
     return 1;
 }
 
+static int test_WPACKET_init_arena(void)
+{
+    WPACKET pkt;
+    OSSL_ARENA *arena;
+    size_t written, allocs, heap_allocs;
+    int i, ret = 0;
+
+    if (!TEST_ptr(arena = ossl_arena_new(256)))
+        return 0;
+
+    /* The same as with WPACKET_init(), without using the heap */
+    for (i = 0; i < 10; i++) {
+        ossl_arena_reset(arena);
+        if (!TEST_true(WPACKET_init_arena(&pkt, buf, arena))
+                || !TEST_true(WPACKET_start_sub_packet_u8(&pkt))
+                || !TEST_true(WPACKET_put_bytes_u8(&pkt, 0xff))
+                || !TEST_true(WPACKET_start_sub_packet_u8(&pkt))
+                || !TEST_true(WPACKET_put_bytes_u8(&pkt, 0xff))
+                || !TEST_true(WPACKET_close(&pkt))
+                || !TEST_true(WPACKET_close(&pkt))
+                || !TEST_true(WPACKET_finish(&pkt))
+                || !TEST_true(WPACKET_get_total_written(&pkt, &written))
+                || !TEST_mem_eq(buf->data, written, nestedsub,
+                                sizeof(nestedsub))) {
+            WPACKET_cleanup(&pkt);
+            goto err;
+        }
+    }
+    ossl_arena_get_stats(arena, &allocs, &heap_allocs, NULL);
+    if (!TEST_size_t_eq(allocs, 30)
+            || !TEST_size_t_eq(heap_allocs, 1))
+        goto err;
+
+    /* Cleaning up leaves the sub-packets to the arena */
+    if (!TEST_true(WPACKET_init_arena(&pkt, buf, arena))
+            || !TEST_true(WPACKET_start_sub_packet_u8(&pkt)))
+        goto err;
+    WPACKET_cleanup(&pkt);
+    if (!TEST_ptr_null(pkt.subs))
+        goto err;
+
+    ret = 1;
+ err:
+    ossl_arena_free(arena);
+    return ret;
+}
+
 int setup_tests(void)
 {
     if (!TEST_ptr(buf = BUF_MEM_new()))
@@ -436,6 +483,7 @@ int setup_tests(void)
     ADD_TEST(test_WPACKET_allocate_bytes);
     ADD_TEST(test_WPACKET_memcpy);
     ADD_TEST(test_WPACKET_init_der);
+    ADD_TEST(test_WPACKET_init_arena);
     return 1;
 }
 
@@ -16,6 +16,7 @@
 #include <openssl/x509v3.h>
 #include "testutil.h"
 #include "internal/nelem.h"
+#include "crypto/x509.h"
 
 /**********************************************************************
  *
@@ -48,8 +49,93 @@ static int test_standard_exts(void)
     return good;
 }
 
+/*
+ * Asking for one extension must only decode that one, and give the same
+ * answer as the full extension cache, even if other extensions are bad.
+ */
+static int test_lazy_extensions(void)
+{
+    static const unsigned char bad_nc[] = { 0x05, 0x00 };
+    X509 *x = NULL;
+    X509_EXTENSION *ext = NULL;
+    ASN1_OCTET_STRING *kid = NULL, *nc = NULL;
+    GENERAL_NAMES *gens = NULL;
+    GENERAL_NAME *gen = NULL;
+    ASN1_IA5STRING *dns = NULL;
+    const ASN1_OCTET_STRING *skid;
+    int i, ret = 0;
+
+    if (!TEST_ptr(x = X509_new())
+            || !TEST_true(X509_set_version(x, 2))
+            || !TEST_ptr(kid = ASN1_OCTET_STRING_new())
+            || !TEST_true(ASN1_OCTET_STRING_set(kid,
+                                                (unsigned char *)"kid", 3))
+            || !TEST_true(X509_add1_ext_i2d(x, NID_subject_key_identifier,
+                                            kid, 0, 0))
+            || !TEST_ptr(gens = GENERAL_NAMES_new())
+            || !TEST_ptr(gen = GENERAL_NAME_new())
+            || !TEST_ptr(dns = ASN1_IA5STRING_new())
+            || !TEST_true(ASN1_STRING_set(dns, "example.com", -1)))
+        goto err;
+    GENERAL_NAME_set0_value(gen, GEN_DNS, dns);
+    dns = NULL;
+    if (!TEST_true(sk_GENERAL_NAME_push(gens, gen)))
+        goto err;
+    gen = NULL;
+    if (!TEST_true(X509_add1_ext_i2d(x, NID_subject_alt_name, gens, 0, 0))
+            || !TEST_ptr(nc = ASN1_OCTET_STRING_new())
+            || !TEST_true(ASN1_OCTET_STRING_set(nc, bad_nc, sizeof(bad_nc)))
+            || !TEST_ptr(ext = X509_EXTENSION_create_by_NID(NULL,
+                                                            NID_name_constraints,
+                                                            0, nc))
+            || !TEST_true(X509_add_ext(x, ext, -1)))
+        goto err;
+
+    if (!TEST_ptr(skid = X509_get0_subject_key_id(x))
+            || !TEST_mem_eq(skid->data, skid->length, "kid", 3)
+            || !TEST_ptr_null(X509_get0_authority_key_id(x))
+            || !TEST_int_eq(X509_check_host(x, "example.com", 0, 0, NULL), 1)
+            || !TEST_int_eq(X509_check_host(x, "example.org", 0, 0, NULL), 0)
+            /* Nothing else has been looked at */
+            || !TEST_ptr_null(x->nc)
+            || !TEST_int_eq(x->ex_flags & EXFLAG_SET, 0))
+        goto err;
+
+    /* The full cache finds the bad extension and keeps what was decoded */
+    if (!TEST_false(ossl_x509v3_cache_extensions(x))
+            || !TEST_int_ne(x->ex_flags & EXFLAG_INVALID, 0)
+            || !TEST_ptr_eq(X509_get0_subject_key_id(x), skid)
+            || !TEST_int_eq(X509_check_host(x, "example.com", 0, 0, NULL), 1))
+        goto err;
+
+    /* Replacing the subject alt name is seen by later checks */
+    X509_EXTENSION_free(ext);
+    ext = NULL;
+    if (!TEST_int_ge(i = X509_get_ext_by_NID(x, NID_subject_alt_name, -1), 0)
+            || !TEST_ptr(ext = X509_delete_ext(x, i))
+            || !TEST_int_eq(X509_check_host(x, "example.com", 0, 0, NULL), 0)
+            || !TEST_true(ASN1_STRING_set(sk_GENERAL_NAME_value(gens, 0)
+                                          ->d.dNSName, "example.org", -1))
+            || !TEST_true(X509_add1_ext_i2d(x, NID_subject_alt_name, gens,
+                                            0, 0))
+            || !TEST_int_eq(X509_check_host(x, "example.com", 0, 0, NULL), 0)
+            || !TEST_int_eq(X509_check_host(x, "example.org", 0, 0, NULL), 1))
+        goto err;
+    ret = 1;
+ err:
+    X509_EXTENSION_free(ext);
+    ASN1_OCTET_STRING_free(nc);
+    ASN1_IA5STRING_free(dns);
+    GENERAL_NAME_free(gen);
+    GENERAL_NAMES_free(gens);
+    ASN1_OCTET_STRING_free(kid);
+    X509_free(x);
+    return ret;
+}
+
 int setup_tests(void)
 {
     ADD_TEST(test_standard_exts);
+    ADD_TEST(test_lazy_extensions);
     return 1;
 }